@@ -0,0 +1,266 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Measure the computation of the global routing tables of large
+// topologies of point-to-point links:
+//
+// - a k-ary fat-tree: k pods of k/2 edge and k/2 aggregation switches,
+//   (k/2)^2 core switches, and k/2 hosts under each edge switch;
+// - a random graph: a random spanning tree of n routers, plus random
+//   links up to an average degree.
+//
+// The program prints the wall clock time taken to build the link state
+// database and to compute the routes and, on request, the number of
+// routes and a checksum of all the routing tables, which depends neither
+// on the number of threads which computed them nor on the order of the
+// routes in the tables.
+//
+// It then optionally takes random links down one at a time, and prints
+// the mean time taken to recompute the routes after each failure, either
+// from scratch or incrementally.
+//
+// ./waf --run "global-routing-bench --topology=fat-tree --k=16 --threads=4"
+// ./waf --run "global-routing-bench --topology=random --n=2000 --degree=4"
+// ./waf --run "global-routing-bench --k=12 --failures=10 --incremental=1"
+
+#include <iostream>
+#include <vector>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-module.h"
+#include "ns3/global-route-manager.h"
+
+using namespace ns3;
+
+/** The links of the topology. */
+static std::vector<NetDeviceContainer> g_links;
+
+/**
+ * Connect two nodes with a point-to-point link on a new /30 network.
+ *
+ * \param a The first node.
+ * \param b The second node.
+ * \param p2p The helper which creates the link.
+ * \param address The helper which allocates the addresses.
+ */
+static void
+Connect (Ptr<Node> a, Ptr<Node> b, PointToPointHelper &p2p, Ipv4AddressHelper &address)
+{
+  NetDeviceContainer devices = p2p.Install (a, b);
+  address.Assign (devices);
+  address.NewNetwork ();
+  g_links.push_back (devices);
+}
+
+/**
+ * Take both ends of a link down.
+ *
+ * \param devices The devices of the link.
+ */
+static void
+SetLinkDown (NetDeviceContainer devices)
+{
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      Ptr<Ipv4> ipv4 = devices.Get (i)->GetNode ()->GetObject<Ipv4> ();
+      ipv4->SetDown (ipv4->GetInterfaceForDevice (devices.Get (i)));
+    }
+}
+
+/**
+ * Build a k-ary fat-tree.
+ *
+ * \param k The number of ports of the switches.
+ * \param p2p The helper which creates the links.
+ * \param address The helper which allocates the addresses.
+ */
+static void
+BuildFatTree (uint32_t k, PointToPointHelper &p2p, Ipv4AddressHelper &address)
+{
+  uint32_t half = k / 2;
+  NodeContainer core;
+  core.Create (half * half);
+  InternetStackHelper internet;
+  internet.Install (core);
+  for (uint32_t pod = 0; pod < k; pod++)
+    {
+      NodeContainer aggregation;
+      aggregation.Create (half);
+      NodeContainer edge;
+      edge.Create (half);
+      NodeContainer hosts;
+      hosts.Create (half * half);
+      internet.Install (aggregation);
+      internet.Install (edge);
+      internet.Install (hosts);
+      for (uint32_t i = 0; i < half; i++)
+        {
+          for (uint32_t j = 0; j < half; j++)
+            {
+              Connect (aggregation.Get (i), core.Get (i * half + j), p2p, address);
+              Connect (edge.Get (i), aggregation.Get (j), p2p, address);
+              Connect (hosts.Get (i * half + j), edge.Get (i), p2p, address);
+            }
+        }
+    }
+}
+
+/**
+ * Build a random connected graph.
+ *
+ * \param n The number of routers.
+ * \param degree The average number of links of a router.
+ * \param p2p The helper which creates the links.
+ * \param address The helper which allocates the addresses.
+ */
+static void
+BuildRandom (uint32_t n, double degree, PointToPointHelper &p2p, Ipv4AddressHelper &address)
+{
+  NodeContainer routers;
+  routers.Create (n);
+  InternetStackHelper internet;
+  internet.Install (routers);
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+  for (uint32_t i = 1; i < n; i++)
+    {
+      Connect (routers.Get (i), routers.Get (random->GetInteger (0, i - 1)), p2p, address);
+    }
+  uint32_t links = static_cast<uint32_t> (n * degree / 2);
+  for (uint32_t i = n - 1; i < links; i++)
+    {
+      uint32_t a = random->GetInteger (0, n - 1);
+      uint32_t b = random->GetInteger (0, n - 1);
+      if (a != b)
+        {
+          Connect (routers.Get (a), routers.Get (b), p2p, address);
+        }
+    }
+}
+
+/**
+ * Sum up the global routing tables of all the nodes.
+ *
+ * \param [out] routes The number of routes.
+ * \returns A checksum of the routes of each table, in any order.
+ */
+static uint32_t
+Checksum (uint32_t &routes)
+{
+  uint32_t checksum = 0;
+  routes = 0;
+  for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); i++)
+    {
+      Ptr<GlobalRouter> router = (*i)->GetObject<GlobalRouter> ();
+      if (router == 0)
+        {
+          continue;
+        }
+      Ptr<Ipv4GlobalRouting> routing = router->GetRoutingProtocol ();
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          Ipv4RoutingTableEntry *route = routing->GetRoute (j);
+          uint32_t fields[5] = { (*i)->GetId (), route->GetDest ().Get (), route->GetDestNetworkMask ().Get (),
+                                 route->GetGateway ().Get (), route->GetInterface () };
+          uint32_t hash = 2166136261U;
+          for (uint32_t f = 0; f < 5; f++)
+            {
+              hash = (hash ^ fields[f]) * 16777619U;
+            }
+          checksum += hash;
+          routes++;
+        }
+    }
+  return checksum;
+}
+
+int
+main (int argc, char *argv[])
+{
+  std::string topology = "fat-tree";
+  uint32_t k = 8;
+  uint32_t n = 1000;
+  double degree = 4.0;
+  uint32_t threads = 1;
+  bool checksum = false;
+  uint32_t failures = 0;
+  bool incremental = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("topology", "The topology: fat-tree or random", topology);
+  cmd.AddValue ("k", "The number of ports of the fat-tree switches", k);
+  cmd.AddValue ("n", "The number of routers of the random graph", n);
+  cmd.AddValue ("degree", "The average number of links of the routers of the random graph", degree);
+  cmd.AddValue ("threads", "The number of threads which compute the routes, 0 for one per processor", threads);
+  cmd.AddValue ("checksum", "Whether to print a checksum of the routing tables", checksum);
+  cmd.AddValue ("failures", "The number of random links to take down", failures);
+  cmd.AddValue ("incremental", "Whether to recompute the routes incrementally after a failure", incremental);
+  cmd.Parse (argc, argv);
+
+  Config::SetGlobal ("GlobalRoutingThreadCount", UintegerValue (threads));
+  Config::SetGlobal ("GlobalRoutingIncrementalRecompute", BooleanValue (incremental));
+
+  PointToPointHelper p2p;
+  Ipv4AddressHelper address ("10.0.0.0", "255.255.255.252");
+  if (topology == "fat-tree")
+    {
+      BuildFatTree (k, p2p, address);
+    }
+  else if (topology == "random")
+    {
+      BuildRandom (n, degree, p2p, address);
+    }
+  else
+    {
+      NS_FATAL_ERROR ("Unknown topology " << topology);
+    }
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  GlobalRouteManager::BuildGlobalRoutingDatabase ();
+  int64_t databaseMs = clock.End ();
+  clock.Start ();
+  GlobalRouteManager::InitializeRoutes ();
+  int64_t routesMs = clock.End ();
+
+  std::cout << "nodes:    " << NodeList::GetNNodes () << std::endl
+            << "database: " << databaseMs << " ms" << std::endl
+            << "routes:   " << routesMs << " ms" << std::endl;
+  if (failures > 0)
+    {
+      Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+      random->SetStream (2);
+      clock.Start ();
+      for (uint32_t i = 0; i < failures; i++)
+        {
+          SetLinkDown (g_links[random->GetInteger (0, g_links.size () - 1)]);
+          Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+        }
+      std::cout << "failure:  " << clock.End () / failures << " ms" << std::endl;
+    }
+  if (checksum)
+    {
+      uint32_t routes;
+      uint32_t sum = Checksum (routes);
+      std::cout << "entries:  " << routes << std::endl
+                << "checksum: " << std::hex << sum << std::dec << std::endl;
+    }
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Measure the throughput of the route lookups of the static and global
+// routing protocols, as made for each forwarded packet, in tables of
+// many host routes and a few network routes.
+//
+// With --scan=1, a route whose mask is not a prefix is added to the
+// tables, so that the lookups walk the lists of routes instead of
+// their longest prefix match tries.
+//
+// The global routing keeps the routes to recent destinations in a cache,
+// whose size is set by the ns3::Ipv4GlobalRouting::RouteCacheSize
+// attribute, 0 to measure the lookups of the tables alone.
+//
+// ./waf --run "routing-lookup-bench --routes=10000 --n=1000000"
+// ./waf --run "routing-lookup-bench --routes=10000 --n=10000 --scan=1"
+// ./waf --run "routing-lookup-bench --ns3::Ipv4GlobalRouting::RouteCacheSize=16384"
+
+#include <iomanip>
+#include <iostream>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+
+using namespace ns3;
+
+/**
+ * Print a result line.
+ *
+ * \param [in] name The name of the measurement.
+ * \param [in] n The number of operations.
+ * \param [in] ms The wall clock time of the operations, in milliseconds.
+ */
+static void
+Report (std::string name, uint32_t n, int64_t ms)
+{
+  double perSecond = n * 1000.0 / (ms > 0 ? ms : 1);
+  std::cout << std::left << std::setw (28) << name
+            << std::right << std::setw (10) << ms
+            << std::setw (14) << static_cast<uint64_t> (perSecond) << std::endl;
+}
+
+/**
+ * Time the lookups of random destinations.
+ *
+ * \param [in] name The name of the measurement.
+ * \param [in] routing The routing protocol.
+ * \param [in] routes The number of host routes, to 10.0.0.0 and up.
+ * \param [in] n The number of lookups.
+ * \returns The number of destinations which have a route.
+ */
+static uint32_t
+Lookup (std::string name, Ptr<Ipv4RoutingProtocol> routing, uint32_t routes, uint32_t n)
+{
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (2);
+  Ipv4Header header;
+  Socket::SocketErrno sockerr;
+  uint32_t found = 0;
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      // mostly host routes, some network routes and some misses
+      header.SetDestination (Ipv4Address ((10 << 24) + random->GetInteger (0, routes + routes / 8)));
+      if (routing->RouteOutput (0, header, 0, sockerr) != 0)
+        {
+          found++;
+        }
+    }
+  Report (name, n, clock.End ());
+  return found;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t routes = 10000;
+  uint32_t n = 1000000;
+  bool scan = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("routes", "Number of host routes of each table", routes);
+  cmd.AddValue ("n", "Number of lookups of each measurement", n);
+  cmd.AddValue ("scan", "Whether to walk the lists of routes instead of the tries", scan);
+  cmd.Parse (argc, argv);
+
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  SimpleNetDeviceHelper devices;
+  NetDeviceContainer interfaces;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      interfaces.Add (devices.Install (node));
+    }
+  Ipv4AddressHelper address ("172.16.0.0", "255.255.255.0");
+  address.Assign (interfaces);
+
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  Ipv4StaticRoutingHelper staticHelper;
+  Ptr<Ipv4StaticRouting> staticRouting = staticHelper.GetStaticRouting (ipv4);
+  Ptr<Ipv4GlobalRouting> globalRouting = node->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+  for (uint32_t i = 0; i < routes; i++)
+    {
+      Ipv4Address dest ((10 << 24) + i);
+      Ipv4Address gateway ((172 << 24) + (16 << 16) + (i % 4 << 8) + 2);
+      staticRouting->AddHostRouteTo (dest, gateway, 1 + i % 4);
+      globalRouting->AddHostRouteTo (dest, gateway, 1 + i % 4);
+    }
+  for (uint32_t i = 0; i < routes / 256; i++)
+    {
+      Ipv4Address network ((10 << 24) + (i << 8));
+      staticRouting->AddNetworkRouteTo (network, Ipv4Mask ("255.255.255.0"), Ipv4Address ("172.16.0.2"), 1);
+      globalRouting->AddNetworkRouteTo (network, Ipv4Mask ("255.255.255.0"), Ipv4Address ("172.16.0.2"), 1);
+    }
+  if (scan)
+    {
+      staticRouting->AddNetworkRouteTo (Ipv4Address ("192.0.168.0"), Ipv4Mask ("255.0.255.0"), 1);
+      globalRouting->AddNetworkRouteTo (Ipv4Address ("192.0.168.0"), Ipv4Mask ("255.0.255.0"), 1);
+    }
+
+  std::cout << std::left << std::setw (28) << "operation"
+            << std::right << std::setw (10) << "ms"
+            << std::setw (14) << "lookups/s" << std::endl;
+  uint32_t staticFound = Lookup ("static RouteOutput", staticRouting, routes, n);
+  uint32_t globalFound = Lookup ("global RouteOutput", globalRouting, routes, n);
+  std::cout << "found: " << staticFound << " " << globalFound << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
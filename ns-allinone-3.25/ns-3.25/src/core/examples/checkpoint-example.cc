@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include "ns3/core-module.h"
+
+/**
+ * \file
+ * \ingroup simulator
+ * Example program which runs several variants of a simulation
+ * from one warmed-up checkpoint.
+ *
+ * The model is a single server queue with Poisson arrivals.  After the
+ * warm-up, each variant continues with its own run number and service
+ * rate, and prints the number of customers it served.
+ *
+ * ./waf --run "checkpoint-example --variants=4"
+ */
+
+using namespace ns3;
+
+/** A single server queue with exponential service times. */
+class SingleServerQueue
+{
+public:
+  SingleServerQueue ();
+  /** Schedule the first arrival. */
+  void Start (void);
+
+  /** The inter-arrival times. */
+  Ptr<ExponentialRandomVariable> m_arrival;
+  /** The service times. */
+  Ptr<ExponentialRandomVariable> m_service;
+  /** The number of customers in the queue. */
+  uint32_t m_length;
+  /** The number of customers served. */
+  uint32_t m_served;
+
+private:
+  /** Handle an arrival. */
+  void Arrive (void);
+  /** Handle the end of a service. */
+  void Depart (void);
+};
+
+SingleServerQueue::SingleServerQueue ()
+  : m_length (0),
+    m_served (0)
+{
+  m_arrival = CreateObject<ExponentialRandomVariable> ();
+  m_arrival->SetAttribute ("Mean", DoubleValue (1.0));
+  m_service = CreateObject<ExponentialRandomVariable> ();
+  m_service->SetAttribute ("Mean", DoubleValue (0.9));
+}
+
+void
+SingleServerQueue::Start (void)
+{
+  Simulator::Schedule (Seconds (m_arrival->GetValue ()), &SingleServerQueue::Arrive, this);
+}
+
+void
+SingleServerQueue::Arrive (void)
+{
+  if (m_length++ == 0)
+    {
+      Simulator::Schedule (Seconds (m_service->GetValue ()), &SingleServerQueue::Depart, this);
+    }
+  Simulator::Schedule (Seconds (m_arrival->GetValue ()), &SingleServerQueue::Arrive, this);
+}
+
+void
+SingleServerQueue::Depart (void)
+{
+  m_served++;
+  if (--m_length > 0)
+    {
+      Simulator::Schedule (Seconds (m_service->GetValue ()), &SingleServerQueue::Depart, this);
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t variants = 4;
+  double warmup = 10000.0;
+  double duration = 1000.0;
+
+  CommandLine cmd;
+  cmd.AddValue ("variants", "Number of variants run from the checkpoint", variants);
+  cmd.AddValue ("warmup", "Duration of the warm-up, in seconds", warmup);
+  cmd.AddValue ("duration", "Duration of the variants after the warm-up, in seconds", duration);
+  cmd.Parse (argc, argv);
+
+  SingleServerQueue queue;
+  queue.Start ();
+  Simulator::Stop (Seconds (warmup));
+  Simulator::Run ();
+  std::cout << "warm-up: served " << queue.m_served
+            << ", queue length " << queue.m_length << std::endl;
+
+  uint32_t served = queue.m_served;
+  for (uint32_t i = 0; i < variants; i++)
+    {
+      if (Checkpoint::Fork ())
+        {
+          RngSeedManager::SetRun (i + 1);
+          RandomVariableStream::ResetAllStreams ();
+          queue.m_service->SetAttribute ("Mean", DoubleValue (0.8 + 0.05 * i));
+          Simulator::Stop (Seconds (duration));
+          Simulator::Run ();
+          std::cout << "variant " << i << ": served " << queue.m_served - served
+                    << ", queue length " << queue.m_length << std::endl;
+          Simulator::Destroy ();
+          std::exit (0);
+        }
+    }
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,184 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include <iostream>
+#include <sstream>
+#include "ns3/core-module.h"
+
+/**
+ * \file
+ * \ingroup simulator
+ * Example program which runs a parameter sweep in parallel workers
+ * forked from one warmed-up simulation.
+ *
+ * The model is a single server queue with Poisson arrivals.  After the
+ * warm-up, each variant continues with its own run number and mean
+ * service time, and returns the number of customers it served.
+ *
+ * ./waf --run "sweep-example --runs=8 --workers=4"
+ */
+
+using namespace ns3;
+
+/** A single server queue with exponential service times. */
+class SingleServerQueue
+{
+public:
+  SingleServerQueue ();
+  /** Schedule the first arrival. */
+  void Start (void);
+
+  /** The inter-arrival times. */
+  Ptr<ExponentialRandomVariable> m_arrival;
+  /** The service times. */
+  Ptr<ExponentialRandomVariable> m_service;
+  /** The number of customers in the queue. */
+  uint32_t m_length;
+  /** The number of customers served. */
+  uint32_t m_served;
+
+private:
+  /** Handle an arrival. */
+  void Arrive (void);
+  /** Handle the end of a service. */
+  void Depart (void);
+};
+
+SingleServerQueue::SingleServerQueue ()
+  : m_length (0),
+    m_served (0)
+{
+  m_arrival = CreateObject<ExponentialRandomVariable> ();
+  m_arrival->SetAttribute ("Mean", DoubleValue (1.0));
+  m_service = CreateObject<ExponentialRandomVariable> ();
+  m_service->SetAttribute ("Mean", DoubleValue (0.9));
+}
+
+void
+SingleServerQueue::Start (void)
+{
+  Simulator::Schedule (Seconds (m_arrival->GetValue ()), &SingleServerQueue::Arrive, this);
+}
+
+void
+SingleServerQueue::Arrive (void)
+{
+  if (m_length++ == 0)
+    {
+      Simulator::Schedule (Seconds (m_service->GetValue ()), &SingleServerQueue::Depart, this);
+    }
+  Simulator::Schedule (Seconds (m_arrival->GetValue ()), &SingleServerQueue::Arrive, this);
+}
+
+void
+SingleServerQueue::Depart (void)
+{
+  m_served++;
+  if (--m_length > 0)
+    {
+      Simulator::Schedule (Seconds (m_service->GetValue ()), &SingleServerQueue::Depart, this);
+    }
+}
+
+/** The queue of the simulation. */
+static SingleServerQueue *g_queue = 0;
+/** The mean service time of a variant, set by its arguments. */
+static double g_mean = 0.9;
+/** The duration of a variant, in seconds. */
+static double g_duration = 1000.0;
+
+/**
+ * Run a variant, in its worker.
+ *
+ * \param [in] i The index of the variant.
+ * \returns The number of customers served.
+ */
+static std::string
+Variant (uint32_t i)
+{
+  uint32_t served = g_queue->m_served;
+  g_queue->m_service->SetAttribute ("Mean", DoubleValue (g_mean));
+  Simulator::Stop (Seconds (g_duration));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  std::ostringstream oss;
+  oss << g_queue->m_served - served;
+  return oss.str ();
+}
+
+/**
+ * Print the result of a variant, as soon as it arrives.
+ *
+ * \param [in] i The index of the variant.
+ * \param [in] result The result of the variant.
+ */
+static void
+Result (uint32_t i, std::string result)
+{
+  std::cout << "variant " << i << ": served " << result << std::endl;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t runs = 4;
+  uint32_t workers = 0;
+  double warmup = 10000.0;
+
+  CommandLine cmd;
+  cmd.AddValue ("runs", "Number of run numbers of each mean service time", runs);
+  cmd.AddValue ("workers", "Number of parallel workers, 0 for the number of processors", workers);
+  cmd.AddValue ("warmup", "Duration of the warm-up, in seconds", warmup);
+  cmd.AddValue ("duration", "Duration of the variants after the warm-up, in seconds", g_duration);
+  cmd.AddValue ("mean", "Mean service time, in seconds", g_mean);
+  cmd.Parse (argc, argv);
+
+  SingleServerQueue queue;
+  g_queue = &queue;
+  queue.Start ();
+  Simulator::Stop (Seconds (warmup));
+  Simulator::Run ();
+  std::cout << "warm-up: served " << queue.m_served
+            << ", queue length " << queue.m_length << std::endl;
+
+  SweepRunner runner;
+  runner.SetMaxWorkers (workers);
+  for (uint32_t mean = 0; mean < 3; mean++)
+    {
+      for (uint32_t run = 1; run <= runs; run++)
+        {
+          std::vector<std::string> args;
+          std::ostringstream oss;
+          oss << "--RngRun=" << run;
+          args.push_back (oss.str ());
+          oss.str ("");
+          oss << "--mean=" << 0.8 + 0.05 * mean;
+          args.push_back (oss.str ());
+          runner.AddVariant (args);
+        }
+    }
+  runner.SetResultCallback (MakeCallback (&Result));
+  runner.Run (cmd, MakeCallback (&Variant));
+
+  for (uint32_t i = 0; i < runner.GetNVariants (); i++)
+    {
+      if (!runner.IsSuccess (i))
+        {
+          std::cout << "variant " << i << " failed" << std::endl;
+        }
+    }
+  Simulator::Destroy ();
+  return 0;
+}
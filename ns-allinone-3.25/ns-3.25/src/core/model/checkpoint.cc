@@ -0,0 +1,133 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "checkpoint.h"
+#include "random-variable-stream.h"
+#include "rng-seed-manager.h"
+#include "simulator.h"
+#include "fatal-error.h"
+#include "log.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::Checkpoint implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Checkpoint");
+
+bool
+Checkpoint::Fork (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::fflush (0);
+
+  pid_t pid = fork ();
+  if (pid < 0)
+    {
+      NS_FATAL_ERROR ("Could not fork the simulation");
+    }
+  if (pid == 0)
+    {
+      return true;
+    }
+
+  int status;
+  pid_t result;
+  while ((result = waitpid (pid, &status, 0)) < 0 && errno == EINTR)
+    {
+    }
+  if (result < 0)
+    {
+      NS_LOG_WARN ("Could not wait for forked simulation " << pid << ": "
+                   << std::strerror (errno));
+    }
+  else if (!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+    {
+      NS_LOG_WARN ("Forked simulation " << pid << " failed");
+    }
+  return false;
+}
+
+void
+Checkpoint::Save (std::string filename)
+{
+  NS_LOG_FUNCTION (filename);
+  std::ofstream os (filename.c_str ());
+  if (!os.good ())
+    {
+      NS_FATAL_ERROR ("Could not open checkpoint file " << filename);
+    }
+  os << "ns3-checkpoint 1" << std::endl
+     << "time " << Simulator::Now ().GetTimeStep () << std::endl
+     << "seed " << RngSeedManager::GetSeed () << std::endl
+     << "run " << RngSeedManager::GetRun () << std::endl;
+  RandomVariableStream::SaveAllStreams (os);
+  os << "end" << std::endl;
+}
+
+void
+Checkpoint::Restore (std::string filename)
+{
+  NS_LOG_FUNCTION (filename);
+  std::ifstream is (filename.c_str ());
+  if (!is.good ())
+    {
+      NS_FATAL_ERROR ("Could not open checkpoint file " << filename);
+    }
+  std::string tag;
+  uint32_t version = 0;
+  int64_t time;
+  uint32_t seed;
+  uint64_t run;
+  is >> tag >> version;
+  if (tag != "ns3-checkpoint" || version != 1)
+    {
+      NS_FATAL_ERROR ("Not a checkpoint file: " << filename);
+    }
+  is >> tag >> time;
+  is >> tag >> seed;
+  is >> tag >> run;
+  if (!is)
+    {
+      NS_FATAL_ERROR ("Corrupted checkpoint file " << filename);
+    }
+  if (time != Simulator::Now ().GetTimeStep ())
+    {
+      NS_LOG_WARN ("Restoring at " << Simulator::Now () << " a checkpoint saved at " << TimeStep (time));
+    }
+  RngSeedManager::SetSeed (seed);
+  RngSeedManager::SetRun (run);
+  if (!RandomVariableStream::RestoreAllStreams (is) || !(is >> tag) || tag != "end")
+    {
+      NS_FATAL_ERROR ("The random variables do not match those of checkpoint " << filename);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,114 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <string>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::Checkpoint declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Resume simulations from a checkpoint.
+ *
+ * The events of the simulator are arbitrary callbacks bound to
+ * arbitrary objects, so the state of a simulation cannot be written
+ * to a file in general.  Instead, a warmed-up simulation is
+ * checkpointed in memory by forking the process: each copy continues
+ * from the exact state of the simulation, with all its objects,
+ * pending events and random number streams, and can then be changed
+ * to run a variant of the scenario:
+ *
+ * \code
+ *   BuildTopology ();
+ *   Simulator::Stop (Seconds (100));
+ *   Simulator::Run ();               // the warm-up
+ *   for (uint32_t run = 1; run <= 10; run++)
+ *     {
+ *       if (Checkpoint::Fork ())
+ *         {
+ *           RngSeedManager::SetRun (run);
+ *           RandomVariableStream::ResetAllStreams ();
+ *           Config::Set ("/NodeList/...", ...);
+ *           Simulator::Stop (Seconds (200));
+ *           Simulator::Run ();
+ *           Simulator::Destroy ();
+ *           exit (0);
+ *         }
+ *     }
+ * \endcode
+ *
+ * The positions of the random number streams can also be saved to a
+ * file and restored into the same topology built by another process,
+ * so that it continues the random number sequences of the saved one.
+ * The attributes of the objects can be saved and loaded with the
+ * ConfigStore.
+ */
+class Checkpoint
+{
+public:
+  /**
+   * Fork a copy of this process, which continues from the current
+   * state of the simulation.
+   *
+   * The output buffers are flushed first, so that the copy does
+   * not repeat the output of this process.  This process waits for
+   * the copy to exit, which must exit instead of returning to the
+   * code which called Fork.
+   *
+   * Files opened before the fork, such as traces, are shared by
+   * both processes: the copy should open its own files.
+   *
+   * \returns \c true in the copy, and \c false in this process
+   *          once the copy has exited, or if it cannot be waited
+   *          for, for example when SIGCHLD is ignored.
+   */
+  static bool Fork (void);
+
+  /**
+   * Save the position of the random number streams to a file.
+   *
+   * The file also records the seed, the run number and the
+   * simulation time.
+   *
+   * \param [in] filename The name of the file.
+   */
+  static void Save (std::string filename);
+
+  /**
+   * Restore the position of the random number streams from a file
+   * written by Save().
+   *
+   * The RandomVariableStreams must have been created in the same
+   * order, with the same stream numbers, as in the process which
+   * saved the file.  This also sets the seed and the run number.
+   *
+   * \param [in] filename The name of the file.
+   */
+  static void Restore (std::string filename);
+};
+
+} // namespace ns3
+
+#endif /* CHECKPOINT_H */
@@ -112,14 +112,24 @@ void
 CommandLine::Parse (int iargc, char *argv[])
 {
   NS_LOG_FUNCTION (this << iargc << argv);
+  Parse (std::vector<std::string> (argv, argv + iargc));
+}
+
+void
+CommandLine::Parse (std::vector<std::string> args)
+{
+  NS_LOG_FUNCTION (this << args.size ());
 
-  m_name = SystemPath::Split (argv[0]).back ();
+  if (args.empty ())
+    {
+      return;
+    }
+  m_name = SystemPath::Split (args[0]).back ();
   
-  int argc = iargc;
-  for (argc--, argv++; argc > 0; argc--, argv++)
+  for (std::vector<std::string>::size_type i = 1; i < args.size (); i++)
     {
       // remove "--" or "-" heading.
-      std::string param = *argv;
+      std::string param = args[i];
       std::string::size_type cur = param.find ("--");
       if (cur == 0)
         {
@@ -23,6 +23,7 @@
 #include <string>
 #include <sstream>
 #include <list>
+#include <vector>
 
 #include "callback.h"
 
@@ -280,6 +281,17 @@ public:
    */
   void Parse (int argc, char *argv[]);
 
+  /**
+   * Parse the program arguments.
+   *
+   * This is the same as Parse(int,char*[]), for arguments which do not
+   * come from \c main, such as those of the variants of a SweepRunner.
+   *
+   * \param [in] args The arguments, including the program name as
+   *        first element.
+   */
+  void Parse (std::vector<std::string> args);
+
   /**
    * Get the program name
    *
@@ -26,7 +26,9 @@
 #include "pointer.h"
 #include "log.h"
 
+#include <map>
 #include <sstream>
+#include <utility>
 
 /**
  * \file
@@ -149,10 +151,17 @@ MatchContainer::DisconnectWithoutContext (std::string name, const CallbackBase &
 } // namespace Config
 
 
-/** Helper to test if an array entry matches a config path specification. */
+/**
+ * Helper to test if an array entry matches a config path specification.
+ *
+ * The specification is parsed once, into a list of index ranges, so
+ * that testing an index does not parse strings.
+ */
 class ArrayMatcher
 {
 public:
+  /** Default constructor: match nothing. */
+  ArrayMatcher ();
   /**
    * Construct from a Config path specification.
    *
@@ -167,6 +176,12 @@ public:
    */
   bool Matches (uint32_t i) const;
 private:
+  /**
+   * Parse a specification, or one of its alternatives.
+   *
+   * \param [in] element The Config path specification.
+   */
+  void Parse (std::string element);
   /**
    * Convert a string to an \c uint32_t.
    *
@@ -177,74 +192,85 @@ private:
   bool StringToUint32 (std::string str, uint32_t *value) const;
   /** The Config path element. */
   std::string m_element;
+  /** Whether every index matches. */
+  bool m_all;
+  /** The inclusive ranges of matching indices. */
+  std::vector<std::pair<uint32_t, uint32_t> > m_ranges;
 };
 
 
+ArrayMatcher::ArrayMatcher ()
+  : m_all (false)
+{
+  NS_LOG_FUNCTION (this);
+}
 ArrayMatcher::ArrayMatcher (std::string element)
-  : m_element (element)
+  : m_element (element),
+    m_all (false)
 {
   NS_LOG_FUNCTION (this << element);
+  Parse (element);
 }
-bool
-ArrayMatcher::Matches (uint32_t i) const
+void
+ArrayMatcher::Parse (std::string element)
 {
-  NS_LOG_FUNCTION (this << i);
-  if (m_element == "*")
+  NS_LOG_FUNCTION (this << element);
+  if (element == "*")
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches *");
-      return true;
+      m_all = true;
+      return;
     }
   std::string::size_type tmp;
-  tmp = m_element.find ("|");
+  tmp = element.find ("|");
   if (tmp != std::string::npos)
     {
-      std::string left = m_element.substr (0, tmp-0);
-      std::string right = m_element.substr (tmp+1, m_element.size () - (tmp + 1));
-      ArrayMatcher matcher = ArrayMatcher (left);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<left);
-          return true;
-        }
-      matcher = ArrayMatcher (right);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<right);
-          return true;
-        }
-      NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
-      return false;
+      std::string left = element.substr (0, tmp-0);
+      std::string right = element.substr (tmp+1, element.size () - (tmp + 1));
+      Parse (left);
+      Parse (right);
+      return;
     }
-  std::string::size_type leftBracket = m_element.find ("[");
-  std::string::size_type rightBracket = m_element.find ("]");
-  std::string::size_type dash = m_element.find ("-");
-  if (leftBracket == 0 && rightBracket == m_element.size () - 1 &&
+  std::string::size_type leftBracket = element.find ("[");
+  std::string::size_type rightBracket = element.find ("]");
+  std::string::size_type dash = element.find ("-");
+  if (leftBracket == 0 && rightBracket == element.size () - 1 &&
       dash > leftBracket && dash < rightBracket)
     {
-      std::string lowerBound = m_element.substr (leftBracket + 1, dash - (leftBracket + 1));
-      std::string upperBound = m_element.substr (dash + 1, rightBracket - (dash + 1));
+      std::string lowerBound = element.substr (leftBracket + 1, dash - (leftBracket + 1));
+      std::string upperBound = element.substr (dash + 1, rightBracket - (dash + 1));
       uint32_t min;
       uint32_t max;
       if (StringToUint32 (lowerBound, &min) && 
-          StringToUint32 (upperBound, &max) &&
-          i >= min && i <= max)
+          StringToUint32 (upperBound, &max))
         {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
-          return true;
-        }
-      else
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" does not "<<m_element);
-          return false;
+          m_ranges.push_back (std::make_pair (min, max));
         }
+      return;
     }
   uint32_t value;
-  if (StringToUint32 (m_element, &value) &&
-      i == value)
+  if (StringToUint32 (element, &value))
+    {
+      m_ranges.push_back (std::make_pair (value, value));
+    }
+}
+bool
+ArrayMatcher::Matches (uint32_t i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  if (m_all)
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
+      NS_LOG_DEBUG ("Array "<<i<<" matches *");
       return true;
     }
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator j = m_ranges.begin ();
+       j != m_ranges.end (); j++)
+    {
+      if (i >= j->first && i <= j->second)
+        {
+          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
+          return true;
+        }
+    }
   NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
   return false;
 }
@@ -261,6 +287,17 @@ ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
 
 /**
  * Abstract class to parse Config paths into object references.
+ *
+ * The paths are resolved together in a single traversal of the object
+ * graph: the paths which share a leading sequence of tokens share the
+ * resolution of that sequence.
+ *
+ * The tokens of each path, the index ranges of array tokens and the
+ * attributes which a token designates on each TypeId are computed once
+ * and cached across resolvers.  The cached attributes are dropped when
+ * the TypeId generation changes, and the caches are trimmed, only when
+ * no resolver is alive, so that a resolver created while another one
+ * runs does not invalidate its references.
  */
 class Resolver
 {
@@ -271,11 +308,17 @@ public:
    * \param [in] path The Config path.
    */
   Resolver (std::string path);
+  /**
+   * Construct from a list of base Config paths.
+   *
+   * \param [in] paths The Config paths.
+   */
+  Resolver (const std::vector<std::string> &paths);
   /** Destructor. */
   virtual ~Resolver ();
 
   /**
-   * Parse the stored Config path into an object reference,
+   * Parse the stored Config paths into object references,
    * beginning at the indicated root object.
    *
    * \param [in] root The object corresponding to the current position in
@@ -284,29 +327,108 @@ public:
   void Resolve (Ptr<Object> root);
   
 private:
-  /** Ensure the Config path starts and ends with a '/'. */
-  void Canonicalize (void);
+  /** The indices of the paths which reached the current object. */
+  typedef std::vector<uint32_t> PathSet;
+
+  /** An object-valued attribute designated by a path token. */
+  struct AttributeStep
+  {
+    std::string name;   //!< The attribute name.
+    bool container;     //!< Whether the attribute is an object container.
+  };
+  /** The attributes designated by a path token on a TypeId. */
+  typedef std::vector<AttributeStep> AttributeSteps;
+
+  /** The results shared by all the resolvers. */
+  struct Cache
+  {
+    /** Constructor. */
+    Cache () : generation (TypeId::GetGeneration ()), resolvers (0) {}
+    /** The tokens of each Config path. */
+    std::map<std::string, std::vector<std::string> > paths;
+    /** The matcher of each index token. */
+    std::map<std::string, ArrayMatcher> matchers;
+    /** The attributes designated by each token on each TypeId. */
+    std::map<std::pair<uint16_t, std::string>, AttributeSteps> attributes;
+    /** The TypeId generation of the attributes. */
+    uint32_t generation;
+    /** The number of resolvers alive. */
+    uint32_t resolvers;
+  };
   /**
-   * Parse the next element in the Config path.
+   * Get the cache shared by all the resolvers.
    *
-   * \param [in] path The remaining portion of the Config path.
+   * \returns The cache.
+   */
+  static Cache & GetCache (void);
+  /** Register a new resolver with the cache, which it may clean first. */
+  void Acquire (void);
+
+  /**
+   * Ensure a Config path starts and ends with a '/', and split it
+   * into its tokens, unless it was already.
+   *
+   * \param [in] path The Config path.
+   */
+  void Compile (const std::string &path);
+  /**
+   * Parse the next element of the Config paths.
+   *
+   * \param [in] paths The paths which reached the current object.
+   * \param [in] level The index of the next token of these paths.
    * \param [in] root The object corresponding to the current positon
-   *                  in the Config path.
+   *                  in the Config paths.
    */
-  void DoResolve (std::string path, Ptr<Object> root);
+  void DoResolve (const PathSet &paths, uint32_t level, Ptr<Object> root);
   /**
-   * Parse an index on the Config path.
+   * Parse the next element of Config paths which share it.
    *
-   * \param [in] path The remaining Config path.
+   * \param [in] paths The paths which share the next token.
+   * \param [in] level The index of the next token of these paths.
+   * \param [in] root The object corresponding to the current positon
+   *                  in the Config paths.
+   */
+  void DoResolveItem (const PathSet &paths, uint32_t level, Ptr<Object> root);
+  /**
+   * Parse an index on the Config paths.
+   *
+   * \param [in] paths The paths which reached the container.
+   * \param [in] level The index of the index token of these paths.
    * \param [in,out] vector The resulting list of matching objects.
    */
-  void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  void DoArrayResolve (const PathSet &paths, uint32_t level, const ObjectPtrContainerValue &vector);
+  /**
+   * Split a set of paths according to their token at some level.
+   *
+   * \param [in] paths The paths.
+   * \param [in] level The token index.
+   * \param [out] ended The paths which have no token at this level.
+   * \param [out] groups The other paths, grouped by token.
+   */
+  void Group (const PathSet &paths, uint32_t level, PathSet &ended,
+              std::vector<PathSet> &groups) const;
+  /**
+   * Get the object-valued attributes designated by a path token.
+   *
+   * \param [in] tid The TypeId of the object.
+   * \param [in] item The path token.
+   * \returns The attributes of \p tid and of its parents matching \p item.
+   */
+  const AttributeSteps & GetAttributeSteps (TypeId tid, std::string item);
+  /**
+   * Get the matcher of an index path token.
+   *
+   * \param [in] item The path token.
+   * \returns The matcher.
+   */
+  const ArrayMatcher & GetArrayMatcher (std::string item);
   /**
    * Handle one object found on the path.
    *
    * \param [in] object The current object on the Config path.
+   * \param [in] index The index of the path.
    */
-  void DoResolveOne (Ptr<Object> object);
+  void DoResolveOne (Ptr<Object> object, uint32_t index);
   /**
    * Get the current Config path.
    *
@@ -318,43 +440,109 @@ private:
    *
    * \param [in] object The found object.
    * \param [in] path The matching Config path context.
+   * \param [in] index The index of the Config path in the resolver.
    */
-  virtual void DoOne (Ptr<Object> object, std::string path) = 0;
+  virtual void DoOne (Ptr<Object> object, std::string path, uint32_t index) = 0;
 
   /** Current list of path tokens. */
   std::vector<std::string> m_workStack;
-  /** The Config path. */
-  std::string m_path;
+  /** The tokens of each Config path, owned by the cache. */
+  std::vector<const std::vector<std::string> *> m_items;
+  /** All the Config paths. */
+  PathSet m_all;
 };
 
 Resolver::Resolver (std::string path)
-  : m_path (path)
 {
   NS_LOG_FUNCTION (this << path);
-  Canonicalize ();
+  Acquire ();
+  Compile (path);
+}
+Resolver::Resolver (const std::vector<std::string> &paths)
+{
+  NS_LOG_FUNCTION (this << paths.size ());
+  Acquire ();
+  for (std::vector<std::string>::const_iterator i = paths.begin (); i != paths.end (); i++)
+    {
+      Compile (*i);
+    }
 }
 Resolver::~Resolver ()
 {
   NS_LOG_FUNCTION (this);
+  GetCache ().resolvers--;
+}
+Resolver::Cache &
+Resolver::GetCache (void)
+{
+  // Never destroyed: Config may be used by the destructors of statics.
+  static Cache *cache = new Cache ();
+  return *cache;
 }
 void
-Resolver::Canonicalize (void)
+Resolver::Acquire (void)
 {
   NS_LOG_FUNCTION (this);
+  Cache &cache = GetCache ();
+  if (cache.resolvers == 0)
+    {
+      if (cache.generation != TypeId::GetGeneration ())
+        {
+          cache.attributes.clear ();
+          cache.generation = TypeId::GetGeneration ();
+        }
+      // Paths which name single objects, such as /NodeList/12/..., are
+      // rarely seen twice: bound the caches.
+      if (cache.paths.size () > 1000)
+        {
+          cache.paths.clear ();
+        }
+      if (cache.matchers.size () > 1000)
+        {
+          cache.matchers.clear ();
+        }
+    }
+  cache.resolvers++;
+}
+void
+Resolver::Compile (const std::string &original)
+{
+  NS_LOG_FUNCTION (this << original);
+  std::map<std::string, std::vector<std::string> > &paths = GetCache ().paths;
+  std::map<std::string, std::vector<std::string> >::iterator it = paths.find (original);
+  if (it != paths.end ())
+    {
+      m_all.push_back (m_items.size ());
+      m_items.push_back (&it->second);
+      return;
+    }
 
   // ensure that we start and end with a '/'
-  std::string::size_type tmp = m_path.find ("/");
+  std::string path = original;
+  std::string::size_type tmp = path.find ("/");
   if (tmp != 0)
     {
       // no slash at start
-      m_path = "/" + m_path;
+      path = "/" + path;
     }
-  tmp = m_path.find_last_of ("/");
-  if (tmp != (m_path.size () - 1))
+  tmp = path.find_last_of ("/");
+  if (tmp != (path.size () - 1))
     {
       // no slash at end
-      m_path = m_path + "/";
+      path = path + "/";
     }
+
+  std::vector<std::string> items;
+  std::string::size_type cur = 0;
+  std::string::size_type next = path.find ("/", 1);
+  while (next != std::string::npos)
+    {
+      items.push_back (path.substr (cur + 1, next - (cur + 1)));
+      cur = next;
+      next = path.find ("/", cur + 1);
+    }
+  m_all.push_back (m_items.size ());
+  m_items.push_back (&(paths[original] = items));
 }
 
 void 
@@ -362,7 +550,7 @@ Resolver::Resolve (Ptr<Object> root)
 {
   NS_LOG_FUNCTION (this << root);
 
-  DoResolve (m_path, root);
+  DoResolve (m_all, 0, root);
 }
 
 std::string
@@ -379,39 +567,134 @@ Resolver::GetResolvedPath (void) const
 }
 
 void 
-Resolver::DoResolveOne (Ptr<Object> object)
+Resolver::DoResolveOne (Ptr<Object> object, uint32_t index)
 {
-  NS_LOG_FUNCTION (this << object);
+  NS_LOG_FUNCTION (this << object << index);
 
   NS_LOG_DEBUG ("resolved="<<GetResolvedPath ());
-  DoOne (object, GetResolvedPath ());
+  DoOne (object, GetResolvedPath (), index);
 }
 
 void
-Resolver::DoResolve (std::string path, Ptr<Object> root)
+Resolver::Group (const PathSet &paths, uint32_t level, PathSet &ended,
+                 std::vector<PathSet> &groups) const
 {
-  NS_LOG_FUNCTION (this << path << root);
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
+  for (PathSet::const_iterator i = paths.begin (); i != paths.end (); i++)
+    {
+      const std::vector<std::string> &items = *m_items[*i];
+      if (items.size () <= level)
+        {
+          ended.push_back (*i);
+          continue;
+        }
+      std::vector<PathSet>::iterator group;
+      for (group = groups.begin (); group != groups.end (); group++)
+        {
+          if ((*m_items[group->front ()])[level] == items[level])
+            {
+              break;
+            }
+        }
+      if (group == groups.end ())
+        {
+          groups.push_back (PathSet ());
+          group = groups.end () - 1;
+        }
+      group->push_back (*i);
+    }
+}
 
-  if (next == std::string::npos)
-    {
-      //
-      // If root is zero, we're beginning to see if we can use the object name 
-      // service to resolve this path.  It is impossible to have a object name 
-      // associated with the root of the object name service since that root
-      // is not an object.  This path must be referring to something in another
-      // namespace and it will have been found already since the name service
-      // is always consulted last.
-      // 
-      if (root)
+const Resolver::AttributeSteps &
+Resolver::GetAttributeSteps (TypeId tid, std::string item)
+{
+  std::pair<uint16_t, std::string> key = std::make_pair (tid.GetUid (), item);
+  std::map<std::pair<uint16_t, std::string>, AttributeSteps> &attributes = GetCache ().attributes;
+  std::map<std::pair<uint16_t, std::string>, AttributeSteps>::iterator it = attributes.find (key);
+  if (it != attributes.end ())
+    {
+      return it->second;
+    }
+  AttributeSteps &steps = attributes[key];
+  TypeId nextTid = tid;
+  do
+    {
+      tid = nextTid;
+      for (uint32_t i = 0; i < tid.GetAttributeN(); i++)
         {
-          DoResolveOne (root);
+          struct TypeId::AttributeInformation info;
+          info = tid.GetAttribute(i);
+          if (info.name != item && item != "*")
+            {
+              continue;
+            }
+          AttributeStep step;
+          step.name = info.name;
+          // attempt to cast to a pointer checker.
+          if (dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              step.container = false;
+              steps.push_back (step);
+            }
+          // attempt to cast to an object vector.
+          else if (dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              step.container = true;
+              steps.push_back (step);
+            }
+          // this could be anything else and we don't know what to do with it.
+          // So, we just ignore it.
+        }
+      nextTid = tid.GetParent ();
+    } while (nextTid != tid);
+  return steps;
+}
+
+const ArrayMatcher &
+Resolver::GetArrayMatcher (std::string item)
+{
+  std::map<std::string, ArrayMatcher> &matchers = GetCache ().matchers;
+  std::map<std::string, ArrayMatcher>::iterator it = matchers.find (item);
+  if (it == matchers.end ())
+    {
+      it = matchers.insert (std::make_pair (item, ArrayMatcher (item))).first;
+    }
+  return it->second;
+}
+
+void
+Resolver::DoResolve (const PathSet &paths, uint32_t level, Ptr<Object> root)
+{
+  NS_LOG_FUNCTION (this << paths.size () << level << root);
+  PathSet ended;
+  std::vector<PathSet> groups;
+  Group (paths, level, ended, groups);
+
+  //
+  // If root is zero, we're beginning to see if we can use the object name 
+  // service to resolve this path.  It is impossible to have a object name 
+  // associated with the root of the object name service since that root
+  // is not an object.  This path must be referring to something in another
+  // namespace and it will have been found already since the name service
+  // is always consulted last.
+  // 
+  if (root)
+    {
+      for (PathSet::const_iterator i = ended.begin (); i != ended.end (); i++)
+        {
+          DoResolveOne (root, *i);
         }
-      return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  for (std::vector<PathSet>::const_iterator group = groups.begin (); group != groups.end (); group++)
+    {
+      DoResolveItem (*group, level, root);
+    }
+}
+
+void
+Resolver::DoResolveItem (const PathSet &paths, uint32_t level, Ptr<Object> root)
+{
+  const std::string &item = (*m_items[paths.front ()])[level];
+  NS_LOG_FUNCTION (this << item << root);
 
   //
   // If root is zero, we're beginning to see if we can use the object name 
@@ -422,11 +705,11 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   //
   if (root == 0)
     {
-      std::string::size_type offset = path.find ("/Names");
+      std::string::size_type offset = item.find ("Names");
       if (offset == 0)
         {
           m_workStack.push_back (item);
-          DoResolve (pathLeft, root);
+          DoResolve (paths, level + 1, root);
           m_workStack.pop_back ();
           return;
         }
@@ -443,7 +726,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       NS_LOG_DEBUG ("Name system resolved item = " << item << " to " << namedObject);
       m_workStack.push_back (item);
-      DoResolve (pathLeft, namedObject);
+      DoResolve (paths, level + 1, namedObject);
       m_workStack.pop_back ();
       return;
     }
@@ -473,67 +756,45 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
           return;
         }
       m_workStack.push_back (item);
-      DoResolve (pathLeft, object);
+      DoResolve (paths, level + 1, object);
       m_workStack.pop_back ();
     }
   else 
     {
       // this is a normal attribute.
-      TypeId tid;
-      TypeId nextTid = root->GetInstanceTypeId ();
+      const AttributeSteps &steps = GetAttributeSteps (root->GetInstanceTypeId (), item);
       bool foundMatch = false;
-      
-      do
+      for (AttributeSteps::const_iterator step = steps.begin (); step != steps.end (); step++)
         {
-          tid = nextTid;
-          
-          for (uint32_t i = 0; i < tid.GetAttributeN(); i++)
+          if (!step->container)
             {
-              struct TypeId::AttributeInformation info;
-              info = tid.GetAttribute(i);
-              if (info.name != item && item != "*")
+              NS_LOG_DEBUG ("GetAttribute(ptr)="<<step->name<<" on path="<<GetResolvedPath ());
+              PointerValue ptr;
+              root->GetAttribute (step->name, ptr);
+              Ptr<Object> object = ptr.Get<Object> ();
+              if (object == 0)
                 {
+                  NS_LOG_ERROR ("Requested object name=\""<<item<<
+                                "\" exists on path=\""<<GetResolvedPath ()<<"\""
+                                " but is null.");
                   continue;
                 }
-              // attempt to cast to a pointer checker.
-              const PointerChecker *ptr = dynamic_cast<const PointerChecker *> (PeekPointer (info.checker));
-              if (ptr != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(ptr)="<<info.name<<" on path="<<GetResolvedPath ());
-                  PointerValue ptr;
-                  root->GetAttribute (info.name, ptr);
-                  Ptr<Object> object = ptr.Get<Object> ();
-                  if (object == 0)
-                    {
-                      NS_LOG_ERROR ("Requested object name=\""<<item<<
-                                    "\" exists on path=\""<<GetResolvedPath ()<<"\""
-                                    " but is null.");
-                      continue;
-                    }
-                  foundMatch = true;
-                  m_workStack.push_back (info.name);
-                  DoResolve (pathLeft, object);
-                  m_workStack.pop_back ();
-                }
-              // attempt to cast to an object vector.
-              const ObjectPtrContainerChecker *vectorChecker = 
-                dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
-              if (vectorChecker != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(vector)="<<info.name<<" on path="<<GetResolvedPath () << pathLeft);
-                  foundMatch = true;
-                  ObjectPtrContainerValue vector;
-                  root->GetAttribute (info.name, vector);
-                  m_workStack.push_back (info.name);
-                  DoArrayResolve (pathLeft, vector);
-                  m_workStack.pop_back ();
-                }
-              // this could be anything else and we don't know what to do with it.
-              // So, we just ignore it.
+              foundMatch = true;
+              m_workStack.push_back (step->name);
+              DoResolve (paths, level + 1, object);
+              m_workStack.pop_back ();
             }
-
-          nextTid = tid.GetParent ();
-        } while (nextTid != tid);
+          else
+            {
+              NS_LOG_DEBUG ("GetAttribute(vector)="<<step->name<<" on path="<<GetResolvedPath ());
+              foundMatch = true;
+              ObjectPtrContainerValue vector;
+              root->GetAttribute (step->name, vector);
+              m_workStack.push_back (step->name);
+              DoArrayResolve (paths, level + 1, vector);
+              m_workStack.pop_back ();
+            }
+        }
       
       if (!foundMatch)
         {
@@ -544,30 +805,28 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
 }
 
 void 
-Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &container)
+Resolver::DoArrayResolve (const PathSet &paths, uint32_t level, const ObjectPtrContainerValue &container)
 {
-  NS_LOG_FUNCTION(this << path << &container);
-  NS_ASSERT (path != "");
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
-  if (next == std::string::npos)
-    {
-      return;
-    }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  NS_LOG_FUNCTION(this << paths.size () << level << &container);
+  PathSet ended;
+  std::vector<PathSet> groups;
+  // the paths which end with the container itself match nothing
+  Group (paths, level, ended, groups);
 
-  ArrayMatcher matcher = ArrayMatcher (item);
-  ObjectPtrContainerValue::Iterator it;
-  for (it = container.Begin (); it != container.End (); ++it)
+  for (std::vector<PathSet>::const_iterator group = groups.begin (); group != groups.end (); group++)
     {
-      if (matcher.Matches ((*it).first))
+      const ArrayMatcher &matcher = GetArrayMatcher ((*m_items[group->front ()])[level]);
+      ObjectPtrContainerValue::Iterator it;
+      for (it = container.Begin (); it != container.End (); ++it)
         {
-          std::ostringstream oss;
-          oss << (*it).first;
-          m_workStack.push_back (oss.str ());
-          DoResolve (pathLeft, (*it).second);
-          m_workStack.pop_back ();
+          if (matcher.Matches ((*it).first))
+            {
+              std::ostringstream oss;
+              oss << (*it).first;
+              m_workStack.push_back (oss.str ());
+              DoResolve (*group, level + 1, (*it).second);
+              m_workStack.pop_back ();
+            }
         }
     }
 }
@@ -586,8 +845,18 @@ public:
   void DisconnectWithoutContext (std::string path, const CallbackBase &cb);
   /** \copydoc Config::Disconnect() */
   void Disconnect (std::string path, const CallbackBase &cb);
+  /** \copydoc Config::ConnectMany() */
+  void ConnectMany (const std::vector<std::string> &paths,
+                    const std::vector<CallbackBase> &cbs);
   /** \copydoc Config::LookupMatches() */
   Config::MatchContainer LookupMatches (std::string path);
+  /**
+   * Resolve a list of Config paths in a single pass.
+   *
+   * \param [in] paths The Config paths.
+   * \returns The matches of each path, in the same order.
+   */
+  std::vector<Config::MatchContainer> LookupMatches (const std::vector<std::string> &paths);
 
   /** \copydoc Config::RegisterRootNamespaceObject() */
   void RegisterRootNamespaceObject (Ptr<Object> obj);
@@ -681,19 +950,28 @@ Config::MatchContainer
 ConfigImpl::LookupMatches (std::string path)
 {
   NS_LOG_FUNCTION (this << path);
+  return LookupMatches (std::vector<std::string> (1, path)).front ();
+}
+
+std::vector<Config::MatchContainer>
+ConfigImpl::LookupMatches (const std::vector<std::string> &paths)
+{
+  NS_LOG_FUNCTION (this << paths.size ());
   class LookupMatchesResolver : public Resolver 
   {
   public:
-    LookupMatchesResolver (std::string path)
-      : Resolver (path)
+    LookupMatchesResolver (const std::vector<std::string> &paths)
+      : Resolver (paths),
+        m_objects (paths.size ()),
+        m_contexts (paths.size ())
     {}
-    virtual void DoOne (Ptr<Object> object, std::string path) {
-      m_objects.push_back (object);
-      m_contexts.push_back (path);
+    virtual void DoOne (Ptr<Object> object, std::string path, uint32_t index) {
+      m_objects[index].push_back (object);
+      m_contexts[index].push_back (path);
     }
-    std::vector<Ptr<Object> > m_objects;
-    std::vector<std::string> m_contexts;
-  } resolver = LookupMatchesResolver (path);
+    std::vector<std::vector<Ptr<Object> > > m_objects;
+    std::vector<std::vector<std::string> > m_contexts;
+  } resolver (paths);
   for (Roots::const_iterator i = m_roots.begin (); i != m_roots.end (); i++)
     {
       resolver.Resolve (*i);
@@ -706,7 +984,38 @@ ConfigImpl::LookupMatches (std::string path)
   //
   resolver.Resolve (0);
 
-  return Config::MatchContainer (resolver.m_objects, resolver.m_contexts, path);
+  std::vector<Config::MatchContainer> containers;
+  for (uint32_t i = 0; i < paths.size (); i++)
+    {
+      containers.push_back (Config::MatchContainer (resolver.m_objects[i],
+                                                    resolver.m_contexts[i],
+                                                    paths[i]));
+    }
+  return containers;
+}
+
+void 
+ConfigImpl::ConnectMany (const std::vector<std::string> &paths,
+                         const std::vector<CallbackBase> &cbs)
+{
+  NS_LOG_FUNCTION (this << paths.size () << cbs.size ());
+  NS_ASSERT_MSG (paths.size () == cbs.size (),
+                 "Config::ConnectMany needs one callback per path");
+
+  std::vector<std::string> roots;
+  std::vector<std::string> leaves;
+  for (std::vector<std::string>::const_iterator i = paths.begin (); i != paths.end (); i++)
+    {
+      std::string root, leaf;
+      ParsePath (*i, &root, &leaf);
+      roots.push_back (root);
+      leaves.push_back (leaf);
+    }
+  std::vector<Config::MatchContainer> containers = LookupMatches (roots);
+  for (uint32_t i = 0; i < containers.size (); i++)
+    {
+      containers[i].Connect (leaves[i], cbs[i]);
+    }
 }
 
 void 
@@ -843,6 +1152,12 @@ Disconnect (std::string path, const CallbackBase &cb)
   NS_LOG_FUNCTION (path << &cb);
   ConfigImpl::Get ()->Disconnect (path, cb);
 }
+void
+ConnectMany (const std::vector<std::string> &paths, const std::vector<CallbackBase> &cbs)
+{
+  NS_LOG_FUNCTION (paths.size () << cbs.size ());
+  ConfigImpl::Get ()->ConnectMany (paths, cbs);
+}
 Config::MatchContainer LookupMatches (std::string path)
 {
   NS_LOG_FUNCTION (path);
@@ -139,6 +139,21 @@ void Connect (std::string path, const CallbackBase &cb);
  * This function undoes the work of Config::ConnectWithContext.
  */
 void Disconnect (std::string path, const CallbackBase &cb);
+/**
+ * \ingroup config
+ * \param [in] paths The paths to match trace sources.
+ * \param [in] cbs The callback to connect to the trace sources
+ *                 matching each path.
+ *
+ * This function is equivalent to calling Config::Connect for each
+ * path and callback in turn, but it resolves all the paths in a
+ * single walk of the object graph: the objects matched by the
+ * leading tokens shared by several paths, such as the wildcards
+ * over the NodeList and the DeviceList of each node, are only
+ * looked up once.
+ */
+void ConnectMany (const std::vector<std::string> &paths,
+                  const std::vector<CallbackBase> &cbs);
 
 /**
  * \ingroup config
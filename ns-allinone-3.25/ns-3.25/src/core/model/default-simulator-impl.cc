@@ -22,13 +22,17 @@
 #include "default-simulator-impl.h"
 #include "scheduler.h"
 #include "event-impl.h"
+#include "event-profiler.h"
 
 #include "ptr.h"
 #include "pointer.h"
+#include "boolean.h"
+#include "uinteger.h"
 #include "assert.h"
 #include "log.h"
 
 #include <cmath>
+#include <iostream>
 
 
 /**
@@ -53,6 +57,43 @@ DefaultSimulatorImpl::GetTypeId (void)
     .SetParent<SimulatorImpl> ()
     .SetGroupName ("Core")
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("EventPoolHits",
+                   "The number of events allocated from the event pool "
+                   "of the simulation thread.",
+                   TypeId::ATTR_GET,
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&DefaultSimulatorImpl::GetEventPoolHits),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("EventPoolMisses",
+                   "The number of events of the simulation thread which "
+                   "could not be allocated from the event pool.",
+                   TypeId::ATTR_GET,
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&DefaultSimulatorImpl::GetEventPoolMisses),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("EnableProfiler",
+                   "Run the events through an EventProfiler, which reports "
+                   "the wall clock time of each kind of event to std::clog.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&DefaultSimulatorImpl::m_enableProfiler),
+                   MakeBooleanChecker ())
+    .AddAttribute ("ProfilerInterval",
+                   "The simulation time between the reports of the profiler, "
+                   "or 0 to only report when the simulator is destroyed.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&DefaultSimulatorImpl::m_profilerInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("ProfilerSamplingPeriod",
+                   "The profiler times one out of this many events.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&DefaultSimulatorImpl::m_profilerSamplingPeriod),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("ProfilerTopN",
+                   "The number of kinds of events and of contexts in the "
+                   "reports of the profiler.",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&DefaultSimulatorImpl::m_profilerTopN),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
@@ -71,13 +112,14 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentTs = 0;
   m_currentContext = 0xffffffff;
   m_unscheduledEvents = 0;
-  m_eventsWithContextEmpty = true;
   m_main = SystemThread::Self();
+  m_profiler = 0;
 }
 
 DefaultSimulatorImpl::~DefaultSimulatorImpl ()
 {
   NS_LOG_FUNCTION (this);
+  delete m_profiler;
 }
 
 void
@@ -108,6 +150,12 @@ DefaultSimulatorImpl::Destroy ()
           ev->Invoke ();
         }
     }
+  if (m_profiler != 0)
+    {
+      m_profiler->Print (std::clog, m_currentTs);
+      delete m_profiler;
+      m_profiler = 0;
+    }
 }
 
 void
@@ -146,7 +194,14 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  if (m_profiler == 0)
+    {
+      next.impl->Invoke ();
+    }
+  else
+    {
+      m_profiler->Invoke (next.impl, m_currentTs, m_currentContext, m_unscheduledEvents);
+    }
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
@@ -161,22 +216,9 @@ DefaultSimulatorImpl::IsFinished (void) const
 void
 DefaultSimulatorImpl::ProcessEventsWithContext (void)
 {
-  if (m_eventsWithContextEmpty)
+  EventWithContext event;
+  while (m_eventsWithContext.Pop (event))
     {
-      return;
-    }
-
-  // swap queues
-  EventsWithContext eventsWithContext;
-  {
-    CriticalSection cs (m_eventsWithContextMutex);
-    m_eventsWithContext.swap(eventsWithContext);
-    m_eventsWithContextEmpty = true;
-  }
-  while (!eventsWithContext.empty ())
-    {
-       EventWithContext event = eventsWithContext.front ();
-       eventsWithContext.pop_front ();
        Scheduler::Event ev;
        ev.impl = event.event;
        ev.key.m_ts = m_currentTs + event.timestamp;
@@ -196,6 +238,13 @@ DefaultSimulatorImpl::Run (void)
   m_main = SystemThread::Self();
   ProcessEventsWithContext ();
   m_stop = false;
+  if (m_enableProfiler && m_profiler == 0)
+    {
+      m_profiler = new EventProfiler (m_currentTs);
+      m_profiler->SetSamplingPeriod (m_profilerSamplingPeriod);
+      m_profiler->SetTopN (m_profilerTopN);
+      m_profiler->SetInterval (&std::clog, m_profilerInterval.GetTimeStep ());
+    }
 
   while (!m_events->IsEmpty () && !m_stop) 
     {
@@ -269,11 +318,7 @@ DefaultSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
       // Current time added in ProcessEventsWithContext()
       ev.timestamp = delay.GetTimeStep ();
       ev.event = event;
-      {
-        CriticalSection cs (m_eventsWithContextMutex);
-        m_eventsWithContext.push_back(ev);
-        m_eventsWithContextEmpty = false;
-      }
+      m_eventsWithContext.Push (ev);
     }
 }
 
@@ -414,4 +459,16 @@ DefaultSimulatorImpl::GetContext (void) const
   return m_currentContext;
 }
 
+uint64_t
+DefaultSimulatorImpl::GetEventPoolHits (void) const
+{
+  return EventImpl::GetPoolHits ();
+}
+
+uint64_t
+DefaultSimulatorImpl::GetEventPoolMisses (void) const
+{
+  return EventImpl::GetPoolMisses ();
+}
+
 } // namespace ns3
@@ -25,7 +25,8 @@
 #include "scheduler.h"
 #include "event-impl.h"
 #include "system-thread.h"
-#include "ns3/system-mutex.h"
+#include "mpsc-queue.h"
+#include "nstime.h"
 
 #include "ptr.h"
 
@@ -39,10 +40,17 @@
 
 namespace ns3 {
 
+class EventProfiler;
+
 /**
  * \ingroup simulator
  *
  * The default single process simulator implementation.
+ *
+ * When the EnableProfiler attribute is set, the events run through
+ * an EventProfiler, which reports to std::clog where the wall clock
+ * time of the simulation goes, every ProfilerInterval of simulation
+ * time and when the simulator is destroyed.
  */
 class DefaultSimulatorImpl : public SimulatorImpl
 {
@@ -78,6 +86,21 @@ public:
   virtual uint32_t GetSystemId (void) const; 
   virtual uint32_t GetContext (void) const;
 
+  /**
+   * Get the number of events allocated from the event pool of the
+   * calling thread, normally the simulation thread.
+   *
+   * \returns The number of event pool hits.
+   */
+  uint64_t GetEventPoolHits (void) const;
+  /**
+   * Get the number of events of the calling thread, normally the
+   * simulation thread, which were allocated from the global heap.
+   *
+   * \returns The number of event pool misses.
+   */
+  uint64_t GetEventPoolMisses (void) const;
+
 private:
   virtual void DoDispose (void);
 
@@ -95,17 +118,11 @@ private:
     /** The event implementation. */
     EventImpl *event;
   };
-  /** Container type for the events from a different context. */
-  typedef std::list<struct EventWithContext> EventsWithContext;
-  /** The container of events from a different context. */
-  EventsWithContext m_eventsWithContext;
   /**
-   * Flag \c true if all events with context have been moved to the
-   * primary event queue.
+   * The events scheduled by other threads, which are moved to the
+   * primary event queue by the simulation thread.
    */
-  bool m_eventsWithContextEmpty;
-  /** Mutex to control access to the list of events with context. */
-  SystemMutex m_eventsWithContextMutex;
+  MpscQueue<struct EventWithContext> m_eventsWithContext;
 
   /** Container type for the events to run at Simulator::Destroy() */
   typedef std::list<EventId> DestroyEvents;
@@ -132,6 +149,17 @@ private:
 
   /** Main execution thread. */
   SystemThread::ThreadId m_main;
+
+  /** Whether the events run through a profiler. */
+  bool m_enableProfiler;
+  /** The simulation time between the reports of the profiler. */
+  Time m_profilerInterval;
+  /** The sampling period of the profiler. */
+  uint32_t m_profilerSamplingPeriod;
+  /** The number of lines of the tables of the profiler. */
+  uint32_t m_profilerTopN;
+  /** The profiler, or 0 when the events run directly. */
+  EventProfiler *m_profiler;
 };
 
 } // namespace ns3
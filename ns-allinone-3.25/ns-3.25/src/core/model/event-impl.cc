@@ -20,6 +20,14 @@
 
 #include "event-impl.h"
 #include "log.h"
+#include "valgrind.h"
+#include "ns3/core-config.h"
+
+#include <new>
+
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif /* HAVE_PTHREAD_H */
 
 /**
  * \file
@@ -31,6 +39,340 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+// Note:  Logging is avoided in the allocator below, which is called
+// for every scheduled event.
+
+#if defined (HAVE_TLS) && defined (HAVE_PTHREAD_H)
+/**
+ * \ingroup events
+ * Events are pooled: per-thread pools need thread-local storage, and
+ * pthread to release them when their thread exits.
+ */
+#define NS3_EVENT_POOL 1
+#endif
+
+namespace {
+
+/**
+ * \ingroup events
+ * Granularity of the event pool size classes, in bytes.
+ */
+const std::size_t EVENT_POOL_GRANULARITY = 16;
+/**
+ * \ingroup events
+ * Number of event pool size classes: events larger than
+ * EVENT_POOL_GRANULARITY * EVENT_POOL_CLASSES bytes are not pooled.
+ */
+const std::size_t EVENT_POOL_CLASSES = 32;
+/**
+ * \ingroup events
+ * Size of the slabs carved into blocks when a size class runs dry.
+ */
+const std::size_t EVENT_POOL_SLAB_SIZE = 4096;
+/**
+ * \ingroup events
+ * Size of the header of the pool blocks and of the slabs, which keeps
+ * the events aligned as if they came from the global heap.
+ */
+const std::size_t EVENT_POOL_HEADER_SIZE = 16;
+
+#ifdef NS3_EVENT_POOL
+
+struct EventPool;
+
+/**
+ * \ingroup events
+ * An event pool block, which starts with its header.
+ */
+struct EventPoolBlock
+{
+  EventPool *owner;     /**< The pool whose slab holds the block. */
+  std::size_t sizeClass; /**< The size class of the block. */
+  /**
+   * Next free block, in the event memory which follows the header
+   * on 64-bit platforms.
+   */
+  EventPoolBlock *next;
+};
+
+/**
+ * \ingroup events
+ * The event pool of a thread.
+ *
+ * Blocks released by another thread are pushed to the remote list of
+ * the pool which owns them, and taken back by the owning thread when a
+ * free list runs dry, so that a thread which only allocates events does
+ * not keep carving new slabs while the threads which release them
+ * accumulate blocks.
+ *
+ * When its thread exits, the pool is released with its slabs as soon as
+ * the last of its blocks still in use elsewhere is released.
+ */
+struct EventPool
+{
+  /** Free lists, one per size class. */
+  EventPoolBlock *freeList[EVENT_POOL_CLASSES];
+  /** Blocks released by other threads, pushed without lock. */
+  EventPoolBlock *remoteList;
+  /** The slabs of the pool, linked through their header. */
+  char *slabs;
+  /** Blocks allocated minus blocks released by the owning thread. */
+  int64_t allocated;
+  /**
+   * Minus the number of blocks released by other threads, until the
+   * owning thread exits and adds the number of blocks it allocated:
+   * the pool is released when this reaches zero.
+   */
+  int64_t outstanding;
+};
+
+/**
+ * \ingroup events
+ * Check whether events are pooled: they are not when running under
+ * valgrind, so that event leaks remain visible.
+ *
+ * \returns \c true if the event pool is enabled.
+ */
+bool
+IsEventPoolEnabled (void)
+{
+  static bool enabled = !RUNNING_ON_VALGRIND;
+  return enabled;
+}
+
+/** \ingroup events The event pool of the thread, created on first use. */
+__thread EventPool *g_eventPool;
+/** \ingroup events Key releasing the event pool when its thread exits. */
+pthread_key_t g_eventPoolKey;
+/** \ingroup events Creation of g_eventPoolKey. */
+pthread_once_t g_eventPoolKeyOnce = PTHREAD_ONCE_INIT;
+/** \ingroup events Number of slabs of all the event pools. */
+uint64_t g_eventPoolSlabs;
+
+/**
+ * \ingroup events
+ * Release a pool and its slabs.
+ *
+ * \param [in] pool The pool, none of whose blocks is in use.
+ */
+void
+FreeEventPool (EventPool *pool)
+{
+  while (pool->slabs != 0)
+    {
+      char *slab = pool->slabs;
+      pool->slabs = *reinterpret_cast<char **> (slab);
+      ::operator delete (slab);
+      __atomic_sub_fetch (&g_eventPoolSlabs, 1, __ATOMIC_RELAXED);
+    }
+  delete pool;
+}
+
+/**
+ * \ingroup events
+ * Give up the pool of an exiting thread: release it now if all its
+ * blocks are free, or leave that to the thread which releases the last
+ * block in use.
+ *
+ * \param [in] data The pool.
+ */
+void
+ReleaseEventPool (void *data)
+{
+  EventPool *pool = static_cast<EventPool *> (data);
+  g_eventPool = 0;
+  if (__atomic_add_fetch (&pool->outstanding, pool->allocated, __ATOMIC_ACQ_REL) == 0)
+    {
+      FreeEventPool (pool);
+    }
+}
+
+/** \ingroup events Create g_eventPoolKey. */
+void
+CreateEventPoolKey (void)
+{
+  pthread_key_create (&g_eventPoolKey, &ReleaseEventPool);
+}
+
+/**
+ * \ingroup events
+ * Get the event pool of the calling thread.
+ *
+ * \returns The event pool.
+ */
+EventPool *
+GetEventPool (void)
+{
+  if (g_eventPool == 0)
+    {
+      EventPool *pool = new EventPool ();
+      pthread_once (&g_eventPoolKeyOnce, &CreateEventPoolKey);
+      pthread_setspecific (g_eventPoolKey, pool);
+      g_eventPool = pool;
+    }
+  return g_eventPool;
+}
+
+/**
+ * \ingroup events
+ * Move the blocks released by other threads to the free lists.
+ *
+ * \param [in] pool The pool of the calling thread.
+ */
+void
+TakeRemoteBlocks (EventPool *pool)
+{
+  EventPoolBlock *block = __atomic_exchange_n (&pool->remoteList, 0, __ATOMIC_ACQUIRE);
+  while (block != 0)
+    {
+      EventPoolBlock *next = block->next;
+      block->next = pool->freeList[block->sizeClass];
+      pool->freeList[block->sizeClass] = block;
+      block = next;
+    }
+}
+
+/**
+ * \ingroup events
+ * Refill the free list of a size class from a new slab.
+ *
+ * \param [in] pool The pool of the calling thread.
+ * \param [in] sizeClass The size class index.
+ */
+void
+RefillEventPool (EventPool *pool, std::size_t sizeClass)
+{
+  std::size_t blockSize = EVENT_POOL_HEADER_SIZE + (sizeClass + 1) * EVENT_POOL_GRANULARITY;
+  std::size_t nBlocks = (EVENT_POOL_SLAB_SIZE - EVENT_POOL_HEADER_SIZE) / blockSize;
+  if (nBlocks == 0)
+    {
+      nBlocks = 1;
+    }
+  char *slab = static_cast<char *> (::operator new (EVENT_POOL_HEADER_SIZE + nBlocks * blockSize));
+  __atomic_add_fetch (&g_eventPoolSlabs, 1, __ATOMIC_RELAXED);
+  *reinterpret_cast<char **> (slab) = pool->slabs;
+  pool->slabs = slab;
+  for (std::size_t i = nBlocks; i > 0; i--)
+    {
+      EventPoolBlock *block = reinterpret_cast<EventPoolBlock *>
+        (slab + EVENT_POOL_HEADER_SIZE + (i - 1) * blockSize);
+      block->owner = pool;
+      block->sizeClass = sizeClass;
+      block->next = pool->freeList[sizeClass];
+      pool->freeList[sizeClass] = block;
+    }
+}
+
+#endif /* NS3_EVENT_POOL */
+
+#ifdef HAVE_TLS
+/** \ingroup events Per-thread count of pooled allocations. */
+__thread uint64_t g_eventPoolHits;
+/** \ingroup events Per-thread count of heap allocations. */
+__thread uint64_t g_eventPoolMisses;
+#else /* HAVE_TLS */
+// Without thread-local storage there is no pool: only the counters
+// are kept.
+uint64_t g_eventPoolHits;
+uint64_t g_eventPoolMisses;
+#endif /* HAVE_TLS */
+
+} // unnamed namespace
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  std::size_t sizeClass = (size - 1) / EVENT_POOL_GRANULARITY;
+#ifdef NS3_EVENT_POOL
+  if (sizeClass < EVENT_POOL_CLASSES && IsEventPoolEnabled ())
+    {
+      EventPool *pool = GetEventPool ();
+      EventPoolBlock *block = pool->freeList[sizeClass];
+      if (block == 0)
+        {
+          TakeRemoteBlocks (pool);
+          block = pool->freeList[sizeClass];
+        }
+      if (block != 0)
+        {
+          g_eventPoolHits++;
+        }
+      else
+        {
+          g_eventPoolMisses++;
+          RefillEventPool (pool, sizeClass);
+          block = pool->freeList[sizeClass];
+        }
+      pool->freeList[sizeClass] = block->next;
+      pool->allocated++;
+      return reinterpret_cast<char *> (block) + EVENT_POOL_HEADER_SIZE;
+    }
+#endif /* NS3_EVENT_POOL */
+  g_eventPoolMisses++;
+  return ::operator new (size);
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+#ifdef NS3_EVENT_POOL
+  std::size_t sizeClass = (size - 1) / EVENT_POOL_GRANULARITY;
+  if (sizeClass < EVENT_POOL_CLASSES && IsEventPoolEnabled ())
+    {
+      EventPoolBlock *block = reinterpret_cast<EventPoolBlock *>
+        (static_cast<char *> (p) - EVENT_POOL_HEADER_SIZE);
+      EventPool *pool = block->owner;
+      if (pool == g_eventPool)
+        {
+          block->next = pool->freeList[sizeClass];
+          pool->freeList[sizeClass] = block;
+          pool->allocated--;
+          return;
+        }
+      // The remote list only grows, and its owner takes it whole, so
+      // that a block cannot be reused under a pushing thread.
+      block->next = __atomic_load_n (&pool->remoteList, __ATOMIC_RELAXED);
+      while (!__atomic_compare_exchange_n (&pool->remoteList, &block->next, block, true,
+                                           __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+        {
+        }
+      if (__atomic_sub_fetch (&pool->outstanding, 1, __ATOMIC_ACQ_REL) == 0)
+        {
+          // The owning thread has exited, and this was its last block.
+          FreeEventPool (pool);
+        }
+      return;
+    }
+#endif /* NS3_EVENT_POOL */
+  ::operator delete (p);
+}
+
+uint64_t
+EventImpl::GetPoolHits (void)
+{
+  return g_eventPoolHits;
+}
+
+uint64_t
+EventImpl::GetPoolMisses (void)
+{
+  return g_eventPoolMisses;
+}
+
+uint64_t
+EventImpl::GetPoolSlabs (void)
+{
+#ifdef NS3_EVENT_POOL
+  return __atomic_load_n (&g_eventPoolSlabs, __ATOMIC_RELAXED);
+#else /* NS3_EVENT_POOL */
+  return 0;
+#endif /* NS3_EVENT_POOL */
+}
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
 /**
@@ -40,6 +41,17 @@ namespace ns3 {
  * when it reaches the time associated to this event. Most subclasses
  * are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * Events are allocated from a per-thread pool of size-classed free lists
+ * rather than from the global heap: memory released by an event goes
+ * back to the pool of the thread which allocated it and is reused for
+ * the next event of the same size class, so that a steady-state
+ * simulation does not call malloc and free for every event. Memory
+ * released by another thread is handed back to the owning pool through
+ * a lock-free list. The pool of a thread is released when the thread
+ * has exited and all its events are gone. Events too large for the
+ * pool, and all events when running under valgrind or without
+ * thread-local storage, go to the global heap.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
@@ -66,6 +78,41 @@ public:
    */
   bool IsCancelled (void);
 
+  /**
+   * Allocate memory for an event from the event pool of the calling thread.
+   *
+   * \param [in] size The size of the event, in bytes.
+   * \returns The event memory.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Return the memory of an event to the event pool it was allocated from.
+   *
+   * \param [in] p The event memory.
+   * \param [in] size The size of the event, in bytes.
+   */
+  static void operator delete (void *p, std::size_t size);
+  /**
+   * Get the number of event allocations served by the event pool
+   * of the calling thread.
+   *
+   * \returns The number of pool hits.
+   */
+  static uint64_t GetPoolHits (void);
+  /**
+   * Get the number of event allocations of the calling thread which
+   * had to fall back to the global heap.
+   *
+   * \returns The number of pool misses.
+   */
+  static uint64_t GetPoolMisses (void);
+  /**
+   * Get the number of slabs held by the event pools of all the threads.
+   *
+   * \returns The number of slabs.
+   */
+  static uint64_t GetPoolSlabs (void);
+
 protected:
   /**
    * Implementation for Invoke().
@@ -0,0 +1,281 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-profiler.h"
+#include "event-impl.h"
+#include "nstime.h"
+#include "assert.h"
+#include "log.h"
+
+#include <algorithm>
+#include <ctime>
+#include <iomanip>
+#include <vector>
+
+#if (__GNUC__ >= 3)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("EventProfiler");
+
+EventProfiler::EventProfiler (uint64_t ts)
+  : m_samplingPeriod (1),
+    m_topN (10),
+    m_os (0),
+    m_interval (0),
+    m_next (0)
+{
+  NS_LOG_FUNCTION (this << ts);
+  Reset (ts);
+}
+
+void
+EventProfiler::SetSamplingPeriod (uint32_t period)
+{
+  NS_LOG_FUNCTION (this << period);
+  NS_ASSERT (period > 0);
+  m_samplingPeriod = period;
+  m_countdown = period;
+}
+
+void
+EventProfiler::SetTopN (uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  m_topN = n;
+}
+
+void
+EventProfiler::SetInterval (std::ostream *os, uint64_t interval)
+{
+  NS_LOG_FUNCTION (this << os << interval);
+  NS_ASSERT (interval == 0 || os != 0);
+  m_os = os;
+  m_interval = interval;
+  if (interval != 0)
+    {
+      m_next = (m_start / interval + 1) * interval;
+    }
+}
+
+void
+EventProfiler::Invoke (EventImpl *event, uint64_t ts, uint32_t context, int pending)
+{
+  if (m_interval != 0 && ts >= m_next)
+    {
+      Print (*m_os, ts);
+      Reset (ts);
+    }
+
+  m_events++;
+  m_depthSum += pending;
+  if (pending > m_maxDepth)
+    {
+      m_maxDepth = pending;
+    }
+  m_contexts[context]++;
+  struct Kind &kind = m_kinds[&typeid (*event)];
+  kind.events++;
+  if (--m_countdown == 0)
+    {
+      m_countdown = m_samplingPeriod;
+      uint64_t start = GetWallClock ();
+      event->Invoke ();
+      kind.ns += GetWallClock () - start;
+      kind.timed++;
+    }
+  else
+    {
+      event->Invoke ();
+    }
+}
+
+/**
+ * Order the lines of a report by decreasing value.
+ *
+ * \param [in] a A line.
+ * \param [in] b Another line.
+ * \returns \c true if \p a has a larger value than \p b.
+ */
+template <typename T, typename U>
+static bool
+IsLarger (const std::pair<T, U> &a, const std::pair<T, U> &b)
+{
+  return a.first > b.first;
+}
+
+void
+EventProfiler::Print (std::ostream &os, uint64_t ts) const
+{
+  NS_LOG_FUNCTION (this << ts);
+  double wallMs = (GetWallClock () - m_wallStart) / 1e6;
+  double seconds = TimeStep (ts - m_start).GetSeconds ();
+
+  std::vector<std::pair<double, const std::type_info *> > kinds;
+  double total = 0;
+  for (Kinds::const_iterator i = m_kinds.begin (); i != m_kinds.end (); i++)
+    {
+      const struct Kind &kind = i->second;
+      double ns = kind.timed == 0 ? 0 : static_cast<double> (kind.ns) * kind.events / kind.timed;
+      kinds.push_back (std::make_pair (ns, i->first));
+      total += ns;
+    }
+  std::stable_sort (kinds.begin (), kinds.end (), &IsLarger<double, const std::type_info *>);
+  std::vector<std::pair<uint64_t, uint32_t> > contexts;
+  for (Contexts::const_iterator i = m_contexts.begin (); i != m_contexts.end (); i++)
+    {
+      contexts.push_back (std::make_pair (i->second, i->first));
+    }
+  std::stable_sort (contexts.begin (), contexts.end (), &IsLarger<uint64_t, uint32_t>);
+
+  std::ios::fmtflags flags = os.flags ();
+  std::streamsize precision = os.precision ();
+  os << std::fixed << std::setprecision (3);
+  os << "Event profile from " << TimeStep (m_start).GetSeconds () << "s to "
+     << TimeStep (ts).GetSeconds () << "s: " << m_events << " events, "
+     << wallMs << " ms of wall clock" << std::endl;
+  os << "  queue depth: mean "
+     << (m_events == 0 ? 0.0 : static_cast<double> (m_depthSum) / m_events)
+     << ", max " << m_maxDepth << std::endl;
+
+  os << std::setw (12) << "events" << std::setw (12) << "ms"
+     << std::setw (8) << "%" << std::setw (10) << "ns/event" << "  kind" << std::endl;
+  for (uint32_t i = 0; i < kinds.size () && i < m_topN; i++)
+    {
+      const struct Kind &kind = m_kinds.find (kinds[i].second)->second;
+      os << std::setw (12) << kind.events
+         << std::setw (12) << kinds[i].first / 1e6
+         << std::setw (8) << (total > 0 ? 100 * kinds[i].first / total : 0.0)
+         << std::setw (10) << std::setprecision (0) << kinds[i].first / kind.events
+         << std::setprecision (3) << "  " << GetName (*kinds[i].second) << std::endl;
+    }
+
+  os << std::setw (12) << "events" << std::setw (12) << "events/s"
+     << "  context" << std::endl;
+  for (uint32_t i = 0; i < contexts.size () && i < m_topN; i++)
+    {
+      os << std::setw (12) << contexts[i].first
+         << std::setw (12) << (seconds > 0 ? contexts[i].first / seconds : 0.0) << "  ";
+      if (contexts[i].second == 0xffffffff)
+        {
+          os << "none" << std::endl;
+        }
+      else
+        {
+          os << contexts[i].second << std::endl;
+        }
+    }
+  os.flags (flags);
+  os.precision (precision);
+}
+
+void
+EventProfiler::Reset (uint64_t ts)
+{
+  NS_LOG_FUNCTION (this << ts);
+  m_kinds.clear ();
+  m_contexts.clear ();
+  m_events = 0;
+  m_depthSum = 0;
+  m_maxDepth = 0;
+  m_start = ts;
+  m_wallStart = GetWallClock ();
+  m_countdown = m_samplingPeriod;
+  if (m_interval != 0)
+    {
+      m_next = (ts / m_interval + 1) * m_interval;
+    }
+}
+
+uint64_t
+EventProfiler::GetEvents (void) const
+{
+  return m_events;
+}
+
+uint64_t
+EventProfiler::GetEvents (const std::type_info &type) const
+{
+  Kinds::const_iterator i = m_kinds.find (&type);
+  return i == m_kinds.end () ? 0 : i->second.events;
+}
+
+uint64_t
+EventProfiler::GetContextEvents (uint32_t context) const
+{
+  Contexts::const_iterator i = m_contexts.find (context);
+  return i == m_contexts.end () ? 0 : i->second;
+}
+
+std::string
+EventProfiler::GetName (const std::type_info &type)
+{
+  std::string name = type.name ();
+#if (__GNUC__ >= 3)
+  int status;
+  char *demangled = abi::__cxa_demangle (name.c_str (), NULL, NULL, &status);
+  if (status == 0)
+    {
+      name = demangled;
+    }
+  std::free (demangled);
+#endif
+  // The events are local classes of the MakeEvent function templates:
+  // their template arguments name the function and the bound arguments.
+  std::string::size_type begin = name.find ("MakeEvent<");
+  if (begin == std::string::npos)
+    {
+      return name;
+    }
+  begin += 10;
+  uint32_t depth = 1;
+  for (std::string::size_type i = begin; i < name.size (); i++)
+    {
+      if (name[i] == '<')
+        {
+          depth++;
+        }
+      else if (name[i] == '>' && --depth == 0)
+        {
+          std::string::size_type end = name.find_last_not_of (' ', i - 1);
+          return name.substr (begin, end + 1 - begin);
+        }
+    }
+  return name;
+}
+
+uint64_t
+EventProfiler::GetWallClock (void)
+{
+#ifdef CLOCK_MONOTONIC
+  struct timespec now;
+  clock_gettime (CLOCK_MONOTONIC, &now);
+  return static_cast<uint64_t> (now.tv_sec) * 1000000000 + now.tv_nsec;
+#else
+  return static_cast<uint64_t> (std::clock ()) * (1000000000 / CLOCKS_PER_SEC);
+#endif
+}
+
+} // namespace ns3
@@ -0,0 +1,193 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler declaration.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Attribute the wall clock time of a simulation to the kinds
+ * of events it runs.
+ *
+ * The profiler invokes the events on behalf of the simulator, and
+ * records for each kind of event the number of events and their wall
+ * clock time, the number of events of each context (the node id,
+ * for most events), and the depth of the event queue.  The kind of
+ * an event is the type of its EventImpl, which MakeEvent() derives
+ * from the function or method and the arguments bound to the event:
+ * the report shows it as the template arguments of MakeEvent().
+ * Methods of one class with the same signature share a kind.
+ *
+ * Reading the clock costs about as much as a small event, so only one
+ * out of SetSamplingPeriod() events is timed, and the time of each
+ * kind of event is extrapolated from its timed events.
+ *
+ * The DefaultSimulatorImpl runs its events through a profiler when
+ * its EnableProfiler attribute is set.
+ */
+class EventProfiler
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param [in] ts The current simulation time, in time steps.
+   */
+  EventProfiler (uint64_t ts);
+
+  /**
+   * Time one out of \p period events.
+   *
+   * \param [in] period The sampling period, 1 to time every event.
+   */
+  void SetSamplingPeriod (uint32_t period);
+  /**
+   * Set the number of kinds of events and of contexts reported.
+   *
+   * \param [in] n The number of lines of each table of the report.
+   */
+  void SetTopN (uint32_t n);
+  /**
+   * Print a report, and start a new interval, every \p interval
+   * of simulation time.
+   *
+   * \param [in] os The stream to print the reports to.
+   * \param [in] interval The interval in time steps, or 0 to only
+   *        report when asked to.
+   */
+  void SetInterval (std::ostream *os, uint64_t interval);
+
+  /**
+   * Invoke an event and record its cost.
+   *
+   * \param [in] event The event.
+   * \param [in] ts The time of the event, in time steps.
+   * \param [in] context The context of the event.
+   * \param [in] pending The number of events left in the queue.
+   */
+  void Invoke (EventImpl *event, uint64_t ts, uint32_t context, int pending);
+
+  /**
+   * Print a report of the current interval.
+   *
+   * \param [in] os The output stream.
+   * \param [in] ts The current simulation time, in time steps.
+   */
+  void Print (std::ostream &os, uint64_t ts) const;
+  /**
+   * Start a new interval.
+   *
+   * \param [in] ts The current simulation time, in time steps.
+   */
+  void Reset (uint64_t ts);
+
+  /**
+   * Get the number of events of the current interval.
+   *
+   * \returns The number of events.
+   */
+  uint64_t GetEvents (void) const;
+  /**
+   * Get the number of events of one kind in the current interval.
+   *
+   * \param [in] type The type of the events.
+   * \returns The number of events.
+   */
+  uint64_t GetEvents (const std::type_info &type) const;
+  /**
+   * Get the number of events of one context in the current interval.
+   *
+   * \param [in] context The context.
+   * \returns The number of events.
+   */
+  uint64_t GetContextEvents (uint32_t context) const;
+
+  /**
+   * Get the name of a kind of event, as printed in the reports.
+   *
+   * \param [in] type The type of the events.
+   * \returns The name.
+   */
+  static std::string GetName (const std::type_info &type);
+
+private:
+  /** The statistics of one kind of event. */
+  struct Kind
+  {
+    uint64_t events;   //!< The number of events.
+    uint64_t timed;    //!< The number of timed events.
+    uint64_t ns;       //!< The wall clock time of the timed events.
+  };
+  /** Order the types of events. */
+  struct TypeLess
+  {
+    /**
+     * \param [in] a A type.
+     * \param [in] b Another type.
+     * \returns \c true if \p a is before \p b.
+     */
+    bool operator () (const std::type_info *a, const std::type_info *b) const
+    {
+      return a->before (*b);
+    }
+  };
+  /** The statistics of the kinds of events. */
+  typedef std::map<const std::type_info *, struct Kind, TypeLess> Kinds;
+  /** The number of events of each context. */
+  typedef std::map<uint32_t, uint64_t> Contexts;
+
+  /**
+   * Read the wall clock.
+   *
+   * \returns The time, in nanoseconds.
+   */
+  static uint64_t GetWallClock (void);
+
+  Kinds m_kinds;              //!< The kinds of events.
+  Contexts m_contexts;        //!< The events of each context.
+  uint64_t m_events;          //!< The number of events.
+  uint64_t m_depthSum;        //!< The sum of the queue depths.
+  int m_maxDepth;             //!< The maximum queue depth.
+  uint64_t m_start;           //!< The start of the interval, in time steps.
+  uint64_t m_wallStart;       //!< The wall clock at the start of the interval.
+  uint32_t m_samplingPeriod;  //!< Time one out of this many events.
+  uint32_t m_countdown;       //!< The events until the next timed event.
+  uint32_t m_topN;            //!< The number of lines of the tables.
+  std::ostream *m_os;         //!< The stream of the periodic reports.
+  uint64_t m_interval;        //!< The interval of the periodic reports.
+  uint64_t m_next;            //!< The time of the next periodic report.
+};
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
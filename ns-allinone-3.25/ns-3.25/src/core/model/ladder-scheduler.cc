@@ -0,0 +1,457 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include <algorithm>
+#include "assert.h"
+#include "log.h"
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::LadderScheduler class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+namespace {
+
+/**
+ * \ingroup scheduler
+ * Bucket size above which a bucket is split into a child rung
+ * rather than sorted into the bottom.
+ */
+const uint32_t LADDER_THRESHOLD = 50;
+/**
+ * \ingroup scheduler
+ * Maximum number of rungs in the ladder.
+ */
+const uint32_t LADDER_MAX_RUNGS = 8;
+
+/**
+ * \ingroup scheduler
+ * Compare (greater than) two events, used to keep the bottom sorted in
+ * decreasing order.
+ *
+ * \param [in] a The first event.
+ * \param [in] b The second event.
+ * \returns \c true if \c a > \c b
+ */
+bool
+EventGreater (const Scheduler::Event &a, const Scheduler::Event &b)
+{
+  return a.key > b.key;
+}
+
+/**
+ * \ingroup scheduler
+ * Hash an event uid into the tombstone table.
+ *
+ * \param [in] uid The event uid.
+ * \param [in] mask The table size minus one.
+ * \returns The first slot to probe.
+ */
+inline uint32_t
+TombstoneHash (uint32_t uid, uint32_t mask)
+{
+  return (uid * 2654435761U) & mask;
+}
+
+} // unnamed namespace
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topMin (~(uint64_t)0),
+    m_topMax (0),
+    m_topStart (0),
+    m_rungs (LADDER_MAX_RUNGS),
+    m_nRungs (0),
+    m_bottomLimit (2 * LADDER_THRESHOLD),
+    m_size (0),
+    m_tombstones (16, 0),
+    m_nTombstones (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+  if (m_nTombstones == 0)
+    {
+      return;
+    }
+  ReleaseTombstones (m_top);
+  for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+      Rung &rung = m_rungs[i];
+      for (uint32_t j = rung.current; j < rung.nBuckets; j++)
+        {
+          ReleaseTombstones (rung.buckets[j]);
+        }
+    }
+  ReleaseTombstones (m_bottom);
+}
+
+void
+LadderScheduler::ReleaseTombstones (const Bucket &bucket)
+{
+  NS_LOG_FUNCTION (this);
+  for (Bucket::const_iterator i = bucket.begin (); i != bucket.end (); ++i)
+    {
+      if (IsTombstone (i->key.m_uid))
+        {
+          i->impl->Unref ();
+        }
+    }
+}
+
+uint64_t
+LadderScheduler::GetCurrentStart (const Rung &rung)
+{
+  return rung.start + rung.current * rung.width;
+}
+
+void
+LadderScheduler::InitRung (Rung &rung, uint64_t start,
+                           uint64_t width, uint32_t nBuckets)
+{
+  NS_LOG_FUNCTION (start << width << nBuckets);
+  NS_ASSERT (width > 0 && nBuckets > 0);
+  rung.start = start;
+  rung.width = width;
+  rung.current = 0;
+  rung.nBuckets = nBuckets;
+  rung.count = 0;
+  if (rung.buckets.size () < nBuckets)
+    {
+      rung.buckets.resize (nBuckets);
+    }
+}
+
+void
+LadderScheduler::InsertInRung (Rung &rung, const Scheduler::Event &ev)
+{
+  uint64_t index = (ev.key.m_ts - rung.start) / rung.width;
+  NS_ASSERT (index >= rung.current && index < rung.nBuckets);
+  rung.buckets[index].push_back (ev);
+  rung.count++;
+}
+
+void
+LadderScheduler::InsertInBottom (const Scheduler::Event &ev)
+{
+  Bucket::iterator i = std::upper_bound (m_bottom.begin (), m_bottom.end (),
+                                         ev, EventGreater);
+  m_bottom.insert (i, ev);
+  if (m_bottom.size () > m_bottomLimit && m_nRungs < LADDER_MAX_RUNGS)
+    {
+      SpillBottom ();
+    }
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
+  m_size++;
+  uint64_t ts = ev.key.m_ts;
+  if (ts >= m_topStart)
+    {
+      m_top.push_back (ev);
+      m_topMin = std::min (m_topMin, ts);
+      m_topMax = std::max (m_topMax, ts);
+      return;
+    }
+  for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+      if (ts >= GetCurrentStart (m_rungs[i]))
+        {
+          InsertInRung (m_rungs[i], ev);
+          return;
+        }
+    }
+  InsertInBottom (ev);
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_size == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  // Refilling the bottom does not change the set of pending events.
+  const_cast<LadderScheduler *> (this)->Settle ();
+  return m_bottom.back ();
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  Settle ();
+  Scheduler::Event ev = m_bottom.back ();
+  m_bottom.pop_back ();
+  m_size--;
+  NS_LOG_LOGIC ("remove ts=" << ev.key.m_ts << ", key=" << ev.key.m_uid);
+  return ev;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (!IsEmpty ());
+  m_size--;
+  // The bottom is small and sorted: remove the event eagerly if it is
+  // there, otherwise leave a tombstone behind.
+  Bucket::iterator i = std::lower_bound (m_bottom.begin (), m_bottom.end (),
+                                         ev, EventGreater);
+  if (i != m_bottom.end () && i->key.m_uid == ev.key.m_uid)
+    {
+      NS_ASSERT (i->impl == ev.impl);
+      m_bottom.erase (i);
+      return;
+    }
+  ev.impl->Ref ();
+  AddTombstone (ev.key.m_uid);
+}
+
+void
+LadderScheduler::TransferTop (void)
+{
+  NS_LOG_FUNCTION (this << m_top.size () << m_topMin << m_topMax);
+  NS_ASSERT (m_nRungs == 0 && !m_top.empty ());
+  uint64_t range = m_topMax - m_topMin;
+  uint64_t width = range / m_top.size () + 1;
+  uint32_t nBuckets = range / width + 1;
+  Rung &rung = m_rungs[0];
+  InitRung (rung, m_topMin, width, nBuckets);
+  for (Bucket::const_iterator i = m_top.begin (); i != m_top.end (); ++i)
+    {
+      InsertInRung (rung, *i);
+    }
+  m_nRungs = 1;
+  m_topStart = rung.start + nBuckets * width;
+  m_topMin = ~(uint64_t)0;
+  m_topMax = 0;
+  m_top.clear ();
+}
+
+void
+LadderScheduler::SpillBottom (void)
+{
+  NS_LOG_FUNCTION (this << m_bottom.size ());
+  uint64_t end = m_topStart;
+  if (m_nRungs > 0)
+    {
+      end = GetCurrentStart (m_rungs[m_nRungs - 1]);
+    }
+  uint64_t start = m_bottom.back ().key.m_ts;
+  NS_ASSERT (end > start);
+  uint64_t range = end - start;
+  uint64_t width = range / m_bottom.size () + 1;
+  uint32_t nBuckets = (range - 1) / width + 1;
+  if (nBuckets < 2)
+    {
+      // all events share the same bucket, spilling would not help.
+      m_bottomLimit = 2 * m_bottom.size ();
+      return;
+    }
+  Rung &rung = m_rungs[m_nRungs];
+  InitRung (rung, start, width, nBuckets);
+  for (Bucket::const_iterator i = m_bottom.begin (); i != m_bottom.end (); ++i)
+    {
+      InsertInRung (rung, *i);
+    }
+  m_nRungs++;
+  m_bottom.clear ();
+}
+
+void
+LadderScheduler::RefillBottom (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_bottom.empty ());
+  while (true)
+    {
+      if (m_nRungs == 0)
+        {
+          TransferTop ();
+        }
+      Rung &rung = m_rungs[m_nRungs - 1];
+      if (rung.count == 0)
+        {
+          m_nRungs--;
+          continue;
+        }
+      while (rung.buckets[rung.current].empty ())
+        {
+          rung.current++;
+        }
+      Bucket &bucket = rung.buckets[rung.current];
+      uint64_t bucketStart = GetCurrentStart (rung);
+      rung.current++;
+      rung.count -= bucket.size ();
+
+      if (bucket.size () <= LADDER_THRESHOLD
+          || rung.width == 1
+          || m_nRungs == LADDER_MAX_RUNGS)
+        {
+          std::sort (bucket.begin (), bucket.end (), EventGreater);
+          m_bottom.swap (bucket);
+          m_bottomLimit = std::max (2 * LADDER_THRESHOLD,
+                                    2 * (uint32_t)m_bottom.size ());
+          return;
+        }
+
+      // Split the bucket into a finer child rung.
+      uint64_t width = rung.width / bucket.size ();
+      if (width == 0)
+        {
+          width = 1;
+        }
+      uint32_t nBuckets = (rung.width - 1) / width + 1;
+      Rung &child = m_rungs[m_nRungs];
+      InitRung (child, bucketStart, width, nBuckets);
+      for (Bucket::const_iterator i = bucket.begin (); i != bucket.end (); ++i)
+        {
+          InsertInRung (child, *i);
+        }
+      bucket.clear ();
+      m_nRungs++;
+    }
+}
+
+void
+LadderScheduler::Settle (void)
+{
+  while (m_size > 0)
+    {
+      if (m_bottom.empty ())
+        {
+          RefillBottom ();
+        }
+      const Scheduler::Event &next = m_bottom.back ();
+      if (m_nTombstones == 0 || !TakeTombstone (next.key.m_uid))
+        {
+          return;
+        }
+      NS_LOG_LOGIC ("drop removed event " << next.key.m_uid);
+      next.impl->Unref ();
+      m_bottom.pop_back ();
+    }
+}
+
+void
+LadderScheduler::AddTombstone (uint32_t uid)
+{
+  NS_LOG_FUNCTION (this << uid);
+  NS_ASSERT (uid != 0);
+  if (2 * (m_nTombstones + 1) > m_tombstones.size ())
+    {
+      std::vector<uint32_t> old (2 * m_tombstones.size (), 0);
+      old.swap (m_tombstones);
+      m_nTombstones = 0;
+      for (std::vector<uint32_t>::const_iterator i = old.begin (); i != old.end (); ++i)
+        {
+          if (*i != 0)
+            {
+              AddTombstone (*i);
+            }
+        }
+    }
+  uint32_t mask = m_tombstones.size () - 1;
+  uint32_t slot = TombstoneHash (uid, mask);
+  while (m_tombstones[slot] != 0)
+    {
+      slot = (slot + 1) & mask;
+    }
+  m_tombstones[slot] = uid;
+  m_nTombstones++;
+}
+
+bool
+LadderScheduler::IsTombstone (uint32_t uid) const
+{
+  uint32_t mask = m_tombstones.size () - 1;
+  for (uint32_t slot = TombstoneHash (uid, mask);
+       m_tombstones[slot] != 0;
+       slot = (slot + 1) & mask)
+    {
+      if (m_tombstones[slot] == uid)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+bool
+LadderScheduler::TakeTombstone (uint32_t uid)
+{
+  uint32_t mask = m_tombstones.size () - 1;
+  uint32_t slot = TombstoneHash (uid, mask);
+  while (m_tombstones[slot] != uid)
+    {
+      if (m_tombstones[slot] == 0)
+        {
+          return false;
+        }
+      slot = (slot + 1) & mask;
+    }
+  // Backward-shift deletion keeps probe sequences intact without
+  // needing deleted markers.
+  uint32_t hole = slot;
+  uint32_t next = (hole + 1) & mask;
+  while (m_tombstones[next] != 0)
+    {
+      uint32_t home = TombstoneHash (m_tombstones[next], mask);
+      if (((next - home) & mask) >= ((next - hole) & mask))
+        {
+          m_tombstones[hole] = m_tombstones[next];
+          hole = next;
+        }
+      next = (next + 1) & mask;
+    }
+  m_tombstones[hole] = 0;
+  m_nTombstones--;
+  return true;
+}
+
+} // namespace ns3
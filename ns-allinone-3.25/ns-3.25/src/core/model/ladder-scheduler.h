@@ -0,0 +1,199 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Declaration of ns3::LadderScheduler class.
+ */
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue described in
+ * "Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by Wai Teng Tang, Rick Siow Mong Goh and
+ * Ian Li-Jin Thng (ACM TOMACS, 2005).
+ *
+ * The event list is split in three tiers:
+ *  - the \em top, an unsorted vector which receives every event
+ *    scheduled after the range currently covered by the ladder,
+ *  - the \em rungs, each of which is an array of time buckets. The
+ *    first rung is created from the top when the lower tiers run dry,
+ *    and a bucket which holds too many events is split into a finer
+ *    child rung instead of being sorted,
+ *  - the \em bottom, a small vector sorted in decreasing order from
+ *    which events are dequeued with pop_back.
+ *
+ * Only the bottom is ever sorted, and it only ever holds the events of
+ * a single bucket, so Insert and RemoveNext run in amortized constant
+ * time regardless of the number of pending events.
+ *
+ * Buckets are plain std::vector instances which are recycled when a rung
+ * is emptied, so that steady-state operation does not allocate.
+ *
+ * Remove is lazy: unless the event is the next one to be dequeued, it is
+ * merely recorded in a tombstone table (keyed by event uid) and dropped
+ * when it reaches the bottom. The scheduler holds a reference on the
+ * EventImpl of a tombstoned event until it is dropped.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** A bucket: a contiguous array of unsorted events. */
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /** One rung of the ladder. */
+  struct Rung
+  {
+    uint64_t start;               /**< Timestamp of the start of bucket 0. */
+    uint64_t width;               /**< Duration of a bucket. */
+    uint32_t current;             /**< Index of the next bucket to dequeue. */
+    uint32_t nBuckets;            /**< Number of buckets in use. */
+    uint32_t count;               /**< Number of events in the rung. */
+    std::vector<Bucket> buckets;  /**< Bucket storage, recycled across uses. */
+  };
+
+  /**
+   * Get the lowest timestamp which can still be inserted in a rung.
+   *
+   * \param [in] rung The rung.
+   * \returns The start of the current bucket of \p rung.
+   */
+  static uint64_t GetCurrentStart (const Rung &rung);
+  /**
+   * Reset a rung before filling it.
+   *
+   * \param [in] rung The rung to initialize.
+   * \param [in] start The timestamp of the start of bucket 0.
+   * \param [in] width The duration of a bucket.
+   * \param [in] nBuckets The number of buckets.
+   */
+  static void InitRung (Rung &rung, uint64_t start,
+                        uint64_t width, uint32_t nBuckets);
+  /**
+   * Store an event in the appropriate bucket of a rung.
+   *
+   * \param [in] rung The rung.
+   * \param [in] ev The event.
+   */
+  static void InsertInRung (Rung &rung, const Scheduler::Event &ev);
+  /**
+   * Insert an event in the sorted bottom list.
+   *
+   * \param [in] ev The event.
+   */
+  void InsertInBottom (const Scheduler::Event &ev);
+  /** Move the content of the top into a new first rung. */
+  void TransferTop (void);
+  /** Move the content of an oversized bottom into a new lowest rung. */
+  void SpillBottom (void);
+  /**
+   * Fill the empty bottom with the content of the next non-empty bucket,
+   * spawning finer rungs as needed.
+   */
+  void RefillBottom (void);
+  /**
+   * Make sure that the last event of the bottom, if any, is the next
+   * live event by dropping tombstoned events and refilling the bottom.
+   */
+  void Settle (void);
+
+  /**
+   * Record the uid of a removed event.
+   *
+   * \param [in] uid The event uid.
+   */
+  void AddTombstone (uint32_t uid);
+  /**
+   * Look up and clear the tombstone of an event.
+   *
+   * \param [in] uid The event uid.
+   * \returns \c true if \p uid had been tombstoned.
+   */
+  bool TakeTombstone (uint32_t uid);
+  /**
+   * Check whether an event has been tombstoned.
+   *
+   * \param [in] uid The event uid.
+   * \returns \c true if \p uid is tombstoned.
+   */
+  bool IsTombstone (uint32_t uid) const;
+  /**
+   * Release the reference held on a tombstoned event, if needed.
+   *
+   * \param [in] bucket The bucket whose events should be checked.
+   */
+  void ReleaseTombstones (const Bucket &bucket);
+
+  /** Events scheduled after the range covered by the rungs. */
+  Bucket m_top;
+  /** Smallest timestamp stored in the top. */
+  uint64_t m_topMin;
+  /** Largest timestamp stored in the top. */
+  uint64_t m_topMax;
+  /** Events with a timestamp larger or equal to this go to the top. */
+  uint64_t m_topStart;
+  /** Rung storage, index 0 being the coarsest rung. */
+  std::vector<Rung> m_rungs;
+  /** Number of rungs in use. */
+  uint32_t m_nRungs;
+  /** Events sorted in decreasing order: the next event is the last one. */
+  Bucket m_bottom;
+  /** Bottom size above which the bottom is spilled into a new rung. */
+  uint32_t m_bottomLimit;
+  /** Number of live (not tombstoned) events. */
+  uint32_t m_size;
+  /** Open-addressing hash set of tombstoned uids, 0 means empty. */
+  std::vector<uint32_t> m_tombstones;
+  /** Number of tombstoned uids. */
+  uint32_t m_nTombstones;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
@@ -0,0 +1,310 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "log.h"
+#include "simulator.h"
+#include "nstime.h"
+#include "assert.h"
+#include "fatal-error.h"
+#include "ns3/core-config.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+#ifdef HAVE_SYS_MMAN_H
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/**
+ * \file
+ * \ingroup logging
+ * ns3::LogBinaryRecord implementation, and the binary sink of the
+ * log messages.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup logging
+ * The header of the file of a binary sink, followed by the records.
+ */
+struct LogBinaryRecord::Header
+{
+  char magic[8];            //!< "ns3blog".
+  uint32_t version;         //!< The version of the format.
+  uint32_t recordSize;      //!< The size of the records.
+  uint64_t capacity;        //!< The number of records.
+  uint64_t next;            //!< The sequence number of the next record.
+  int64_t stepsPerSecond;   //!< The time steps of one second.
+  char padding[24];         //!< Align the records on a cache line.
+};
+
+/**
+ * \ingroup logging
+ * A record of a binary sink.
+ */
+struct LogBinaryRecord::Slot
+{
+  /**
+   * 1 + the sequence number of the record, 0 if it was never written,
+   * or LOG_WRITING while it is written.
+   */
+  uint64_t sequence;
+  int64_t time;             //!< The simulation time, in time steps.
+  uint32_t context;         //!< The simulation context.
+  uint32_t level;           //!< The LogLevel, and the enabled prefixes.
+  char component[32];       //!< The name of the component.
+  char function[32];        //!< The name of the function.
+  char message[168];        //!< The message.
+};
+
+/** The time of the records written outside of a simulation. */
+static const int64_t LOG_NO_TIME = std::numeric_limits<int64_t>::min ();
+/** The sequence of the records being written. */
+static const uint64_t LOG_WRITING = std::numeric_limits<uint64_t>::max ();
+/** The magic string of the binary sinks. */
+static const char LOG_MAGIC[8] = "ns3blog";
+/** The version of the format of the binary sinks. */
+static const uint32_t LOG_VERSION = 2;
+/** The prefixes recorded with the messages. */
+static const enum LogLevel LOG_PREFIXES[] = {
+  LOG_PREFIX_FUNC, LOG_PREFIX_TIME, LOG_PREFIX_NODE, LOG_PREFIX_LEVEL
+};
+
+LogBinaryRecord::Header *LogBinaryRecord::m_sink = 0;
+std::size_t LogBinaryRecord::m_size = 0;
+
+/**
+ * Copy a string into a field of a record, truncated if needed.
+ *
+ * \param [out] field The field.
+ * \param [in] size The size of the field.
+ * \param [in] s The string.
+ */
+static void
+LogCopyField (char *field, std::size_t size, const char *s)
+{
+  std::strncpy (field, s, size - 1);
+  field[size - 1] = '\0';
+}
+
+LogBinaryRecord::LogBinaryRecord (const LogComponent &component, enum LogLevel level,
+                                  const char *function)
+  : m_os (&m_buffer),
+    m_slot (0),
+    m_dropped (false)
+{
+  NS_ASSERT (m_sink != 0);
+  struct Slot *slots = reinterpret_cast<struct Slot *> (m_sink + 1);
+  // A writer stalled in a record one lap behind still holds it: claim
+  // the next record rather than mix the two messages.  After a whole
+  // lap, drop the message instead of waiting, since the record may be
+  // held by this thread, streaming a message which logs itself.
+  for (uint64_t i = 0; i < m_sink->capacity && m_slot == 0; i++)
+    {
+      m_sequence = __atomic_fetch_add (&m_sink->next, 1, __ATOMIC_RELAXED);
+      struct Slot *slot = slots + m_sequence % m_sink->capacity;
+      uint64_t sequence = __atomic_load_n (&slot->sequence, __ATOMIC_RELAXED);
+      if (sequence != LOG_WRITING
+          && __atomic_compare_exchange_n (&slot->sequence, &sequence, LOG_WRITING, false,
+                                          __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+          m_slot = slot;
+        }
+    }
+  if (m_slot == 0)
+    {
+      m_slot = new struct Slot;
+      m_dropped = true;
+    }
+  // The time printer is set once the simulator exists: do not create
+  // it just to log.
+  if (LogGetTimePrinter () != 0)
+    {
+      m_slot->time = Simulator::Now ().GetTimeStep ();
+      m_slot->context = Simulator::GetContext ();
+    }
+  else
+    {
+      m_slot->time = LOG_NO_TIME;
+      m_slot->context = 0xffffffff;
+    }
+  m_slot->level = level;
+  for (std::size_t i = 0; i < sizeof (LOG_PREFIXES) / sizeof (LOG_PREFIXES[0]); i++)
+    {
+      if (component.IsEnabled (LOG_PREFIXES[i]))
+        {
+          m_slot->level |= LOG_PREFIXES[i];
+        }
+    }
+  LogCopyField (m_slot->component, sizeof (m_slot->component), component.Name ());
+  LogCopyField (m_slot->function, sizeof (m_slot->function), function);
+  m_buffer.Set (m_slot->message, sizeof (m_slot->message) - 1);
+}
+
+LogBinaryRecord::~LogBinaryRecord ()
+{
+  // The message is truncated when the buffer is full.
+  *m_buffer.GetEnd () = '\0';
+  if (m_dropped)
+    {
+      delete m_slot;
+      return;
+    }
+  __atomic_store_n (&m_slot->sequence, m_sequence + 1, __ATOMIC_RELEASE);
+}
+
+void
+LogSetBinarySink (const std::string &filename, uint32_t records)
+{
+  NS_ASSERT (records > 0);
+  LogCloseBinarySink ();
+#ifdef HAVE_SYS_MMAN_H
+  std::size_t size = sizeof (LogBinaryRecord::Header)
+    + records * sizeof (LogBinaryRecord::Slot);
+  int fd = open (filename.c_str (), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0)
+    {
+      NS_FATAL_ERROR ("Could not open " << filename);
+    }
+  if (ftruncate (fd, size) < 0)
+    {
+      NS_FATAL_ERROR ("Could not resize " << filename);
+    }
+  void *map = mmap (0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close (fd);
+  if (map == MAP_FAILED)
+    {
+      NS_FATAL_ERROR ("Could not map " << filename);
+    }
+  LogBinaryRecord::Header *header = static_cast<LogBinaryRecord::Header *> (map);
+  std::memcpy (header->magic, LOG_MAGIC, sizeof (header->magic));
+  header->version = LOG_VERSION;
+  header->recordSize = sizeof (LogBinaryRecord::Slot);
+  header->capacity = records;
+  header->next = 0;
+  header->stepsPerSecond = Time::FromInteger (1, Time::S).GetTimeStep ();
+  LogBinaryRecord::m_size = size;
+  LogBinaryRecord::m_sink = header;
+#else
+  NS_FATAL_ERROR ("Binary log sinks are not supported on this platform");
+#endif
+}
+
+void
+LogCloseBinarySink (void)
+{
+  if (LogBinaryRecord::m_sink == 0)
+    {
+      return;
+    }
+#ifdef HAVE_SYS_MMAN_H
+  munmap (LogBinaryRecord::m_sink, LogBinaryRecord::m_size);
+#endif
+  LogBinaryRecord::m_sink = 0;
+  LogBinaryRecord::m_size = 0;
+}
+
+void
+LogDecodeBinarySink (const std::string &filename, std::ostream &os)
+{
+  std::ifstream is (filename.c_str (), std::ios::binary);
+  if (!is)
+    {
+      NS_FATAL_ERROR ("Could not open " << filename);
+    }
+  LogBinaryRecord::Header header;
+  is.read (reinterpret_cast<char *> (&header), sizeof (header));
+  if (!is
+      || std::memcmp (header.magic, LOG_MAGIC, sizeof (header.magic)) != 0
+      || header.version != LOG_VERSION
+      || header.recordSize != sizeof (LogBinaryRecord::Slot))
+    {
+      NS_FATAL_ERROR (filename << " is not a binary log");
+    }
+  std::vector<LogBinaryRecord::Slot> slots (header.capacity);
+  is.read (reinterpret_cast<char *> (&slots[0]), header.capacity * sizeof (LogBinaryRecord::Slot));
+  if (!is)
+    {
+      NS_FATAL_ERROR (filename << " is truncated");
+    }
+
+  std::vector<std::pair<uint64_t, uint64_t> > order;
+  for (uint64_t i = 0; i < slots.size (); i++)
+    {
+      if (slots[i].sequence != 0 && slots[i].sequence != LOG_WRITING)
+        {
+          order.push_back (std::make_pair (slots[i].sequence, i));
+        }
+    }
+  std::sort (order.begin (), order.end ());
+  if (header.next > order.size ())
+    {
+      os << "# " << header.next - order.size ()
+         << " older messages were overwritten or not completed" << std::endl;
+    }
+
+  for (uint64_t i = 0; i < order.size (); i++)
+    {
+      LogBinaryRecord::Slot &slot = slots[order[i].second];
+      // Terminate the strings of a corrupted file.
+      slot.component[sizeof (slot.component) - 1] = '\0';
+      slot.function[sizeof (slot.function) - 1] = '\0';
+      slot.message[sizeof (slot.message) - 1] = '\0';
+      enum LogLevel level = static_cast<enum LogLevel> (slot.level & LOG_LEVEL_ALL);
+      // The prefixes of the messages written to std::clog, with the
+      // default time and node printers.
+      if (slot.time != LOG_NO_TIME && (slot.level & LOG_PREFIX_TIME))
+        {
+          os << static_cast<double> (slot.time) / header.stepsPerSecond << "s ";
+        }
+      if (slot.time != LOG_NO_TIME && (slot.level & LOG_PREFIX_NODE))
+        {
+          if (slot.context == 0xffffffff)
+            {
+              os << "-1 ";
+            }
+          else
+            {
+              os << slot.context << " ";
+            }
+        }
+      if (level == LOG_FUNCTION)
+        {
+          os << slot.component << ":" << slot.function << "("
+             << slot.message << ")" << std::endl;
+        }
+      else
+        {
+          if (slot.level & LOG_PREFIX_FUNC)
+            {
+              os << slot.component << ":" << slot.function << "(): ";
+            }
+          if (slot.level & LOG_PREFIX_LEVEL)
+            {
+              os << "[" << LogComponent::GetLevelLabel (level) << "] ";
+            }
+          os << slot.message << std::endl;
+        }
+    }
+}
+
+} // namespace ns3
@@ -112,6 +112,43 @@
 #endif /* NS_LOG_APPEND_CONTEXT */
 
 
+#ifndef NS3_LOG_LEVEL_CAP
+/**
+ * \ingroup logging
+ * The log levels compiled in all the components, set by
+ * \c \-\-log-level-cap.
+ */
+#define NS3_LOG_LEVEL_CAP ns3::LOG_ALL
+#endif
+
+#ifndef NS_LOG_COMPONENT_LEVEL_CAP
+/**
+ * \ingroup logging
+ * The log levels compiled in the component of a file.
+ *
+ * This is redefined locally in `.cc` files, after the includes:
+ * \code
+ *   #undef NS_LOG_COMPONENT_LEVEL_CAP
+ *   #define NS_LOG_COMPONENT_LEVEL_CAP ns3::LOG_LEVEL_WARN
+ * \endcode
+ * so that the messages of the higher levels and the evaluation of
+ * their arguments are compiled out.
+ */
+#define NS_LOG_COMPONENT_LEVEL_CAP ns3::LOG_ALL
+#endif
+
+/**
+ * \ingroup logging
+ * Check whether a log level is compiled in.
+ * \internal
+ * Logging implementation macro; should not be called directly.
+ *
+ * \param [in] level The log level.
+ */
+#define NS_LOG_COMPILED(level)                                  \
+  (((level) & NS3_LOG_LEVEL_CAP & NS_LOG_COMPONENT_LEVEL_CAP) != 0)
+
+
 #ifndef NS_LOG_CONDITION
 /**
  * \ingroup logging
@@ -153,14 +190,23 @@
   NS_LOG_CONDITION                                              \
   do                                                            \
     {                                                           \
-      if (g_log.IsEnabled (level))                              \
+      if (NS_LOG_COMPILED (level) && g_log.IsEnabled (level))   \
         {                                                       \
-          NS_LOG_APPEND_TIME_PREFIX;                            \
-          NS_LOG_APPEND_NODE_PREFIX;                            \
-          NS_LOG_APPEND_CONTEXT;                                \
-          NS_LOG_APPEND_FUNC_PREFIX;                            \
-          NS_LOG_APPEND_LEVEL_PREFIX (level);                   \
-          std::clog << msg << std::endl;                        \
+          if (ns3::LogBinaryRecord::IsSinkOpen ())              \
+            {                                                   \
+              ns3::LogBinaryRecord ns3LogRecord (g_log, level,  \
+                                                 __FUNCTION__); \
+              ns3LogRecord.GetStream () << msg;                 \
+            }                                                   \
+          else                                                  \
+            {                                                   \
+              NS_LOG_APPEND_TIME_PREFIX;                        \
+              NS_LOG_APPEND_NODE_PREFIX;                        \
+              NS_LOG_APPEND_CONTEXT;                            \
+              NS_LOG_APPEND_FUNC_PREFIX;                        \
+              NS_LOG_APPEND_LEVEL_PREFIX (level);               \
+              std::clog << msg << std::endl;                    \
+            }                                                   \
         }                                                       \
     }                                                           \
   while (false)
@@ -177,13 +223,22 @@
   NS_LOG_CONDITION                                              \
   do                                                            \
     {                                                           \
-      if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
+      if (NS_LOG_COMPILED (ns3::LOG_FUNCTION)                   \
+          && g_log.IsEnabled (ns3::LOG_FUNCTION))               \
         {                                                       \
-          NS_LOG_APPEND_TIME_PREFIX;                            \
-          NS_LOG_APPEND_NODE_PREFIX;                            \
-          NS_LOG_APPEND_CONTEXT;                                \
-          std::clog << g_log.Name () << ":"                     \
-                    << __FUNCTION__ << "()" << std::endl;       \
+          if (ns3::LogBinaryRecord::IsSinkOpen ())              \
+            {                                                   \
+              ns3::LogBinaryRecord ns3LogRecord                 \
+                (g_log, ns3::LOG_FUNCTION, __FUNCTION__);       \
+            }                                                   \
+          else                                                  \
+            {                                                   \
+              NS_LOG_APPEND_TIME_PREFIX;                        \
+              NS_LOG_APPEND_NODE_PREFIX;                        \
+              NS_LOG_APPEND_CONTEXT;                            \
+              std::clog << g_log.Name () << ":"                 \
+                        << __FUNCTION__ << "()" << std::endl;   \
+            }                                                   \
         }                                                       \
     }                                                           \
   while (false)
@@ -214,15 +269,26 @@
   NS_LOG_CONDITION                                              \
   do                                                            \
     {                                                           \
-      if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
+      if (NS_LOG_COMPILED (ns3::LOG_FUNCTION)                   \
+          && g_log.IsEnabled (ns3::LOG_FUNCTION))               \
         {                                                       \
-          NS_LOG_APPEND_TIME_PREFIX;                            \
-          NS_LOG_APPEND_NODE_PREFIX;                            \
-          NS_LOG_APPEND_CONTEXT;                                \
-          std::clog << g_log.Name () << ":"                     \
-                    << __FUNCTION__ << "(";                     \
-          ns3::ParameterLogger (std::clog) << parameters;       \
-          std::clog << ")" << std::endl;                        \
+          if (ns3::LogBinaryRecord::IsSinkOpen ())              \
+            {                                                   \
+              ns3::LogBinaryRecord ns3LogRecord                 \
+                (g_log, ns3::LOG_FUNCTION, __FUNCTION__);       \
+              ns3::ParameterLogger (ns3LogRecord.GetStream ())  \
+                << parameters;                                  \
+            }                                                   \
+          else                                                  \
+            {                                                   \
+              NS_LOG_APPEND_TIME_PREFIX;                        \
+              NS_LOG_APPEND_NODE_PREFIX;                        \
+              NS_LOG_APPEND_CONTEXT;                            \
+              std::clog << g_log.Name () << ":"                 \
+                        << __FUNCTION__ << "(";                 \
+              ns3::ParameterLogger (std::clog) << parameters;   \
+              std::clog << ")" << std::endl;                    \
+            }                                                   \
         }                                                       \
     }                                                           \
   while (false)
@@ -23,6 +23,7 @@
 
 #include <string>
 #include <iostream>
+#include <streambuf>
 #include <stdint.h>
 #include <map>
 
@@ -78,6 +79,18 @@
  *   NS_LOG_FUNCTION (this << arg1 << args);
  * \endcode
  * Use NS_LOG_FUNCTION_NOARGS() only in static functions with no arguments.
+ *
+ * Logging is compiled in the debug builds, and in the other builds
+ * configured with \c \-\-enable-logs.  The levels above a cap are
+ * compiled out: \c \-\-log-level-cap=warn caps all components, and a
+ * file can cap its own component after its includes:
+ * \code
+ *   #undef NS_LOG_COMPONENT_LEVEL_CAP
+ *   #define NS_LOG_COMPONENT_LEVEL_CAP ns3::LOG_LEVEL_INFO
+ * \endcode
+ *
+ * The messages can go to a binary sink instead of \c std::clog, see
+ * LogSetBinarySink().
  */
 /** @{ */
 
@@ -409,6 +422,12 @@ private:
 
 };  // class LogComponent
 
+inline bool
+LogComponent::IsEnabled (const enum LogLevel level) const
+{
+  return (level & m_levels) ? 1 : 0;
+}
+
   
 /**
  * Insert `, ` when streaming function arguments.
@@ -448,6 +467,135 @@ public:
   }
 };
 
+
+/**
+ * Write the log messages to a binary sink, instead of \c std::clog.
+ *
+ * The sink is a ring of fixed-size records in a memory-mapped file:
+ * a message costs no system call, the last \p records messages
+ * survive a crash of the program, and the records of several threads
+ * do not need a lock.  Each record holds the simulation time, the
+ * context, the level, the enabled prefixes, the component and
+ * function names, and the message, truncated to a fixed length.
+ * A message is dropped when every record is still being written.
+ * The file is decoded offline by LogDecodeBinarySink(), or by the
+ * \c decode-binary-log program.
+ *
+ * The custom contexts of NS_LOG_APPEND_CONTEXT are not recorded,
+ * the times are printed by the default time printer rather than by
+ * the one of LogSetTimePrinter(), and NS_LOG_UNCOND() still writes
+ * to \c std::clog.
+ *
+ * \param [in] filename The file to write, replaced if it exists.
+ * \param [in] records The number of records of the ring.
+ */
+void LogSetBinarySink (const std::string &filename, uint32_t records);
+/**
+ * Close the binary sink, and write the log messages to \c std::clog again.
+ */
+void LogCloseBinarySink (void);
+/**
+ * Print the records of a binary sink, from the oldest to the newest,
+ * in the format of the messages written to \c std::clog, with the
+ * prefixes enabled when they were logged.
+ *
+ * \param [in] filename The file of the binary sink.
+ * \param [in,out] os The output stream.
+ */
+void LogDecodeBinarySink (const std::string &filename, std::ostream &os);
+
+/**
+ * A record of the binary sink, being written.
+ *
+ * \internal
+ * Logging implementation class; used by the logging macros while a
+ * binary sink is open.  The message is streamed into the record
+ * through GetStream(), and the record is committed by the destructor.
+ */
+class LogBinaryRecord
+{
+public:
+  /**
+   * Claim the next record of the binary sink.
+   *
+   * \param [in] component The LogComponent of the message.
+   * \param [in] level The level of the message.
+   * \param [in] function The name of the function logging the message.
+   */
+  LogBinaryRecord (const LogComponent &component, enum LogLevel level,
+                   const char *function);
+  /** Commit the record. */
+  ~LogBinaryRecord ();
+  /**
+   * Get the stream which writes the message into the record.
+   *
+   * \returns The stream.
+   */
+  std::ostream &GetStream (void);
+  /**
+   * Check whether a binary sink is open.
+   *
+   * \returns \c true if the messages go to a binary sink.
+   */
+  static bool IsSinkOpen (void);
+
+private:
+  friend void LogSetBinarySink (const std::string &filename, uint32_t records);
+  friend void LogCloseBinarySink (void);
+  friend void LogDecodeBinarySink (const std::string &filename, std::ostream &os);
+
+  /** The record, as laid out in the file. */
+  struct Slot;
+  /** The header of the file. */
+  struct Header;
+
+  /** A stream buffer writing in place into the message of a record. */
+  class Buffer : public std::streambuf
+  {
+  public:
+    /**
+     * Set the memory to write into.
+     *
+     * \param [in] begin The memory.
+     * \param [in] size The size of the memory, in bytes.
+     */
+    void Set (char *begin, std::size_t size)
+    {
+      setp (begin, begin + size);
+    }
+    /**
+     * Get the end of the characters written.
+     *
+     * \returns The end of the characters written.
+     */
+    char *GetEnd (void) const
+    {
+      return pptr ();
+    }
+  };
+
+  Buffer m_buffer;           //!< The buffer of the message.
+  std::ostream m_os;         //!< The stream of the message.
+  struct Slot *m_slot;       //!< The record.
+  uint64_t m_sequence;       //!< The sequence number of the record.
+  bool m_dropped;            //!< Whether the record is outside of the sink.
+
+  static struct Header *m_sink;  //!< The mapped file, or 0.
+  static std::size_t m_size;     //!< The size of the mapped file.
+};
+
+inline bool
+LogBinaryRecord::IsSinkOpen (void)
+{
+  return m_sink != 0;
+}
+
+inline std::ostream &
+LogBinaryRecord::GetStream (void)
+{
+  return m_os;
+}
+
 } // namespace ns3
 
 /**@}*/  // \ingroup logging
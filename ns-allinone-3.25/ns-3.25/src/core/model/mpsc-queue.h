@@ -0,0 +1,288 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include "system-mutex.h"
+#include <stdint.h>
+#include <list>
+#include <vector>
+
+/**
+ * @file
+ * @ingroup thread
+ * ns3::MpscQueue declaration and template implementation.
+ */
+
+namespace ns3 {
+
+/**
+ * @ingroup thread
+ * @brief A multiple producer, single consumer FIFO queue.
+ *
+ * Producers normally go through a bounded ring of cells, each tagged
+ * with a sequence number as in Dmitry Vyukov's bounded queue: a
+ * producer claims a cell with a single compare-and-swap on the tail
+ * index, and publishes the item by advancing the sequence of the cell.
+ * No lock is taken, and producers never wait for the consumer.
+ *
+ * When the ring is full, items go to an overflow list protected by a
+ * SystemMutex, and keep going there until the consumer has taken the
+ * list, so that the items of each producer are always consumed in the
+ * order in which they were pushed.
+ *
+ * Push reports whether the consumer may be about to wait for an item,
+ * so that a consumer which drains the queue in batches needs to be
+ * woken up once per batch instead of once per item.
+ *
+ * @tparam T \explicit The type of the items, which must be copyable.
+ */
+template <typename T>
+class MpscQueue
+{
+public:
+  /**
+   * Constructor.
+   *
+   * @param [in] capacity The minimum number of items held by the ring,
+   *             rounded up to a power of two.
+   */
+  MpscQueue (uint32_t capacity = 1024);
+
+  /**
+   * Append an item; this can be called by any thread.
+   *
+   * @param [in] item The item.
+   * @returns \c true if the consumer had taken every earlier item,
+   *          so that it should be woken up.
+   */
+  bool Push (const T &item);
+
+  /**
+   * Remove the oldest item; this must only be called by the consumer.
+   *
+   * After the overflow list has been taken, this may have to wait for
+   * a producer to publish an item it is writing in the ring.
+   *
+   * @param [out] item The item.
+   * @returns \c false if the queue was empty.
+   */
+  bool Pop (T &item);
+
+  /**
+   * Check whether the queue is empty; this must only be called by
+   * the consumer.
+   *
+   * @returns \c true if there was no item to pop.
+   */
+  bool IsEmpty (void) const;
+
+private:
+  /** A ring cell. */
+  struct Cell
+  {
+    /**
+     * Equal to the position of the cell when it is free, to the
+     * position plus one when it holds an item.
+     */
+    uint64_t sequence;
+    T item;  /**< The item. */
+  };
+
+  /**
+   * Try to take an item from the ring.
+   *
+   * @param [out] item The item.
+   * @returns \c false if the ring was empty.
+   */
+  bool PopRing (T &item);
+  /**
+   * Append an item to the overflow list.
+   *
+   * @param [in] item The item.
+   * @returns \c true if the overflow list was empty.
+   */
+  bool PushOverflow (const T &item);
+
+  /** The ring. */
+  std::vector<Cell> m_cells;
+  /** Capacity of the ring minus one. */
+  uint64_t m_mask;
+  /** Next position to be claimed by a producer. */
+  uint64_t m_tail;
+  /** Next position to be read by the consumer. */
+  uint64_t m_head;
+  /** Whether the overflow list is in use. */
+  bool m_overflowing;
+  /** Items pushed while the ring was full. */
+  std::list<T> m_overflow;
+  /** Items taken from the overflow list, owned by the consumer. */
+  std::list<T> m_pending;
+  /**
+   * Ring position claimed next when the overflow list was taken: the
+   * ring items before it are older than the items of m_pending.
+   */
+  uint64_t m_pendingStart;
+  /** Mutex protecting the overflow list. */
+  SystemMutex m_overflowMutex;
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename T>
+MpscQueue<T>::MpscQueue (uint32_t capacity)
+  : m_tail (0),
+    m_head (0),
+    m_overflowing (false),
+    m_pendingStart (0)
+{
+  uint64_t size = 2;
+  while (size < capacity)
+    {
+      size <<= 1;
+    }
+  m_cells.resize (size);
+  for (uint64_t i = 0; i < size; i++)
+    {
+      m_cells[i].sequence = i;
+    }
+  m_mask = size - 1;
+}
+
+template <typename T>
+bool
+MpscQueue<T>::Push (const T &item)
+{
+  if (__atomic_load_n (&m_overflowing, __ATOMIC_ACQUIRE))
+    {
+      return PushOverflow (item);
+    }
+  uint64_t pos = __atomic_load_n (&m_tail, __ATOMIC_RELAXED);
+  Cell *cell;
+  for (;;)
+    {
+      cell = &m_cells[pos & m_mask];
+      uint64_t sequence = __atomic_load_n (&cell->sequence, __ATOMIC_ACQUIRE);
+      int64_t diff = (int64_t)(sequence - pos);
+      if (diff == 0)
+        {
+          if (__atomic_compare_exchange_n (&m_tail, &pos, pos + 1, true,
+                                           __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+              break;
+            }
+        }
+      else if (diff < 0)
+        {
+          // The consumer has not freed this cell yet: the ring is full.
+          return PushOverflow (item);
+        }
+      else
+        {
+          pos = __atomic_load_n (&m_tail, __ATOMIC_RELAXED);
+        }
+    }
+  cell->item = item;
+  __atomic_store_n (&cell->sequence, pos + 1, __ATOMIC_SEQ_CST);
+  // If the consumer already went past every earlier item, it may be
+  // waiting for this one.
+  return __atomic_load_n (&m_head, __ATOMIC_SEQ_CST) == pos;
+}
+
+template <typename T>
+bool
+MpscQueue<T>::PushOverflow (const T &item)
+{
+  CriticalSection cs (m_overflowMutex);
+  bool wasEmpty = m_overflow.empty ();
+  m_overflow.push_back (item);
+  __atomic_store_n (&m_overflowing, true, __ATOMIC_RELEASE);
+  return wasEmpty;
+}
+
+template <typename T>
+bool
+MpscQueue<T>::PopRing (T &item)
+{
+  Cell *cell = &m_cells[m_head & m_mask];
+  if (__atomic_load_n (&cell->sequence, __ATOMIC_ACQUIRE) != m_head + 1)
+    {
+      return false;
+    }
+  item = cell->item;
+  cell->item = T ();
+  __atomic_store_n (&cell->sequence, m_head + m_mask + 1, __ATOMIC_RELEASE);
+  __atomic_store_n (&m_head, m_head + 1, __ATOMIC_SEQ_CST);
+  return true;
+}
+
+template <typename T>
+bool
+MpscQueue<T>::Pop (T &item)
+{
+  if (m_pending.empty ())
+    {
+      if (PopRing (item))
+        {
+          return true;
+        }
+      if (!__atomic_load_n (&m_overflowing, __ATOMIC_ACQUIRE))
+        {
+          return false;
+        }
+      CriticalSection cs (m_overflowMutex);
+      // A producer which saw the flag set does not use the ring until
+      // it is cleared: the ring items claimed so far are older than the
+      // overflow items of the same producer, the ones claimed later are
+      // newer.
+      m_pendingStart = __atomic_load_n (&m_tail, __ATOMIC_SEQ_CST);
+      m_pending.swap (m_overflow);
+      __atomic_store_n (&m_overflowing, false, __ATOMIC_RELEASE);
+    }
+  while (m_head < m_pendingStart)
+    {
+      // This cell has been claimed, wait until it is published.
+      if (PopRing (item))
+        {
+          return true;
+        }
+    }
+  item = m_pending.front ();
+  m_pending.pop_front ();
+  return true;
+}
+
+template <typename T>
+bool
+MpscQueue<T>::IsEmpty (void) const
+{
+  const Cell *cell = &m_cells[m_head & m_mask];
+  return m_pending.empty ()
+         && __atomic_load_n (&cell->sequence, __ATOMIC_ACQUIRE) != m_head + 1
+         && !__atomic_load_n (&m_overflowing, __ATOMIC_ACQUIRE);
+}
+
+} // namespace ns3
+
+#endif /* MPSC_QUEUE_H */
@@ -490,6 +490,15 @@ public:
   }
   inline double ToDouble (enum Unit unit) const
   {
+    struct Information *info = PeekInformation (unit);
+    // If both the value and the factor are exact in a double, a single
+    // floating point operation gives the correctly rounded result.
+    const int64_t exact = static_cast<int64_t> (1) << 53;
+    if (info->factor <= exact && m_data <= exact && m_data >= -exact)
+      {
+        double v = static_cast<double> (m_data);
+        return info->toMul ? v * info->factor : v / info->factor;
+      }
     return To (unit).GetDouble ();
   }
   inline int64x64_t To (enum Unit unit) const
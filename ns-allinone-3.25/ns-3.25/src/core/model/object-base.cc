@@ -79,96 +79,103 @@ ObjectBase::NotifyConstructionCompleted (void)
 void
 ObjectBase::ConstructSelf (const AttributeConstructionList &attributes)
 {
-  // loop over the inheritance tree back to the Object base class.
+  // loop over the attributes of the whole inheritance tree, flattened
+  // by TypeId in class order, back to the Object base class.
   NS_LOG_FUNCTION (this << &attributes);
-  TypeId tid = GetInstanceTypeId ();
-  do {
-      // loop over all attributes in object type
-      NS_LOG_DEBUG ("construct tid="<<tid.GetName ()<<", params="<<tid.GetAttributeN ());
-      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
+  TypeId instanceTid = GetInstanceTypeId ();
+  NS_LOG_DEBUG ("construct tid="<<instanceTid.GetName ()<<", params="<<instanceTid.GetInheritedAttributeN ());
+#ifdef HAVE_GETENV
+  char *envVar = getenv ("NS_ATTRIBUTE_DEFAULT");
+#endif /* HAVE_GETENV */
+  for (uint32_t i = 0; i < instanceTid.GetInheritedAttributeN (); i++)
+    {
+      TypeId tid;
+      const struct TypeId::AttributeInformation &info = instanceTid.GetInheritedAttribute (i, &tid);
+      // Keep what we need: setting an attribute can register new TypeIds,
+      // which invalidates info.
+      uint32_t flags = info.flags;
+      Ptr<const AttributeAccessor> accessor = info.accessor;
+      Ptr<const AttributeChecker> checker = info.checker;
+      Ptr<const AttributeValue> initialValue = info.initialValue;
+      NS_LOG_DEBUG ("try to construct \""<< tid.GetName ()<<"::"<<
+                    info.name <<"\"");
+      // is this attribute stored in this AttributeConstructionList instance ?
+      Ptr<AttributeValue> value = attributes.Find(checker);
+      // See if this attribute should not be set here in the
+      // constructor.
+      if (!(flags & TypeId::ATTR_CONSTRUCT))
         {
-          struct TypeId::AttributeInformation info = tid.GetAttribute(i);
-          NS_LOG_DEBUG ("try to construct \""<< tid.GetName ()<<"::"<<
-                        info.name <<"\"");
-          // is this attribute stored in this AttributeConstructionList instance ?
-          Ptr<AttributeValue> value = attributes.Find(info.checker);
-          // See if this attribute should not be set here in the
-          // constructor.
-          if (!(info.flags & TypeId::ATTR_CONSTRUCT))
-            {
-              // Handle this attribute if it should not be 
-              // set here.
-              if (value == 0)
-                {
-                  // Skip this attribute if it's not in the
-                  // AttributeConstructionList.
-                  continue;
-                }              
-              else
-                {
-                  // This is an error because this attribute is not
-                  // settable in its constructor but is present in
-                  // the AttributeConstructionList.
-                  NS_FATAL_ERROR ("Attribute name="<<info.name<<" tid="<<tid.GetName () << ": initial value cannot be set using attributes");
-                }
-            }
-          bool found = false;
-          if (value != 0)
+          // Handle this attribute if it should not be 
+          // set here.
+          if (value == 0)
             {
-              // We have a matching attribute value.
-              if (DoSet (info.accessor, info.checker, *value))
-                {
-                  NS_LOG_DEBUG ("construct \""<< tid.GetName ()<<"::"<<
-                                info.name<<"\"");
-                  found = true;
-                  continue;
-                }
+              // Skip this attribute if it's not in the
+              // AttributeConstructionList.
+              continue;
             }              
-          if (!found)
+          else
             {
-              // No matching attribute value so we try to look at the env var.
+              // This is an error because this attribute is not
+              // settable in its constructor but is present in
+              // the AttributeConstructionList.
+              NS_FATAL_ERROR ("Attribute name="<<info.name<<" tid="<<tid.GetName () << ": initial value cannot be set using attributes");
+            }
+        }
+      bool found = false;
+      if (value != 0)
+        {
+          // We have a matching attribute value.
+          if (DoSet (accessor, checker, *value))
+            {
+              NS_LOG_DEBUG ("construct \""<< tid.GetName ()<<"::"<<
+                            instanceTid.GetInheritedAttribute (i, &tid).name<<"\"");
+              found = true;
+              continue;
+            }
+        }              
+      if (!found)
+        {
+          // No matching attribute value so we try to look at the env var.
 #ifdef HAVE_GETENV
-              char *envVar = getenv ("NS_ATTRIBUTE_DEFAULT");
-              if (envVar != 0)
+          if (envVar != 0)
+            {
+              std::string env = std::string (envVar);
+              std::string fullName = tid.GetName () + "::" +
+                instanceTid.GetInheritedAttribute (i, &tid).name;
+              std::string::size_type cur = 0;
+              std::string::size_type next = 0;
+              while (next != std::string::npos)
                 {
-                  std::string env = std::string (envVar);
-                  std::string::size_type cur = 0;
-                  std::string::size_type next = 0;
-                  while (next != std::string::npos)
+                  next = env.find (";", cur);
+                  std::string tmp = std::string (env, cur, next-cur);
+                  std::string::size_type equal = tmp.find ("=");
+                  if (equal != std::string::npos)
                     {
-                      next = env.find (";", cur);
-                      std::string tmp = std::string (env, cur, next-cur);
-                      std::string::size_type equal = tmp.find ("=");
-                      if (equal != std::string::npos)
+                      std::string name = tmp.substr (0, equal);
+                      std::string value = tmp.substr (equal+1, tmp.size () - equal - 1);
+                      if (name == fullName)
                         {
-                          std::string name = tmp.substr (0, equal);
-                          std::string value = tmp.substr (equal+1, tmp.size () - equal - 1);
-                          if (name == tid.GetAttributeFullName (i))
+                          if (DoSet (accessor, checker, StringValue (value)))
                             {
-                              if (DoSet (info.accessor, info.checker, StringValue (value)))
-                                {
-                                  NS_LOG_DEBUG ("construct \""<< tid.GetName ()<<"::"<<
-                                                info.name <<"\" from env var");
-                                  found = true;
-                                  break;
-                                }
+                              NS_LOG_DEBUG ("construct \""<< fullName <<"\" from env var");
+                              found = true;
+                              break;
                             }
                         }
-                      cur = next + 1;
                     }
+                  cur = next + 1;
                 }
-#endif /* HAVE_GETENV */
-            }
-          if (!found)
-            {
-              // No matching attribute value so we try to set the default value.
-              DoSet (info.accessor, info.checker, *info.initialValue);
-              NS_LOG_DEBUG ("construct \""<< tid.GetName ()<<"::"<<
-                            info.name <<"\" from initial value.");
             }
+#endif /* HAVE_GETENV */
         }
-      tid = tid.GetParent ();
-    } while (tid != ObjectBase::GetTypeId ());
+      if (!found)
+        {
+          // No matching attribute value so we try to set the default value.
+          DoSet (accessor, checker, *initialValue);
+          NS_LOG_DEBUG ("construct \""<< tid.GetName ()<<"::"<<
+                        instanceTid.GetInheritedAttribute (i, &tid).name <<"\" from initial value.");
+        }
+    }
   NotifyConstructionCompleted ();
 }
 
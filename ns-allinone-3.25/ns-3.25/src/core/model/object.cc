@@ -103,6 +103,7 @@ Object::Object ()
   NS_LOG_FUNCTION (this);
   m_aggregates->n = 1;
   m_aggregates->buffer[0] = this;
+  ClearCache (m_aggregates);
 }
 Object::~Object () 
 {
@@ -120,6 +121,8 @@ Object::~Object ()
           m_aggregates->n--;
         }
     }
+  // the cache may point to this object
+  ClearCache (m_aggregates);
   // finally, if all objects have been removed from the list,
   // delete the aggregate list
   if (m_aggregates->n == 0)
@@ -137,6 +140,7 @@ Object::Object (const Object &o)
 {
   m_aggregates->n = 1;
   m_aggregates->buffer[0] = this;
+  ClearCache (m_aggregates);
 }
 void
 Object::Construct (const AttributeConstructionList &attributes)
@@ -151,6 +155,16 @@ Object::DoGetObject (TypeId tid) const
   NS_LOG_FUNCTION (this << tid);
   NS_ASSERT (CheckLoose ());
 
+  uint16_t uid = tid.GetUid ();
+  struct Aggregates::CacheEntry *entry =
+    &m_aggregates->cache[uid & (Aggregates::CACHE_SIZE - 1)];
+  if (entry->uid == uid)
+    {
+      return const_cast<Object *> (entry->object);
+    }
+  entry->uid = uid;
+  entry->object = 0;
+
   uint32_t n = m_aggregates->n;
   TypeId objectTid = Object::GetTypeId ();
   for (uint32_t i = 0; i < n; i++)
@@ -173,8 +187,9 @@ Object::DoGetObject (TypeId tid) const
           current->m_getObjectCount++;
           // then, update the sort
           UpdateSortedArray (m_aggregates, i);
-          // finally, return the match
-          return const_cast<Object *> (current);
+          // finally, remember and return the match
+          entry->object = const_cast<Object *> (current);
+          return entry->object;
         }
     }
   return 0;
@@ -242,6 +257,16 @@ Object::UpdateSortedArray (struct Aggregates *aggregates, uint32_t j) const
       j--;
     }
 }
+void
+Object::ClearCache (struct Aggregates *aggregates)
+{
+  NS_LOG_FUNCTION (aggregates);
+  for (uint32_t i = 0; i < Aggregates::CACHE_SIZE; i++)
+    {
+      aggregates->cache[i].uid = 0;
+      aggregates->cache[i].object = 0;
+    }
+}
 void 
 Object::AggregateObject (Ptr<Object> o)
 {
@@ -264,6 +289,7 @@ Object::AggregateObject (Ptr<Object> o)
   struct Aggregates *aggregates = 
     (struct Aggregates *)std::malloc (sizeof(struct Aggregates)+(total-1)*sizeof(Object*));
   aggregates->n = total;
+  ClearCache (aggregates);
 
   // copy our buffer to the new buffer
   std::memcpy (&aggregates->buffer[0], 
@@ -327,10 +327,28 @@ private:
    * chunk of memory than the struct to allow space for a larger
    * variable sized buffer whose size is indicated by the element
    * \c n
+   *
+   * The list also holds a small direct-mapped cache of the results of
+   * DoGetObject(), indexed by the uid of the requested TypeId, so that
+   * repeated lookups of the same type do not walk the aggregates and
+   * their TypeId parents.  Since the list is replaced by
+   * AggregateObject(), the cache is naturally invalidated when the
+   * set of aggregated Objects changes.
    */
   struct Aggregates {
     /** The number of entries in \c buffer. */
     uint32_t n;
+    /** A cached result of DoGetObject(). */
+    struct CacheEntry {
+      /** The uid of the requested TypeId, or zero if the entry is empty. */
+      uint16_t uid;
+      /** The matching Object, or zero if there is none. */
+      Object *object;
+    };
+    /** The size of \c cache, a power of two. */
+    enum { CACHE_SIZE = 8 };
+    /** The cache of DoGetObject() results. */
+    struct CacheEntry cache[CACHE_SIZE];
     /** The array of Objects. */
     Object *buffer[1];
   };
@@ -389,6 +407,12 @@ private:
    * \param [in] i The most recently used entry in the list.
    */
   void UpdateSortedArray (struct Aggregates *aggregates, uint32_t i) const;
+  /**
+   * Forget the results of DoGetObject() cached in a list of aggregates.
+   *
+   * \param [in,out] aggregates The list of aggregated Objects.
+   */
+  static void ClearCache (struct Aggregates *aggregates);
   /**
    * Attempt to delete this Object.
    *
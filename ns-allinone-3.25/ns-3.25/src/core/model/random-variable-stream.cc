@@ -33,6 +33,7 @@
 #include "log.h"
 #include "rng-stream.h"
 #include "rng-seed-manager.h"
+#include "system-mutex.h"
 #include <cmath>
 #include <iostream>
 
@@ -48,6 +49,21 @@ NS_LOG_COMPONENT_DEFINE ("RandomVariableStream");
 
 NS_OBJECT_ENSURE_REGISTERED (RandomVariableStream);
 
+/**
+ * \ingroup randomvariable
+ * Get the mutex of the registry of the live RandomVariableStreams,
+ * which are created and destroyed by the threads of the simulation.
+ *
+ * \returns The mutex.
+ */
+static SystemMutex &
+GetRegistryMutex (void)
+{
+  // Never destroyed: streams may outlive the other statics.
+  static SystemMutex *mutex = new SystemMutex ();
+  return *mutex;
+}
+
 TypeId 
 RandomVariableStream::GetTypeId (void)
 {
@@ -72,16 +88,111 @@ RandomVariableStream::GetTypeId (void)
 }
 
 RandomVariableStream::RandomVariableStream()
-  : m_rng (0)
+  : m_rng (0),
+    m_rngStream (0)
 {
   NS_LOG_FUNCTION (this);
+  CriticalSection cs (GetRegistryMutex ());
+  m_registration = GetRegistry ()->insert (GetRegistry ()->end (), this);
 }
 RandomVariableStream::~RandomVariableStream()
 {
   NS_LOG_FUNCTION (this);
+  {
+    CriticalSection cs (GetRegistryMutex ());
+    GetRegistry ()->erase (m_registration);
+  }
   delete m_rng;
 }
 
+RandomVariableStream::Registry *
+RandomVariableStream::GetRegistry (void)
+{
+  // Never destroyed: streams may outlive the other statics.
+  static Registry *registry = new Registry ();
+  return registry;
+}
+
+void
+RandomVariableStream::ResetAllStreams (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  CriticalSection cs (GetRegistryMutex ());
+  Registry *registry = GetRegistry ();
+  for (Registry::iterator i = registry->begin (); i != registry->end (); ++i)
+    {
+      RandomVariableStream *stream = *i;
+      if (stream->m_rng != 0)
+        {
+          delete stream->m_rng;
+          stream->m_rng = new RngStream (RngSeedManager::GetSeed (),
+                                         stream->m_rngStream,
+                                         RngSeedManager::GetRun ());
+        }
+    }
+}
+
+void
+RandomVariableStream::SaveAllStreams (std::ostream &os)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  CriticalSection cs (GetRegistryMutex ());
+  Registry *registry = GetRegistry ();
+  for (Registry::const_iterator i = registry->begin (); i != registry->end (); ++i)
+    {
+      RandomVariableStream *stream = *i;
+      if (stream->m_rng == 0)
+        {
+          continue;
+        }
+      double state[6];
+      stream->m_rng->GetState (state);
+      // The state of MRG32k3a only holds integers below 2^32.
+      os << "stream " << stream->m_rngStream;
+      for (int j = 0; j < 6; j++)
+        {
+          os << " " << static_cast<uint64_t> (state[j]);
+        }
+      os << std::endl;
+    }
+}
+
+bool
+RandomVariableStream::RestoreAllStreams (std::istream &is)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  CriticalSection cs (GetRegistryMutex ());
+  Registry *registry = GetRegistry ();
+  for (Registry::iterator i = registry->begin (); i != registry->end (); ++i)
+    {
+      RandomVariableStream *stream = *i;
+      if (stream->m_rng == 0)
+        {
+          continue;
+        }
+      std::string tag;
+      uint64_t rngStream;
+      uint64_t values[6];
+      is >> tag >> rngStream;
+      for (int j = 0; j < 6; j++)
+        {
+          is >> values[j];
+        }
+      if (!is || tag != "stream" || rngStream != stream->m_rngStream)
+        {
+          NS_LOG_WARN ("Saved stream does not match stream " << stream->m_rngStream);
+          return false;
+        }
+      double state[6];
+      for (int j = 0; j < 6; j++)
+        {
+          state[j] = static_cast<double> (values[j]);
+        }
+      stream->m_rng->SetState (state);
+    }
+  return true;
+}
+
 void
 RandomVariableStream::SetAntithetic(bool isAntithetic)
 {
@@ -110,6 +221,7 @@ RandomVariableStream::SetStream (int64_t stream)
       m_rng = new RngStream (RngSeedManager::GetSeed (),
                              nextStream,
                              RngSeedManager::GetRun ());
+      m_rngStream = nextStream;
     }
   else
     {
@@ -120,6 +232,7 @@ RandomVariableStream::SetStream (int64_t stream)
       m_rng = new RngStream (RngSeedManager::GetSeed (),
                              target,
                              RngSeedManager::GetRun ());
+      m_rngStream = target;
     }
   m_stream = stream;
 }
@@ -130,6 +243,16 @@ RandomVariableStream::GetStream(void) const
   return m_stream;
 }
 
+void
+RandomVariableStream::GetValues (double *values, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      values[i] = GetValue ();
+    }
+}
+
 RngStream *
 RandomVariableStream::Peek(void) const
 {
@@ -207,6 +330,21 @@ UniformRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_min, m_max + 1);
 }
+void
+UniformRandomVariable::GetValues (double *values, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  Peek ()->RandU01 (values, n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double v = m_min + values[i] * (m_max - m_min);
+      if (IsAntithetic ())
+        {
+          v = m_min + (m_max - v);
+        }
+      values[i] = v;
+    }
+}
 
 NS_OBJECT_ENSURE_REGISTERED(ConstantRandomVariable);
 
@@ -262,6 +400,15 @@ ConstantRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_constant);
 }
+void
+ConstantRandomVariable::GetValues (double *values, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      values[i] = m_constant;
+    }
+}
 
 NS_OBJECT_ENSURE_REGISTERED(SequentialRandomVariable);
 
@@ -444,6 +591,32 @@ ExponentialRandomVariable::GetInteger (void)
   NS_LOG_FUNCTION (this);
   return (uint32_t)GetValue (m_mean, m_bound);
 }
+void
+ExponentialRandomVariable::GetValues (double *values, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  // Transform the uniform random numbers in place, in the order
+  // GetValue would draw them: a value rejected by the bound is
+  // replaced by the next one, so more numbers may be needed.
+  uint32_t done = 0;
+  while (done < n)
+    {
+      Peek ()->RandU01 (values + done, n - done);
+      for (uint32_t i = done; i < n; i++)
+        {
+          double v = values[i];
+          if (IsAntithetic ())
+            {
+              v = (1 - v);
+            }
+          double r = -m_mean * std::log (v);
+          if (m_bound == 0 || r <= m_bound)
+            {
+              values[done++] = r;
+            }
+        }
+    }
+}
 
 NS_OBJECT_ENSURE_REGISTERED(ParetoRandomVariable);
 
@@ -30,6 +30,8 @@
 #include "object.h"
 #include "attribute-helper.h"
 #include <stdint.h>
+#include <list>
+#include <iostream>
 
 /**
  * \file
@@ -149,6 +151,50 @@ public:
    */
   virtual uint32_t GetInteger (void) = 0;
 
+  /**
+   * \brief Get the next \p n random values drawn from the distribution.
+   *
+   * The values are the same as those returned by \p n calls to
+   * GetValue().  Subclasses override this method to draw the
+   * underlying uniform random numbers in bulk.
+   *
+   * \param [out] values The array to fill with the random values.
+   * \param [in] n The number of random values.
+   */
+  virtual void GetValues (double *values, uint32_t n);
+
+  /**
+   * \brief Restart all the RNG streams from the current seed and run.
+   *
+   * Each RandomVariableStream keeps its stream number, and starts
+   * again at the beginning of the substream selected by the current
+   * run number.  This lets a process forked from a running simulation
+   * draw values independent from those of its siblings, by setting
+   * its own run number first.
+   */
+  static void ResetAllStreams (void);
+  /**
+   * \brief Write the position of all the RNG streams.
+   *
+   * The streams are written in the order the RandomVariableStreams
+   * were created.
+   *
+   * \param [in,out] os The stream to write to.
+   */
+  static void SaveAllStreams (std::ostream &os);
+  /**
+   * \brief Restore the position of all the RNG streams.
+   *
+   * The RandomVariableStreams must have been created in the same
+   * order, with the same stream numbers, as when the positions were
+   * saved, which is the case when the same program builds the same
+   * topology.
+   *
+   * \param [in,out] is The stream to read from.
+   * \returns \c false if the streams do not match those saved.
+   */
+  static bool RestoreAllStreams (std::istream &is);
+
 protected:
   /**
    * \brief Get the pointer to the underlying RNG stream.
@@ -186,6 +232,23 @@ private:
   /** The stream number for this RNG stream. */
   int64_t m_stream;
 
+  /** The stream number given to the underlying RngStream. */
+  uint64_t m_rngStream;
+
+  /** Container of all the live RandomVariableStreams, in creation order. */
+  typedef std::list<RandomVariableStream *> Registry;
+  /**
+   * Get the registry of all the live RandomVariableStreams.
+   *
+   * The registry is only accessed with the registry mutex held,
+   * since streams are created and destroyed by several threads.
+   *
+   * \returns The registry.
+   */
+  static Registry *GetRegistry (void);
+  /** The position of this RandomVariableStream in the registry. */
+  Registry::iterator m_registration;
+
 };  // class RandomVariableStream
 
   
@@ -293,6 +356,12 @@ public:
    * \note The upper limit is included in the output range.
    */
   virtual uint32_t GetInteger (void);
+  /**
+   * \brief Get the next \p n random values drawn from the distribution.
+   * \param [out] values The array to fill with the random values.
+   * \param [in] n The number of random values.
+   */
+  virtual void GetValues (double *values, uint32_t n);
   
 private:
   /** The lower bound on values that can be returned by this RNG stream. */
@@ -352,6 +421,8 @@ public:
   virtual double GetValue (void);
   /* \note This RNG always returns the same value. */
   virtual uint32_t GetInteger (void);
+  /* \note This RNG always returns the same value. */
+  virtual void GetValues (double *values, uint32_t n);
 
 private:
   /** The constant value returned by this RNG stream. */
@@ -585,6 +656,7 @@ public:
   // Inherited from RandomVariableStream
   virtual double GetValue (void);
   virtual uint32_t GetInteger (void);
+  virtual void GetValues (double *values, uint32_t n);
 
 private:
   /** The mean value of the unbounded exponential distribution. */
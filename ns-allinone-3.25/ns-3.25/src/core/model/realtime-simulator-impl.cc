@@ -107,6 +107,11 @@ void
 RealtimeSimulatorImpl::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  Scheduler::Event injected;
+  while (m_injected.Pop (injected))
+    {
+      injected.impl->Unref ();
+    }
   while (!m_events->IsEmpty ())
     {
       Scheduler::Event next = m_events->RemoveNext ();
@@ -208,6 +213,15 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
 
       { 
         CriticalSection cs (m_mutex);
+        //
+        // This resets the synchronizer so that any event scheduled from now
+        // on will cause it to interrupt.  It has to be done before the events
+        // injected by other threads are collected: an event injected after 
+        // that point signals the synchronizer.
+        //
+        m_synchronizer->SetCondition (false);
+        ProcessInjectedEvents ();
+
         //
         // Since we are in realtime mode, the time to delay has got to be the 
         // difference between the current realtime and the timestamp of the next 
@@ -251,12 +265,10 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
 
         //
         // We've figured out how long we need to delay in order to pace the 
-        // simulation time with the real time.  We're going to sleep, but need
-        // to work with the synchronizer to make sure we're awakened if something 
-        // external happens (like a packet is received).  This next line resets
-        // the synchronizer so that any future event will cause it to interrupt.
+        // simulation time with the real time.  We're going to sleep, but the
+        // synchronizer was reset above so we're awakened if something 
+        // external happens (like a packet is received).
         //
-        m_synchronizer->SetCondition (false);
       }
 
       //
@@ -399,7 +411,7 @@ RealtimeSimulatorImpl::IsFinished (void) const
   bool rc;
   {
     CriticalSection cs (m_mutex);
-    rc = m_events->IsEmpty () || m_stop;
+    rc = (m_events->IsEmpty () && m_injected.IsEmpty ()) || m_stop;
   }
 
   return rc;
@@ -442,6 +454,8 @@ RealtimeSimulatorImpl::Run (void)
       {
         CriticalSection cs (m_mutex);
 
+        m_synchronizer->SetCondition (false);
+        ProcessInjectedEvents ();
         if (!m_events->IsEmpty ())
           {
             process = true;
@@ -543,23 +557,20 @@ RealtimeSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
 {
   NS_LOG_FUNCTION (this << context << delay << impl);
 
+  if (!SystemThread::Equals (m_main))
+    {
+      //
+      // If the simulator is running, we're pacing and have a meaningful 
+      // realtime clock.  If we're not, then m_currentTs is where we stopped.
+      // 
+      uint64_t ts = m_running ? m_synchronizer->GetCurrentRealtime () : m_currentTs;
+      Inject (ts + delay.GetTimeStep (), context, impl);
+      return;
+    }
+
   {
     CriticalSection cs (m_mutex);
-    uint64_t ts;
-
-    if (SystemThread::Equals (m_main))
-      {
-        ts = m_currentTs + delay.GetTimeStep ();
-      }
-    else
-      {
-        //
-        // If the simulator is running, we're pacing and have a meaningful 
-        // realtime clock.  If we're not, then m_currentTs is where we stopped.
-        // 
-        ts = m_running ? m_synchronizer->GetCurrentRealtime () : m_currentTs;
-        ts += delay.GetTimeStep ();
-      }
+    uint64_t ts = m_currentTs + delay.GetTimeStep ();
 
     NS_ASSERT_MSG (ts >= m_currentTs, "RealtimeSimulatorImpl::ScheduleRealtime(): schedule for time < m_currentTs");
     Scheduler::Event ev;
@@ -574,6 +585,46 @@ RealtimeSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay,
   }
 }
 
+void
+RealtimeSimulatorImpl::Inject (uint64_t ts, uint32_t context, EventImpl *impl)
+{
+  Scheduler::Event ev;
+  ev.impl = impl;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  ev.key.m_uid = 0;
+  //
+  // The simulation thread collects all the injected events each time it
+  // wakes up, so it only needs to be signalled by the first event of a
+  // batch.
+  //
+  if (m_injected.Push (ev))
+    {
+      m_synchronizer->Signal ();
+    }
+}
+
+void
+RealtimeSimulatorImpl::ProcessInjectedEvents (void)
+{
+  Scheduler::Event ev;
+  while (m_injected.Pop (ev))
+    {
+      //
+      // The simulation time may have moved past the realtime clock value
+      // read by the injecting thread while the event was queued.
+      //
+      if (ev.key.m_ts < m_currentTs)
+        {
+          ev.key.m_ts = m_currentTs;
+        }
+      ev.key.m_uid = m_uid;
+      m_uid++;
+      m_unscheduledEvents++;
+      m_events->Insert (ev);
+    }
+}
+
 EventId
 RealtimeSimulatorImpl::ScheduleNow (EventImpl *impl)
 {
@@ -609,6 +660,12 @@ RealtimeSimulatorImpl::ScheduleRealtimeWithContext (uint32_t context, Time const
 {
   NS_LOG_FUNCTION (this << context << time << impl);
 
+  if (!SystemThread::Equals (m_main))
+    {
+      Inject (m_synchronizer->GetCurrentRealtime () + time.GetTimeStep (), context, impl);
+      return;
+    }
+
   {
     CriticalSection cs (m_mutex);
 
@@ -617,6 +674,7 @@ RealtimeSimulatorImpl::ScheduleRealtimeWithContext (uint32_t context, Time const
     Scheduler::Event ev;
     ev.impl = impl;
     ev.key.m_ts = ts;
+    ev.key.m_context = context;
     ev.key.m_uid = m_uid;
     m_uid++;
     m_unscheduledEvents++;
@@ -636,6 +694,14 @@ void
 RealtimeSimulatorImpl::ScheduleRealtimeNowWithContext (uint32_t context, EventImpl *impl)
 {
   NS_LOG_FUNCTION (this << context << impl);
+
+  if (!SystemThread::Equals (m_main))
+    {
+      uint64_t ts = m_running ? m_synchronizer->GetCurrentRealtime () : m_currentTs;
+      Inject (ts, context, impl);
+      return;
+    }
+
   {
     CriticalSection cs (m_mutex);
 
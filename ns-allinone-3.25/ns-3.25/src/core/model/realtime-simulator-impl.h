@@ -30,6 +30,7 @@
 #include "assert.h"
 #include "log.h"
 #include "system-mutex.h"
+#include "mpsc-queue.h"
 
 #include <list>
 
@@ -172,6 +173,20 @@ private:
   uint64_t NextTs (void) const;
   /** Process the next event. */
   void ProcessOneEvent (void);
+  /**
+   * Queue an event scheduled by a thread other than the simulation
+   * thread, and wake up the simulation thread if needed.
+   *
+   * \param [in] ts The absolute event timestamp.
+   * \param [in] context The event context.
+   * \param [in] impl The event implementation.
+   */
+  void Inject (uint64_t ts, uint32_t context, EventImpl *impl);
+  /**
+   * Move the events queued by Inject to the event list.
+   * Should be called with #m_mutex locked.
+   */
+  void ProcessInjectedEvents (void);
   /** Destructor implementation. */
   virtual void DoDispose (void);
 
@@ -207,6 +222,12 @@ private:
   /** Mutex to control access to key state. */  
   mutable SystemMutex m_mutex;  
 
+  /**
+   * Events scheduled by other threads, with their absolute timestamp.
+   * Their uid is assigned when they are moved to the event list.
+   */
+  MpscQueue<Scheduler::Event> m_injected;
+
   /** The synchronizer in use to track real time. */
   Ptr<Synchronizer> m_synchronizer;
 
@@ -70,6 +70,28 @@ public:
    * \returns The next random.
    */
   double RandU01 (void);
+  /**
+   * Generate the next \p n random numbers for this stream.
+   *
+   * This produces the same numbers as \p n calls to RandU01(),
+   * but keeps the state of the generator in registers.
+   *
+   * \param [out] values The array to fill with the random numbers.
+   * \param [in] n The number of random numbers to generate.
+   */
+  void RandU01 (double *values, uint32_t n);
+  /**
+   * Get the position of this stream.
+   *
+   * \param [out] state The state vector of the generator.
+   */
+  void GetState (double state[6]) const;
+  /**
+   * Move this stream to a position returned by GetState().
+   *
+   * \param [in] state The state vector of the generator.
+   */
+  void SetState (const double state[6]);
 
 private:
   /**
@@ -0,0 +1,261 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "sweep-runner.h"
+#include "command-line.h"
+#include "random-variable-stream.h"
+#include "fatal-error.h"
+#include "assert.h"
+#include "log.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::SweepRunner implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SweepRunner");
+
+SweepRunner::SweepRunner ()
+  : m_maxWorkers (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+SweepRunner::SetMaxWorkers (uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  m_maxWorkers = n;
+}
+
+uint32_t
+SweepRunner::GetMaxWorkers (void) const
+{
+  NS_LOG_FUNCTION (this);
+  if (m_maxWorkers != 0)
+    {
+      return m_maxWorkers;
+    }
+  long processors = sysconf (_SC_NPROCESSORS_ONLN);
+  return processors > 0 ? static_cast<uint32_t> (processors) : 1;
+}
+
+uint32_t
+SweepRunner::AddVariant (std::vector<std::string> args)
+{
+  NS_LOG_FUNCTION (this << args.size ());
+  struct Variant variant;
+  variant.args = args;
+  variant.success = false;
+  m_variants.push_back (variant);
+  return m_variants.size () - 1;
+}
+
+uint32_t
+SweepRunner::GetNVariants (void) const
+{
+  return m_variants.size ();
+}
+
+void
+SweepRunner::SetResultCallback (Callback<void, uint32_t, std::string> cb)
+{
+  NS_LOG_FUNCTION (this);
+  m_result = cb;
+}
+
+std::string
+SweepRunner::GetResult (uint32_t i) const
+{
+  NS_ASSERT (i < m_variants.size ());
+  return m_variants[i].result;
+}
+
+bool
+SweepRunner::IsSuccess (uint32_t i) const
+{
+  NS_ASSERT (i < m_variants.size ());
+  return m_variants[i].success;
+}
+
+void
+SweepRunner::RunWorker (uint32_t i, int fd, CommandLine &cmd,
+                        Callback<std::string, uint32_t> variant)
+{
+  NS_LOG_FUNCTION (this << i << fd);
+  std::string name = cmd.GetName ();
+  std::vector<std::string> args (1, name.empty () ? std::string ("sweep") : name);
+  args.insert (args.end (), m_variants[i].args.begin (), m_variants[i].args.end ());
+  cmd.Parse (args);
+  RandomVariableStream::ResetAllStreams ();
+
+  std::string result = variant (i);
+
+  const char *data = result.data ();
+  std::string::size_type left = result.size ();
+  while (left > 0)
+    {
+      ssize_t written = write (fd, data, left);
+      if (written < 0 && errno == EINTR)
+        {
+          continue;
+        }
+      if (written <= 0)
+        {
+          _exit (1);
+        }
+      data += written;
+      left -= written;
+    }
+  close (fd);
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::fflush (0);
+  _exit (0);
+}
+
+void
+SweepRunner::Run (CommandLine &cmd, Callback<std::string, uint32_t> variant)
+{
+  NS_LOG_FUNCTION (this);
+
+  /** A running worker. */
+  struct Worker
+  {
+    pid_t pid;          //!< The process of the worker.
+    int fd;             //!< The pipe the result is read from.
+    uint32_t variant;   //!< The index of the variant.
+  };
+  std::vector<struct Worker> workers;
+  uint32_t maxWorkers = GetMaxWorkers ();
+  uint32_t next = 0;
+
+  while (next < m_variants.size () || !workers.empty ())
+    {
+      while (next < m_variants.size () && workers.size () < maxWorkers)
+        {
+          int fds[2];
+          if (pipe (fds) < 0)
+            {
+              NS_FATAL_ERROR ("Could not create the pipe of a sweep worker");
+            }
+          std::cout.flush ();
+          std::cerr.flush ();
+          std::fflush (0);
+          pid_t pid = fork ();
+          if (pid < 0)
+            {
+              NS_FATAL_ERROR ("Could not fork a sweep worker");
+            }
+          if (pid == 0)
+            {
+              close (fds[0]);
+              for (uint32_t j = 0; j < workers.size (); j++)
+                {
+                  close (workers[j].fd);
+                }
+              RunWorker (next, fds[1], cmd, variant);
+            }
+          close (fds[1]);
+          struct Worker worker;
+          worker.pid = pid;
+          worker.fd = fds[0];
+          worker.variant = next;
+          workers.push_back (worker);
+          m_variants[next].result = "";
+          NS_LOG_LOGIC ("variant " << next << " runs in process " << pid);
+          next++;
+        }
+
+      std::vector<struct pollfd> fds (workers.size ());
+      for (uint32_t j = 0; j < workers.size (); j++)
+        {
+          fds[j].fd = workers[j].fd;
+          fds[j].events = POLLIN;
+          fds[j].revents = 0;
+        }
+      if (poll (&fds[0], fds.size (), -1) < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+          NS_FATAL_ERROR ("Could not wait for the sweep workers");
+        }
+
+      // Walk backwards, so that completed workers can be erased.
+      for (uint32_t j = workers.size (); j-- > 0; )
+        {
+          if (fds[j].revents == 0)
+            {
+              continue;
+            }
+          struct Variant &v = m_variants[workers[j].variant];
+          char buffer[4096];
+          ssize_t n = read (workers[j].fd, buffer, sizeof (buffer));
+          if (n > 0)
+            {
+              v.result.append (buffer, n);
+              continue;
+            }
+          if (n < 0 && errno == EINTR)
+            {
+              continue;
+            }
+          close (workers[j].fd);
+          int status = 0;
+          pid_t result;
+          while ((result = waitpid (workers[j].pid, &status, 0)) < 0
+                 && errno == EINTR)
+            {
+            }
+          if (result < 0)
+            {
+              v.success = false;
+              NS_LOG_WARN ("Could not wait for variant " << workers[j].variant
+                           << ": " << std::strerror (errno));
+            }
+          else
+            {
+              v.success = WIFEXITED (status) && WEXITSTATUS (status) == 0;
+              if (!v.success)
+                {
+                  NS_LOG_WARN ("Variant " << workers[j].variant << " failed");
+                }
+            }
+          uint32_t index = workers[j].variant;
+          workers.erase (workers.begin () + j);
+          if (!m_result.IsNull ())
+            {
+              m_result (index, v.result);
+            }
+        }
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,173 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SWEEP_RUNNER_H
+#define SWEEP_RUNNER_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "callback.h"
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::SweepRunner declaration.
+ */
+
+namespace ns3 {
+
+class CommandLine;
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Run the variants of a parameter sweep in parallel worker
+ * processes forked from one simulation.
+ *
+ * The program builds its topology once, and possibly warms it up,
+ * then runs each variant in a copy-on-write copy of itself, forked
+ * like Checkpoint::Fork.  A variant is a list of command line
+ * arguments, parsed in its worker by the CommandLine of the program:
+ * \c \-\-RngRun selects the run number, and the other arguments set
+ * global values, attribute defaults and the program's own values.
+ * The worker then restarts the random number streams at its run
+ * number, calls the variant callback, which runs the simulation and
+ * returns the result, and sends the result back through a pipe.
+ *
+ * \code
+ *   std::string Variant (uint32_t i)
+ *   {
+ *     Simulator::Stop (Seconds (10));
+ *     Simulator::Run ();
+ *     std::ostringstream oss;
+ *     oss << g_received;
+ *     return oss.str ();
+ *   }
+ *
+ *   BuildTopology ();
+ *   SweepRunner runner;
+ *   for (uint32_t run = 1; run <= 1000; run++)
+ *     {
+ *       std::ostringstream oss;
+ *       oss << "--RngRun=" << run;
+ *       runner.AddVariant (std::vector<std::string> (1, oss.str ()));
+ *     }
+ *   runner.Run (cmd, MakeCallback (&Variant));
+ *   for (uint32_t i = 0; i < runner.GetNVariants (); i++)
+ *     {
+ *       std::cout << runner.GetResult (i) << std::endl;
+ *     }
+ * \endcode
+ *
+ * At most SetMaxWorkers() workers run at the same time, by default
+ * as many as there are processors.
+ */
+class SweepRunner
+{
+public:
+  SweepRunner ();
+
+  /**
+   * Set the maximum number of workers running at the same time.
+   *
+   * \param [in] n The number of workers, or 0 for the number of processors.
+   */
+  void SetMaxWorkers (uint32_t n);
+  /**
+   * Get the maximum number of workers running at the same time.
+   *
+   * \returns The number of workers.
+   */
+  uint32_t GetMaxWorkers (void) const;
+
+  /**
+   * Add a variant.
+   *
+   * \param [in] args The command line arguments of the variant,
+   *        without the program name.
+   * \returns The index of the variant.
+   */
+  uint32_t AddVariant (std::vector<std::string> args);
+  /**
+   * Get the number of variants.
+   *
+   * \returns The number of variants.
+   */
+  uint32_t GetNVariants (void) const;
+
+  /**
+   * Set a callback invoked in this process as soon as the result of
+   * a variant arrives, in the order the variants complete.
+   *
+   * \param [in] cb The callback, invoked with the index of the variant
+   *        and its result.
+   */
+  void SetResultCallback (Callback<void, uint32_t, std::string> cb);
+
+  /**
+   * Run all the variants, and wait for them to complete.
+   *
+   * \param [in] cmd The CommandLine which parses the arguments of the
+   *        variants, in the workers.
+   * \param [in] variant The callback which runs a variant, in its
+   *        worker, and returns its result.
+   */
+  void Run (CommandLine &cmd, Callback<std::string, uint32_t> variant);
+
+  /**
+   * Get the result of a variant, once Run() returned.
+   *
+   * \param [in] i The index of the variant.
+   * \returns The result of the variant.
+   */
+  std::string GetResult (uint32_t i) const;
+  /**
+   * Check whether the worker of a variant completed successfully.
+   *
+   * \param [in] i The index of the variant.
+   * \returns \c true if the worker exited normally.
+   */
+  bool IsSuccess (uint32_t i) const;
+
+private:
+  /** The state of a variant. */
+  struct Variant
+  {
+    std::vector<std::string> args;  //!< The command line arguments.
+    std::string result;             //!< The result.
+    bool success;                   //!< Whether the worker exited normally.
+  };
+
+  /**
+   * Run a variant in a worker, and exit.
+   *
+   * \param [in] i The index of the variant.
+   * \param [in] fd The pipe to write the result to.
+   * \param [in] cmd The CommandLine which parses the arguments.
+   * \param [in] variant The callback which runs the variant.
+   */
+  void RunWorker (uint32_t i, int fd, CommandLine &cmd,
+                  Callback<std::string, uint32_t> variant);
+
+  uint32_t m_maxWorkers;                           //!< Maximum number of workers.
+  std::vector<struct Variant> m_variants;          //!< The variants.
+  Callback<void, uint32_t, std::string> m_result;  //!< The result callback.
+};
+
+} // namespace ns3
+
+#endif /* SWEEP_RUNNER_H */
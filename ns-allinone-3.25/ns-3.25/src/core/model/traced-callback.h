@@ -21,7 +21,7 @@
 #ifndef TRACED_CALLBACK_H
 #define TRACED_CALLBACK_H
 
-#include <list>
+#include <vector>
 #include "callback.h"
 
 /**
@@ -46,6 +46,21 @@ namespace ns3 {
  * calling one of the \c operator() forms with the appropriate
  * number of arguments.
  *
+ * Most trace sources have no sink, and most of the others have
+ * a single one, so the first Callback of the chain is stored inline:
+ * invoking a TracedCallback without sink costs a single test,
+ * and neither invoking nor connecting the first sink allocates memory.
+ *
+ * A Callback may connect or disconnect Callbacks, including itself,
+ * while the chain is invoked: those connected are invoked at the end of
+ * the chain, those disconnected are not invoked if they were not yet.
+ * Invoking the chain does not modify it.  A Callback which disconnects
+ * itself must not use afterwards the objects the chain held the last
+ * reference to, since they are released by the disconnection.
+ *
+ * The packet trace sources of devices and PHYs which only users
+ * connect to can be compiled out with NS_OPTIONAL_TRACE.
+ *
  * \tparam T1 \explicit Type of the first argument to the functor.
  * \tparam T2 \explicit Type of the second argument to the functor.
  * \tparam T3 \explicit Type of the third argument to the functor.
@@ -64,6 +79,19 @@ class TracedCallback
 public:
   /** Constructor. */
   TracedCallback ();
+  /**
+   * Copy constructor.
+   *
+   * \param [in] o The TracedCallback to copy.
+   */
+  TracedCallback (const TracedCallback &o);
+  /**
+   * Assignment operator.
+   *
+   * \param [in] o The TracedCallback to copy.
+   * \returns This TracedCallback.
+   */
+  TracedCallback & operator = (const TracedCallback &o);
   /**
    * Append a Callback to the chain (without a context).
    *
@@ -93,6 +121,18 @@ public:
    * \param [in] path Context path which was used to connect the Callback.
    */
   void Disconnect (const CallbackBase & callback, std::string path);
+  /**
+   * Check whether invoking the chain would invoke any Callback.
+   *
+   * This lets trace sources skip the computation of expensive
+   * arguments when nothing is connected.
+   *
+   * \returns \c true if no Callback is connected.
+   */
+  inline bool IsEmpty (void) const
+  {
+    return m_first.callback.IsNull ();
+  }
   /**
    * \name Functors taking various numbers of arguments.
    *
@@ -234,11 +274,74 @@ private:
    * \tparam T7 \deduced Type of the seventh argument to the functor.
    * \tparam T8 \deduced Type of the eighth argument to the functor.
    */
-  typedef std::list<Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> > CallbackList;
-  /** The chain of Callbacks. */
-  CallbackList m_callbackList;
+  /** A Callback of the chain. */
+  struct Sink
+  {
+    /** The Callback. */
+    Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> callback;
+    /**
+     * The number of Callbacks connected before this one, which
+     * orders the chain.
+     */
+    uint64_t id;
+  };
+  typedef std::vector<Sink> CallbackList;
+  /** The first Callback of the chain, null if the chain is empty. */
+  Sink m_first;
+  /** The rest of the chain of Callbacks. */
+  CallbackList m_others;
+  /** The number of Callbacks connected so far. */
+  uint64_t m_connected;
+  /**
+   * The number of times Callbacks were removed from the chain, which
+   * tells an invocation in progress that its position moved.
+   */
+  uint64_t m_removals;
+  /**
+   * Append a Callback to the chain.
+   *
+   * \param [in] cb Callback to add to chain.
+   */
+  void Append (const Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> & cb);
+  /**
+   * Get a Callback of the chain.
+   *
+   * The positions in the chain are 0 for m_first, and i + 1 for
+   * m_others[i].
+   *
+   * \param [in] position The position of the Callback.
+   * \returns The Callback.
+   */
+  const Sink & Get (std::size_t position) const;
+  /**
+   * Find where an invocation resumes after Callbacks were removed.
+   *
+   * \param [in] id The id of the last Callback invoked.
+   * \returns The position of the first Callback connected after it.
+   */
+  std::size_t Next (uint64_t id) const;
 };
 
+/**
+ * \ingroup tracing
+ * Invoke an optional trace source.
+ *
+ * The packet trace sources of devices and PHYs, such as MacTx or
+ * PhyTxBegin, are fired for every packet but only connected by users
+ * and helpers. Their invocations are wrapped in this macro, which
+ * compiles them out when NS3_DISABLE_TRACE_SOURCES is defined
+ * (./waf configure --disable-trace-sources). Trace sources which
+ * models connect to, such as CourseChange or CongestionWindow, must
+ * not use it.
+ *
+ * \param [in] invocation The invocation of the TracedCallback.
+ */
+#ifdef NS3_DISABLE_TRACE_SOURCES
+#define NS_OPTIONAL_TRACE(invocation)
+#else /* NS3_DISABLE_TRACE_SOURCES */
+#define NS_OPTIONAL_TRACE(invocation) invocation
+#endif /* NS3_DISABLE_TRACE_SOURCES */
+
 } // namespace ns3
 
 
@@ -253,9 +356,82 @@ template<typename T1, typename T2,
          typename T5, typename T6,
          typename T7, typename T8>
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::TracedCallback ()
-  : m_callbackList () 
+  : m_first (),
+    m_others (),
+    m_connected (0),
+    m_removals (0)
+{
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::TracedCallback (const TracedCallback &o)
+  : m_first (o.m_first),
+    m_others (o.m_others),
+    m_connected (o.m_connected),
+    m_removals (0)
 {
 }
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8> &
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator = (const TracedCallback &o)
+{
+  m_first = o.m_first;
+  m_others = o.m_others;
+  m_connected = o.m_connected;
+  m_removals++;
+  return *this;
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+void
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Append (const Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> & cb)
+{
+  Sink sink;
+  sink.callback = cb;
+  sink.id = m_connected++;
+  if (m_first.callback.IsNull ())
+    {
+      m_first = sink;
+    }
+  else
+    {
+      m_others.push_back (sink);
+    }
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+const typename TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Sink &
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Get (std::size_t position) const
+{
+  return position == 0 ? m_first : m_others[position - 1];
+}
+template<typename T1, typename T2,
+         typename T3, typename T4,
+         typename T5, typename T6,
+         typename T7, typename T8>
+std::size_t
+TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Next (uint64_t id) const
+{
+  if (m_first.callback.IsNull () || m_first.id > id)
+    {
+      return 0;
+    }
+  std::size_t position = 1;
+  while (position <= m_others.size () && m_others[position - 1].id <= id)
+    {
+      position++;
+    }
+  return position;
+}
 template<typename T1, typename T2,
          typename T3, typename T4,
          typename T5, typename T6,
@@ -266,7 +442,7 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::ConnectWithoutContext (const CallbackBa
   Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> cb;
   if (!cb.Assign (callback))
     NS_FATAL_ERROR_NO_MSG();
-  m_callbackList.push_back (cb);
+  Append (cb);
 }
 template<typename T1, typename T2,
          typename T3, typename T4,
@@ -279,7 +455,7 @@ TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::Connect (const CallbackBase & callback,
   if (!cb.Assign (callback))
     NS_FATAL_ERROR ("when connecting to " << path);
   Callback<void,T1,T2,T3,T4,T5,T6,T7,T8> realCb = cb.Bind (path);
-  m_callbackList.push_back (realCb);
+  Append (realCb);
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -288,18 +464,35 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::DisconnectWithoutContext (const CallbackBase & callback)
 {
-  for (typename CallbackList::iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); /* empty */)
+  std::size_t size = m_others.size ();
+  for (std::size_t i = 0; i < m_others.size (); /* empty */)
     {
-      if ((*i).IsEqual (callback))
+      if (m_others[i].callback.IsEqual (callback))
         {
-          i = m_callbackList.erase (i);
+          m_others.erase (m_others.begin () + i);
         }
       else
         {
           i++;
         }
     }
+  if (!m_first.callback.IsNull () && m_first.callback.IsEqual (callback))
+    {
+      if (m_others.empty ())
+        {
+          m_first = Sink ();
+        }
+      else
+        {
+          m_first = m_others.front ();
+          m_others.erase (m_others.begin ());
+        }
+      m_removals++;
+    }
+  else if (m_others.size () != size)
+    {
+      m_removals++;
+    }
 }
 template<typename T1, typename T2, 
          typename T3, typename T4,
@@ -321,10 +514,14 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (void) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index rather than iterate: a sink may connect or disconnect sinks.
+  for (std::size_t i = 0; i <= m_others.size () && !m_first.callback.IsNull (); /* empty */)
     {
-      (*i)();
+      const Sink &sink = Get (i);
+      uint64_t id = sink.id;
+      uint64_t removals = m_removals;
+      sink.callback ();
+      i = m_removals == removals ? i + 1 : Next (id);
     }
 }
 template<typename T1, typename T2, 
@@ -334,10 +531,14 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index rather than iterate: a sink may connect or disconnect sinks.
+  for (std::size_t i = 0; i <= m_others.size () && !m_first.callback.IsNull (); /* empty */)
     {
-      (*i)(a1);
+      const Sink &sink = Get (i);
+      uint64_t id = sink.id;
+      uint64_t removals = m_removals;
+      sink.callback (a1);
+      i = m_removals == removals ? i + 1 : Next (id);
     }
 }
 template<typename T1, typename T2, 
@@ -347,10 +548,14 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index rather than iterate: a sink may connect or disconnect sinks.
+  for (std::size_t i = 0; i <= m_others.size () && !m_first.callback.IsNull (); /* empty */)
     {
-      (*i)(a1, a2);
+      const Sink &sink = Get (i);
+      uint64_t id = sink.id;
+      uint64_t removals = m_removals;
+      sink.callback (a1, a2);
+      i = m_removals == removals ? i + 1 : Next (id);
     }
 }
 template<typename T1, typename T2, 
@@ -360,10 +565,14 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index rather than iterate: a sink may connect or disconnect sinks.
+  for (std::size_t i = 0; i <= m_others.size () && !m_first.callback.IsNull (); /* empty */)
     {
-      (*i)(a1, a2, a3);
+      const Sink &sink = Get (i);
+      uint64_t id = sink.id;
+      uint64_t removals = m_removals;
+      sink.callback (a1, a2, a3);
+      i = m_removals == removals ? i + 1 : Next (id);
     }
 }
 template<typename T1, typename T2, 
@@ -373,10 +582,14 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index rather than iterate: a sink may connect or disconnect sinks.
+  for (std::size_t i = 0; i <= m_others.size () && !m_first.callback.IsNull (); /* empty */)
     {
-      (*i)(a1, a2, a3, a4);
+      const Sink &sink = Get (i);
+      uint64_t id = sink.id;
+      uint64_t removals = m_removals;
+      sink.callback (a1, a2, a3, a4);
+      i = m_removals == removals ? i + 1 : Next (id);
     }
 }
 template<typename T1, typename T2, 
@@ -386,10 +599,14 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index rather than iterate: a sink may connect or disconnect sinks.
+  for (std::size_t i = 0; i <= m_others.size () && !m_first.callback.IsNull (); /* empty */)
     {
-      (*i)(a1, a2, a3, a4, a5);
+      const Sink &sink = Get (i);
+      uint64_t id = sink.id;
+      uint64_t removals = m_removals;
+      sink.callback (a1, a2, a3, a4, a5);
+      i = m_removals == removals ? i + 1 : Next (id);
     }
 }
 template<typename T1, typename T2, 
@@ -399,10 +616,14 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index rather than iterate: a sink may connect or disconnect sinks.
+  for (std::size_t i = 0; i <= m_others.size () && !m_first.callback.IsNull (); /* empty */)
     {
-      (*i)(a1, a2, a3, a4, a5, a6);
+      const Sink &sink = Get (i);
+      uint64_t id = sink.id;
+      uint64_t removals = m_removals;
+      sink.callback (a1, a2, a3, a4, a5, a6);
+      i = m_removals == removals ? i + 1 : Next (id);
     }
 }
 template<typename T1, typename T2, 
@@ -412,10 +633,14 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index rather than iterate: a sink may connect or disconnect sinks.
+  for (std::size_t i = 0; i <= m_others.size () && !m_first.callback.IsNull (); /* empty */)
     {
-      (*i)(a1, a2, a3, a4, a5, a6, a7);
+      const Sink &sink = Get (i);
+      uint64_t id = sink.id;
+      uint64_t removals = m_removals;
+      sink.callback (a1, a2, a3, a4, a5, a6, a7);
+      i = m_removals == removals ? i + 1 : Next (id);
     }
 }
 template<typename T1, typename T2, 
@@ -425,10 +650,14 @@ template<typename T1, typename T2,
 void 
 TracedCallback<T1,T2,T3,T4,T5,T6,T7,T8>::operator() (T1 a1, T2 a2, T3 a3, T4 a4, T5 a5, T6 a6, T7 a7, T8 a8) const
 {
-  for (typename CallbackList::const_iterator i = m_callbackList.begin ();
-       i != m_callbackList.end (); i++)
+  // Index rather than iterate: a sink may connect or disconnect sinks.
+  for (std::size_t i = 0; i <= m_others.size () && !m_first.callback.IsNull (); /* empty */)
     {
-      (*i)(a1, a2, a3, a4, a5, a6, a7, a8);
+      const Sink &sink = Get (i);
+      uint64_t id = sink.id;
+      uint64_t removals = m_removals;
+      sink.callback (a1, a2, a3, a4, a5, a6, a7, a8);
+      i = m_removals == removals ? i + 1 : Next (id);
     }
 }
 
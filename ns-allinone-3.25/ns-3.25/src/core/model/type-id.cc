@@ -21,8 +21,10 @@
 #include "hash.h"
 #include "type-id.h"
 #include "singleton.h"
+#include "system-mutex.h"
 #include "trace-source-accessor.h"
 
+#include <algorithm>
 #include <map>
 #include <vector>
 #include <sstream>
@@ -53,6 +55,16 @@ NS_LOG_COMPONENT_DEFINE ("TypeId");
  * Information records are stored in a vector.  Name and hash lookup
  * are performed by maps to the vector index.
  *
+ * The Attributes and TraceSources of a type id and of all its parents
+ * are listed in a flattened table, indexed by name with an open
+ * addressing hash table, so that looking one up by name does not walk
+ * the inheritance tree.  A table is built once, by the first lookup
+ * after the type id and its parents are registered, under a lock
+ * which later lookups skip.  Adding an Attribute, a TraceSource or a
+ * parent to a type id marks the tables of the type id and of its
+ * subclasses stale, so registrations must not run concurrently with
+ * lookups.
+ *
  * \internal
  * <b>Hash Chaining</b>
  *
@@ -78,6 +90,8 @@ NS_LOG_COMPONENT_DEFINE ("TypeId");
 class IidManager : public Singleton<IidManager>
 {
 public:
+  /** Constructor. */
+  IidManager ();
   /**
    * Create a new unique type id.
    * \param [in] name The name of this type id.
@@ -182,6 +196,11 @@ public:
    * \returns The type id.
    */
   uint16_t GetRegistered (uint32_t i) const;
+  /**
+   * Get the generation of the database.
+   * \returns The number of registrations so far.
+   */
+  uint32_t GetGeneration (void) const;
   /**
    * Record a new attribute in a type id.
    * \param [in] uid The id.
@@ -225,6 +244,39 @@ public:
    * \returns The information associated to attribute whose index is \p i.
    */
   struct TypeId::AttributeInformation GetAttribute(uint16_t uid, uint32_t i) const;
+  /**
+   * Find an attribute of a type id or of its parents by name.
+   * \param [in] uid The id.
+   * \param [in] name The attribute name.
+   * \returns The information associated to the attribute,
+   *          or zero if there is no such attribute.
+   */
+  const struct TypeId::AttributeInformation *
+  LookupAttributeByName (uint16_t uid, std::string name) const;
+  /**
+   * Find a trace source of a type id or of its parents by name.
+   * \param [in] uid The id.
+   * \param [in] name The trace source name.
+   * \returns The information associated to the trace source,
+   *          or zero if there is no such trace source.
+   */
+  const struct TypeId::TraceSourceInformation *
+  LookupTraceSourceByName (uint16_t uid, std::string name) const;
+  /**
+   * Get the number of attributes of a type id and of all its parents.
+   * \param [in] uid The id.
+   * \returns The number of attributes declared or inherited by \p uid.
+   */
+  uint32_t GetInheritedAttributeN (uint16_t uid) const;
+  /**
+   * Get an attribute of a type id or of one of its parents.
+   * \param [in] uid The id.
+   * \param [in] i Index into the inherited attribute array.
+   * \param [out] owner The id which declares the attribute.
+   * \returns The information associated to the attribute.
+   */
+  const struct TypeId::AttributeInformation &
+  GetInheritedAttribute (uint16_t uid, uint32_t i, uint16_t *owner) const;
   /**
    * Record a new TraceSource.
    * \param [in] uid The id.
@@ -284,6 +336,39 @@ private:
    * \returns The hashed value of \p name.
    */
   static TypeId::hash_t Hasher (const std::string name);
+  /**
+   * Hashing function of the Attribute and TraceSource names, for the
+   * inherited tables.  Unlike Hasher, it keeps no state, so that the
+   * lookups can be made from several threads.
+   * \param [in] name The Attribute or TraceSource name.
+   * \returns The FNV-1a hash of \p name.
+   */
+  static TypeId::hash_t NameHasher (const std::string &name);
+
+  /** An Attribute or TraceSource of a type id or of one of its parents. */
+  struct InheritedItem {
+    /** The type id which declares the item. */
+    uint16_t uid;
+    /** The index of the item in the declaring type id. */
+    uint32_t index;
+    /** The hash of the item name. */
+    TypeId::hash_t hash;
+  };
+  /** The Attributes or TraceSources of a type id and of its parents. */
+  struct InheritedTable {
+    /**
+     * The items, in class order: those of the type id first, then
+     * those of its parent, and so on, including the items hidden by
+     * an item of the same name in a subclass.
+     */
+    std::vector<struct InheritedItem> items;
+    /**
+     * Open addressing hash table of the items which are not hidden:
+     * zero for an empty slot, otherwise one plus the index of an item.
+     * The size is a power of two.
+     */
+    std::vector<uint32_t> slots;
+  };
 
   /** The information record about a single type id. */
   struct IidInformation {
@@ -307,6 +392,14 @@ private:
     std::vector<struct TypeId::AttributeInformation> attributes;
     /** The container of TraceSources. */
     std::vector<struct TypeId::TraceSourceInformation> traceSources;
+    /** The type ids which have this type id as parent. */
+    std::vector<uint16_t> children;
+    /** The Attributes of this type id and of its parents. */
+    struct InheritedTable inheritedAttributes;
+    /** The TraceSources of this type id and of its parents. */
+    struct InheritedTable inheritedTraceSources;
+    /** \c true if the inherited tables are up to date. */
+    bool inheritedBuilt;
   };
   /** Iterator type. */
   typedef std::vector<struct IidInformation>::const_iterator Iterator;
@@ -317,6 +410,55 @@ private:
    * \returns The information record.
    */
   struct IidManager::IidInformation *LookupInformation (uint16_t uid) const;
+  /**
+   * Get the information record of a type id, with its inherited
+   * Attribute and TraceSource tables up to date.
+   * \param [in] uid The id.
+   * \returns The information record.
+   */
+  struct IidManager::IidInformation *LookupInherited (uint16_t uid) const;
+  /**
+   * Build the inherited Attribute and TraceSource tables of a type id,
+   * from its own items and the tables of its parent, unless they are
+   * up to date.  Called with m_inheritedMutex held.
+   * \param [in] uid The id.
+   */
+  void BuildInherited (uint16_t uid) const;
+  /**
+   * Mark the inherited tables of a type id and of its subclasses stale.
+   * \param [in] uid The id.
+   */
+  void InvalidateInherited (uint16_t uid);
+  /**
+   * Get the name of an inherited item.
+   * \param [in] item The item.
+   * \param [in] attribute \c true if the item is an Attribute,
+   *             \c false if it is a TraceSource.
+   * \returns The name of the item.
+   */
+  const std::string & GetInheritedName (const struct InheritedItem &item,
+                                        bool attribute) const;
+  /**
+   * Find an item of an inherited table by name.
+   * \param [in] table The table.
+   * \param [in] name The name of the item.
+   * \param [in] hash The hash of \p name.
+   * \param [in] attribute \c true if the table holds Attributes,
+   *             \c false if it holds TraceSources.
+   * \returns The item, or zero if there is no such item.
+   */
+  const struct InheritedItem * FindInherited (const struct InheritedTable &table,
+                                              std::string name,
+                                              TypeId::hash_t hash,
+                                              bool attribute) const;
+  /**
+   * Index the items of an inherited table by name.  An item hidden by
+   * an earlier item of the same name gets no slot.
+   * \param [in,out] table The table.
+   * \param [in] attribute \c true if the table holds Attributes,
+   *             \c false if it holds TraceSources.
+   */
+  void IndexInherited (struct InheritedTable &table, bool attribute) const;
 
   /** The container of all type id records. */
   std::vector<struct IidInformation> m_information;
@@ -331,6 +473,12 @@ private:
   /** The by-hash index. */
   hashmap_t m_hashmap;
 
+  /** Serializes the builds of the inherited tables. */
+  mutable SystemMutex m_inheritedMutex;
+
+  /** The number of type ids, parents, Attributes and TraceSources registered. */
+  uint32_t m_generation;
+
 
   enum {
     /**
@@ -344,6 +492,12 @@ private:
 };
 
 
+IidManager::IidManager ()
+  : m_generation (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
 //static
 TypeId::hash_t
 IidManager::Hasher (const std::string name)
@@ -351,6 +505,19 @@ IidManager::Hasher (const std::string name)
   static ns3::Hasher hasher ( Create<Hash::Function::Murmur3> () );
   return hasher.clear ().GetHash32 (name);
 }
+
+//static
+TypeId::hash_t
+IidManager::NameHasher (const std::string &name)
+{
+  TypeId::hash_t hash = 2166136261U;
+  for (std::string::size_type i = 0; i < name.size (); i++)
+    {
+      hash ^= static_cast<uint8_t> (name[i]);
+      hash *= 16777619U;
+    }
+  return hash;
+}
   
 uint16_t
 IidManager::AllocateUid (std::string name)
@@ -413,6 +580,7 @@ IidManager::AllocateUid (std::string name)
   information.size = (std::size_t)(-1);
   information.hasConstructor = false;
   information.mustHideFromDocumentation = false;
+  information.inheritedBuilt = false;
   m_information.push_back (information);
   uint32_t uid = m_information.size ();
   NS_ASSERT (uid <= 0xffff);
@@ -420,6 +588,7 @@ IidManager::AllocateUid (std::string name)
   // Add to both maps:
   m_namemap.insert (std::make_pair (name, uid));
   m_hashmap.insert (std::make_pair (hash, uid));
+  m_generation++;
   return uid;
 }
 
@@ -437,7 +606,18 @@ IidManager::SetParent (uint16_t uid, uint16_t parent)
   NS_LOG_FUNCTION (this << uid << parent);
   NS_ASSERT (parent <= m_information.size ());
   struct IidInformation *information = LookupInformation (uid);
+  if (information->parent != 0 && information->parent != uid)
+    {
+      std::vector<uint16_t> &children = LookupInformation (information->parent)->children;
+      children.erase (std::find (children.begin (), children.end (), uid));
+    }
   information->parent = parent;
+  if (parent != 0 && parent != uid)
+    {
+      LookupInformation (parent)->children.push_back (uid);
+    }
+  InvalidateInherited (uid);
+  m_generation++;
 }
 void 
 IidManager::SetGroupName (uint16_t uid, std::string groupName)
@@ -569,6 +749,11 @@ IidManager::GetRegistered (uint32_t i) const
   NS_LOG_FUNCTION (this << i);
   return i + 1;
 }
+uint32_t
+IidManager::GetGeneration (void) const
+{
+  return m_generation;
+}
 
 bool
 IidManager::HasAttribute (uint16_t uid,
@@ -623,6 +808,8 @@ IidManager::AddAttribute (uint16_t uid,
   info.accessor = accessor;
   info.checker = checker;
   information->attributes.push_back (info);
+  InvalidateInherited (uid);
+  m_generation++;
 }
 void 
 IidManager::SetAttributeInitialValue(uint16_t uid,
@@ -653,6 +840,175 @@ IidManager::GetAttribute(uint16_t uid, uint32_t i) const
   return information->attributes[i];
 }
 
+const std::string &
+IidManager::GetInheritedName (const struct InheritedItem &item, bool attribute) const
+{
+  struct IidInformation *information = LookupInformation (item.uid);
+  if (attribute)
+    {
+      return information->attributes[item.index].name;
+    }
+  return information->traceSources[item.index].name;
+}
+
+const struct IidManager::InheritedItem *
+IidManager::FindInherited (const struct InheritedTable &table, std::string name,
+                           TypeId::hash_t hash, bool attribute) const
+{
+  if (table.slots.empty ())
+    {
+      return 0;
+    }
+  uint32_t mask = table.slots.size () - 1;
+  for (uint32_t slot = hash & mask; table.slots[slot] != 0; slot = (slot + 1) & mask)
+    {
+      const struct InheritedItem *item = &table.items[table.slots[slot] - 1];
+      if (item->hash == hash && GetInheritedName (*item, attribute) == name)
+        {
+          return item;
+        }
+    }
+  return 0;
+}
+
+void
+IidManager::IndexInherited (struct InheritedTable &table, bool attribute) const
+{
+  // keep the load factor at or below one half
+  uint32_t size = 8;
+  while (size < table.items.size () * 2)
+    {
+      size *= 2;
+    }
+  table.slots.assign (size, 0);
+  for (uint32_t i = 0; i < table.items.size (); i++)
+    {
+      const struct InheritedItem &item = table.items[i];
+      if (FindInherited (table, GetInheritedName (item, attribute), item.hash, attribute) != 0)
+        {
+          // hidden by an item of the same name in a subclass
+          continue;
+        }
+      uint32_t slot = item.hash & (size - 1);
+      while (table.slots[slot] != 0)
+        {
+          slot = (slot + 1) & (size - 1);
+        }
+      table.slots[slot] = i + 1;
+    }
+}
+
+void
+IidManager::BuildInherited (uint16_t uid) const
+{
+  NS_LOG_FUNCTION (this << uid);
+  struct IidInformation *information = LookupInformation (uid);
+  if (information->inheritedBuilt)
+    {
+      return;
+    }
+  information->inheritedAttributes = InheritedTable ();
+  information->inheritedTraceSources = InheritedTable ();
+  struct InheritedItem item;
+  item.uid = uid;
+  for (item.index = 0; item.index < information->attributes.size (); item.index++)
+    {
+      item.hash = NameHasher (information->attributes[item.index].name);
+      information->inheritedAttributes.items.push_back (item);
+    }
+  for (item.index = 0; item.index < information->traceSources.size (); item.index++)
+    {
+      item.hash = NameHasher (information->traceSources[item.index].name);
+      information->inheritedTraceSources.items.push_back (item);
+    }
+  if (information->parent != 0 && information->parent != uid)
+    {
+      // the tables of the parent hold the items of all the ancestors.
+      BuildInherited (information->parent);
+      struct IidInformation *parent = LookupInformation (information->parent);
+      information->inheritedAttributes.items.insert (information->inheritedAttributes.items.end (),
+                                                     parent->inheritedAttributes.items.begin (),
+                                                     parent->inheritedAttributes.items.end ());
+      information->inheritedTraceSources.items.insert (information->inheritedTraceSources.items.end (),
+                                                       parent->inheritedTraceSources.items.begin (),
+                                                       parent->inheritedTraceSources.items.end ());
+    }
+  IndexInherited (information->inheritedAttributes, true);
+  IndexInherited (information->inheritedTraceSources, false);
+  // Publish the tables to the lookups which skip the lock.
+  __atomic_store_n (&information->inheritedBuilt, true, __ATOMIC_RELEASE);
+}
+
+struct IidManager::IidInformation *
+IidManager::LookupInherited (uint16_t uid) const
+{
+  struct IidInformation *information = LookupInformation (uid);
+  if (!__atomic_load_n (&information->inheritedBuilt, __ATOMIC_ACQUIRE))
+    {
+      CriticalSection cs (m_inheritedMutex);
+      BuildInherited (uid);
+    }
+  return information;
+}
+
+void
+IidManager::InvalidateInherited (uint16_t uid)
+{
+  NS_LOG_FUNCTION (this << uid);
+  struct IidInformation *information = LookupInformation (uid);
+  information->inheritedBuilt = false;
+  for (uint32_t i = 0; i < information->children.size (); i++)
+    {
+      InvalidateInherited (information->children[i]);
+    }
+}
+
+const struct TypeId::AttributeInformation *
+IidManager::LookupAttributeByName (uint16_t uid, std::string name) const
+{
+  NS_LOG_FUNCTION (this << uid << name);
+  struct IidInformation *information = LookupInherited (uid);
+  const struct InheritedItem *item =
+    FindInherited (information->inheritedAttributes, name, NameHasher (name), true);
+  if (item == 0)
+    {
+      return 0;
+    }
+  return &LookupInformation (item->uid)->attributes[item->index];
+}
+
+const struct TypeId::TraceSourceInformation *
+IidManager::LookupTraceSourceByName (uint16_t uid, std::string name) const
+{
+  NS_LOG_FUNCTION (this << uid << name);
+  struct IidInformation *information = LookupInherited (uid);
+  const struct InheritedItem *item =
+    FindInherited (information->inheritedTraceSources, name, NameHasher (name), false);
+  if (item == 0)
+    {
+      return 0;
+    }
+  return &LookupInformation (item->uid)->traceSources[item->index];
+}
+
+uint32_t
+IidManager::GetInheritedAttributeN (uint16_t uid) const
+{
+  NS_LOG_FUNCTION (this << uid);
+  return LookupInherited (uid)->inheritedAttributes.items.size ();
+}
+
+const struct TypeId::AttributeInformation &
+IidManager::GetInheritedAttribute (uint16_t uid, uint32_t i, uint16_t *owner) const
+{
+  NS_LOG_FUNCTION (this << uid << i << owner);
+  struct IidInformation *information = LookupInherited (uid);
+  NS_ASSERT (i < information->inheritedAttributes.items.size ());
+  const struct InheritedItem &item = information->inheritedAttributes.items[i];
+  *owner = item.uid;
+  return LookupInformation (item.uid)->attributes[item.index];
+}
+
 bool
 IidManager::HasTraceSource (uint16_t uid,
                             std::string name)
@@ -701,6 +1057,8 @@ IidManager::AddTraceSource (uint16_t uid,
   source.accessor = accessor;
   source.callback = callback;
   information->traceSources.push_back (source);
+  InvalidateInherited (uid);
+  m_generation++;
 }
 uint32_t 
 IidManager::GetTraceSourceN (uint16_t uid) const
@@ -799,27 +1157,24 @@ TypeId::GetRegistered (uint32_t i)
   NS_LOG_FUNCTION (i);
   return TypeId (IidManager::Get ()->GetRegistered (i));
 }
+uint32_t
+TypeId::GetGeneration (void)
+{
+  return IidManager::Get ()->GetGeneration ();
+}
 
 bool
 TypeId::LookupAttributeByName (std::string name, struct TypeId::AttributeInformation *info) const
 {
   NS_LOG_FUNCTION (this << name << info);
-  TypeId tid;
-  TypeId nextTid = *this;
-  do {
-      tid = nextTid;
-      for (uint32_t i = 0; i < tid.GetAttributeN (); i++)
-        {
-          struct TypeId::AttributeInformation tmp = tid.GetAttribute(i);
-          if (tmp.name == name)
-            {
-              *info = tmp;
-              return true;
-            }
-        }
-      nextTid = tid.GetParent ();
-    } while (nextTid != tid);
-  return false;
+  const struct TypeId::AttributeInformation *found =
+    IidManager::Get ()->LookupAttributeByName (m_tid, name);
+  if (found == 0)
+    {
+      return false;
+    }
+  *info = *found;
+  return true;
 }
 
 TypeId 
@@ -977,6 +1332,18 @@ TypeId::GetAttribute(uint32_t i) const
   NS_LOG_FUNCTION (this << i);
   return IidManager::Get ()->GetAttribute(m_tid, i);
 }
+uint32_t
+TypeId::GetInheritedAttributeN (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return IidManager::Get ()->GetInheritedAttributeN (m_tid);
+}
+const struct TypeId::AttributeInformation &
+TypeId::GetInheritedAttribute (uint32_t i, TypeId *owner) const
+{
+  NS_LOG_FUNCTION (this << i << owner);
+  return IidManager::Get ()->GetInheritedAttribute (m_tid, i, &owner->m_tid);
+}
 std::string 
 TypeId::GetAttributeFullName (uint32_t i) const
 {
@@ -1030,21 +1397,13 @@ Ptr<const TraceSourceAccessor>
 TypeId::LookupTraceSourceByName (std::string name) const
 {
   NS_LOG_FUNCTION (this << name);
-  TypeId tid;
-  TypeId nextTid = *this;
-  do {
-      tid = nextTid;
-      for (uint32_t i = 0; i < tid.GetTraceSourceN (); i++)
-        {
-          struct TypeId::TraceSourceInformation info = tid.GetTraceSource (i);
-          if (info.name == name)
-            {
-              return info.accessor;
-            }
-        }
-      nextTid = tid.GetParent ();
-    } while (nextTid != tid);
-  return 0;
+  const struct TypeId::TraceSourceInformation *info =
+    IidManager::Get ()->LookupTraceSourceByName (m_tid, name);
+  if (info == 0)
+    {
+      return 0;
+    }
+  return info->accessor;
 }
 
 uint16_t 
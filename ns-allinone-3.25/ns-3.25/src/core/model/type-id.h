@@ -149,6 +149,16 @@ public:
    * \returns The TypeId instance whose index is \c i.
    */
   static TypeId GetRegistered (uint32_t i);
+  /**
+   * Get the generation of the TypeId database.
+   *
+   * The generation changes whenever a TypeId, a parent, an Attribute
+   * or a TraceSource is registered, so that the results derived from
+   * the database can be cached until then.
+   *
+   * \returns The generation of the TypeId database.
+   */
+  static uint32_t GetGeneration (void);
 
   /**
    * Constructor.
@@ -240,6 +250,27 @@ public:
    * \returns The information associated to attribute whose index is \p i.
    */
   struct TypeId::AttributeInformation GetAttribute(uint32_t i) const;
+  /**
+   * Get the number of attributes of this TypeId and of all its parents.
+   *
+   * \returns The number of attributes declared or inherited by this TypeId
+   */
+  uint32_t GetInheritedAttributeN (void) const;
+  /**
+   * Get an attribute of this TypeId or of one of its parents.
+   *
+   * The attributes are numbered in class order: those of this
+   * TypeId first, then those of its parent, and so on.  An attribute
+   * which is hidden by an attribute of the same name in a subclass
+   * is listed too, after it.
+   *
+   * \param [in] i Index into the inherited attribute array
+   * \param [out] owner The TypeId which declares the attribute.
+   * \returns The information associated to the attribute.  The
+   *          reference is only valid until the next TypeId, Attribute
+   *          or TraceSource is registered.
+   */
+  const struct TypeId::AttributeInformation & GetInheritedAttribute (uint32_t i, TypeId *owner) const;
   /**
    * Get the Attribute name by index.
    *
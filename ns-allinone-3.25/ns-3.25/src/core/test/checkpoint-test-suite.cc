@@ -0,0 +1,180 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/checkpoint.h"
+#include "ns3/double.h"
+#include "ns3/integer.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/simulator.h"
+#include <fstream>
+#include <unistd.h>
+
+using namespace ns3;
+
+class CheckpointRestoreTestCase : public TestCase
+{
+public:
+  CheckpointRestoreTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+CheckpointRestoreTestCase::CheckpointRestoreTestCase ()
+  : TestCase ("Check that restored random variables repeat their values")
+{
+}
+
+void
+CheckpointRestoreTestCase::DoRun (void)
+{
+  Ptr<RandomVariableStream> rv[3];
+  rv[0] = CreateObject<UniformRandomVariable> ();
+  rv[1] = CreateObject<ExponentialRandomVariable> ();
+  rv[2] = CreateObject<UniformRandomVariable> ();
+  rv[2]->SetStream (5);
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      rv[i]->GetValue ();
+    }
+
+  std::string filename = CreateTempDirFilename ("checkpoint");
+  Checkpoint::Save (filename);
+  double values[3][10];
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      rv[i]->GetValues (values[i], 10);
+    }
+
+  Checkpoint::Restore (filename);
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      for (uint32_t j = 0; j < 10; j++)
+        {
+          double value = rv[i]->GetValue ();
+          NS_TEST_ASSERT_MSG_EQ (value, values[i][j], "Random variable " << i << " not restored");
+        }
+    }
+  unlink (filename.c_str ());
+}
+
+class CheckpointResetTestCase : public TestCase
+{
+public:
+  CheckpointResetTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+CheckpointResetTestCase::CheckpointResetTestCase ()
+  : TestCase ("Check that reset random variables use the new run number")
+{
+}
+
+void
+CheckpointResetTestCase::DoRun (void)
+{
+  uint64_t run = RngSeedManager::GetRun ();
+  Ptr<UniformRandomVariable> a = CreateObject<UniformRandomVariable> ();
+  a->SetStream (3);
+  a->GetValue ();
+
+  RngSeedManager::SetRun (run + 6);
+  RandomVariableStream::ResetAllStreams ();
+  Ptr<UniformRandomVariable> b = CreateObject<UniformRandomVariable> ();
+  b->SetStream (3);
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      double value = a->GetValue ();
+      NS_TEST_ASSERT_MSG_EQ (value, b->GetValue (), "Reset stream does not use the new run");
+    }
+  RngSeedManager::SetRun (run);
+}
+
+class CheckpointForkTestCase : public TestCase
+{
+public:
+  CheckpointForkTestCase ();
+private:
+  virtual void DoRun (void);
+  /** Draw a value from the random variable. */
+  void Draw (void);
+
+  Ptr<UniformRandomVariable> m_rv;   //!< The random variable.
+  double m_value;                    //!< The last value drawn.
+};
+
+CheckpointForkTestCase::CheckpointForkTestCase ()
+  : TestCase ("Check that a forked simulation continues from the checkpoint")
+{
+}
+
+void
+CheckpointForkTestCase::Draw (void)
+{
+  m_value = m_rv->GetValue ();
+}
+
+void
+CheckpointForkTestCase::DoRun (void)
+{
+  m_rv = CreateObject<UniformRandomVariable> ();
+  m_value = 0;
+  Simulator::Schedule (Seconds (1), &CheckpointForkTestCase::Draw, this);
+  Simulator::Schedule (Seconds (3), &CheckpointForkTestCase::Draw, this);
+  Simulator::Stop (Seconds (2));
+  Simulator::Run ();
+
+  // The copy runs the rest of the simulation and writes its result.
+  std::string filename = CreateTempDirFilename ("checkpoint-fork");
+  if (Checkpoint::Fork ())
+    {
+      Simulator::Run ();
+      std::ofstream os (filename.c_str ());
+      os.precision (17);
+      os << Simulator::Now ().GetSeconds () << " " << m_value << std::endl;
+      os.close ();
+      _exit (0);
+    }
+
+  Simulator::Run ();
+  double now = Simulator::Now ().GetSeconds ();
+  Simulator::Destroy ();
+  std::ifstream is (filename.c_str ());
+  double forkedNow = 0;
+  double forkedValue = -1;
+  is >> forkedNow >> forkedValue;
+  NS_TEST_ASSERT_MSG_EQ (forkedNow, now, "The forked simulation did not run the pending events");
+  NS_TEST_ASSERT_MSG_EQ (forkedValue, m_value, "The forked simulation drew a different value");
+  unlink (filename.c_str ());
+}
+
+class CheckpointTestSuite : public TestSuite
+{
+public:
+  CheckpointTestSuite ();
+};
+
+CheckpointTestSuite::CheckpointTestSuite ()
+  : TestSuite ("checkpoint", UNIT)
+{
+  AddTestCase (new CheckpointRestoreTestCase, TestCase::QUICK);
+  AddTestCase (new CheckpointResetTestCase, TestCase::QUICK);
+  AddTestCase (new CheckpointForkTestCase, TestCase::QUICK);
+}
+
+static CheckpointTestSuite checkpointTestSuite;
@@ -49,6 +49,7 @@ public:
 
   void SetNodeA (Ptr<ConfigTestObject> a);
   void SetNodeB (Ptr<ConfigTestObject> b);
+  Ptr<ConfigTestObject> GetNodeB (void) const;
 
   int8_t GetA (void) const;
   int8_t GetB (void) const;
@@ -115,6 +116,12 @@ ConfigTestObject::SetNodeB (Ptr<ConfigTestObject> b)
   m_nodeB = b;
 }
 
+Ptr<ConfigTestObject>
+ConfigTestObject::GetNodeB (void) const
+{
+  return m_nodeB;
+}
+
 void 
 ConfigTestObject::AddNodeA (Ptr<ConfigTestObject> a)
 {
@@ -721,6 +728,148 @@ SearchAttributesOfParentObjectsTestCase::DoRun (void)
 
 }
 
+// ===========================================================================
+// Test for the ability to connect a batch of paths in a single pass.
+// ===========================================================================
+class ConnectManyConfigTestCase : public TestCase
+{
+public:
+  ConnectManyConfigTestCase ();
+  virtual ~ConnectManyConfigTestCase () {}
+
+  void TraceA (std::string path, int16_t old, int16_t newValue) { m_pathsA.push_back (path); }
+  void TraceB (std::string path, int16_t old, int16_t newValue) { m_pathsB.push_back (path); }
+
+private:
+  virtual void DoRun (void);
+
+  std::vector<std::string> m_pathsA;
+  std::vector<std::string> m_pathsB;
+};
+
+ConnectManyConfigTestCase::ConnectManyConfigTestCase ()
+  : TestCase ("Check ability to trace connect a list of paths sharing their prefix")
+{
+}
+
+void
+ConnectManyConfigTestCase::DoRun (void)
+{
+  //
+  // A named object, so that the root namespace objects left by the other
+  // tests do not match the paths, with four objects in each of its
+  // ObjectVector Attributes.
+  //
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Names::Add ("ConnectManyRoot", root);
+  std::vector<Ptr<ConfigTestObject> > nodesA;
+  std::vector<Ptr<ConfigTestObject> > nodesB;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      nodesA.push_back (CreateObject<ConfigTestObject> ());
+      root->AddNodeA (nodesA.back ());
+      nodesB.push_back (CreateObject<ConfigTestObject> ());
+      root->AddNodeB (nodesB.back ());
+    }
+
+  std::vector<std::string> paths;
+  std::vector<CallbackBase> cbs;
+  paths.push_back ("/Names/ConnectManyRoot/NodesB/[0-1]|3/Source");
+  cbs.push_back (MakeCallback (&ConnectManyConfigTestCase::TraceB, this));
+  paths.push_back ("/Names/ConnectManyRoot/NodesA/2/Source");
+  cbs.push_back (MakeCallback (&ConnectManyConfigTestCase::TraceA, this));
+  paths.push_back ("/Names/ConnectManyRoot/NodesA/*/Source");
+  cbs.push_back (MakeCallback (&ConnectManyConfigTestCase::TraceA, this));
+  paths.push_back ("/Names/ConnectManyRoot/NodesA/[4-7]/Source");
+  cbs.push_back (MakeCallback (&ConnectManyConfigTestCase::TraceB, this));
+  Config::ConnectMany (paths, cbs);
+
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      nodesA[i]->SetAttribute ("Source", IntegerValue (-2));
+      nodesB[i]->SetAttribute ("Source", IntegerValue (-2));
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (m_pathsA.size (), 5, "Unexpected number of NodesA traces");
+  NS_TEST_EXPECT_MSG_EQ (m_pathsA[0], "/Names/ConnectManyRoot/NodesA/0/Source", "Unexpected context");
+  NS_TEST_EXPECT_MSG_EQ (m_pathsA[1], "/Names/ConnectManyRoot/NodesA/1/Source", "Unexpected context");
+  NS_TEST_EXPECT_MSG_EQ (m_pathsA[2], "/Names/ConnectManyRoot/NodesA/2/Source", "Unexpected context");
+  NS_TEST_EXPECT_MSG_EQ (m_pathsA[3], "/Names/ConnectManyRoot/NodesA/2/Source", "Unexpected context");
+  NS_TEST_EXPECT_MSG_EQ (m_pathsA[4], "/Names/ConnectManyRoot/NodesA/3/Source", "Unexpected context");
+  NS_TEST_ASSERT_MSG_EQ (m_pathsB.size (), 3, "Unexpected number of NodesB traces");
+  NS_TEST_EXPECT_MSG_EQ (m_pathsB[0], "/Names/ConnectManyRoot/NodesB/0/Source", "Unexpected context");
+  NS_TEST_EXPECT_MSG_EQ (m_pathsB[1], "/Names/ConnectManyRoot/NodesB/1/Source", "Unexpected context");
+  NS_TEST_EXPECT_MSG_EQ (m_pathsB[2], "/Names/ConnectManyRoot/NodesB/3/Source", "Unexpected context");
+
+  //
+  // The matches of a batch are the matches of each path looked up alone.
+  //
+  uint32_t expected[4] = { 3, 1, 4, 0 };
+  for (uint32_t i = 0; i < paths.size (); i++)
+    {
+      std::string root = paths[i].substr (0, paths[i].find_last_of ("/"));
+      Config::MatchContainer single = Config::LookupMatches (root);
+      NS_TEST_EXPECT_MSG_EQ (single.GetN (), expected[i],
+                             "Unexpected number of matches for " << root);
+    }
+
+  Names::Clear ();
+}
+
+// ===========================================================================
+// Test that paths resolved before an Attribute is registered see it
+// afterwards, even though the Resolver caches its lookups across calls.
+// ===========================================================================
+class LateAttributeConfigTestCase : public TestCase
+{
+public:
+  LateAttributeConfigTestCase ();
+  virtual ~LateAttributeConfigTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+};
+
+LateAttributeConfigTestCase::LateAttributeConfigTestCase ()
+  : TestCase ("Check that cached paths see attributes registered after they were resolved")
+{
+}
+
+void
+LateAttributeConfigTestCase::DoRun (void)
+{
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Names::Add ("LateAttributeRoot", root);
+  root->SetNodeB (CreateObject<ConfigTestObject> ());
+
+  //
+  // Resolve the same path twice, so that the miss is cached.
+  //
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Config::MatchContainer matches = Config::LookupMatches ("/Names/LateAttributeRoot/LateNodeB");
+      NS_TEST_EXPECT_MSG_EQ (matches.GetN (), 0, "Unexpected match before the attribute exists");
+    }
+
+  //
+  // Register another name for NodeB, then resolve the path again.
+  //
+  TypeId tid = ConfigTestObject::GetTypeId ();
+  tid.AddAttribute ("LateNodeB", "",
+                    PointerValue (),
+                    MakePointerAccessor (&ConfigTestObject::SetNodeB,
+                                         &ConfigTestObject::GetNodeB),
+                    MakePointerChecker<ConfigTestObject> ());
+  Config::MatchContainer matches = Config::LookupMatches ("/Names/LateAttributeRoot/LateNodeB");
+  Names::Clear ();
+  NS_TEST_ASSERT_MSG_EQ (matches.GetN (), 1, "Attribute registered late not found");
+  if (matches.GetN () == 1)
+    {
+      NS_TEST_EXPECT_MSG_EQ (matches.Get (0), root->GetNodeB (), "Unexpected object");
+    }
+}
+
 // ===========================================================================
 // The Test Suite that glues all of the Test Cases together.
 // ===========================================================================
@@ -737,6 +886,8 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new UnderRootNamespaceConfigTestCase, TestCase::QUICK);
   AddTestCase (new ObjectVectorConfigTestCase, TestCase::QUICK);
   AddTestCase (new SearchAttributesOfParentObjectsTestCase, TestCase::QUICK);
+  AddTestCase (new ConnectManyConfigTestCase, TestCase::QUICK);
+  AddTestCase (new LateAttributeConfigTestCase, TestCase::QUICK);
 }
 
 static ConfigTestSuite configTestSuite;
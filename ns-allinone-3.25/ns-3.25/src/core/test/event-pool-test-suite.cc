@@ -0,0 +1,177 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/event-impl.h"
+#include "ns3/make-event.h"
+#include "ns3/system-thread.h"
+#include "ns3/callback.h"
+#include "ns3/valgrind.h"
+
+#include <vector>
+
+using namespace ns3;
+
+namespace {
+
+/** The number of events allocated at once by the test threads. */
+const uint32_t EVENT_POOL_BATCH = 1000;
+
+/** An event function. */
+void
+NoOp (void)
+{
+}
+
+} // unnamed namespace
+
+/**
+ * \brief Check that events released by another thread go back to the
+ * pool of the thread which allocated them, and that the pool of a
+ * thread is released when the thread and its events are gone.
+ */
+class EventPoolThreadsTestCase : public TestCase
+{
+public:
+  EventPoolThreadsTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /** Allocate a batch of events, released by another thread, in rounds. */
+  void Producer (void);
+  /** Allocate a batch of events, and leave them in use. */
+  void Allocate (void);
+  /** Allocate a batch of events, and release them. */
+  void AllocateAndRelease (void);
+  /** Release the events. */
+  void Release (void);
+  /**
+   * Run a function in a new thread, and wait for the thread to exit.
+   *
+   * \param [in] f The function.
+   */
+  void RunThread (void (EventPoolThreadsTestCase::*f)(void));
+
+  std::vector<EventImpl *> m_events; //!< Events in use
+  uint64_t m_firstMisses;            //!< Misses of the producer after its first round
+  uint64_t m_lastMisses;             //!< Misses of the producer after its last round
+  uint64_t m_firstSlabs;             //!< Slabs after the first round of the producer
+  uint64_t m_lastSlabs;              //!< Slabs after the last round of the producer
+};
+
+EventPoolThreadsTestCase::EventPoolThreadsTestCase ()
+  : TestCase ("Check that the event pool reclaims blocks released by other threads")
+{
+}
+
+void
+EventPoolThreadsTestCase::Allocate (void)
+{
+  for (uint32_t i = 0; i < EVENT_POOL_BATCH; i++)
+    {
+      m_events.push_back (MakeEvent (&NoOp));
+    }
+}
+
+void
+EventPoolThreadsTestCase::Release (void)
+{
+  for (uint32_t i = 0; i < m_events.size (); i++)
+    {
+      m_events[i]->Unref ();
+    }
+  m_events.clear ();
+}
+
+void
+EventPoolThreadsTestCase::AllocateAndRelease (void)
+{
+  Allocate ();
+  Release ();
+}
+
+void
+EventPoolThreadsTestCase::RunThread (void (EventPoolThreadsTestCase::*f)(void))
+{
+  Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (f, this));
+  thread->Start ();
+  thread->Join ();
+}
+
+void
+EventPoolThreadsTestCase::Producer (void)
+{
+  for (uint32_t round = 0; round < 20; round++)
+    {
+      Allocate ();
+      RunThread (&EventPoolThreadsTestCase::Release);
+      if (round == 0)
+        {
+          m_firstMisses = EventImpl::GetPoolMisses ();
+          m_firstSlabs = EventImpl::GetPoolSlabs ();
+        }
+    }
+  m_lastMisses = EventImpl::GetPoolMisses ();
+  m_lastSlabs = EventImpl::GetPoolSlabs ();
+}
+
+void
+EventPoolThreadsTestCase::DoRun (void)
+{
+  if (RUNNING_ON_VALGRIND)
+    {
+      // The event pool is disabled under valgrind.
+      return;
+    }
+  uint64_t slabs = EventImpl::GetPoolSlabs ();
+
+  RunThread (&EventPoolThreadsTestCase::Producer);
+  NS_TEST_EXPECT_MSG_GT (m_firstMisses, 0, "The producer did not allocate from slabs");
+  NS_TEST_EXPECT_MSG_EQ (m_lastMisses, m_firstMisses,
+                         "The producer did not reuse the events released by another thread");
+  NS_TEST_EXPECT_MSG_EQ (m_lastSlabs, m_firstSlabs, "The producer kept carving slabs");
+  NS_TEST_EXPECT_MSG_EQ (EventImpl::GetPoolSlabs (), slabs,
+                         "The slabs of the producer were not released when it exited");
+
+  RunThread (&EventPoolThreadsTestCase::AllocateAndRelease);
+  NS_TEST_EXPECT_MSG_EQ (EventImpl::GetPoolSlabs (), slabs,
+                         "The slabs of a thread were not released when it exited");
+
+  RunThread (&EventPoolThreadsTestCase::Allocate);
+  NS_TEST_EXPECT_MSG_GT (EventImpl::GetPoolSlabs (), slabs,
+                         "The slabs of events still in use were released");
+  Release ();
+  NS_TEST_EXPECT_MSG_EQ (EventImpl::GetPoolSlabs (), slabs,
+                         "The slabs of an exited thread were not released with its last event");
+}
+
+/**
+ * \brief TestSuite for the event pool.
+ */
+class EventPoolTestSuite : public TestSuite
+{
+public:
+  EventPoolTestSuite ();
+};
+
+EventPoolTestSuite::EventPoolTestSuite ()
+  : TestSuite ("event-pool", UNIT)
+{
+  AddTestCase (new EventPoolThreadsTestCase (), TestCase::QUICK);
+}
+
+static EventPoolTestSuite g_eventPoolTestSuite; //!< The testsuite
@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/event-profiler.h"
+#include "ns3/event-impl.h"
+#include "ns3/make-event.h"
+#include "ns3/nstime.h"
+#include <sstream>
+
+using namespace ns3;
+
+class EventProfilerTestCase : public TestCase
+{
+public:
+  EventProfilerTestCase ();
+private:
+  virtual void DoRun (void);
+  /** An event without argument. */
+  void Tick (void);
+  /**
+   * An event with an argument.
+   *
+   * \param [in] n The argument.
+   */
+  void Add (uint32_t n);
+  /**
+   * Invoke an event through the profiler.
+   *
+   * \param [in] profiler The profiler.
+   * \param [in] event The event.
+   * \param [in] ts The time of the event.
+   * \param [in] context The context of the event.
+   */
+  void Invoke (EventProfiler &profiler, EventImpl *event, uint64_t ts, uint32_t context);
+
+  uint32_t m_ticks;  //!< The number of Tick events.
+  uint32_t m_sum;    //!< The sum of the arguments of the Add events.
+};
+
+EventProfilerTestCase::EventProfilerTestCase ()
+  : TestCase ("Check the counts and reports of the event profiler")
+{
+}
+
+void
+EventProfilerTestCase::Tick (void)
+{
+  m_ticks++;
+}
+
+void
+EventProfilerTestCase::Add (uint32_t n)
+{
+  m_sum += n;
+}
+
+void
+EventProfilerTestCase::Invoke (EventProfiler &profiler, EventImpl *event, uint64_t ts, uint32_t context)
+{
+  profiler.Invoke (event, ts, context, 3);
+  event->Unref ();
+}
+
+void
+EventProfilerTestCase::DoRun (void)
+{
+  m_ticks = 0;
+  m_sum = 0;
+  uint64_t second = Seconds (1).GetTimeStep ();
+  std::ostringstream periodic;
+  EventProfiler profiler (0);
+  profiler.SetSamplingPeriod (2);
+  profiler.SetInterval (&periodic, 10 * second);
+
+  EventImpl *tick = MakeEvent (&EventProfilerTestCase::Tick, this);
+  const std::type_info &tickType = typeid (*tick);
+  Invoke (profiler, tick, 0, 1);
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      Invoke (profiler, MakeEvent (&EventProfilerTestCase::Add, this, i), i * second, 2);
+      Invoke (profiler, MakeEvent (&EventProfilerTestCase::Tick, this), i * second, 0xffffffff);
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_ticks, 6, "Events not invoked");
+  NS_TEST_ASSERT_MSG_EQ (m_sum, 10, "Events not invoked");
+  NS_TEST_ASSERT_MSG_EQ (profiler.GetEvents (), 11, "Wrong number of events");
+  NS_TEST_ASSERT_MSG_EQ (profiler.GetEvents (tickType), 6, "Wrong number of events of a kind");
+  NS_TEST_ASSERT_MSG_EQ (profiler.GetContextEvents (2), 5, "Wrong number of events of a context");
+  NS_TEST_ASSERT_MSG_EQ (profiler.GetContextEvents (0xffffffff), 5, "Wrong number of events of a context");
+  NS_TEST_ASSERT_MSG_EQ (periodic.str (), "", "Report before the end of the interval");
+
+  std::string name = EventProfiler::GetName (tickType);
+  NS_TEST_ASSERT_MSG_NE (name.find ("EventProfilerTestCase::*"), std::string::npos,
+                         "The name " << name << " does not show the method");
+  NS_TEST_ASSERT_MSG_EQ (name.find ("MakeEvent"), std::string::npos,
+                         "The name " << name << " was not shortened");
+  std::ostringstream report;
+  profiler.Print (report, 5 * second);
+  NS_TEST_ASSERT_MSG_NE (report.str ().find (name), std::string::npos, "Kind missing from the report");
+  NS_TEST_ASSERT_MSG_NE (report.str ().find ("none"), std::string::npos, "Context missing from the report");
+
+  // The first event after the end of the interval prints the report,
+  // and starts a new interval.
+  Invoke (profiler, MakeEvent (&EventProfilerTestCase::Tick, this), 12 * second, 2);
+  NS_TEST_ASSERT_MSG_NE (periodic.str ().find ("11 events"), std::string::npos, "Missing periodic report");
+  NS_TEST_ASSERT_MSG_EQ (profiler.GetEvents (), 1, "The interval was not reset");
+  NS_TEST_ASSERT_MSG_EQ (profiler.GetContextEvents (0xffffffff), 0, "The interval was not reset");
+}
+
+class EventProfilerTestSuite : public TestSuite
+{
+public:
+  EventProfilerTestSuite ();
+};
+
+EventProfilerTestSuite::EventProfilerTestSuite ()
+  : TestSuite ("event-profiler", UNIT)
+{
+  AddTestCase (new EventProfilerTestCase, TestCase::QUICK);
+}
+
+static EventProfilerTestSuite g_eventProfilerTestSuite;
@@ -0,0 +1,268 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include <cstdio>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("LogTestSuite");
+
+// Compile out the LOG_LOGIC messages of this file.
+#undef NS_LOG_COMPONENT_LEVEL_CAP
+#define NS_LOG_COMPONENT_LEVEL_CAP ns3::LOG_LEVEL_FUNCTION
+
+class LogBinarySinkTestCase : public TestCase
+{
+public:
+  LogBinarySinkTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Log a message during a simulation.
+   *
+   * \param [in] n A parameter to log.
+   */
+  void Event (uint32_t n);
+};
+
+LogBinarySinkTestCase::LogBinarySinkTestCase ()
+  : TestCase ("Check that the binary sink keeps the last messages")
+{
+}
+
+void
+LogBinarySinkTestCase::Event (uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+}
+
+void
+LogBinarySinkTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("log");
+  LogComponentEnable ("LogTestSuite", LogLevel (LOG_LEVEL_FUNCTION | LOG_PREFIX_ALL));
+  LogSetBinarySink (filename, 4);
+  for (uint32_t i = 0; i < 6; i++)
+    {
+      NS_LOG_INFO ("message " << i);
+    }
+  NS_LOG_WARN (std::string (500, 'x'));
+  Simulator::ScheduleWithContext (3, Seconds (1.5), &LogBinarySinkTestCase::Event, this, 42);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  LogCloseBinarySink ();
+  LogComponentDisable ("LogTestSuite", LogLevel (LOG_LEVEL_ALL | LOG_PREFIX_ALL));
+  NS_LOG_INFO ("not logged");
+
+  std::ostringstream decoded;
+  LogDecodeBinarySink (filename, decoded);
+  std::remove (filename.c_str ());
+#ifdef NS3_LOG_ENABLE
+  std::string s = decoded.str ();
+  NS_TEST_ASSERT_MSG_NE (s.find ("# 4 older messages"), std::string::npos, "Overwritten messages not reported");
+  NS_TEST_ASSERT_MSG_EQ (s.find ("message 3"), std::string::npos, "Old message not overwritten");
+  NS_TEST_ASSERT_MSG_NE (s.find ("LogTestSuite:DoRun(): [INFO ] message 4\n"), std::string::npos, "Missing message");
+  NS_TEST_ASSERT_MSG_LT (s.find ("message 4"), s.find ("message 5"), "Messages out of order");
+  NS_TEST_ASSERT_MSG_NE (s.find ("[WARN ] " + std::string (167, 'x') + "\n"), std::string::npos,
+                         "Long message not truncated");
+  NS_TEST_ASSERT_MSG_NE (s.find ("1.5s 3 LogTestSuite:Event("), std::string::npos,
+                         "Missing time and context");
+  NS_TEST_ASSERT_MSG_NE (s.find (", 42)\n"), std::string::npos, "Missing parameters");
+  NS_TEST_ASSERT_MSG_EQ (s.find ("not logged"), std::string::npos, "Logged after the sink was closed");
+#else
+  NS_TEST_ASSERT_MSG_EQ (decoded.str (), "", "Logged with logging compiled out");
+#endif
+}
+
+class LogBinaryFormatTestCase : public TestCase
+{
+public:
+  LogBinaryFormatTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Log messages during a simulation.
+   *
+   * \param [in] n A parameter to log.
+   */
+  void Event (uint32_t n);
+};
+
+LogBinaryFormatTestCase::LogBinaryFormatTestCase ()
+  : TestCase ("Check that the binary sink decodes to the std::clog messages")
+{
+}
+
+void
+LogBinaryFormatTestCase::Event (uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  NS_LOG_INFO ("event " << n);
+  NS_LOG_WARN ("warning");
+}
+
+void
+LogBinaryFormatTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("log");
+  // All the prefixes but the level.
+  LogComponentEnable ("LogTestSuite", LogLevel (LOG_LEVEL_FUNCTION | LOG_PREFIX_TIME
+                                                | LOG_PREFIX_NODE | LOG_PREFIX_FUNC));
+
+  std::ostringstream written;
+  std::streambuf *clog = std::clog.rdbuf (written.rdbuf ());
+  Simulator::ScheduleWithContext (3, Seconds (1.25), &LogBinaryFormatTestCase::Event, this, 7);
+  Simulator::Schedule (Seconds (2), &LogBinaryFormatTestCase::Event, this, 8);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  std::clog.rdbuf (clog);
+
+  LogSetBinarySink (filename, 16);
+  Simulator::ScheduleWithContext (3, Seconds (1.25), &LogBinaryFormatTestCase::Event, this, 7);
+  Simulator::Schedule (Seconds (2), &LogBinaryFormatTestCase::Event, this, 8);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  LogCloseBinarySink ();
+  LogComponentDisable ("LogTestSuite", LogLevel (LOG_LEVEL_ALL | LOG_PREFIX_ALL));
+
+  std::ostringstream decoded;
+  LogDecodeBinarySink (filename, decoded);
+  std::remove (filename.c_str ());
+  NS_TEST_EXPECT_MSG_EQ (decoded.str (), written.str (), "Decoded messages differ from std::clog");
+}
+
+/**
+ * A value whose printing logs a message.
+ */
+struct LogNested
+{
+};
+
+/**
+ * Print a LogNested, logging a message.
+ *
+ * \param [in,out] os The output stream.
+ * \param [in] nested The value.
+ * \returns The output stream.
+ */
+static std::ostream &
+operator << (std::ostream &os, const LogNested &nested)
+{
+  NS_LOG_INFO ("nested");
+  return os << "printed";
+}
+
+class LogBinaryNestedTestCase : public TestCase
+{
+public:
+  LogBinaryNestedTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+LogBinaryNestedTestCase::LogBinaryNestedTestCase ()
+  : TestCase ("Check that a message does not overwrite a record still being written")
+{
+}
+
+void
+LogBinaryNestedTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("log");
+  LogComponentEnable ("LogTestSuite", LOG_LEVEL_INFO);
+  // The nested message finds the only record held by the outer one.
+  LogSetBinarySink (filename, 1);
+  NS_LOG_INFO ("outer " << LogNested () << " message");
+  LogCloseBinarySink ();
+  LogComponentDisable ("LogTestSuite", LogLevel (LOG_LEVEL_ALL | LOG_PREFIX_ALL));
+
+  std::ostringstream decoded;
+  LogDecodeBinarySink (filename, decoded);
+  std::remove (filename.c_str ());
+#ifdef NS3_LOG_ENABLE
+  NS_TEST_EXPECT_MSG_EQ (decoded.str (), "# 1 older messages were overwritten or not completed\n"
+                         "outer printed message\n", "Unexpected records");
+#else
+  NS_TEST_EXPECT_MSG_EQ (decoded.str (), "", "Logged with logging compiled out");
+#endif
+}
+
+/** The number of evaluations of the arguments of a log message. */
+static uint32_t g_evaluations = 0;
+
+/**
+ * Count the evaluations of the arguments of a log message.
+ *
+ * \returns The number of evaluations.
+ */
+static uint32_t
+Evaluate (void)
+{
+  return ++g_evaluations;
+}
+
+class LogLevelCapTestCase : public TestCase
+{
+public:
+  LogLevelCapTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+LogLevelCapTestCase::LogLevelCapTestCase ()
+  : TestCase ("Check that the levels above the cap are compiled out")
+{
+}
+
+void
+LogLevelCapTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("log");
+  LogComponentEnable ("LogTestSuite", LOG_LEVEL_ALL);
+  LogSetBinarySink (filename, 16);
+  g_evaluations = 0;
+  NS_LOG_LOGIC ("compiled out " << Evaluate ());
+  NS_LOG_DEBUG ("compiled in " << Evaluate ());
+  LogCloseBinarySink ();
+  LogComponentDisable ("LogTestSuite", LOG_LEVEL_ALL);
+  std::remove (filename.c_str ());
+#ifdef NS3_LOG_ENABLE
+  NS_TEST_ASSERT_MSG_EQ (g_evaluations, 1, "Wrong number of evaluations of the messages");
+#else
+  NS_TEST_ASSERT_MSG_EQ (g_evaluations, 0, "Message evaluated with logging compiled out");
+#endif
+}
+
+class LogTestSuite : public TestSuite
+{
+public:
+  LogTestSuite ();
+};
+
+LogTestSuite::LogTestSuite ()
+  : TestSuite ("log", UNIT)
+{
+  AddTestCase (new LogBinarySinkTestCase, TestCase::QUICK);
+  AddTestCase (new LogBinaryFormatTestCase, TestCase::QUICK);
+  AddTestCase (new LogBinaryNestedTestCase, TestCase::QUICK);
+  AddTestCase (new LogLevelCapTestCase, TestCase::QUICK);
+}
+
+static LogTestSuite g_logTestSuite;
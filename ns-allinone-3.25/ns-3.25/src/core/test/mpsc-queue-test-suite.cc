@@ -0,0 +1,169 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/mpsc-queue.h"
+#include "ns3/system-thread.h"
+
+#include <list>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup thread
+ * Check that MpscQueue delivers every item, in order for each producer.
+ */
+class MpscQueueTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param [in] capacity The capacity of the ring.
+   * \param [in] producers The number of producer threads.
+   */
+  MpscQueueTestCase (uint32_t capacity, uint32_t producers);
+
+private:
+  virtual void DoRun (void);
+
+  /** An item: the producer index and a sequence number. */
+  typedef std::pair<uint32_t, uint32_t> Item;
+
+  /**
+   * Push a sequence of items.
+   *
+   * \param [in] context The test case and the producer index.
+   */
+  static void Produce (std::pair<MpscQueueTestCase *, uint32_t> context);
+
+  /** The number of items pushed by each producer. */
+  static const uint32_t ITEMS = 20000;
+
+  uint32_t m_capacity;          //!< The capacity of the ring.
+  uint32_t m_producers;         //!< The number of producer threads.
+  MpscQueue<Item> *m_queue;     //!< The queue under test.
+};
+
+/**
+ * Build the name of a MpscQueueTestCase.
+ *
+ * \param [in] capacity The capacity of the ring.
+ * \param [in] producers The number of producer threads.
+ * \returns The test name.
+ */
+static std::string
+MpscQueueTestName (uint32_t capacity, uint32_t producers)
+{
+  std::ostringstream oss;
+  oss << "Check an MpscQueue of capacity " << capacity
+      << " with " << producers << " producers";
+  return oss.str ();
+}
+
+MpscQueueTestCase::MpscQueueTestCase (uint32_t capacity, uint32_t producers)
+  : TestCase (MpscQueueTestName (capacity, producers)),
+    m_capacity (capacity),
+    m_producers (producers),
+    m_queue (0)
+{
+}
+
+void
+MpscQueueTestCase::Produce (std::pair<MpscQueueTestCase *, uint32_t> context)
+{
+  for (uint32_t i = 0; i < ITEMS; i++)
+    {
+      context.first->m_queue->Push (std::make_pair (context.second, i));
+    }
+}
+
+void
+MpscQueueTestCase::DoRun (void)
+{
+  MpscQueue<Item> queue (m_capacity);
+  m_queue = &queue;
+
+  NS_TEST_EXPECT_MSG_EQ (queue.IsEmpty (), true, "New queue is not empty");
+  NS_TEST_EXPECT_MSG_EQ (queue.Push (std::make_pair (0u, 0u)), true,
+                         "First push should ask for a wakeup");
+  NS_TEST_EXPECT_MSG_EQ (queue.Push (std::make_pair (0u, 1u)), false,
+                         "Second push should not ask for a wakeup");
+  Item item;
+  NS_TEST_EXPECT_MSG_EQ (queue.Pop (item), true, "Pop failed");
+  NS_TEST_EXPECT_MSG_EQ (item.second, 0, "Wrong first item");
+  NS_TEST_EXPECT_MSG_EQ (queue.Pop (item), true, "Pop failed");
+  NS_TEST_EXPECT_MSG_EQ (item.second, 1, "Wrong second item");
+  NS_TEST_EXPECT_MSG_EQ (queue.IsEmpty (), true, "Drained queue is not empty");
+
+  std::list<Ptr<SystemThread> > threads;
+  for (uint32_t i = 0; i < m_producers; i++)
+    {
+      Ptr<SystemThread> thread =
+        Create<SystemThread> (MakeBoundCallback (&MpscQueueTestCase::Produce,
+                                                 std::make_pair (this, i)));
+      thread->Start ();
+      threads.push_back (thread);
+    }
+
+  std::vector<uint32_t> next (m_producers, 0);
+  uint32_t received = 0;
+  bool ordered = true;
+  while (received < m_producers * ITEMS)
+    {
+      if (!queue.Pop (item))
+        {
+          continue;
+        }
+      if (item.first >= m_producers || item.second != next[item.first])
+        {
+          ordered = false;
+          break;
+        }
+      next[item.first]++;
+      received++;
+    }
+  for (std::list<Ptr<SystemThread> >::iterator i = threads.begin (); i != threads.end (); ++i)
+    {
+      (*i)->Join ();
+    }
+
+  NS_TEST_EXPECT_MSG_EQ (ordered, true, "Items of a producer were reordered");
+  NS_TEST_EXPECT_MSG_EQ (received, m_producers * ITEMS, "Items were lost");
+  NS_TEST_EXPECT_MSG_EQ (queue.Pop (item), false, "Unexpected extra item");
+  m_queue = 0;
+}
+
+/**
+ * \ingroup thread
+ * MpscQueue test suite.
+ */
+class MpscQueueTestSuite : public TestSuite
+{
+public:
+  MpscQueueTestSuite ()
+    : TestSuite ("mpsc-queue")
+  {
+    // A tiny ring exercises the overflow list.
+    AddTestCase (new MpscQueueTestCase (2, 4), TestCase::QUICK);
+    AddTestCase (new MpscQueueTestCase (1024, 1), TestCase::QUICK);
+    AddTestCase (new MpscQueueTestCase (1024, 4), TestCase::QUICK);
+  }
+} g_mpscQueueTestSuite;
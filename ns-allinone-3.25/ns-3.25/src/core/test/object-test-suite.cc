@@ -357,6 +357,18 @@ AggregateObjectTestCase::DoRun (void)
 
   baseA = baseB->GetObject<BaseA> ();
   NS_TEST_ASSERT_MSG_NE (baseA, 0, "Unable to GetObject on released object");
+
+  //
+  // GetObject remembers its results, including the failed ones: make sure
+  // that a failed lookup does not hide an Object aggregated afterwards.
+  //
+  baseA = CreateObject<BaseA> ();
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<BaseB> (), 0, "Unexpectedly found a BaseB through baseA");
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<BaseB> (), 0, "Unexpectedly found a BaseB through baseA");
+  baseB = CreateObject<BaseB> ();
+  baseA->AggregateObject (baseB);
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<BaseB> (), baseB, "Cannot GetObject (through baseA) for newly aggregated BaseB");
+  NS_TEST_ASSERT_MSG_EQ (baseA->GetObject<BaseB> (), baseB, "Cannot GetObject (through baseA) for newly aggregated BaseB");
 }
 
 // ===========================================================================
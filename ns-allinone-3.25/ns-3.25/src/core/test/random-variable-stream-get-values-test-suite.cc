@@ -0,0 +1,118 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/object-factory.h"
+#include "ns3/random-variable-stream.h"
+#include <vector>
+
+using namespace ns3;
+
+// ===========================================================================
+// Test case for the bulk generation of random values
+// ===========================================================================
+
+class RandomVariableStreamGetValuesTestCase : public TestCase
+{
+public:
+  RandomVariableStreamGetValuesTestCase ();
+  virtual ~RandomVariableStreamGetValuesTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Check that GetValues returns the same values as GetValue.
+   *
+   * \param [in] name The TypeId name of the random variable.
+   * \param [in] attribute The name of an attribute to set, or an empty string.
+   * \param [in] value The value of the attribute.
+   * \param [in] antithetic Whether to generate antithetic values.
+   */
+  void Check (std::string name, std::string attribute, double value, bool antithetic);
+};
+
+RandomVariableStreamGetValuesTestCase::RandomVariableStreamGetValuesTestCase ()
+  : TestCase ("GetValues returns the same values as GetValue")
+{
+}
+
+RandomVariableStreamGetValuesTestCase::~RandomVariableStreamGetValuesTestCase ()
+{
+}
+
+void
+RandomVariableStreamGetValuesTestCase::Check (std::string name, std::string attribute,
+                                              double value, bool antithetic)
+{
+  Ptr<RandomVariableStream> rv[2];
+  ObjectFactory factory;
+  factory.SetTypeId (name);
+  if (!attribute.empty ())
+    {
+      factory.Set (attribute, DoubleValue (value));
+    }
+  factory.Set ("Antithetic", BooleanValue (antithetic));
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      rv[i] = factory.Create<RandomVariableStream> ();
+      rv[i]->SetStream (17);
+    }
+
+  // Draw in batches of growing sizes, including empty ones.
+  std::vector<double> values (1000);
+  uint32_t total = 0;
+  for (uint32_t n = 0; total + n <= values.size (); n += 7)
+    {
+      rv[1]->GetValues (&values[total], n);
+      total += n;
+    }
+  for (uint32_t i = 0; i < total; i++)
+    {
+      double expected = rv[0]->GetValue ();
+      NS_TEST_ASSERT_MSG_EQ (values[i], expected, name << " value " << i << " differs");
+    }
+}
+
+void
+RandomVariableStreamGetValuesTestCase::DoRun (void)
+{
+  Check ("ns3::UniformRandomVariable", "Max", 10.0, false);
+  Check ("ns3::UniformRandomVariable", "Min", -3.0, true);
+  Check ("ns3::ConstantRandomVariable", "Constant", 4.0, false);
+  Check ("ns3::ExponentialRandomVariable", "", 0.0, false);
+  // A bound which rejects about 40% of the exponential values.
+  Check ("ns3::ExponentialRandomVariable", "Bound", 0.5, false);
+  Check ("ns3::ExponentialRandomVariable", "Bound", 0.5, true);
+  // A random variable which draws with GetValue.
+  Check ("ns3::NormalRandomVariable", "", 0.0, false);
+}
+
+class RandomVariableStreamGetValuesTestSuite : public TestSuite
+{
+public:
+  RandomVariableStreamGetValuesTestSuite ();
+};
+
+RandomVariableStreamGetValuesTestSuite::RandomVariableStreamGetValuesTestSuite ()
+  : TestSuite ("random-variable-stream-get-values", UNIT)
+{
+  AddTestCase (new RandomVariableStreamGetValuesTestCase, TestCase::QUICK);
+}
+
+static RandomVariableStreamGetValuesTestSuite randomVariableStreamGetValuesTestSuite;
@@ -19,10 +19,16 @@
  */
 #include "ns3/test.h"
 #include "ns3/simulator.h"
+#include "ns3/simulator-impl.h"
 #include "ns3/list-scheduler.h"
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/uinteger.h"
+#include "ns3/valgrind.h"
+#include <vector>
 
 using namespace ns3;
 
@@ -168,6 +174,172 @@ SimulatorEventsTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_destroy, true, "Event should have run");
 }
 
+class SimulatorEventOrderTestCase : public TestCase
+{
+public:
+  SimulatorEventOrderTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  void ScheduleOne (void);
+  void Fire (uint32_t seq);
+  uint32_t m_scheduled;
+  uint32_t m_fired;
+  uint32_t m_removed;
+  uint64_t m_lastTs;
+  uint32_t m_lastSeq;
+  bool m_ordered;
+  bool m_removedFired;
+  std::vector<EventId> m_ids;
+  std::vector<bool> m_wasRemoved;
+  Ptr<UniformRandomVariable> m_rng;
+  ObjectFactory m_schedulerFactory;
+};
+
+SimulatorEventOrderTestCase::SimulatorEventOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check event ordering under random insertions and removals with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+void
+SimulatorEventOrderTestCase::ScheduleOne (void)
+{
+  // Mostly short, clustered delays with frequent ties, plus a few
+  // events far in the future.
+  Time delay;
+  if (m_rng->GetInteger (0, 49) == 0)
+    {
+      delay = MicroSeconds (m_rng->GetInteger (0, 1000));
+    }
+  else
+    {
+      delay = NanoSeconds (m_rng->GetInteger (0, 1000));
+    }
+  uint32_t seq = m_ids.size ();
+  m_ids.push_back (Simulator::Schedule (delay, &SimulatorEventOrderTestCase::Fire, this, seq));
+  m_wasRemoved.push_back (false);
+  m_scheduled++;
+}
+
+void
+SimulatorEventOrderTestCase::Fire (uint32_t seq)
+{
+  uint64_t ts = Simulator::Now ().GetTimeStep ();
+  if (ts < m_lastTs || (ts == m_lastTs && seq < m_lastSeq))
+    {
+      m_ordered = false;
+    }
+  if (m_wasRemoved[seq])
+    {
+      m_removedFired = true;
+    }
+  m_lastTs = ts;
+  m_lastSeq = seq;
+  m_fired++;
+
+  if (m_scheduled < 20000)
+    {
+      ScheduleOne ();
+      if (m_rng->GetInteger (0, 1) == 0)
+        {
+          ScheduleOne ();
+        }
+    }
+  if (m_rng->GetInteger (0, 4) == 0)
+    {
+      uint32_t victim = m_rng->GetInteger (0, m_ids.size () - 1);
+      if (!m_ids[victim].IsExpired ())
+        {
+          Simulator::Remove (m_ids[victim]);
+          m_wasRemoved[victim] = true;
+          m_removed++;
+        }
+    }
+}
+
+void
+SimulatorEventOrderTestCase::DoRun (void)
+{
+  m_scheduled = 0;
+  m_fired = 0;
+  m_removed = 0;
+  m_lastTs = 0;
+  m_lastSeq = 0;
+  m_ordered = true;
+  m_removedFired = false;
+  m_rng = CreateObject<UniformRandomVariable> ();
+  m_rng->SetStream (1);
+
+  Simulator::SetScheduler (m_schedulerFactory);
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      ScheduleOne ();
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_ordered, true, "Events were not run in (timestamp, uid) order");
+  NS_TEST_EXPECT_MSG_EQ (m_removedFired, false, "A removed event was run");
+  NS_TEST_EXPECT_MSG_EQ (m_fired + m_removed, m_scheduled, "Events were lost");
+}
+
+class SimulatorEventPoolTestCase : public TestCase
+{
+public:
+  SimulatorEventPoolTestCase ();
+  virtual void DoRun (void);
+  void Event5 (uint32_t n, uint64_t a, uint64_t b, uint64_t c, uint64_t d);
+  uint64_t GetPoolCounter (std::string name);
+};
+
+SimulatorEventPoolTestCase::SimulatorEventPoolTestCase ()
+  : TestCase ("Check that steady-state event scheduling is served by the event pool")
+{
+}
+
+void
+SimulatorEventPoolTestCase::Event5 (uint32_t n, uint64_t a, uint64_t b, uint64_t c, uint64_t d)
+{
+  if (n > 0)
+    {
+      Simulator::Schedule (NanoSeconds (1), &SimulatorEventPoolTestCase::Event5, this,
+                           n - 1, a, b, c, d);
+    }
+}
+
+uint64_t
+SimulatorEventPoolTestCase::GetPoolCounter (std::string name)
+{
+  UintegerValue value;
+  Simulator::GetImplementation ()->GetAttribute (name, value);
+  return value.Get ();
+}
+
+void
+SimulatorEventPoolTestCase::DoRun (void)
+{
+  if (RUNNING_ON_VALGRIND)
+    {
+      // The event pool is disabled under valgrind.
+      return;
+    }
+  // Warm up the pool.
+  Simulator::Schedule (NanoSeconds (1), &SimulatorEventPoolTestCase::Event5, this,
+                       1000, 1, 2, 3, 4);
+  Simulator::Run ();
+
+  uint64_t hits = GetPoolCounter ("EventPoolHits");
+  uint64_t misses = GetPoolCounter ("EventPoolMisses");
+  Simulator::Schedule (NanoSeconds (1), &SimulatorEventPoolTestCase::Event5, this,
+                       1000, 1, 2, 3, 4);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (GetPoolCounter ("EventPoolMisses"), misses,
+                         "Steady-state events were allocated from the heap");
+  NS_TEST_EXPECT_MSG_GT (GetPoolCounter ("EventPoolHits"), hits + 1000,
+                         "Events were not allocated from the pool");
+  Simulator::Destroy ();
+}
+
 class SimulatorTemplateTestCase : public TestCase
 {
 public:
@@ -475,5 +647,16 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+
+    factory.SetTypeId (MapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (CalendarScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventOrderTestCase (factory), TestCase::QUICK);
+
+    AddTestCase (new SimulatorEventPoolTestCase (), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/sweep-runner.h"
+#include "ns3/command-line.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include <sstream>
+#include <unistd.h>
+
+using namespace ns3;
+
+class SweepRunnerTestCase : public TestCase
+{
+public:
+  SweepRunnerTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Run a variant.
+   *
+   * \param [in] i The index of the variant.
+   * \returns The parameter of the variant and a random value.
+   */
+  std::string Variant (uint32_t i);
+  /**
+   * Record the completion of a variant.
+   *
+   * \param [in] i The index of the variant.
+   * \param [in] result The result of the variant.
+   */
+  void Result (uint32_t i, std::string result);
+
+  Ptr<UniformRandomVariable> m_random;  //!< The random variable drawn by the variants.
+  uint32_t m_param;                     //!< The parameter set by the variants.
+  uint32_t m_results;                   //!< The number of results received.
+};
+
+SweepRunnerTestCase::SweepRunnerTestCase ()
+  : TestCase ("Check that variants run with their own arguments and run number")
+{
+}
+
+std::string
+SweepRunnerTestCase::Variant (uint32_t i)
+{
+  if (m_param == 99)
+    {
+      _exit (1);
+    }
+  std::ostringstream oss;
+  oss.precision (17);
+  oss << m_param << " " << m_random->GetValue ();
+  return oss.str ();
+}
+
+void
+SweepRunnerTestCase::Result (uint32_t i, std::string result)
+{
+  m_results++;
+}
+
+void
+SweepRunnerTestCase::DoRun (void)
+{
+  uint64_t run = RngSeedManager::GetRun ();
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_param = 0;
+  m_results = 0;
+  CommandLine cmd;
+  cmd.AddValue ("param", "The parameter of the variant", m_param);
+
+  SweepRunner runner;
+  runner.SetMaxWorkers (2);
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      std::vector<std::string> args;
+      std::ostringstream rngRun;
+      rngRun << "--RngRun=" << i + 1;
+      args.push_back (rngRun.str ());
+      std::ostringstream param;
+      param << "--param=" << 10 * i;
+      args.push_back (param.str ());
+      runner.AddVariant (args);
+    }
+  runner.AddVariant (std::vector<std::string> (1, "--param=99"));
+  runner.SetResultCallback (MakeCallback (&SweepRunnerTestCase::Result, this));
+  runner.Run (cmd, MakeCallback (&SweepRunnerTestCase::Variant, this));
+
+  NS_TEST_ASSERT_MSG_EQ (m_results, 6, "Missing results");
+  NS_TEST_ASSERT_MSG_EQ (m_param, 0, "The variants changed this process");
+  NS_TEST_ASSERT_MSG_EQ (RngSeedManager::GetRun (), run, "The variants changed this process");
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      RngSeedManager::SetRun (i + 1);
+      RandomVariableStream::ResetAllStreams ();
+      std::ostringstream expected;
+      expected.precision (17);
+      expected << 10 * i << " " << m_random->GetValue ();
+      NS_TEST_ASSERT_MSG_EQ (runner.IsSuccess (i), true, "Variant " << i << " failed");
+      NS_TEST_ASSERT_MSG_EQ (runner.GetResult (i), expected.str (), "Wrong result of variant " << i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (runner.IsSuccess (5), false, "The failure of a variant was not reported");
+  NS_TEST_ASSERT_MSG_EQ (runner.GetResult (5), "", "A failed variant returned a result");
+  RngSeedManager::SetRun (run);
+  RandomVariableStream::ResetAllStreams ();
+}
+
+class SweepRunnerTestSuite : public TestSuite
+{
+public:
+  SweepRunnerTestSuite ();
+};
+
+SweepRunnerTestSuite::SweepRunnerTestSuite ()
+  : TestSuite ("sweep-runner", UNIT)
+{
+  AddTestCase (new SweepRunnerTestCase, TestCase::QUICK);
+}
+
+static SweepRunnerTestSuite g_sweepRunnerTestSuite;
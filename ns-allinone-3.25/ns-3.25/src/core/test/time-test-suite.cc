@@ -20,6 +20,7 @@
  * TimeStep support by Emmanuelle Laprise <emmanuelle.laprise@bluekazoo.ca>
  */
 
+#include <cmath>
 #include <iomanip>
 #include <iostream>
 #include <string>
@@ -230,6 +231,47 @@ TimeInputOutputTestCase::DoRun (void)
   std::cout << std::endl;
 }
     
+class TimeToDoubleTestCase : public TestCase
+{
+public:
+  TimeToDoubleTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TimeToDoubleTestCase::TimeToDoubleTestCase ()
+  : TestCase ("Check the conversion of times to doubles")
+{
+}
+
+void
+TimeToDoubleTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (NanoSeconds (1).GetSeconds (), 1e-9,
+                         "1ns is not exactly 1e-9s");
+  NS_TEST_ASSERT_MSG_EQ (MilliSeconds (1500).GetSeconds (), 1.5,
+                         "1500ms is not exactly 1.5s");
+  NS_TEST_ASSERT_MSG_EQ (Seconds (-3.0).ToDouble (Time::MS), -3000.0,
+                         "-3s is not exactly -3000ms");
+
+  // Beyond 2^53 steps, the conversion goes through int64x64_t
+  int64_t steps[] = { 1, -7, 123456789, 1000000000, (static_cast<int64_t> (1) << 53) + 1,
+                      -((static_cast<int64_t> (1) << 60) + 3) };
+  Time::Unit units[] = { Time::S, Time::MS, Time::US, Time::NS, Time::PS, Time::MIN };
+  for (uint32_t i = 0; i < sizeof (steps) / sizeof (steps[0]); i++)
+    {
+      Time t = TimeStep (steps[i]);
+      for (uint32_t j = 0; j < sizeof (units) / sizeof (units[0]); j++)
+        {
+          // To () multiplies by an inverse rounded to 2^-64
+          double expected = t.To (units[j]).GetDouble ();
+          double tolerance = std::fabs (expected) * 1e-15 + std::fabs (static_cast<double> (steps[i])) * 1e-19;
+          NS_TEST_ASSERT_MSG_EQ_TOL (t.ToDouble (units[j]), expected, tolerance,
+                                     "Wrong conversion of " << steps[i] << " steps to unit " << units[j]);
+        }
+    }
+}
+
 static class TimeTestSuite : public TestSuite
 {
 public:
@@ -238,6 +280,7 @@ public:
   {
     AddTestCase (new TimeWithSignTestCase (), TestCase::QUICK);
     AddTestCase (new TimeInputOutputTestCase (), TestCase::QUICK);
+    AddTestCase (new TimeToDoubleTestCase (), TestCase::QUICK);
     // This should be last, since it changes the resolution
     AddTestCase (new TimeSimpleTestCase (), TestCase::QUICK);
   }
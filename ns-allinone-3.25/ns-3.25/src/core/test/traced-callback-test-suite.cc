@@ -18,6 +18,7 @@
 
 #include "ns3/test.h"
 #include "ns3/traced-callback.h"
+#include <vector>
 
 using namespace ns3;
 
@@ -108,6 +109,188 @@ BasicTracedCallbackTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_two, true, "Callback CbTwo not called");
 }
 
+class OrderTracedCallbackTestCase : public TestCase
+{
+public:
+  OrderTracedCallbackTestCase ();
+  virtual ~OrderTracedCallbackTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  void Cb (uint32_t id);
+  void CbConnect (uint32_t id);
+
+  std::vector<uint32_t> m_calls;
+  TracedCallback<uint32_t> m_trace;
+};
+
+OrderTracedCallbackTestCase::OrderTracedCallbackTestCase ()
+  : TestCase ("Check the order of the chain of callbacks")
+{
+}
+
+void
+OrderTracedCallbackTestCase::Cb (uint32_t id)
+{
+  m_calls.push_back (id);
+}
+
+void
+OrderTracedCallbackTestCase::CbConnect (uint32_t id)
+{
+  m_calls.push_back (id);
+  m_trace.ConnectWithoutContext (MakeCallback (&OrderTracedCallbackTestCase::Cb, this));
+}
+
+void
+OrderTracedCallbackTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), true, "New TracedCallback is not empty");
+  m_trace (1);
+
+  //
+  // The callbacks are invoked in the order they were connected, also
+  // after the first one is disconnected.
+  //
+  m_trace.ConnectWithoutContext (MakeCallback (&OrderTracedCallbackTestCase::Cb, this));
+  m_trace.ConnectWithoutContext (MakeCallback (&OrderTracedCallbackTestCase::CbConnect, this));
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), false, "TracedCallback with callbacks is empty");
+  m_trace.DisconnectWithoutContext (MakeCallback (&OrderTracedCallbackTestCase::Cb, this));
+  m_trace.ConnectWithoutContext (MakeCallback (&OrderTracedCallbackTestCase::Cb, this));
+
+  //
+  // A callback connected during the invocation of the chain is invoked
+  // at the end of the chain.
+  //
+  m_trace (2);
+  NS_TEST_ASSERT_MSG_EQ (m_calls.size (), 3, "Unexpected number of calls");
+  NS_TEST_ASSERT_MSG_EQ (m_calls[0], 2, "Unexpected argument");
+  NS_TEST_ASSERT_MSG_EQ (m_calls[2], 2, "Unexpected argument");
+
+  //
+  // Disconnecting removes all the copies of a callback.
+  //
+  m_trace.DisconnectWithoutContext (MakeCallback (&OrderTracedCallbackTestCase::CbConnect, this));
+  m_trace.DisconnectWithoutContext (MakeCallback (&OrderTracedCallbackTestCase::Cb, this));
+  NS_TEST_ASSERT_MSG_EQ (m_trace.IsEmpty (), true, "TracedCallback is not empty");
+  m_calls.clear ();
+  m_trace (3);
+  NS_TEST_ASSERT_MSG_EQ (m_calls.size (), 0, "Disconnected callback called");
+}
+
+class DisconnectTracedCallbackTestCase : public TestCase
+{
+public:
+  DisconnectTracedCallbackTestCase ();
+  virtual ~DisconnectTracedCallbackTestCase () {}
+
+private:
+  virtual void DoRun (void);
+
+  void CbSelf (uint32_t id);
+  void CbTwo (uint32_t id);
+  void CbThree (uint32_t id);
+  void CbRemoveThree (uint32_t id);
+  void CbReenter (uint32_t id);
+
+  std::vector<uint32_t> m_calls;
+  TracedCallback<uint32_t> m_trace;
+};
+
+DisconnectTracedCallbackTestCase::DisconnectTracedCallbackTestCase ()
+  : TestCase ("Check callbacks which disconnect callbacks during the invocation")
+{
+}
+
+void
+DisconnectTracedCallbackTestCase::CbSelf (uint32_t id)
+{
+  m_calls.push_back (1);
+  m_trace.DisconnectWithoutContext (MakeCallback (&DisconnectTracedCallbackTestCase::CbSelf, this));
+}
+
+void
+DisconnectTracedCallbackTestCase::CbTwo (uint32_t id)
+{
+  m_calls.push_back (2);
+}
+
+void
+DisconnectTracedCallbackTestCase::CbThree (uint32_t id)
+{
+  m_calls.push_back (3);
+}
+
+void
+DisconnectTracedCallbackTestCase::CbRemoveThree (uint32_t id)
+{
+  m_calls.push_back (4);
+  m_trace.DisconnectWithoutContext (MakeCallback (&DisconnectTracedCallbackTestCase::CbThree, this));
+}
+
+void
+DisconnectTracedCallbackTestCase::CbReenter (uint32_t id)
+{
+  m_calls.push_back (5);
+  m_trace.DisconnectWithoutContext (MakeCallback (&DisconnectTracedCallbackTestCase::CbReenter, this));
+  m_trace (id + 1);
+}
+
+void
+DisconnectTracedCallbackTestCase::DoRun (void)
+{
+  //
+  // A callback which disconnects itself does not make the chain skip
+  // the next callback, whether it is the first one or not.
+  //
+  m_trace.ConnectWithoutContext (MakeCallback (&DisconnectTracedCallbackTestCase::CbSelf, this));
+  m_trace.ConnectWithoutContext (MakeCallback (&DisconnectTracedCallbackTestCase::CbTwo, this));
+  m_trace.ConnectWithoutContext (MakeCallback (&DisconnectTracedCallbackTestCase::CbSelf, this));
+  m_trace.ConnectWithoutContext (MakeCallback (&DisconnectTracedCallbackTestCase::CbThree, this));
+  m_trace (0);
+  NS_TEST_ASSERT_MSG_EQ (m_calls.size (), 3, "Unexpected number of calls");
+  NS_TEST_EXPECT_MSG_EQ (m_calls[0], 1, "CbSelf not called first");
+  NS_TEST_EXPECT_MSG_EQ (m_calls[1], 2, "CbTwo skipped");
+  NS_TEST_EXPECT_MSG_EQ (m_calls[2], 3, "CbThree skipped");
+
+  m_calls.clear ();
+  m_trace (0);
+  NS_TEST_ASSERT_MSG_EQ (m_calls.size (), 2, "Unexpected number of calls");
+  NS_TEST_EXPECT_MSG_EQ (m_calls[0], 2, "CbTwo not called");
+  NS_TEST_EXPECT_MSG_EQ (m_calls[1], 3, "CbThree not called");
+
+  //
+  // A callback disconnected before its turn is not invoked.
+  //
+  m_trace.DisconnectWithoutContext (MakeCallback (&DisconnectTracedCallbackTestCase::CbThree, this));
+  m_trace.ConnectWithoutContext (MakeCallback (&DisconnectTracedCallbackTestCase::CbRemoveThree, this));
+  m_trace.ConnectWithoutContext (MakeCallback (&DisconnectTracedCallbackTestCase::CbThree, this));
+  m_calls.clear ();
+  m_trace (0);
+  NS_TEST_ASSERT_MSG_EQ (m_calls.size (), 2, "Unexpected number of calls");
+  NS_TEST_EXPECT_MSG_EQ (m_calls[0], 2, "CbTwo not called");
+  NS_TEST_EXPECT_MSG_EQ (m_calls[1], 4, "CbRemoveThree not called");
+
+  //
+  // Callbacks disconnected by a nested invocation do not make the
+  // enclosing one skip or repeat callbacks.
+  //
+  m_trace.DisconnectWithoutContext (MakeCallback (&DisconnectTracedCallbackTestCase::CbRemoveThree, this));
+  m_trace.ConnectWithoutContext (MakeCallback (&DisconnectTracedCallbackTestCase::CbReenter, this));
+  m_trace.ConnectWithoutContext (MakeCallback (&DisconnectTracedCallbackTestCase::CbSelf, this));
+  m_trace.ConnectWithoutContext (MakeCallback (&DisconnectTracedCallbackTestCase::CbThree, this));
+  m_calls.clear ();
+  m_trace (0);
+  NS_TEST_ASSERT_MSG_EQ (m_calls.size (), 6, "Unexpected number of calls");
+  NS_TEST_EXPECT_MSG_EQ (m_calls[0], 2, "CbTwo not called");
+  NS_TEST_EXPECT_MSG_EQ (m_calls[1], 5, "CbReenter not called");
+  NS_TEST_EXPECT_MSG_EQ (m_calls[2], 2, "CbTwo not called again");
+  NS_TEST_EXPECT_MSG_EQ (m_calls[3], 1, "CbSelf not called");
+  NS_TEST_EXPECT_MSG_EQ (m_calls[4], 3, "CbThree not called");
+  NS_TEST_EXPECT_MSG_EQ (m_calls[5], 3, "CbThree skipped after the nested invocation");
+}
+
 class TracedCallbackTestSuite : public TestSuite
 {
 public:
@@ -118,6 +301,8 @@ TracedCallbackTestSuite::TracedCallbackTestSuite ()
   : TestSuite ("traced-callback", UNIT)
 {
   AddTestCase (new BasicTracedCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new OrderTracedCallbackTestCase, TestCase::QUICK);
+  AddTestCase (new DisconnectTracedCallbackTestCase, TestCase::QUICK);
 }
 
 static TracedCallbackTestSuite tracedCallbackTestSuite;
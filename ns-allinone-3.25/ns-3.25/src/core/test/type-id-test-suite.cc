@@ -25,6 +25,9 @@
 #include "ns3/type-id.h"
 #include "ns3/test.h"
 #include "ns3/log.h"
+#include "ns3/object.h"
+#include "ns3/integer.h"
+#include "ns3/traced-value.h"
 
 using namespace std;
 
@@ -188,6 +191,133 @@ CollisionTestCase::DoRun (void)
 }
   
   
+//----------------------------
+//
+// Inherited attribute and trace source lookup test
+
+class InheritedLookupTestObject : public Object
+{
+public:
+  int32_t m_a;
+  int32_t m_b;
+  int32_t m_c;
+  TracedValue<int32_t> m_source;
+};
+
+class InheritedLookupTestCase : public TestCase
+{
+public:
+  InheritedLookupTestCase ();
+  virtual ~InheritedLookupTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+InheritedLookupTestCase::InheritedLookupTestCase ()
+  : TestCase ("Check lookup of inherited attributes and trace sources")
+{
+}
+
+InheritedLookupTestCase::~InheritedLookupTestCase ()
+{
+}
+
+void
+InheritedLookupTestCase::DoRun (void)
+{
+  TypeId base = TypeId ("InheritedLookupBase")
+    .SetParent<Object> ()
+    .AddAttribute ("A", "", IntegerValue (1),
+                   MakeIntegerAccessor (&InheritedLookupTestObject::m_a),
+                   MakeIntegerChecker<int32_t> ())
+    .AddTraceSource ("Source", "",
+                     MakeTraceSourceAccessor (&InheritedLookupTestObject::m_source),
+                     "ns3::TracedValueCallback::Int32")
+  ;
+  TypeId derived = TypeId ("InheritedLookupDerived")
+    .SetParent (base)
+    .AddAttribute ("B", "", IntegerValue (2),
+                   MakeIntegerAccessor (&InheritedLookupTestObject::m_b),
+                   MakeIntegerChecker<int32_t> ())
+  ;
+
+  struct TypeId::AttributeInformation info;
+  NS_TEST_ASSERT_MSG_EQ (derived.LookupAttributeByName ("A", &info), true,
+                         "Inherited attribute not found");
+  NS_TEST_ASSERT_MSG_EQ (info.name, "A", "Wrong attribute found");
+  NS_TEST_ASSERT_MSG_EQ (derived.LookupAttributeByName ("B", &info), true,
+                         "Attribute not found");
+  NS_TEST_ASSERT_MSG_EQ (info.name, "B", "Wrong attribute found");
+  NS_TEST_ASSERT_MSG_EQ (base.LookupAttributeByName ("B", &info), false,
+                         "Attribute of a subclass found");
+  NS_TEST_ASSERT_MSG_EQ (derived.LookupAttributeByName ("C", &info), false,
+                         "Missing attribute found");
+  NS_TEST_ASSERT_MSG_NE (derived.LookupTraceSourceByName ("Source"), 0,
+                         "Inherited trace source not found");
+  NS_TEST_ASSERT_MSG_EQ (derived.LookupTraceSourceByName ("A"), 0,
+                         "Missing trace source found");
+
+  TypeId grandchild = TypeId ("InheritedLookupGrandchild")
+    .SetParent (derived)
+    .AddAttribute ("D", "", IntegerValue (4),
+                   MakeIntegerAccessor (&InheritedLookupTestObject::m_c),
+                   MakeIntegerChecker<int32_t> ())
+  ;
+  NS_TEST_ASSERT_MSG_EQ (grandchild.LookupAttributeByName ("A", &info), true,
+                         "Attribute of a grandparent not found");
+  NS_TEST_ASSERT_MSG_EQ (info.name, "A", "Wrong attribute found");
+  NS_TEST_ASSERT_MSG_EQ (derived.LookupAttributeByName ("D", &info), false,
+                         "Attribute of a subclass found");
+
+  // An attribute added to the parent after a lookup shows up in the
+  // subclass.
+  base.AddAttribute ("C", "", IntegerValue (3),
+                     MakeIntegerAccessor (&InheritedLookupTestObject::m_c),
+                     MakeIntegerChecker<int32_t> ());
+  NS_TEST_ASSERT_MSG_EQ (derived.LookupAttributeByName ("C", &info), true,
+                         "Attribute added to the parent not found");
+  NS_TEST_ASSERT_MSG_EQ (grandchild.LookupAttributeByName ("C", &info), true,
+                         "Attribute added to a grandparent not found");
+  NS_TEST_ASSERT_MSG_EQ (grandchild.LookupAttributeByName ("B", &info), true,
+                         "Inherited attribute not found");
+
+  // The flattened list is in class order.
+  NS_TEST_ASSERT_MSG_EQ (grandchild.GetInheritedAttributeN (), 4,
+                         "Wrong number of inherited attributes");
+  TypeId owner;
+  NS_TEST_ASSERT_MSG_EQ (grandchild.GetInheritedAttribute (0, &owner).name, "D",
+                         "Attributes of the subclass should come first");
+  NS_TEST_ASSERT_MSG_EQ (owner, grandchild, "Wrong owner");
+  NS_TEST_ASSERT_MSG_EQ (grandchild.GetInheritedAttribute (1, &owner).name, "B",
+                         "Attributes of the parent should come next");
+  NS_TEST_ASSERT_MSG_EQ (owner, derived, "Wrong owner");
+  NS_TEST_ASSERT_MSG_EQ (grandchild.GetInheritedAttribute (2, &owner).name, "A",
+                         "Attributes of the grandparent should come last");
+  NS_TEST_ASSERT_MSG_EQ (grandchild.GetInheritedAttribute (3, &owner).name, "C",
+                         "Attributes of the grandparent should come last");
+  NS_TEST_ASSERT_MSG_EQ (owner, base, "Wrong owner");
+
+  // An attribute of a parent hidden by one of a subclass stays in the
+  // flattened list, after it, but lookups find the subclass one.
+  base.AddAttribute ("D", "", IntegerValue (5),
+                     MakeIntegerAccessor (&InheritedLookupTestObject::m_c),
+                     MakeIntegerChecker<int32_t> ());
+  NS_TEST_ASSERT_MSG_EQ (grandchild.GetInheritedAttributeN (), 5,
+                         "Hidden attribute not listed");
+  NS_TEST_ASSERT_MSG_EQ (grandchild.GetInheritedAttribute (4, &owner).name, "D",
+                         "Hidden attribute not listed last");
+  NS_TEST_ASSERT_MSG_EQ (owner, base, "Wrong owner");
+  NS_TEST_ASSERT_MSG_EQ (grandchild.LookupAttributeByName ("D", &info), true,
+                         "Attribute not found");
+  NS_TEST_ASSERT_MSG_EQ (DynamicCast<const IntegerValue> (info.initialValue)->Get (), 4,
+                         "Hidden attribute found");
+  NS_TEST_ASSERT_MSG_EQ (derived.LookupAttributeByName ("D", &info), true,
+                         "Attribute added to the parent not found");
+  NS_TEST_ASSERT_MSG_EQ (DynamicCast<const IntegerValue> (info.initialValue)->Get (), 5,
+                         "Wrong attribute found");
+}
+  
+  
 //----------------------------
 //
 // Performance test
@@ -298,6 +428,7 @@ TypeIdTestSuite::TypeIdTestSuite ()
   // as chained.
   AddTestCase (new UniqueTypeIdTestCase, QUICK);
   AddTestCase (new CollisionTestCase, QUICK);
+  AddTestCase (new InheritedLookupTestCase, QUICK);
 }
 
 static TypeIdTestSuite g_TypeIdTestSuite;  
@@ -454,7 +454,7 @@ CsmaNetDevice::TransmitStart (void)
   //
   if (IsSendEnabled () == false)
     {
-      m_phyTxDropTrace (m_currentPkt);
+      NS_OPTIONAL_TRACE (m_phyTxDropTrace (m_currentPkt));
       m_currentPkt = 0;
       return;
     }
@@ -489,7 +489,7 @@ CsmaNetDevice::TransmitStart (void)
         } 
       else 
         {
-          m_macTxBackoffTrace (m_currentPkt);
+          NS_OPTIONAL_TRACE (m_macTxBackoffTrace (m_currentPkt));
 
           m_backoff.IncrNumRetries ();
           Time backoffTime = m_backoff.GetBackoffTime ();
@@ -507,7 +507,7 @@ CsmaNetDevice::TransmitStart (void)
       if (m_channel->TransmitStart (m_currentPkt, m_deviceId) == false)
         {
           NS_LOG_WARN ("Channel TransmitStart returns an error");
-          m_phyTxDropTrace (m_currentPkt);
+          NS_OPTIONAL_TRACE (m_phyTxDropTrace (m_currentPkt));
           m_currentPkt = 0;
           m_txMachineState = READY;
         } 
@@ -519,7 +519,7 @@ CsmaNetDevice::TransmitStart (void)
           //
           m_backoff.ResetBackoffTime ();
           m_txMachineState = BUSY;
-          m_phyTxBeginTrace (m_currentPkt);
+          NS_OPTIONAL_TRACE (m_phyTxBeginTrace (m_currentPkt));
 
           Time tEvent = m_bps.CalculateBytesTxTime (m_currentPkt->GetSize ());
           NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << tEvent.GetSeconds () << "sec");
@@ -541,7 +541,7 @@ CsmaNetDevice::TransmitAbort (void)
   NS_LOG_LOGIC ("m_currentPkt=" << m_currentPkt);
   NS_LOG_LOGIC ("Pkt UID is " << m_currentPkt->GetUid () << ")");
 
-  m_phyTxDropTrace (m_currentPkt);
+  NS_OPTIONAL_TRACE (m_phyTxDropTrace (m_currentPkt));
   m_currentPkt = 0;
 
   NS_ASSERT_MSG (m_txMachineState == BACKOFF, "Must be in BACKOFF state to abort.  Tx state is: " << m_txMachineState);
@@ -567,8 +567,8 @@ CsmaNetDevice::TransmitAbort (void)
       Ptr<QueueItem> item = m_queue->Dequeue ();
       NS_ASSERT_MSG (item != 0, "CsmaNetDevice::TransmitAbort(): IsEmpty false but no Packet on queue?");
       m_currentPkt = item->GetPacket ();
-      m_snifferTrace (m_currentPkt);
-      m_promiscSnifferTrace (m_currentPkt);
+      NS_OPTIONAL_TRACE (m_snifferTrace (m_currentPkt));
+      NS_OPTIONAL_TRACE (m_promiscSnifferTrace (m_currentPkt));
       TransmitStart ();
     }
 }
@@ -597,7 +597,7 @@ CsmaNetDevice::TransmitCompleteEvent (void)
   NS_LOG_LOGIC ("Pkt UID is " << m_currentPkt->GetUid () << ")");
 
   m_channel->TransmitEnd (); 
-  m_phyTxEndTrace (m_currentPkt);
+  NS_OPTIONAL_TRACE (m_phyTxEndTrace (m_currentPkt));
   m_currentPkt = 0;
 
   NS_LOG_LOGIC ("Schedule TransmitReadyEvent in " << m_tInterframeGap.GetSeconds () << "sec");
@@ -636,8 +636,8 @@ CsmaNetDevice::TransmitReadyEvent (void)
       Ptr<QueueItem> item = m_queue->Dequeue ();
       NS_ASSERT_MSG (item != 0, "CsmaNetDevice::TransmitReadyEvent(): IsEmpty false but no Packet on queue?");
       m_currentPkt = item->GetPacket ();
-      m_snifferTrace (m_currentPkt);
-      m_promiscSnifferTrace (m_currentPkt);
+      NS_OPTIONAL_TRACE (m_snifferTrace (m_currentPkt));
+      NS_OPTIONAL_TRACE (m_promiscSnifferTrace (m_currentPkt));
       TransmitStart ();
     }
 }
@@ -701,21 +701,21 @@ CsmaNetDevice::Receive (Ptr<Packet> packet, Ptr<CsmaNetDevice> senderDevice)
   // Hit the trace hook.  This trace will fire on all packets received from the
   // channel except those originated by this device.
   //
-  m_phyRxEndTrace (packet);
+  NS_OPTIONAL_TRACE (m_phyRxEndTrace (packet));
 
   // 
   // Only receive if the send side of net device is enabled
   //
   if (IsReceiveEnabled () == false)
     {
-      m_phyRxDropTrace (packet);
+      NS_OPTIONAL_TRACE (m_phyRxDropTrace (packet));
       return;
     }
 
   if (m_receiveErrorModel && m_receiveErrorModel->IsCorrupt (packet) )
     {
       NS_LOG_LOGIC ("Dropping pkt due to error model ");
-      m_phyRxDropTrace (packet);
+      NS_OPTIONAL_TRACE (m_phyRxDropTrace (packet));
       return;
     }
 
@@ -736,7 +736,7 @@ CsmaNetDevice::Receive (Ptr<Packet> packet, Ptr<CsmaNetDevice> senderDevice)
   if (!crcGood)
     {
       NS_LOG_INFO ("CRC error on Packet " << packet);
-      m_phyRxDropTrace (packet);
+      NS_OPTIONAL_TRACE (m_phyRxDropTrace (packet));
       return;
     }
 
@@ -799,10 +799,10 @@ CsmaNetDevice::Receive (Ptr<Packet> packet, Ptr<CsmaNetDevice> senderDevice)
   // hook and pass a copy up to the promiscuous callback.  Pass a copy to 
   // make sure that nobody messes with our packet.
   //
-  m_promiscSnifferTrace (originalPacket);
+  NS_OPTIONAL_TRACE (m_promiscSnifferTrace (originalPacket));
   if (!m_promiscRxCallback.IsNull ())
     {
-      m_macPromiscRxTrace (originalPacket);
+      NS_OPTIONAL_TRACE (m_macPromiscRxTrace (originalPacket));
       m_promiscRxCallback (this, packet, protocol, header.GetSource (), header.GetDestination (), packetType);
     }
 
@@ -813,8 +813,8 @@ CsmaNetDevice::Receive (Ptr<Packet> packet, Ptr<CsmaNetDevice> senderDevice)
   //
   if (packetType != PACKET_OTHERHOST)
     {
-      m_snifferTrace (originalPacket);
-      m_macRxTrace (originalPacket);
+      NS_OPTIONAL_TRACE (m_snifferTrace (originalPacket));
+      NS_OPTIONAL_TRACE (m_macRxTrace (originalPacket));
       m_rxCallback (this, packet, protocol, header.GetSource ());
     }
 }
@@ -956,7 +956,7 @@ CsmaNetDevice::SendFrom (Ptr<Packet> packet, const Address& src, const Address&
   //
   if (IsSendEnabled () == false)
     {
-      m_macTxDropTrace (packet);
+      NS_OPTIONAL_TRACE (m_macTxDropTrace (packet));
       return false;
     }
 
@@ -964,7 +964,7 @@ CsmaNetDevice::SendFrom (Ptr<Packet> packet, const Address& src, const Address&
   Mac48Address source = Mac48Address::ConvertFrom (src);
   AddHeader (packet, source, destination, protocolNumber);
 
-  m_macTxTrace (packet);
+  NS_OPTIONAL_TRACE (m_macTxTrace (packet));
 
   //
   // Place the packet to be sent on the send queue.  Note that the 
@@ -972,7 +972,7 @@ CsmaNetDevice::SendFrom (Ptr<Packet> packet, const Address& src, const Address&
   //
   if (m_queue->Enqueue (Create<QueueItem> (packet)) == false)
     {
-      m_macTxDropTrace (packet);
+      NS_OPTIONAL_TRACE (m_macTxDropTrace (packet));
       return false;
     }
 
@@ -988,8 +988,8 @@ CsmaNetDevice::SendFrom (Ptr<Packet> packet, const Address& src, const Address&
           Ptr<QueueItem> item = m_queue->Dequeue ();
           NS_ASSERT_MSG (item != 0, "CsmaNetDevice::SendFrom(): IsEmpty false but no Packet on queue?");
           m_currentPkt = item->GetPacket ();
-          m_promiscSnifferTrace (m_currentPkt);
-          m_snifferTrace (m_currentPkt);
+          NS_OPTIONAL_TRACE (m_promiscSnifferTrace (m_currentPkt));
+          NS_OPTIONAL_TRACE (m_snifferTrace (m_currentPkt));
           TransmitStart ();
         }
     }
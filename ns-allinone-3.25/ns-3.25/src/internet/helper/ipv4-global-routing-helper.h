@@ -80,6 +80,8 @@ public:
    * Users must first call PopulateRoutingTables() and then may subsequently
    * call RecomputeRoutingTables() at any later time in the simulation.
    *
+   * If the "GlobalRoutingIncrementalRecompute" global value is true, only
+   * the routes changed by the topology changes are recomputed.
    */
   static void RecomputeRoutingTables (void);
 private:
@@ -51,22 +51,24 @@ operator<< (std::ostream& os, const CandidateQueue& q)
 {
   typedef CandidateQueue::CandidateList_t List_t;
   typedef List_t::const_iterator CIter_t;
-  const CandidateQueue::CandidateList_t& list = q.m_candidates;
+  List_t list = q.m_candidates;
+  std::sort (list.begin (), list.end (), &CandidateQueue::Before);
 
   os << "*** CandidateQueue Begin (<id, distance, LSA-type>) ***" << std::endl;
   for (CIter_t iter = list.begin (); iter != list.end (); iter++)
     {
       os << "<" 
-      << (*iter)->GetVertexId () << ", "
-      << (*iter)->GetDistanceFromRoot () << ", "
-      << (*iter)->GetVertexType () << ">" << std::endl;
+      << iter->vertex->GetVertexId () << ", "
+      << iter->vertex->GetDistanceFromRoot () << ", "
+      << iter->vertex->GetVertexType () << ">" << std::endl;
     }
   os << "*** CandidateQueue End ***";
   return os;
 }
 
 CandidateQueue::CandidateQueue()
-  : m_candidates ()
+  : m_candidates (),
+    m_order (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -94,11 +96,11 @@ CandidateQueue::Push (SPFVertex *vNew)
 {
   NS_LOG_FUNCTION (this << vNew);
 
-  CandidateList_t::iterator i = std::upper_bound (
-      m_candidates.begin (), m_candidates.end (), vNew,
-      &CandidateQueue::CompareSPFVertex
-      );
-  m_candidates.insert (i, vNew);
+  Candidate c;
+  c.vertex = vNew;
+  SetKey (c);
+  m_candidates.push_back (c);
+  SiftUp (m_candidates.size () - 1);
 }
 
 SPFVertex *
@@ -110,8 +112,14 @@ CandidateQueue::Pop (void)
       return 0;
     }
 
-  SPFVertex *v = m_candidates.front ();
-  m_candidates.pop_front ();
+  SPFVertex *v = m_candidates.front ().vertex;
+  Candidate last = m_candidates.back ();
+  m_candidates.pop_back ();
+  if (!m_candidates.empty ())
+    {
+      Place (0, last);
+      SiftDown (0);
+    }
   return v;
 }
 
@@ -124,7 +132,7 @@ CandidateQueue::Top (void) const
       return 0;
     }
 
-  return m_candidates.front ();
+  return m_candidates.front ().vertex;
 }
 
 bool
@@ -145,18 +153,17 @@ SPFVertex *
 CandidateQueue::Find (const Ipv4Address addr) const
 {
   NS_LOG_FUNCTION (this);
-  CandidateList_t::const_iterator i = m_candidates.begin ();
+  const Candidate *found = 0;
 
-  for (; i != m_candidates.end (); i++)
+  for (CandidateList_t::const_iterator i = m_candidates.begin (); i != m_candidates.end (); i++)
     {
-      SPFVertex *v = *i;
-      if (v->GetVertexId () == addr)
+      if (i->vertex->GetVertexId () == addr && (found == 0 || Before (*i, *found)))
         {
-          return v;
+          found = &(*i);
         }
     }
 
-  return 0;
+  return found ? found->vertex : 0;
 }
 
 void
@@ -164,11 +171,41 @@ CandidateQueue::Reorder (void)
 {
   NS_LOG_FUNCTION (this);
 
-  m_candidates.sort (&CandidateQueue::CompareSPFVertex);
+  // Like a stable sort of a sorted list, give the vertices whose distance
+  // changed new keys in their previous order, then rebuild the heap.
+  CandidateList_t changed;
+  for (CandidateList_t::const_iterator i = m_candidates.begin (); i != m_candidates.end (); i++)
+    {
+      if (i->distance != i->vertex->GetDistanceFromRoot ())
+        {
+          changed.push_back (*i);
+        }
+    }
+  std::sort (changed.begin (), changed.end (), &CandidateQueue::Before);
+  for (CandidateList_t::iterator i = changed.begin (); i != changed.end (); i++)
+    {
+      SetKey (m_candidates[i->vertex->m_candidateIndex]);
+    }
+  for (uint32_t i = m_candidates.size () / 2; i > 0; i--)
+    {
+      SiftDown (i - 1);
+    }
   NS_LOG_LOGIC ("After reordering the CandidateQueue");
   NS_LOG_LOGIC (*this);
 }
 
+void
+CandidateQueue::Reorder (SPFVertex *v)
+{
+  NS_LOG_FUNCTION (this << v);
+
+  uint32_t i = v->m_candidateIndex;
+  NS_ASSERT (i < m_candidates.size () && m_candidates[i].vertex == v);
+  SetKey (m_candidates[i]);
+  SiftUp (i);
+  SiftDown (v->m_candidateIndex);
+}
+
 /*
  * In this implementation, SPFVertex follows the ordering where
  * a vertex is ranked first if its GetDistanceFromRoot () is smaller;
@@ -177,24 +214,75 @@ CandidateQueue::Reorder (void)
  * This ordering is necessary for implementing ECMP
  */
 bool 
-CandidateQueue::CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2)
+CandidateQueue::Before (const Candidate &c1, const Candidate &c2)
+{
+  if (c1.distance != c2.distance)
+    {
+      return c1.distance < c2.distance;
+    }
+  if (c1.network != c2.network)
+    {
+      return c1.network;
+    }
+  return c1.order < c2.order;
+}
+
+void
+CandidateQueue::SetKey (Candidate &c)
 {
-  NS_LOG_FUNCTION (&v1 << &v2);
+  c.distance = c.vertex->GetDistanceFromRoot ();
+  c.network = c.vertex->GetVertexType () == SPFVertex::VertexNetwork;
+  c.order = m_order++;
+}
 
-  bool result = false;
-  if (v1->GetDistanceFromRoot () < v2->GetDistanceFromRoot ())
+void
+CandidateQueue::SiftUp (uint32_t i)
+{
+  Candidate c = m_candidates[i];
+  while (i > 0)
     {
-      result = true;
+      uint32_t parent = (i - 1) / 2;
+      if (!Before (c, m_candidates[parent]))
+        {
+          break;
+        }
+      Place (i, m_candidates[parent]);
+      i = parent;
     }
-  else if (v1->GetDistanceFromRoot () == v2->GetDistanceFromRoot ())
+  Place (i, c);
+}
+
+void
+CandidateQueue::SiftDown (uint32_t i)
+{
+  uint32_t n = m_candidates.size ();
+  Candidate c = m_candidates[i];
+  for (;;)
     {
-      if (v1->GetVertexType () == SPFVertex::VertexNetwork 
-          && v2->GetVertexType () == SPFVertex::VertexRouter)
+      uint32_t child = 2 * i + 1;
+      if (child >= n)
+        {
+          break;
+        }
+      if (child + 1 < n && Before (m_candidates[child + 1], m_candidates[child]))
+        {
+          child++;
+        }
+      if (!Before (m_candidates[child], c))
         {
-          result = true;
+          break;
         }
+      Place (i, m_candidates[child]);
+      i = child;
     }
-  return result;
+  Place (i, c);
+}
+
+void
+CandidateQueue::Place (uint32_t i, const Candidate &c)
+{
+  m_candidates[i] = c;
+  c.vertex->m_candidateIndex = i;
 }
 
 } // namespace ns3
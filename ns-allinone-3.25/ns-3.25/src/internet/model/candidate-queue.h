@@ -22,7 +22,7 @@
 #define CANDIDATE_QUEUE_H
 
 #include <stdint.h>
-#include <list>
+#include <vector>
 #include "ns3/ipv4-address.h"
 
 namespace ns3 {
@@ -45,6 +45,11 @@ class SPFVertex;
  * for a Find () operation, the dynamic nature of the data and the derived
  * requirement for a Reorder () operation led us to implement this simple 
  * enhanced priority queue.
+ *
+ * The queue is a binary heap, in which each vertex records its position
+ * so that Reorder (SPFVertex*) restores the order in logarithmic time.
+ * Vertices at the same distance leave the queue in the order in which
+ * they were pushed, or in which their distance was last decreased.
  */
 class CandidateQueue
 {
@@ -152,6 +157,18 @@ public:
  */
   void Reorder (void);
 
+/**
+ * @brief Reorders the Candidate Queue after the distance of one of its
+ * vertices decreased.
+ *
+ * This is equivalent to, but much faster than, Reorder () when only
+ * the distance of \p v changed.
+ *
+ * @see SPFVertex
+ * @param v The vertex whose m_distanceFromRoot decreased.
+ */
+  void Reorder (SPFVertex *v);
+
 private:
 /**
  * Candidate Queue copy construction is disallowed (not implemented) to 
@@ -169,21 +186,58 @@ private:
  * \return copied object
  */
   CandidateQueue& operator= (CandidateQueue& sr);
-/**
- * \brief return true if v1 < v2
- *
- * SPFVertexes are added into the queue according to the ordering
- * defined by this method. If v1 should be popped before v2, this 
- * method return true; false otherwise
- *
- * \param v1 first operand
- * \param v2 second operand
- * \return True if v1 should be popped before v2; false otherwise
- */
-  static bool CompareSPFVertex (const SPFVertex* v1, const SPFVertex* v2);
+  /**
+   * \brief A vertex in the heap, with its sort key.
+   */
+  struct Candidate
+  {
+    SPFVertex *vertex;  //!< the vertex
+    uint32_t distance;  //!< the distance of the vertex when it was last ordered
+    bool network;       //!< whether the vertex is a network vertex
+    uint64_t order;     //!< the order in which the vertex was pushed or reordered
+  };
+
+  /**
+   * \brief return true if c1 should be popped before c2
+   *
+   * SPFVertexes are popped from the queue according to the ordering
+   * defined by this method: by distance, then network vertices before
+   * router vertices, then first in, first out.
+   *
+   * \param c1 first operand
+   * \param c2 second operand
+   * \return True if c1 should be popped before c2; false otherwise
+   */
+  static bool Before (const Candidate &c1, const Candidate &c2);
+
+  /**
+   * \brief Set the sort key of a candidate from its vertex.
+   * \param c the candidate
+   */
+  void SetKey (Candidate &c);
+
+  /**
+   * \brief Move a candidate towards the top of the heap.
+   * \param i the position of the candidate
+   */
+  void SiftUp (uint32_t i);
+
+  /**
+   * \brief Move a candidate towards the bottom of the heap.
+   * \param i the position of the candidate
+   */
+  void SiftDown (uint32_t i);
+
+  /**
+   * \brief Store a candidate at a position of the heap.
+   * \param i the position
+   * \param c the candidate
+   */
+  void Place (uint32_t i, const Candidate &c);
 
-  typedef std::list<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
-  CandidateList_t m_candidates;  //!< SPFVertex candidates
+  typedef std::vector<Candidate> CandidateList_t; //!< container of SPFVertex candidates
+  CandidateList_t m_candidates;  //!< SPFVertex candidates, in a binary heap
+  uint64_t m_order;  //!< the order of the next candidate pushed or reordered
 
   /**
    * \brief Stream insertion operator.
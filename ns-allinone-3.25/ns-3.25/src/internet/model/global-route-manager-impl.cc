@@ -35,6 +35,15 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-list-routing.h"
 #include "ns3/mpi-interface.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/core-config.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include <unistd.h>
+#endif
 #include "global-router-interface.h"
 #include "global-route-manager-impl.h"
 #include "candidate-queue.h"
@@ -44,6 +53,25 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("GlobalRouteManagerImpl");
 
+/**
+ * \brief The number of threads which compute the global routes.
+ */
+static GlobalValue g_threadCount = GlobalValue ("GlobalRoutingThreadCount",
+                                                "The number of threads which compute the global routes, "
+                                                "0 for one per processor",
+                                                UintegerValue (1),
+                                                MakeUintegerChecker<uint32_t> ());
+
+/**
+ * \brief Whether the global routes are recomputed incrementally.
+ */
+static GlobalValue g_incrementalRecompute = GlobalValue ("GlobalRoutingIncrementalRecompute",
+                                                         "Whether a recomputation of the global routes only "
+                                                         "updates the routes changed by the topology changes, "
+                                                         "which keeps the shortest paths of all the routers in memory",
+                                                         BooleanValue (false),
+                                                         MakeBooleanChecker ());
+
 /**
  * \brief Stream insertion operator.
  *
@@ -89,12 +117,14 @@ SPFVertex::SPFVertex () :
   m_vertexType (VertexUnknown), 
   m_vertexId ("255.255.255.255"), 
   m_lsa (0),
+  m_lsaIndex (0),
   m_distanceFromRoot (SPF_INFINITY), 
   m_rootOif (SPF_INFINITY),
   m_nextHop ("0.0.0.0"),
   m_parents (),
   m_children (),
-  m_vertexProcessed (false)
+  m_vertexProcessed (false),
+  m_candidateIndex (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -102,12 +132,14 @@ SPFVertex::SPFVertex () :
 SPFVertex::SPFVertex (GlobalRoutingLSA* lsa) : 
   m_vertexId (lsa->GetLinkStateId ()),
   m_lsa (lsa),
+  m_lsaIndex (0),
   m_distanceFromRoot (SPF_INFINITY), 
   m_rootOif (SPF_INFINITY),
   m_nextHop ("0.0.0.0"),
   m_parents (),
   m_children (),
-  m_vertexProcessed (false)
+  m_vertexProcessed (false),
+  m_candidateIndex (0)
 {
   NS_LOG_FUNCTION (this << lsa);
 
@@ -216,6 +248,20 @@ SPFVertex::GetLSA (void) const
   return m_lsa;
 }
 
+void
+SPFVertex::SetLSAIndex (uint32_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+  m_lsaIndex = index;
+}
+
+uint32_t
+SPFVertex::GetLSAIndex (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_lsaIndex;
+}
+
 void
 SPFVertex::SetDistanceFromRoot (uint32_t distance)
 {
@@ -448,16 +494,114 @@ GlobalRouteManagerLSDB::~GlobalRouteManagerLSDB ()
   m_database.clear ();
 }
 
+const uint32_t GlobalRouteManagerLSDB::NO_VERTEX;
+
 void
 GlobalRouteManagerLSDB::Initialize ()
 {
   NS_LOG_FUNCTION (this);
+  m_vertices.clear ();
+  m_vertexIndices.clear ();
+  m_firstEdges.clear ();
+  m_edges.clear ();
+//
+// Number the LSAs, and index the router LSAs by the link data of their
+// transit link records, as GetLSAByLinkData () finds them.
+//
+  std::map<Ipv4Address, uint32_t> byLinkData;
   LSDBMap_t::iterator i;
   for (i= m_database.begin (); i!= m_database.end (); i++)
     {
       GlobalRoutingLSA* temp = i->second;
       temp->SetStatus (GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED);
+      uint32_t index = m_vertices.size ();
+      m_vertices.push_back (temp);
+      m_vertexIndices[i->first] = index;
+      for (uint32_t j = 0; j < temp->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *lr = temp->GetLinkRecord (j);
+          if (lr->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+            {
+              byLinkData.insert (std::make_pair (lr->GetLinkData (), index));
+            }
+        }
     }
+//
+// Then resolve the links of each LSA to the LSAs at their other end.
+//
+  for (uint32_t v = 0; v < m_vertices.size (); v++)
+    {
+      m_firstEdges.push_back (m_edges.size ());
+      GlobalRoutingLSA* temp = m_vertices[v];
+      if (temp->GetLSType () == GlobalRoutingLSA::RouterLSA)
+        {
+          for (uint32_t j = 0; j < temp->GetNLinkRecords (); j++)
+            {
+              Edge edge;
+              edge.record = temp->GetLinkRecord (j);
+              edge.target = NO_VERTEX;
+              if (edge.record->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint
+                  || edge.record->GetLinkType () == GlobalRoutingLinkRecord::TransitNetwork)
+                {
+                  edge.target = GetVertexIndex (edge.record->GetLinkId ());
+                }
+              m_edges.push_back (edge);
+            }
+        }
+      else if (temp->GetLSType () == GlobalRoutingLSA::NetworkLSA)
+        {
+          for (uint32_t j = 0; j < temp->GetNAttachedRouters (); j++)
+            {
+              Edge edge;
+              edge.record = 0;
+              edge.target = NO_VERTEX;
+              std::map<Ipv4Address, uint32_t>::const_iterator router =
+                byLinkData.find (temp->GetAttachedRouter (j));
+              if (router != byLinkData.end ())
+                {
+                  edge.target = router->second;
+                }
+              m_edges.push_back (edge);
+            }
+        }
+    }
+  m_firstEdges.push_back (m_edges.size ());
+  NS_LOG_LOGIC ("Graph of " << m_vertices.size () << " vertices and " << m_edges.size () << " edges");
+}
+
+uint32_t
+GlobalRouteManagerLSDB::GetNVertices (void) const
+{
+  return m_vertices.size ();
+}
+
+uint32_t
+GlobalRouteManagerLSDB::GetVertexIndex (Ipv4Address addr) const
+{
+  std::map<Ipv4Address, uint32_t>::const_iterator i = m_vertexIndices.find (addr);
+  if (i == m_vertexIndices.end ())
+    {
+      return NO_VERTEX;
+    }
+  return i->second;
+}
+
+GlobalRoutingLSA*
+GlobalRouteManagerLSDB::GetVertexLSA (uint32_t index) const
+{
+  return m_vertices[index];
+}
+
+uint32_t
+GlobalRouteManagerLSDB::GetFirstEdge (uint32_t index) const
+{
+  return m_firstEdges[index];
+}
+
+const GlobalRouteManagerLSDB::Edge&
+GlobalRouteManagerLSDB::GetEdge (uint32_t edge) const
+{
+  return m_edges[edge];
 }
 
 void
@@ -495,13 +639,10 @@ GlobalRouteManagerLSDB::GetLSA (Ipv4Address addr) const
 //
 // Look up an LSA by its address.
 //
-  LSDBMap_t::const_iterator i;
-  for (i= m_database.begin (); i!= m_database.end (); i++)
+  LSDBMap_t::const_iterator i = m_database.find (addr);
+  if (i != m_database.end ())
     {
-      if (i->first == addr)
-        {
-          return i->second;
-        }
+      return i->second;
     }
   return 0;
 }
@@ -539,16 +680,26 @@ GlobalRouteManagerLSDB::GetLSAByLinkData (Ipv4Address addr) const
 
 GlobalRouteManagerImpl::GlobalRouteManagerImpl () 
   :
-    m_spfroot (0)
+    m_spfroot (0),
+    m_ownLsdb (true)
 {
   NS_LOG_FUNCTION (this);
   m_lsdb = new GlobalRouteManagerLSDB ();
 }
 
+GlobalRouteManagerImpl::GlobalRouteManagerImpl (GlobalRouteManagerLSDB* lsdb) 
+  :
+    m_spfroot (0),
+    m_lsdb (lsdb),
+    m_ownLsdb (false)
+{
+  NS_LOG_FUNCTION (this << lsdb);
+}
+
 GlobalRouteManagerImpl::~GlobalRouteManagerImpl ()
 {
   NS_LOG_FUNCTION (this);
-  if (m_lsdb)
+  if (m_lsdb && m_ownLsdb)
     {
       delete m_lsdb;
     }
@@ -558,11 +709,12 @@ void
 GlobalRouteManagerImpl::DebugUseLsdb (GlobalRouteManagerLSDB* lsdb)
 {
   NS_LOG_FUNCTION (this << lsdb);
-  if (m_lsdb)
+  if (m_lsdb && m_ownLsdb)
     {
       delete m_lsdb;
     }
   m_lsdb = lsdb;
+  m_ownLsdb = true;
 }
 
 void
@@ -578,20 +730,10 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
         {
           continue;
         }
-      Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-      uint32_t j = 0;
-      uint32_t nRoutes = gr->GetNRoutes ();
-      NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes from node " << node->GetId ());
-      // Each time we delete route 0, the route index shifts downward
-      // We can delete all routes if we delete the route numbered 0
-      // nRoutes times
-      for (j = 0; j < nRoutes; j++)
-        {
-          NS_LOG_LOGIC ("Deleting global route " << j << " from node " << node->GetId ());
-          gr->RemoveRoute (0);
-        }
-      NS_LOG_LOGIC ("Deleted " << j << " global routes from node "<< node->GetId ());
+      NS_LOG_LOGIC ("Deleting routes from node " << node->GetId ());
+      DeleteRoutes (router->GetRoutingProtocol ());
     }
+  m_results.clear ();
   if (m_lsdb)
     {
       NS_LOG_LOGIC ("Deleting LSDB, creating new one");
@@ -600,6 +742,24 @@ GlobalRouteManagerImpl::DeleteGlobalRoutes ()
     }
 }
 
+void
+GlobalRouteManagerImpl::DeleteRoutes (Ptr<Ipv4GlobalRouting> gr)
+{
+  NS_LOG_FUNCTION (gr);
+  uint32_t j = 0;
+  uint32_t nRoutes = gr->GetNRoutes ();
+  NS_LOG_LOGIC ("Deleting " << gr->GetNRoutes ()<< " routes");
+  // Each time we delete route 0, the route index shifts downward
+  // We can delete all routes if we delete the route numbered 0
+  // nRoutes times
+  for (j = 0; j < nRoutes; j++)
+    {
+      NS_LOG_LOGIC ("Deleting global route " << j);
+      gr->RemoveRoute (0);
+    }
+  NS_LOG_LOGIC ("Deleted " << j << " global routes");
+}
+
 //
 // In order to build the routing database, we need to walk the list of nodes
 // in the system and look for those that support the GlobalRouter interface.
@@ -692,42 +852,857 @@ GlobalRouteManagerImpl::BuildGlobalRoutingDatabase ()
 // algorithm then iterates again.  It terminates when the candidate
 // list becomes empty. 
 //
+struct GlobalRouteManagerImpl::SPFRootQueue
+{
+  std::vector<SPFRoot> roots; //!< the routers
+  uint32_t next; //!< the index of the next router to compute
+#ifdef HAVE_PTHREAD_H
+  SystemMutex mutex; //!< protects next
+#endif
+};
+
+void
+GlobalRouteManagerImpl::InitializeRoutes ()
+{
+  NS_LOG_FUNCTION (this);
+//
+// Build the graph of the database that the SPF calculations walk.
+//
+  m_lsdb->Initialize ();
+//
+// Walk the list of nodes in the system.
+//
+  NS_LOG_INFO ("About to start SPF calculation");
+  SPFRootQueue queue;
+  queue.next = 0;
+  CollectSPFRoots (queue.roots);
+//
+// Keep the shortest paths of the routers if they are to be updated
+// incrementally.
+//
+  BooleanValue incremental;
+  g_incrementalRecompute.GetValue (incremental);
+  m_results.clear ();
+  if (incremental.Get ())
+    {
+      m_results.resize (NodeList::GetNNodes ());
+      for (uint32_t i = 0; i < queue.roots.size (); i++)
+        {
+          queue.roots[i].result = &m_results[queue.roots[i].nodeId];
+        }
+    }
+  RunSPFQueue (queue);
+  NS_LOG_INFO ("Finished SPF calculation");
+}
+
+void
+GlobalRouteManagerImpl::CollectSPFRoots (std::vector<SPFRoot> &roots)
+{
+  NS_LOG_FUNCTION (&roots);
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<Node> node = *i;
+//
+// Look for the GlobalRouter interface that indicates that the node is
+// participating in routing.
+//
+      Ptr<GlobalRouter> rtr = 
+        node->GetObject<GlobalRouter> ();
+
+      uint32_t systemId = MpiInterface::GetSystemId ();
+      // Ignore nodes that are not assigned to our systemId (distributed sim)
+      if (node->GetSystemId () != systemId) 
+        {
+          continue;
+        }
+
+//
+// if the node has a global router interface, then run the global routing
+// algorithms.
+//
+      if (rtr && rtr->GetNumLSAs () )
+        {
+          SPFRoot root;
+          root.routerId = rtr->GetRouterId ();
+          root.nodeId = node->GetId ();
+          root.ipv4 = node->GetObject<Ipv4> ();
+          NS_ASSERT_MSG (root.ipv4, 
+                         "GlobalRouteManagerImpl::InitializeRoutes (): "
+                         "GetObject for <Ipv4> interface failed");
+          root.routing = rtr->GetRoutingProtocol ();
+          root.result = 0;
+          roots.push_back (root);
+        }
+    }
+}
+
+void
+GlobalRouteManagerImpl::RunSPFQueue (SPFRootQueue &queue)
+{
+  NS_LOG_FUNCTION (this << &queue);
+  UintegerValue threadCount;
+  g_threadCount.GetValue (threadCount);
+  uint32_t threads = threadCount.Get ();
+#ifdef HAVE_PTHREAD_H
+  if (threads == 0)
+    {
+      long online = sysconf (_SC_NPROCESSORS_ONLN);
+      threads = online > 0 ? online : 1;
+    }
+#else
+  threads = 1;
+#endif
+  threads = std::min<uint32_t> (threads, queue.roots.size ());
+  if (threads <= 1)
+    {
+      SPFCalculateQueue (this, &queue);
+    }
+#ifdef HAVE_PTHREAD_H
+  else
+    {
+//
+// The calculations of the routers only read the database, and only write
+// the routing table of their router, so that each thread runs them in an
+// implementation of its own which shares our database.
+//
+      NS_LOG_INFO ("Running SPF calculations in " << threads << " threads");
+      std::vector<GlobalRouteManagerImpl *> impls;
+      std::vector<Ptr<SystemThread> > systemThreads;
+      for (uint32_t i = 0; i < threads; i++)
+        {
+          GlobalRouteManagerImpl *impl = new GlobalRouteManagerImpl (m_lsdb);
+          Ptr<SystemThread> thread = Create<SystemThread> (MakeBoundCallback (&GlobalRouteManagerImpl::SPFCalculateQueue, impl, &queue));
+          thread->Start ();
+          impls.push_back (impl);
+          systemThreads.push_back (thread);
+        }
+      for (uint32_t i = 0; i < threads; i++)
+        {
+          systemThreads[i]->Join ();
+          delete impls[i];
+        }
+    }
+#endif
+}
+
+void
+GlobalRouteManagerImpl::SPFCalculateQueue (GlobalRouteManagerImpl *impl, SPFRootQueue *queue)
+{
+  NS_LOG_FUNCTION (impl << queue);
+  for (;;)
+    {
+      uint32_t next;
+      {
+#ifdef HAVE_PTHREAD_H
+        CriticalSection cs (queue->mutex);
+#endif
+        next = queue->next++;
+      }
+      if (next >= queue->roots.size ())
+        {
+          break;
+        }
+      impl->SPFCalculate (queue->roots[next]);
+    }
+}
+
+GlobalRouteManagerImpl::SPFRoot
+GlobalRouteManagerImpl::FindSPFRoot (Ipv4Address root)
+{
+  NS_LOG_FUNCTION (root);
+  SPFRoot router;
+  router.routerId = root;
+  router.nodeId = 0;
+  router.result = 0;
+//
+// Walk the list of nodes looking for the one that has the router ID of the
+// root.  This is the one we're going to write the routing information to.
+//
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<Node> node = *i;
+      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
+      if (rtr == 0)
+        {
+          NS_LOG_LOGIC ("No GlobalRouter interface on node " << node->GetId ());
+          continue;
+        }
+      if (rtr->GetRouterId () == root)
+        {
+          router.nodeId = node->GetId ();
+          router.ipv4 = node->GetObject<Ipv4> ();
+          NS_ASSERT_MSG (router.ipv4, 
+                         "GlobalRouteManagerImpl::FindSPFRoot (): "
+                         "GetObject for <Ipv4> interface failed");
+          router.routing = rtr->GetRoutingProtocol ();
+          break;
+        }
+    }
+  return router;
+}
+
+GlobalRouteManagerImpl::SPFResult::Path::Path ()
+  : distance (SPF_INFINITY),
+    firstExit (0),
+    nExits (0)
+{
+}
+
+GlobalRouteManagerImpl::SPFResult::SPFResult ()
+  : computed (false),
+    stub (false)
+{
+}
+
+/**
+ * \brief Test if two LSAs are identical, except for their SPF status.
+ *
+ * \param a the first LSA
+ * \param b the second LSA
+ * \returns true if the LSAs are identical
+ */
+static bool
+IsSameLSA (GlobalRoutingLSA *a, GlobalRoutingLSA *b)
+{
+  if (a->GetLSType () != b->GetLSType ()
+      || a->GetLinkStateId () != b->GetLinkStateId ()
+      || a->GetAdvertisingRouter () != b->GetAdvertisingRouter ()
+      || a->GetNetworkLSANetworkMask () != b->GetNetworkLSANetworkMask ()
+      || a->GetNLinkRecords () != b->GetNLinkRecords ()
+      || a->GetNAttachedRouters () != b->GetNAttachedRouters ())
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < a->GetNLinkRecords (); i++)
+    {
+      GlobalRoutingLinkRecord *la = a->GetLinkRecord (i);
+      GlobalRoutingLinkRecord *lb = b->GetLinkRecord (i);
+      if (la->GetLinkType () != lb->GetLinkType ()
+          || la->GetLinkId () != lb->GetLinkId ()
+          || la->GetLinkData () != lb->GetLinkData ()
+          || la->GetMetric () != lb->GetMetric ())
+        {
+          return false;
+        }
+    }
+  for (uint32_t i = 0; i < a->GetNAttachedRouters (); i++)
+    {
+      if (a->GetAttachedRouter (i) != b->GetAttachedRouter (i))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+/**
+ * \brief Test if two external LSAs advertise the same route.
+ *
+ * \param a the first LSA
+ * \param b the second LSA
+ * \returns true if the LSAs advertise the same route
+ */
+static bool
+IsSameExternal (GlobalRoutingLSA *a, GlobalRoutingLSA *b)
+{
+  return a->GetLinkStateId () == b->GetLinkStateId ()
+         && a->GetNetworkLSANetworkMask () == b->GetNetworkLSANetworkMask ()
+         && a->GetAdvertisingRouter () == b->GetAdvertisingRouter ();
+}
+
+/**
+ * \brief A link between two vertices of the graph of a database.
+ */
+struct SPFLink
+{
+  Ipv4Address target; //!< the link state ID of the vertex at the other end
+  Ipv4Address data; //!< the link data of the link record, if any
+  uint32_t metric; //!< the metric of the link
+};
+
+/**
+ * \brief Compare two links.
+ *
+ * \param a the first link
+ * \param b the second link
+ * \returns true if the links are identical
+ */
+static bool
+operator == (const SPFLink &a, const SPFLink &b)
+{
+  return a.target == b.target && a.data == b.data && a.metric == b.metric;
+}
+
+/**
+ * \brief Get the links of a vertex to the other vertices of a database.
+ *
+ * \param lsdb the database
+ * \param id the link state ID of the vertex
+ * \param [out] links the links, none if the vertex is not in the database
+ */
+static void
+GetSPFLinks (const GlobalRouteManagerLSDB *lsdb, Ipv4Address id, std::vector<SPFLink> &links)
+{
+  links.clear ();
+  uint32_t v = lsdb->GetVertexIndex (id);
+  if (v == GlobalRouteManagerLSDB::NO_VERTEX)
+    {
+      return;
+    }
+  for (uint32_t j = lsdb->GetFirstEdge (v); j < lsdb->GetFirstEdge (v + 1); j++)
+    {
+      const GlobalRouteManagerLSDB::Edge &edge = lsdb->GetEdge (j);
+      if (edge.target == GlobalRouteManagerLSDB::NO_VERTEX)
+        {
+          continue;
+        }
+      SPFLink link;
+      link.target = lsdb->GetVertexLSA (edge.target)->GetLinkStateId ();
+      link.data = edge.record ? edge.record->GetLinkData () : Ipv4Address ();
+      link.metric = edge.record ? edge.record->GetMetric () : 0;
+      links.push_back (link);
+    }
+}
+
+/**
+ * \brief Get the smallest metric of the links from a vertex to another.
+ *
+ * \param lsdb the database
+ * \param from the link state ID of the first vertex
+ * \param to the link state ID of the second vertex
+ * \returns the metric, SPF_INFINITY if there is no link
+ */
+static uint32_t
+GetSPFLinkMetric (const GlobalRouteManagerLSDB *lsdb, Ipv4Address from, Ipv4Address to)
+{
+  std::vector<SPFLink> links;
+  GetSPFLinks (lsdb, from, links);
+  uint32_t metric = SPF_INFINITY;
+  for (uint32_t i = 0; i < links.size (); i++)
+    {
+      if (links[i].target == to)
+        {
+          metric = std::min (metric, links[i].metric);
+        }
+    }
+  return metric;
+}
+
+/**
+ * \brief Get the links of a list which are not in another list.
+ *
+ * \param a the first list
+ * \param b the second list
+ * \param [out] diff the links of the first list which are not in the second
+ */
+static void
+GetSPFLinksDifference (const std::vector<SPFLink> &a, const std::vector<SPFLink> &b,
+                       std::vector<SPFLink> &diff)
+{
+  diff.clear ();
+  std::vector<bool> matched (b.size (), false);
+  for (uint32_t i = 0; i < a.size (); i++)
+    {
+      bool found = false;
+      for (uint32_t j = 0; j < b.size () && !found; j++)
+        {
+          if (!matched[j] && a[i] == b[j])
+            {
+              matched[j] = true;
+              found = true;
+            }
+        }
+      if (!found)
+        {
+          diff.push_back (a[i]);
+        }
+    }
+}
+
+/**
+ * \brief Test if a router may be found to be a stub node by its SPF
+ * calculation, that is if it has at most one link to another router.
+ *
+ * \param lsa the router LSA
+ * \returns true if the router may be a stub node
+ */
+static bool
+MayBeStubNode (GlobalRoutingLSA *lsa)
+{
+  uint32_t transits = 0;
+  for (uint32_t i = 0; i < lsa->GetNLinkRecords (); i++)
+    {
+      GlobalRoutingLinkRecord::LinkType type = lsa->GetLinkRecord (i)->GetLinkType ();
+      if (type == GlobalRoutingLinkRecord::TransitNetwork || type == GlobalRoutingLinkRecord::PointToPoint)
+        {
+          transits++;
+        }
+    }
+  return transits <= 1;
+}
+
+void
+GlobalRouteManagerImpl::RecomputeRoutes ()
+{
+  NS_LOG_FUNCTION (this);
+  BooleanValue incremental;
+  g_incrementalRecompute.GetValue (incremental);
+  if (!incremental.Get () || m_results.empty ())
+    {
+      DeleteGlobalRoutes ();
+      BuildGlobalRoutingDatabase ();
+      InitializeRoutes ();
+      return;
+    }
+//
+// Build the new database next to the one the current routes were computed
+// from, and find the LSAs which changed.
+//
+  LSDBDiff diff;
+  diff.oldLsdb = m_lsdb;
+  m_lsdb = new GlobalRouteManagerLSDB ();
+  BuildGlobalRoutingDatabase ();
+  m_lsdb->Initialize ();
+  for (uint32_t i = 0; i < m_lsdb->GetNVertices (); i++)
+    {
+      GlobalRoutingLSA *lsa = m_lsdb->GetVertexLSA (i);
+      uint32_t oldIndex = diff.oldLsdb->GetVertexIndex (lsa->GetLinkStateId ());
+      diff.oldIndices.push_back (oldIndex);
+      GlobalRoutingLSA *oldLsa = 0;
+      if (oldIndex != GlobalRouteManagerLSDB::NO_VERTEX)
+        {
+          oldLsa = diff.oldLsdb->GetVertexLSA (oldIndex);
+          if (IsSameLSA (oldLsa, lsa))
+            {
+              continue;
+            }
+        }
+      LSAChange change;
+      change.oldLsa = oldLsa;
+      change.newLsa = lsa;
+      diff.changes.push_back (change);
+    }
+  for (uint32_t i = 0; i < diff.oldLsdb->GetNVertices (); i++)
+    {
+      GlobalRoutingLSA *oldLsa = diff.oldLsdb->GetVertexLSA (i);
+      if (m_lsdb->GetVertexIndex (oldLsa->GetLinkStateId ()) == GlobalRouteManagerLSDB::NO_VERTEX)
+        {
+          LSAChange change;
+          change.oldLsa = oldLsa;
+          change.newLsa = 0;
+          diff.changes.push_back (change);
+        }
+    }
+  std::vector<bool> matched (m_lsdb->GetNumExtLSAs (), false);
+  for (uint32_t i = 0; i < diff.oldLsdb->GetNumExtLSAs (); i++)
+    {
+      GlobalRoutingLSA *oldLsa = diff.oldLsdb->GetExtLSA (i);
+      bool found = false;
+      for (uint32_t j = 0; j < m_lsdb->GetNumExtLSAs () && !found; j++)
+        {
+          if (!matched[j] && IsSameExternal (oldLsa, m_lsdb->GetExtLSA (j)))
+            {
+              matched[j] = true;
+              found = true;
+            }
+        }
+      if (!found)
+        {
+          diff.withdrawn.push_back (oldLsa);
+        }
+    }
+  for (uint32_t j = 0; j < m_lsdb->GetNumExtLSAs (); j++)
+    {
+      if (!matched[j])
+        {
+          diff.advertised.push_back (m_lsdb->GetExtLSA (j));
+        }
+    }
+  NS_LOG_INFO (diff.changes.size () << " LSAs and " <<
+               diff.withdrawn.size () + diff.advertised.size () << " external LSAs changed");
+//
+// Routers which may be stub nodes, or had no shortest paths yet, compute
+// their routes from scratch.  The others run their SPF calculation again
+// without a routing table if their shortest paths may have changed, and
+// patch their routes.
+//
+  SPFRootQueue queue;
+  queue.next = 0;
+  std::vector<SPFRoot> roots;
+  CollectSPFRoots (roots);
+  m_results.resize (NodeList::GetNNodes ());
+  std::vector<SPFResult> newResults (roots.size ());
+  std::vector<bool> isRoot (m_results.size (), false);
+  uint32_t nRecomputed = 0;
+  for (uint32_t i = 0; i < roots.size (); i++)
+    {
+      SPFRoot &root = roots[i];
+      SPFResult &result = m_results[root.nodeId];
+      isRoot[root.nodeId] = true;
+      if (!result.computed || result.stub || MayBeStubNode (m_lsdb->GetLSA (root.routerId)))
+        {
+          DeleteRoutes (root.routing);
+          root.result = &result;
+          queue.roots.push_back (root);
+          nRecomputed++;
+        }
+      else if (IsSPFTreeChanged (root, result, diff))
+        {
+          SPFRoot dry = root;
+          dry.routing = 0;
+          dry.result = &newResults[i];
+          queue.roots.push_back (dry);
+        }
+      else
+        {
+          RenumberPaths (result, diff, newResults[i]);
+        }
+    }
+  NS_LOG_INFO ("Recomputing the routes of " << nRecomputed << " routers, the shortest paths of " <<
+               queue.roots.size () - nRecomputed << " and patching " << roots.size () - nRecomputed);
+  RunSPFQueue (queue);
+  for (uint32_t i = 0; i < roots.size (); i++)
+    {
+      if (roots[i].result == 0)
+        {
+          PatchRoutes (roots[i], m_results[roots[i].nodeId], newResults[i], diff);
+        }
+    }
+//
+// Routers which no longer have any LSA have no routes.
+//
+  for (uint32_t i = 0; i < m_results.size (); i++)
+    {
+      if (!isRoot[i] && m_results[i].computed)
+        {
+          Ptr<GlobalRouter> router = NodeList::GetNode (i)->GetObject<GlobalRouter> ();
+          if (router != 0)
+            {
+              DeleteRoutes (router->GetRoutingProtocol ());
+            }
+          m_results[i] = SPFResult ();
+        }
+    }
+  delete diff.oldLsdb;
+}
+
+bool
+GlobalRouteManagerImpl::IsSPFTreeChanged (const SPFRoot &root, const SPFResult &result,
+                                          const LSDBDiff &diff) const
+{
+  NS_LOG_FUNCTION (this << root.routerId);
+//
+// The next hops are found in the LSAs of the router, of its neighbors and
+// of the routers on its transit networks, so that any change there is a
+// change of the shortest paths.
+//
+  std::vector<Ipv4Address> near;
+  near.push_back (root.routerId);
+  std::vector<SPFLink> links;
+  std::vector<SPFLink> networkLinks;
+  GetSPFLinks (diff.oldLsdb, root.routerId, links);
+  for (uint32_t i = 0; i < links.size (); i++)
+    {
+      near.push_back (links[i].target);
+      GetSPFLinks (diff.oldLsdb, links[i].target, networkLinks);
+      for (uint32_t j = 0; j < networkLinks.size (); j++)
+        {
+          near.push_back (networkLinks[j].target);
+        }
+      GetSPFLinks (m_lsdb, links[i].target, networkLinks);
+      for (uint32_t j = 0; j < networkLinks.size (); j++)
+        {
+          near.push_back (networkLinks[j].target);
+        }
+    }
+  std::vector<SPFLink> newLinks;
+  std::vector<SPFLink> changed;
+  for (uint32_t i = 0; i < diff.changes.size (); i++)
+    {
+      const LSAChange &change = diff.changes[i];
+      Ipv4Address id = change.oldLsa ? change.oldLsa->GetLinkStateId () : change.newLsa->GetLinkStateId ();
+      if (std::find (near.begin (), near.end (), id) != near.end ())
+        {
+          NS_LOG_LOGIC ("LSA " << id << " changed near router " << root.routerId);
+          return true;
+        }
+      uint32_t index = diff.oldLsdb->GetVertexIndex (id);
+      uint32_t distance = index == GlobalRouteManagerLSDB::NO_VERTEX ? SPF_INFINITY : result.paths[index].distance;
+      GetSPFLinks (diff.oldLsdb, id, links);
+      GetSPFLinks (m_lsdb, id, newLinks);
+//
+// A removed link matters if it was on a shortest path, in either direction.
+//
+      GetSPFLinksDifference (links, newLinks, changed);
+      for (uint32_t j = 0; j < changed.size (); j++)
+        {
+          uint32_t target = diff.oldLsdb->GetVertexIndex (changed[j].target);
+          uint32_t targetDistance = result.paths[target].distance;
+          if (distance == SPF_INFINITY || targetDistance == SPF_INFINITY)
+            {
+              continue;
+            }
+          uint32_t reverse = GetSPFLinkMetric (diff.oldLsdb, changed[j].target, id);
+          if (distance + changed[j].metric == targetDistance
+              || (reverse != SPF_INFINITY && targetDistance + reverse == distance))
+            {
+              NS_LOG_LOGIC ("Shortest path link " << id << " - " << changed[j].target <<
+                            " changed for router " << root.routerId);
+              return true;
+            }
+        }
+//
+// An added link matters if it is as short as the shortest path between
+// its ends, in either direction.
+//
+      GetSPFLinksDifference (newLinks, links, changed);
+      for (uint32_t j = 0; j < changed.size (); j++)
+        {
+          uint32_t target = diff.oldLsdb->GetVertexIndex (changed[j].target);
+          uint32_t targetDistance = target == GlobalRouteManagerLSDB::NO_VERTEX ? SPF_INFINITY : result.paths[target].distance;
+          uint32_t reverse = GetSPFLinkMetric (m_lsdb, changed[j].target, id);
+          if ((distance != SPF_INFINITY
+               && (targetDistance == SPF_INFINITY || distance + changed[j].metric <= targetDistance))
+              || (targetDistance != SPF_INFINITY && reverse != SPF_INFINITY
+                  && (distance == SPF_INFINITY || targetDistance + reverse <= distance)))
+            {
+              NS_LOG_LOGIC ("Shorter link " << id << " - " << changed[j].target <<
+                            " for router " << root.routerId);
+              return true;
+            }
+        }
+    }
+  return false;
+}
+
+void
+GlobalRouteManagerImpl::RenumberPaths (const SPFResult &result, const LSDBDiff &diff,
+                                       SPFResult &newResult) const
+{
+  NS_LOG_FUNCTION (this);
+  newResult.computed = true;
+  newResult.stub = false;
+  newResult.paths.assign (m_lsdb->GetNVertices (), SPFResult::Path ());
+  for (uint32_t i = 0; i < newResult.paths.size (); i++)
+    {
+      if (diff.oldIndices[i] != GlobalRouteManagerLSDB::NO_VERTEX)
+        {
+          newResult.paths[i] = result.paths[diff.oldIndices[i]];
+        }
+    }
+  newResult.exits = result.exits;
+}
+
+bool
+GlobalRouteManagerImpl::IsSamePath (const SPFResult::Path &a, const std::vector<SPFVertex::NodeExit_t> &aExits,
+                                    const SPFResult::Path &b, const std::vector<SPFVertex::NodeExit_t> &bExits)
+{
+  if (a.distance != b.distance || a.nExits != b.nExits)
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < a.nExits; i++)
+    {
+      if (aExits[a.firstExit + i] != bExits[b.firstExit + i])
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+GlobalRouteManagerImpl::PatchRoutes (const SPFRoot &root, SPFResult &result, SPFResult &newResult,
+                                     const LSDBDiff &diff)
+{
+  NS_LOG_FUNCTION (this << root.routerId);
+  std::vector<bool> changed (m_lsdb->GetNVertices (), false);
+  for (uint32_t i = 0; i < diff.changes.size (); i++)
+    {
+      if (diff.changes[i].newLsa)
+        {
+          changed[m_lsdb->GetVertexIndex (diff.changes[i].newLsa->GetLinkStateId ())] = true;
+        }
+    }
+//
+// Replace the routes to the vertices whose path or LSA changed.  The router
+// itself has no route to its own hosts and networks.
+//
+  RouteSet removed;
+  RouteSet added;
+  std::vector<bool> pathChanged (m_lsdb->GetNVertices (), false);
+  for (uint32_t i = 0; i < m_lsdb->GetNVertices (); i++)
+    {
+      GlobalRoutingLSA *lsa = m_lsdb->GetVertexLSA (i);
+      if (lsa->GetLinkStateId () == root.routerId)
+        {
+          continue;
+        }
+      const SPFResult::Path &newPath = newResult.paths[i];
+      uint32_t oldIndex = diff.oldIndices[i];
+      if (oldIndex != GlobalRouteManagerLSDB::NO_VERTEX)
+        {
+          const SPFResult::Path &oldPath = result.paths[oldIndex];
+          pathChanged[i] = !IsSamePath (oldPath, result.exits, newPath, newResult.exits);
+          if (!pathChanged[i] && !changed[i])
+            {
+              continue;
+            }
+          if (oldPath.distance != SPF_INFINITY)
+            {
+              GetLSARoutes (diff.oldLsdb->GetVertexLSA (oldIndex), result, oldPath, removed);
+            }
+        }
+      else
+        {
+          pathChanged[i] = true;
+        }
+      if (newPath.distance != SPF_INFINITY)
+        {
+          GetLSARoutes (lsa, newResult, newPath, added);
+        }
+    }
+  for (uint32_t i = 0; i < diff.changes.size (); i++)
+    {
+      const LSAChange &change = diff.changes[i];
+      if (change.newLsa || change.oldLsa->GetLinkStateId () == root.routerId)
+        {
+          continue;
+        }
+      const SPFResult::Path &oldPath = result.paths[diff.oldLsdb->GetVertexIndex (change.oldLsa->GetLinkStateId ())];
+      if (oldPath.distance != SPF_INFINITY)
+        {
+          GetLSARoutes (change.oldLsa, result, oldPath, removed);
+        }
+    }
+//
+// Replace the external routes which are withdrawn, advertised, or whose
+// advertising router has a new path.
+//
+  for (uint32_t i = 0; i < diff.oldLsdb->GetNumExtLSAs (); i++)
+    {
+      GlobalRoutingLSA *extlsa = diff.oldLsdb->GetExtLSA (i);
+      Ipv4Address adv = extlsa->GetAdvertisingRouter ();
+      uint32_t oldIndex = diff.oldLsdb->GetVertexIndex (adv);
+      if (adv == root.routerId || oldIndex == GlobalRouteManagerLSDB::NO_VERTEX
+          || diff.oldLsdb->GetVertexLSA (oldIndex)->GetLSType () != GlobalRoutingLSA::RouterLSA
+          || result.paths[oldIndex].distance == SPF_INFINITY)
+        {
+          continue;
+        }
+      uint32_t index = m_lsdb->GetVertexIndex (adv);
+      if (index == GlobalRouteManagerLSDB::NO_VERTEX || pathChanged[index]
+          || std::find (diff.withdrawn.begin (), diff.withdrawn.end (), extlsa) != diff.withdrawn.end ())
+        {
+          GetExternalRoutes (extlsa, result, result.paths[oldIndex], removed);
+        }
+    }
+  for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs (); i++)
+    {
+      GlobalRoutingLSA *extlsa = m_lsdb->GetExtLSA (i);
+      Ipv4Address adv = extlsa->GetAdvertisingRouter ();
+      uint32_t index = m_lsdb->GetVertexIndex (adv);
+      if (adv == root.routerId || index == GlobalRouteManagerLSDB::NO_VERTEX
+          || m_lsdb->GetVertexLSA (index)->GetLSType () != GlobalRoutingLSA::RouterLSA
+          || newResult.paths[index].distance == SPF_INFINITY)
+        {
+          continue;
+        }
+      if (pathChanged[index]
+          || std::find (diff.advertised.begin (), diff.advertised.end (), extlsa) != diff.advertised.end ())
+        {
+          GetExternalRoutes (extlsa, newResult, newResult.paths[index], added);
+        }
+    }
+
+  Ptr<Ipv4GlobalRouting> gr = root.routing;
+  gr->RemoveHostRoutes (removed.host);
+  gr->RemoveNetworkRoutes (removed.network);
+  gr->RemoveASExternalRoutes (removed.external);
+  for (uint32_t i = 0; i < added.host.size (); i++)
+    {
+      const Ipv4RoutingTableEntry &route = added.host[i];
+      gr->AddHostRouteTo (route.GetDest (), route.GetGateway (), route.GetInterface ());
+    }
+  for (uint32_t i = 0; i < added.network.size (); i++)
+    {
+      const Ipv4RoutingTableEntry &route = added.network[i];
+      gr->AddNetworkRouteTo (route.GetDestNetwork (), route.GetDestNetworkMask (),
+                             route.GetGateway (), route.GetInterface ());
+    }
+  for (uint32_t i = 0; i < added.external.size (); i++)
+    {
+      const Ipv4RoutingTableEntry &route = added.external[i];
+      gr->AddASExternalRouteTo (route.GetDestNetwork (), route.GetDestNetworkMask (),
+                                route.GetGateway (), route.GetInterface ());
+    }
+  NS_LOG_LOGIC ("Router " << root.routerId << " replaced " << removed.host.size () + removed.network.size () +
+                removed.external.size () << " routes by " << added.host.size () + added.network.size () +
+                added.external.size ());
+
+  result.paths.swap (newResult.paths);
+  result.exits.swap (newResult.exits);
+  newResult = SPFResult ();
+}
+
 void
-GlobalRouteManagerImpl::InitializeRoutes ()
+GlobalRouteManagerImpl::GetLSARoutes (GlobalRoutingLSA *lsa, const SPFResult &result,
+                                      const SPFResult::Path &path, RouteSet &routes)
 {
-  NS_LOG_FUNCTION (this);
-//
-// Walk the list of nodes in the system.
-//
-  NS_LOG_INFO ("About to start SPF calculation");
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+  NS_LOG_FUNCTION (lsa);
+  for (uint32_t i = path.firstExit; i < path.firstExit + path.nExits; i++)
     {
-      Ptr<Node> node = *i;
-//
-// Look for the GlobalRouter interface that indicates that the node is
-// participating in routing.
-//
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      uint32_t systemId = MpiInterface::GetSystemId ();
-      // Ignore nodes that are not assigned to our systemId (distributed sim)
-      if (node->GetSystemId () != systemId) 
+      Ipv4Address nextHop = result.exits[i].first;
+      int32_t outIf = result.exits[i].second;
+      if (outIf < 0)
+        {
+          continue;
+        }
+      if (lsa->GetLSType () == GlobalRoutingLSA::NetworkLSA)
         {
+          // as SPFIntraAddTransit ()
+          Ipv4Mask mask = lsa->GetNetworkLSANetworkMask ();
+          Ipv4Address network = lsa->GetLinkStateId ().CombineMask (mask);
+          routes.network.push_back (Ipv4RoutingTableEntry::CreateNetworkRouteTo (network, mask, nextHop, outIf));
           continue;
         }
+      for (uint32_t j = 0; j < lsa->GetNLinkRecords (); j++)
+        {
+          GlobalRoutingLinkRecord *l = lsa->GetLinkRecord (j);
+          if (l->GetLinkType () == GlobalRoutingLinkRecord::PointToPoint)
+            {
+              // as SPFIntraAddRouter ()
+              routes.host.push_back (Ipv4RoutingTableEntry::CreateHostRouteTo (l->GetLinkData (), nextHop, outIf));
+            }
+          else if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
+            {
+              // as SPFIntraAddStub ()
+              Ipv4Mask mask (l->GetLinkData ().Get ());
+              Ipv4Address network = l->GetLinkId ().CombineMask (mask);
+              routes.network.push_back (Ipv4RoutingTableEntry::CreateNetworkRouteTo (network, mask, nextHop, outIf));
+            }
+        }
+    }
+}
 
-//
-// if the node has a global router interface, then run the global routing
-// algorithms.
-//
-      if (rtr && rtr->GetNumLSAs () )
+void
+GlobalRouteManagerImpl::GetExternalRoutes (GlobalRoutingLSA *extlsa, const SPFResult &result,
+                                           const SPFResult::Path &path, RouteSet &routes)
+{
+  NS_LOG_FUNCTION (extlsa);
+  // as SPFAddASExternal ()
+  Ipv4Mask mask = extlsa->GetNetworkLSANetworkMask ();
+  Ipv4Address network = extlsa->GetLinkStateId ().CombineMask (mask);
+  for (uint32_t i = path.firstExit; i < path.firstExit + path.nExits; i++)
+    {
+      int32_t outIf = result.exits[i].second;
+      if (outIf >= 0)
         {
-          SPFCalculate (rtr->GetRouterId ());
+          routes.external.push_back (Ipv4RoutingTableEntry::CreateNetworkRouteTo (network, mask, result.exits[i].first, outIf));
         }
     }
-  NS_LOG_INFO ("Finished SPF calculation");
 }
 
 //
@@ -750,36 +1725,33 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 
   SPFVertex* w = 0;
   GlobalRoutingLSA* w_lsa = 0;
+  uint32_t w_index = 0;
   GlobalRoutingLinkRecord *l = 0;
   uint32_t distance = 0;
-  uint32_t numRecordsInVertex = 0;
 //
 // V points to a Router-LSA or Network-LSA
-// Loop over the links in router LSA or attached routers in Network LSA
+// Loop over the links in router LSA or attached routers in Network LSA,
+// which are the edges of V in the graph of the LSDB.
 //
-  if (v->GetVertexType () == SPFVertex::VertexRouter)
-    {
-      numRecordsInVertex = v->GetLSA ()->GetNLinkRecords (); 
-    }
-  if (v->GetVertexType () == SPFVertex::VertexNetwork)
-    {
-      numRecordsInVertex = v->GetLSA ()->GetNAttachedRouters (); 
-    }
+  uint32_t firstEdge = m_lsdb->GetFirstEdge (v->GetLSAIndex ());
+  uint32_t lastEdge = m_lsdb->GetFirstEdge (v->GetLSAIndex () + 1);
 
-  for (uint32_t i = 0; i < numRecordsInVertex; i++)
+  for (uint32_t i = firstEdge; i < lastEdge; i++)
     {
+      const GlobalRouteManagerLSDB::Edge &edge = m_lsdb->GetEdge (i);
+      w_index = edge.target;
 // Get w_lsa:  In case of V is Router-LSA
       if (v->GetVertexType () == SPFVertex::VertexRouter) 
         {
-          NS_LOG_LOGIC ("Examining link " << i << " of " << 
+          NS_LOG_LOGIC ("Examining link " << i - firstEdge << " of " << 
                         v->GetVertexId () << "'s " <<
-                        v->GetLSA ()->GetNLinkRecords () << " link records");
+                        lastEdge - firstEdge << " link records");
 //
 // (a) If this is a link to a stub network, examine the next link in V's LSA.
 // Links to stub networks will be considered in the second stage of the
 // shortest path calculation.
 //
-          l = v->GetLSA ()->GetLinkRecord (i);
+          l = edge.record;
           NS_ASSERT (l != 0);
           if (l->GetLinkType () == GlobalRoutingLinkRecord::StubNetwork)
             {
@@ -797,16 +1769,16 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // Lookup the link state advertisement of the new link -- we call it <w> in
 // the link state database.
 //
-              w_lsa = m_lsdb->GetLSA (l->GetLinkId ());
-              NS_ASSERT (w_lsa);
+              NS_ASSERT (w_index != GlobalRouteManagerLSDB::NO_VERTEX);
+              w_lsa = m_lsdb->GetVertexLSA (w_index);
               NS_LOG_LOGIC ("Found a P2P record from " << 
                             v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
             }
           else if (l->GetLinkType () == 
                    GlobalRoutingLinkRecord::TransitNetwork)
             {
-              w_lsa = m_lsdb->GetLSA (l->GetLinkId ());
-              NS_ASSERT (w_lsa);
+              NS_ASSERT (w_index != GlobalRouteManagerLSDB::NO_VERTEX);
+              w_lsa = m_lsdb->GetVertexLSA (w_index);
               NS_LOG_LOGIC ("Found a Transit record from " << 
                             v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
             }
@@ -818,12 +1790,11 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // Get w_lsa:  In case of V is Network-LSA
       if (v->GetVertexType () == SPFVertex::VertexNetwork) 
         {
-          w_lsa = m_lsdb->GetLSAByLinkData 
-              (v->GetLSA ()->GetAttachedRouter (i));
-          if (!w_lsa)
+          if (w_index == GlobalRouteManagerLSDB::NO_VERTEX)
             {
               continue;
             }
+          w_lsa = m_lsdb->GetVertexLSA (w_index);
           NS_LOG_LOGIC ("Found a Network LSA from " << 
                         v->GetVertexId () << " to " << w_lsa->GetLinkStateId ());
         }
@@ -836,7 +1807,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // If the link is to a router that is already in the shortest path first tree
 // then we have it covered -- ignore it.
 //
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
+      if (m_status[w_index] == GlobalRoutingLSA::LSA_SPF_IN_SPFTREE) 
         {
           NS_LOG_LOGIC ("Skipping ->  LSA "<< 
                         w_lsa->GetLinkStateId () << " already in SPF tree");
@@ -861,7 +1832,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
       NS_LOG_LOGIC ("Considering w_lsa " << w_lsa->GetLinkStateId ());
 
 // Is there already vertex w in candidate list?
-      if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
+      if (m_status[w_index] == GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED)
         {
 // Calculate nexthop to w
 // We need to figure out how to actually get to the new router represented
@@ -871,9 +1842,11 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 
 // prepare vertex w
           w = new SPFVertex (w_lsa);
+          w->SetLSAIndex (w_index);
           if (SPFNexthopCalculation (v, w, l, distance))
             {
-              w_lsa->SetStatus (GlobalRoutingLSA::LSA_SPF_CANDIDATE);
+              m_status[w_index] = GlobalRoutingLSA::LSA_SPF_CANDIDATE;
+              m_candidates[w_index] = w;
 //
 // Push this new vertex onto the priority queue (ordered by distance from the
 // root node).
@@ -888,7 +1861,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
             NS_ASSERT_MSG (0, "SPFNexthopCalculation never " 
                            << "return false, but it does now!");
         }
-      else if (w_lsa->GetStatus () == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
+      else if (m_status[w_index] == GlobalRoutingLSA::LSA_SPF_CANDIDATE)
         {
 //
 // We have already considered the link represented by <w>.  What wse have to
@@ -904,7 +1877,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 * if we've found a shorter path.
 */
           SPFVertex* cw;
-          cw = candidate.Find (w_lsa->GetLinkStateId ());
+          cw = m_candidates[w_index];
           if (cw->GetDistanceFromRoot () < distance)
             {
 //
@@ -935,6 +1908,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 
 // prepare vertex w
               w = new SPFVertex (w_lsa);
+              w->SetLSAIndex (w_index);
               SPFNexthopCalculation (v, w, l, distance);
               cw->MergeRootExitDirections (w);
               cw->MergeParent (w);
@@ -960,7 +1934,7 @@ GlobalRouteManagerImpl::SPFNext (SPFVertex* v, CandidateQueue& candidate)
 // If we've changed the cost to get to the vertex represented by <w>, we 
 // must reorder the priority queue keyed to that cost.
 //
-                  candidate.Reorder ();
+                  candidate.Reorder (cw);
                 }
             } // new lower cost path found
         } // end W is already on the candidate list
@@ -1247,7 +2221,8 @@ void
 GlobalRouteManagerImpl::DebugSPFCalculate (Ipv4Address root)
 {
   NS_LOG_FUNCTION (this << root);
-  SPFCalculate (root);
+  m_lsdb->Initialize ();
+  SPFCalculate (FindSPFRoot (root));
 }
 
 //
@@ -1320,9 +2295,7 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
               if (lr->GetLinkId () == myRouterId)
                 {
                   // Next hop is stored in the LinkID field of lr
-                  Ptr<GlobalRouter> router = rlsa->GetNode ()->GetObject<GlobalRouter> ();
-                  NS_ASSERT (router);
-                  Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
+                  Ptr<Ipv4GlobalRouting> gr = m_spfrootRouter.routing;
                   NS_ASSERT (gr);
                   gr->AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), lr->GetLinkData (), 
                                          FindOutgoingInterfaceId (transitLink->GetLinkData ()));
@@ -1339,15 +2312,28 @@ GlobalRouteManagerImpl::CheckForStubNode (Ipv4Address root)
 
 // quagga ospf_spf_calculate
 void
-GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
+GlobalRouteManagerImpl::SPFCalculate (const SPFRoot &router)
 {
+  Ipv4Address root = router.routerId;
   NS_LOG_FUNCTION (this << root);
 
   SPFVertex *v;
 //
-// Initialize the Link State Database.
+// Initialize the status of the LSAs.  It is kept here rather than in the
+// Link State Database, which SPF calculations of other roots may be
+// reading concurrently.
 //
-  m_lsdb->Initialize ();
+  m_status.assign (m_lsdb->GetNVertices (), GlobalRoutingLSA::LSA_SPF_NOT_EXPLORED);
+  m_candidates.assign (m_lsdb->GetNVertices (), 0);
+  m_spfrootRouter = router;
+  SPFResult *result = router.result;
+  if (result)
+    {
+      result->computed = true;
+      result->stub = false;
+      result->paths.assign (m_lsdb->GetNVertices (), SPFResult::Path ());
+      result->exits.clear ();
+    }
 //
 // The candidate queue is a priority queue of SPFVertex objects, with the top
 // of the queue being the closest vertex in terms of distance from the root
@@ -1360,14 +2346,22 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // calculation.  Each router (and corresponding network) is a vertex in the
 // shortest path first (SPF) tree.
 //
-  v = new SPFVertex (m_lsdb->GetLSA (root));
+  uint32_t rootIndex = m_lsdb->GetVertexIndex (root);
+  NS_ASSERT_MSG (rootIndex != GlobalRouteManagerLSDB::NO_VERTEX,
+                 "GlobalRouteManagerImpl::SPFCalculate (): No LSA for root " << root);
+  v = new SPFVertex (m_lsdb->GetVertexLSA (rootIndex));
+  v->SetLSAIndex (rootIndex);
 // 
 // This vertex is the root of the SPF tree and it is distance 0 from the root.
 // We also mark this vertex as being in the SPF tree.
 //
   m_spfroot= v;
   v->SetDistanceFromRoot (0);
-  v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+  m_status[rootIndex] = GlobalRoutingLSA::LSA_SPF_IN_SPFTREE;
+  if (result)
+    {
+      result->paths[rootIndex].distance = 0;
+    }
   NS_LOG_LOGIC ("Starting SPFCalculate for node " << root);
 
 //
@@ -1377,10 +2371,17 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // reached.  Instead, short-circuit this computation and just install
 // a default route in the CheckForStubNode() method.
 //
-  if (NodeList::GetNNodes () > 0 && CheckForStubNode (root))
+  if (m_spfrootRouter.routing != 0 && CheckForStubNode (root))
     {
       NS_LOG_LOGIC ("SPFCalculate truncated for stub node " << root);
+      if (result)
+        {
+          result->stub = true;
+          result->paths.clear ();
+        }
       delete m_spfroot;
+      m_spfroot = 0;
+      m_spfrootRouter = SPFRoot ();
       return;
     }
 
@@ -1428,7 +2429,22 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 // Update the status field of the vertex to indicate that it is in the SPF
 // tree.
 //
-      v->GetLSA ()->SetStatus (GlobalRoutingLSA::LSA_SPF_IN_SPFTREE);
+      m_status[v->GetLSAIndex ()] = GlobalRoutingLSA::LSA_SPF_IN_SPFTREE;
+//
+// Its distance and exit directions are final, keep them if the routes are
+// to be updated incrementally.
+//
+      if (result)
+        {
+          SPFResult::Path &path = result->paths[v->GetLSAIndex ()];
+          path.distance = v->GetDistanceFromRoot ();
+          path.firstExit = result->exits.size ();
+          path.nExits = v->GetNRootExitDirections ();
+          for (uint32_t i = 0; i < path.nExits; i++)
+            {
+              result->exits.push_back (v->GetRootExitDirection (i));
+            }
+        }
 //
 // The current vertex has a parent pointer.  By calling this rather oddly 
 // named method (blame quagga) we add the current vertex to the list of 
@@ -1485,14 +2501,17 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 
     }  // end for loop
 
-// Second stage of SPF calculation procedure
-  SPFProcessStubs (m_spfroot);
-  for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs (); i++)
+// Second stage of SPF calculation procedure, which only adds routes
+  if (m_spfrootRouter.routing != 0)
     {
-      m_spfroot->ClearVertexProcessed ();
-      GlobalRoutingLSA *extlsa = m_lsdb->GetExtLSA (i);
-      NS_LOG_LOGIC ("Processing External LSA with id " << extlsa->GetLinkStateId ());
-      ProcessASExternals (m_spfroot, extlsa);
+      SPFProcessStubs (m_spfroot);
+      for (uint32_t i = 0; i < m_lsdb->GetNumExtLSAs (); i++)
+        {
+          m_spfroot->ClearVertexProcessed ();
+          GlobalRoutingLSA *extlsa = m_lsdb->GetExtLSA (i);
+          NS_LOG_LOGIC ("Processing External LSA with id " << extlsa->GetLinkStateId ());
+          ProcessASExternals (m_spfroot, extlsa);
+        }
     }
 
 //
@@ -1502,6 +2521,7 @@ GlobalRouteManagerImpl::SPFCalculate (Ipv4Address root)
 //
   delete m_spfroot;
   m_spfroot = 0;
+  m_spfrootRouter = SPFRoot ();
 }
 
 void
@@ -1560,58 +2580,30 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
 //
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
+// The node that has the router ID corresponding to the root vertex was looked
+// up before the SPF calculation.  This is the one we're going to write the
+// routing information to.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Ipv4GlobalRouting> gr = m_spfrootRouter.routing;
+  if (gr == 0)
     {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
-
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+      NS_LOG_LOGIC ("No node with router ID " << routerId);
+      return;
+    }
+  uint32_t nodeId = m_spfrootRouter.nodeId;
+  NS_LOG_LOGIC ("Setting routes for node " << nodeId);
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = extlsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = extlsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = extlsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
 
 //
 // Here's why we did all of that work.  We're going to add a host route to the
@@ -1626,39 +2618,29 @@ GlobalRouteManagerImpl::SPFAddASExternal (GlobalRoutingLSA *extlsa, SPFVertex *v
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add external network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
+        {
+          gr->AddASExternalRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << nodeId <<
+                        " add external network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << nodeId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 
@@ -1721,68 +2703,34 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 //
 // The root of the Shortest Path First tree is the router to which we are 
 // going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// to this router has a vertex ID which is the router ID of that node.  The
+// node with this router ID, which is the one we're actually going to update,
+// was looked up before the SPF calculation.
 //
   Ipv4Address routerId = m_spfroot->GetVertexId ();
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
-    {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to QI for that interface.  If there's no GlobalRouter interface, the node
-// in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
 
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to QI
-// for that interface.  If the node is acting as an IP version 4 router, it
-// should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "QI for <Ipv4> interface failed");
+  Ptr<Ipv4GlobalRouting> gr = m_spfrootRouter.routing;
+  if (gr == 0)
+    {
+      NS_LOG_LOGIC ("No node with router ID " << routerId);
+      return;
+    }
+  uint32_t nodeId = m_spfrootRouter.nodeId;
+  NS_LOG_LOGIC ("Setting routes for node " << nodeId);
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          NS_ASSERT_MSG (v->GetLSA (), 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask (l->GetLinkData ().Get ());
-          Ipv4Address tempip = l->GetLinkId ();
-          tempip = tempip.CombineMask (tempmask);
+  NS_ASSERT_MSG (v->GetLSA (), 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask (l->GetLinkData ().Get ());
+  Ipv4Address tempip = l->GetLinkId ();
+  tempip = tempip.CombineMask (tempmask);
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -1796,40 +2744,29 @@ GlobalRouteManagerImpl::SPFIntraAddStub (GlobalRoutingLinkRecord *l, SPFVertex*
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all next-hop-IPs and out-going-interfaces for reaching
-          // the stub network gateway 'v' from the root node
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative");
-                }
-            }
-          return;
-        } // if
-    } // for
+  // walk through all next-hop-IPs and out-going-interfaces for reaching
+  // the stub network gateway 'v' from the root node
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
+      if (outIf >= 0)
+        {
+          gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << nodeId <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << nodeId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative");
+        }
+    }
 }
 
 //
@@ -1846,68 +2783,35 @@ GlobalRouteManagerImpl::FindOutgoingInterfaceId (Ipv4Address a, Ipv4Mask amask)
 //
 // We have an IP address <a> and a vertex ID of the root of the SPF tree.
 // The question is what interface index does this address correspond to.
-// The answer is a little complicated since we have to find a pointer to
-// the node corresponding to the vertex ID, find the Ipv4 interface on that
-// node in order to iterate the interfaces and find the one corresponding to
-// the address in question.
-//
-  Ipv4Address routerId = m_spfroot->GetVertexId ();
-//
-// Walk the list of nodes in the system looking for the one corresponding to
-// the node at the root of the SPF tree.  This is the node for which we are
-// building the routing table.
+// The answer is a little complicated since we have to find the Ipv4
+// interface of the node corresponding to the vertex ID in order to iterate
+// the interfaces and find the one corresponding to the address in question.
+// The node, if any, was looked up before the SPF calculation started.
 //
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
+  Ptr<Ipv4> ipv4 = m_spfrootRouter.ipv4;
+  if (ipv4 == 0)
     {
-      Ptr<Node> node = *i;
-
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-//
-// If the node doesn't have a GlobalRouter interface it can't be the one
-// we're interested in.
-//
-      if (rtr == 0)
-        {
-          continue;
-        }
-
-      if (rtr->GetRouterId () == routerId)
-        {
 //
-// This is the node we're building the routing table for.  We're going to need
-// the Ipv4 interface to look for the ipv4 interface index.  Since this node
-// is participating in routing IP version 4 packets, it certainly must have 
-// an Ipv4 interface.
+// Couldn't find it.
 //
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::FindOutgoingInterfaceId (): "
-                         "GetObject for <Ipv4> interface failed");
+      NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << m_spfroot->GetVertexId ());
+      return -1;
+    }
 //
 // Look through the interfaces on this node for one that has the IP address
 // we're looking for.  If we find one, return the corresponding interface
 // index, or -1 if not found.
 //
-          int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
+  int32_t interface = ipv4->GetInterfaceForPrefix (a, amask);
 
 #if 0
-          if (interface < 0)
-            {
-              NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
-                              "Expected an interface associated with address a:" << a);
-            }
-#endif 
-          return interface;
-        }
+  if (interface < 0)
+    {
+      NS_FATAL_ERROR ("GlobalRouteManagerImpl::FindOutgoingInterfaceId(): "
+                      "Expected an interface associated with address a:" << a);
     }
-//
-// Couldn't find it.
-//
-  NS_LOG_LOGIC ("FindOutgoingInterfaceId():Can't find root node " << routerId);
-  return -1;
+#endif 
+  return interface;
 }
 
 //
@@ -1936,88 +2840,55 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 //
 // The root of the Shortest Path First tree is the router to which we are 
 // going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// to this router has a vertex ID which is the router ID of that node.  The
+// node with this router ID, which is the one we're actually going to update,
+// was looked up before the SPF calculation.
 //
   Ipv4Address routerId = m_spfroot->GetVertexId ();
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
-    {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
 
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("Setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "GetObject for <Ipv4> interface failed");
+  Ptr<Ipv4GlobalRouting> gr = m_spfrootRouter.routing;
+  if (gr == 0)
+    {
+      NS_LOG_LOGIC ("No node with router ID " << routerId);
+      return;
+    }
+  uint32_t nodeId = m_spfrootRouter.nodeId;
+  NS_LOG_LOGIC ("Setting routes for node " << nodeId);
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
-                         "Expected valid LSA in SPFVertex* v");
-
-          uint32_t nLinkRecords = lsa->GetNLinkRecords ();
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddRouter (): "
+                 "Expected valid LSA in SPFVertex* v");
 //
 // Iterate through the link records on the vertex to which we're going to add
 // routes.  To make sure we're being clear, we're going to add routing table
 // entries to the tables on the node corresping to the root of the SPF tree.
 // These entries will have routes to the IP addresses we find from looking at
 // the local side of the point-to-point links found on the node described by
-// the vertex <v>.
-//
-          NS_LOG_LOGIC (" Node " << node->GetId () <<
-                        " found " << nLinkRecords << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
-          for (uint32_t j = 0; j < nLinkRecords; ++j)
-            {
+// the vertex <v>.  The link records are the edges of <v> in the graph of the
+// LSDB.
+//
+  uint32_t firstEdge = m_lsdb->GetFirstEdge (v->GetLSAIndex ());
+  uint32_t lastEdge = m_lsdb->GetFirstEdge (v->GetLSAIndex () + 1);
+  NS_LOG_LOGIC (" Node " << nodeId <<
+                " found " << lastEdge - firstEdge << " link records in LSA " << lsa << "with LinkStateId "<< lsa->GetLinkStateId ());
+  for (uint32_t j = firstEdge; j < lastEdge; ++j)
+    {
 //
 // We are only concerned about point-to-point links
 //
-              GlobalRoutingLinkRecord *lr = lsa->GetLinkRecord (j);
-              if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
-                {
-                  continue;
-                }
+      GlobalRoutingLinkRecord *lr = m_lsdb->GetEdge (j).record;
+      if (lr->GetLinkType () != GlobalRoutingLinkRecord::PointToPoint)
+        {
+          continue;
+        }
 //
 // Here's why we did all of that work.  We're going to add a host route to the
 // host address found in the m_linkData field of the point-to-point link
@@ -2031,46 +2902,34 @@ GlobalRouteManagerImpl::SPFIntraAddRouter (SPFVertex* v)
 // Similarly, the vertex <v> has an m_rootOif (outbound interface index) to
 // which the packets should be send for forwarding.
 //
-              Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-              if (router == 0)
-                {
-                  continue;
-                }
-              Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-              NS_ASSERT (gr);
-              // walk through all available exit directions due to ECMP,
-              // and add host route for each of the exit direction toward
-              // the vertex 'v'
-              for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-                {
-                  SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-                  Ipv4Address nextHop = exit.first;
-                  int32_t outIf = exit.second;
-                  if (outIf >= 0)
-                    {
-                      gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
-                                          outIf);
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " adding host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " and outgoing interface " << outIf);
-                    }
-                  else
-                    {
-                      NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                    " NOT able to add host route to " << lr->GetLinkData () <<
-                                    " using next hop " << nextHop <<
-                                    " since outgoing interface id is negative " << outIf);
-                    }
-                } // for all routes from the root the vertex 'v'
+      // walk through all available exit directions due to ECMP,
+      // and add host route for each of the exit direction toward
+      // the vertex 'v'
+      for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+        {
+          SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+          Ipv4Address nextHop = exit.first;
+          int32_t outIf = exit.second;
+          if (outIf >= 0)
+            {
+              gr->AddHostRouteTo (lr->GetLinkData (), nextHop,
+                                  outIf);
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << nodeId <<
+                            " adding host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " and outgoing interface " << outIf);
             }
-//
-// Done adding the routes for the selected node.
-//
-          return;
-        }
+          else
+            {
+              NS_LOG_LOGIC ("(Route " << i << ") Node " << nodeId <<
+                            " NOT able to add host route to " << lr->GetLinkData () <<
+                            " using next hop " << nextHop <<
+                            " since outgoing interface id is negative " << outIf);
+            }
+        } // for all routes from the root the vertex 'v'
     }
 }
+
 void
 GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
 {
@@ -2081,103 +2940,60 @@ GlobalRouteManagerImpl::SPFIntraAddTransit (SPFVertex* v)
 //
 // The root of the Shortest Path First tree is the router to which we are 
 // going to write the actual routing table entries.  The vertex corresponding
-// to this router has a vertex ID which is the router ID of that node.  We're
-// going to use this ID to discover which node it is that we're actually going
-// to update.
+// to this router has a vertex ID which is the router ID of that node.  The
+// node with this router ID, which is the one we're actually going to update,
+// was looked up before the SPF calculation.
 //
   Ipv4Address routerId = m_spfroot->GetVertexId ();
 
   NS_LOG_LOGIC ("Vertex ID = " << routerId);
-//
-// We need to walk the list of nodes looking for the one that has the router
-// ID corresponding to the root vertex.  This is the one we're going to write
-// the routing information to.
-//
-  NodeList::Iterator i = NodeList::Begin (); 
-  NodeList::Iterator listEnd = NodeList::End ();
-  for (; i != listEnd; i++)
-    {
-      Ptr<Node> node = *i;
-//
-// The router ID is accessible through the GlobalRouter interface, so we need
-// to GetObject for that interface.  If there's no GlobalRouter interface, 
-// the node in question cannot be the router we want, so we continue.
-// 
-      Ptr<GlobalRouter> rtr = 
-        node->GetObject<GlobalRouter> ();
-
-      if (rtr == 0)
-        {
-          NS_LOG_LOGIC ("No GlobalRouter interface on node " << 
-                        node->GetId ());
-          continue;
-        }
-//
-// If the router ID of the current node is equal to the router ID of the 
-// root of the SPF tree, then this node is the one for which we need to 
-// write the routing tables.
-//
-      NS_LOG_LOGIC ("Considering router " << rtr->GetRouterId ());
 
-      if (rtr->GetRouterId () == routerId)
-        {
-          NS_LOG_LOGIC ("setting routes for node " << node->GetId ());
-//
-// Routing information is updated using the Ipv4 interface.  We need to 
-// GetObject for that interface.  If the node is acting as an IP version 4 
-// router, it should absolutely have an Ipv4 interface.
-//
-          Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-          NS_ASSERT_MSG (ipv4, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "GetObject for <Ipv4> interface failed");
+  Ptr<Ipv4GlobalRouting> gr = m_spfrootRouter.routing;
+  if (gr == 0)
+    {
+      NS_LOG_LOGIC ("No node with router ID " << routerId);
+      return;
+    }
+  uint32_t nodeId = m_spfrootRouter.nodeId;
+  NS_LOG_LOGIC ("setting routes for node " << nodeId);
 //
 // Get the Global Router Link State Advertisement from the vertex we're
 // adding the routes to.  The LSA will have a number of attached Global Router
 // Link Records corresponding to links off of that vertex / node.  We're going
 // to be interested in the records corresponding to point-to-point links.
 //
-          GlobalRoutingLSA *lsa = v->GetLSA ();
-          NS_ASSERT_MSG (lsa, 
-                         "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
-                         "Expected valid LSA in SPFVertex* v");
-          Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
-          Ipv4Address tempip = lsa->GetLinkStateId ();
-          tempip = tempip.CombineMask (tempmask);
-          Ptr<GlobalRouter> router = node->GetObject<GlobalRouter> ();
-          if (router == 0)
-            {
-              continue;
-            }
-          Ptr<Ipv4GlobalRouting> gr = router->GetRoutingProtocol ();
-          NS_ASSERT (gr);
-          // walk through all available exit directions due to ECMP,
-          // and add host route for each of the exit direction toward
-          // the vertex 'v'
-          for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
-            {
-              SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
-              Ipv4Address nextHop = exit.first;
-              int32_t outIf = exit.second;
+  GlobalRoutingLSA *lsa = v->GetLSA ();
+  NS_ASSERT_MSG (lsa, 
+                 "GlobalRouteManagerImpl::SPFIntraAddTransit (): "
+                 "Expected valid LSA in SPFVertex* v");
+  Ipv4Mask tempmask = lsa->GetNetworkLSANetworkMask ();
+  Ipv4Address tempip = lsa->GetLinkStateId ();
+  tempip = tempip.CombineMask (tempmask);
+  // walk through all available exit directions due to ECMP,
+  // and add host route for each of the exit direction toward
+  // the vertex 'v'
+  for (uint32_t i = 0; i < v->GetNRootExitDirections (); i++)
+    {
+      SPFVertex::NodeExit_t exit = v->GetRootExitDirection (i);
+      Ipv4Address nextHop = exit.first;
+      int32_t outIf = exit.second;
 
-              if (outIf >= 0)
-                {
-                  gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " via interface " << outIf);
-                }
-              else
-                {
-                  NS_LOG_LOGIC ("(Route " << i << ") Node " << node->GetId () <<
-                                " NOT able to add network route to " << tempip <<
-                                " using next hop " << nextHop <<
-                                " since outgoing interface id is negative " << outIf);
-                }
-            }
+      if (outIf >= 0)
+        {
+          gr->AddNetworkRouteTo (tempip, tempmask, nextHop, outIf);
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << nodeId <<
+                        " add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " via interface " << outIf);
         }
-    } 
+      else
+        {
+          NS_LOG_LOGIC ("(Route " << i << ") Node " << nodeId <<
+                        " NOT able to add network route to " << tempip <<
+                        " using next hop " << nextHop <<
+                        " since outgoing interface id is negative " << outIf);
+        }
+    }
 }
 
 // Derived from quagga ospf_vertex_add_parents ()
@@ -30,6 +30,7 @@
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/ipv4-routing-table-entry.h"
 #include "global-router-interface.h"
 
 namespace ns3 {
@@ -37,6 +38,7 @@ namespace ns3 {
 const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
 class CandidateQueue;
+class Ipv4;
 class Ipv4GlobalRouting;
 
 /**
@@ -201,6 +203,24 @@ public:
  */
   void SetLSA (GlobalRoutingLSA* lsa);
 
+/**
+ * @brief Get the index of the Global Router Link State Advertisement of
+ * this SPFVertex in the graph of the Link State Database.
+ *
+ * @see GlobalRouteManagerLSDB::GetVertexIndex ()
+ * @returns The index of the LSA.
+ */
+  uint32_t GetLSAIndex (void) const;
+
+/**
+ * @brief Set the index of the Global Router Link State Advertisement of
+ * this SPFVertex in the graph of the Link State Database.
+ *
+ * @see GlobalRouteManagerLSDB::GetVertexIndex ()
+ * @param index The index of the LSA.
+ */
+  void SetLSAIndex (uint32_t index);
+
 /**
  * @brief Get the distance from the root vertex to "this" SPFVertex object.
  *
@@ -527,6 +547,7 @@ private:
   VertexType m_vertexType; //!< Vertex type
   Ipv4Address m_vertexId; //!< Vertex ID
   GlobalRoutingLSA* m_lsa; //!< Link State Advertisement
+  uint32_t m_lsaIndex; //!< Index of the LSA in the graph of the LSDB
   uint32_t m_distanceFromRoot; //!< Distance from root node
   int32_t m_rootOif; //!< root Output Interface
   Ipv4Address m_nextHop; //!< next hop
@@ -536,6 +557,9 @@ private:
   ListOfSPFVertex_t m_parents; //!< parent list
   ListOfSPFVertex_t m_children; //!< Children list
   bool m_vertexProcessed; //!< Flag to note whether vertex has been processed in stage two of SPF computation
+  uint32_t m_candidateIndex; //!< Position of the vertex in the heap of a CandidateQueue
+
+  friend class CandidateQueue;
 
 /**
  * @brief The SPFVertex copy construction is disallowed.  There's no need for
@@ -643,15 +667,80 @@ public:
  * @brief Set all LSA flags to an initialized state, for SPF computation
  *
  * This function walks the database and resets the status flags of all of the
- * contained Link State Advertisements to LSA_SPF_NOT_EXPLORED.  This is done
- * prior to each SPF calculation to reset the state of the SPFVertex structures
- * that will reference the LSAs during the calculation.
+ * contained Link State Advertisements to LSA_SPF_NOT_EXPLORED, and builds the
+ * graph of the database that the SPF calculations walk.  This is done after
+ * the last LSA is inserted, prior to the SPF calculations.
  *
  * @see GlobalRoutingLSA
  * @see SPFVertex
  */
   void Initialize ();
 
+  /**
+   * @brief An edge of the graph of the Link State Database.
+   *
+   * The vertices of the graph are the router and network Link State
+   * Advertisements of the database.  The edges of a router LSA are its
+   * link records, and the edges of a network LSA are its attached routers,
+   * in the same order.
+   */
+  struct Edge
+  {
+    uint32_t target; //!< index of the LSA at the other end, or NO_VERTEX
+    GlobalRoutingLinkRecord *record; //!< link record of a router LSA, 0 for a network LSA
+  };
+
+  /**
+   * The target of the edges to stub networks, and to routers or networks
+   * which have no LSA in the database.
+   */
+  static const uint32_t NO_VERTEX = 0xffffffff;
+
+  /**
+   * @brief Get the number of vertices of the graph of the database.
+   *
+   * The graph is built by Initialize ().
+   *
+   * @returns The number of router and network LSAs.
+   */
+  uint32_t GetNVertices (void) const;
+
+  /**
+   * @brief Look up the index of the vertex of the LSA associated with the
+   * given link state ID (address).
+   *
+   * @param addr The IP address associated with the LSA.
+   * @returns The index of the LSA, or NO_VERTEX.
+   */
+  uint32_t GetVertexIndex (Ipv4Address addr) const;
+
+  /**
+   * @brief Get the LSA of a vertex of the graph of the database.
+   *
+   * @param index The index of the vertex.
+   * @returns The LSA.
+   */
+  GlobalRoutingLSA* GetVertexLSA (uint32_t index) const;
+
+  /**
+   * @brief Get the first edge of a vertex of the graph of the database.
+   *
+   * The edges of the vertex \p index are the edges from GetFirstEdge (index)
+   * included to GetFirstEdge (index + 1) excluded.
+   *
+   * @param index The index of the vertex, up to GetNVertices () included.
+   * @returns The index of the first edge.
+   */
+  uint32_t GetFirstEdge (uint32_t index) const;
+
+  /**
+   * @brief Get an edge of the graph of the database.
+   *
+   * @param edge The index of the edge.
+   * @returns The edge.
+   */
+  const Edge& GetEdge (uint32_t edge) const;
+
   /**
    * @brief Look up the External Link State Advertisement associated with the given
    * index.
@@ -680,6 +769,11 @@ private:
   LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
 
+  std::vector<GlobalRoutingLSA*> m_vertices; //!< LSAs of the vertices of the graph
+  std::map<Ipv4Address, uint32_t> m_vertexIndices; //!< indices of the vertices of the graph, by link state ID
+  std::vector<uint32_t> m_firstEdges; //!< index of the first edge of each vertex, and the number of edges
+  std::vector<Edge> m_edges; //!< edges of the graph
+
 /**
  * @brief GlobalRouteManagerLSDB copy construction is disallowed.  There's no 
  * need for it and a compiler provided shallow copy would be wrong.
@@ -730,9 +824,30 @@ public:
 /**
  * @brief Compute routes using a Dijkstra SPF computation and populate
  * per-node forwarding tables
+ *
+ * The SPF computations of the routers are independent, and are spread
+ * over the number of threads set by the "GlobalRoutingThreadCount"
+ * global value.
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Recompute the routes after a change of the topology.
+ *
+ * By default, all the routes and the database are deleted, and built
+ * again by BuildGlobalRoutingDatabase () and InitializeRoutes ().
+ *
+ * If the "GlobalRoutingIncrementalRecompute" global value is true,
+ * InitializeRoutes () keeps the shortest paths it computed, and the new
+ * database is compared with the previous one instead.  Only the routers
+ * whose shortest paths may go through a changed link run their SPF
+ * calculation again, without writing their routing table; then each
+ * router only replaces the routes to the vertices whose shortest path or
+ * LSA changed.  The routes are the same as those of a full recomputation,
+ * but the order of the entries in the routing tables may differ.
+ */
+  virtual void RecomputeRoutes ();
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  */
@@ -764,8 +879,208 @@ private:
  */
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
+  /**
+   * \brief Create a Global Route Manager Implementation which runs SPF
+   * calculations on the LSDB of another one.
+   *
+   * The LSDB is not deleted with the new object.
+   *
+   * \param lsdb the LSDB
+   */
+  GlobalRouteManagerImpl (GlobalRouteManagerLSDB* lsdb);
+
+  /**
+   * \brief The shortest paths found by the SPF calculation of a router,
+   * kept to recompute its routes incrementally.
+   */
+  struct SPFResult
+  {
+    /**
+     * \brief The shortest path to a vertex.
+     */
+    struct Path
+    {
+      Path ();
+      uint32_t distance; //!< the distance from the root, SPF_INFINITY if the vertex is unreachable
+      uint32_t firstExit; //!< the index of the first exit direction of the path in exits
+      uint32_t nExits; //!< the number of exit directions of the path
+    };
+
+    SPFResult ();
+    bool computed; //!< whether the SPF calculation ran
+    bool stub; //!< whether the router was found to be a stub node
+    std::vector<Path> paths; //!< the paths, by LSDB vertex index
+    std::vector<SPFVertex::NodeExit_t> exits; //!< the exit directions of the paths
+  };
+
+  /**
+   * \brief The router at the root of an SPF calculation.
+   *
+   * The node of the router is looked up before the calculation starts,
+   * so that concurrent calculations never walk the NodeList.
+   */
+  struct SPFRoot
+  {
+    Ipv4Address routerId; //!< the router ID
+    uint32_t nodeId; //!< the ID of the node of the router
+    Ptr<Ipv4> ipv4; //!< the IPv4 stack of the node, 0 if the node is unknown
+    Ptr<Ipv4GlobalRouting> routing; //!< the routing protocol of the node, 0 if the node is unknown
+    SPFResult *result; //!< where to keep the shortest paths found, or 0
+  };
+
+  /**
+   * \brief An LSA which differs between two databases.
+   */
+  struct LSAChange
+  {
+    GlobalRoutingLSA *oldLsa; //!< the LSA in the previous database, 0 if it is new
+    GlobalRoutingLSA *newLsa; //!< the LSA in the new database, 0 if it was withdrawn
+  };
+
+  /**
+   * \brief The differences between the database the routes were computed
+   * from and a new one.
+   */
+  struct LSDBDiff
+  {
+    GlobalRouteManagerLSDB *oldLsdb; //!< the previous database
+    std::vector<LSAChange> changes; //!< the changed router and network LSAs
+    std::vector<GlobalRoutingLSA *> withdrawn; //!< the external LSAs of the previous database only
+    std::vector<GlobalRoutingLSA *> advertised; //!< the external LSAs of the new database only
+    std::vector<uint32_t> oldIndices; //!< the previous vertex index of the new vertices, or NO_VERTEX
+  };
+
+  /**
+   * \brief The routers whose routes are computed by InitializeRoutes,
+   * shared by the threads which compute them.
+   */
+  struct SPFRootQueue;
+
+  /**
+   * \brief Run the SPF calculations of the routers of a queue, until it
+   * is empty.
+   *
+   * \param impl the implementation running the calculations
+   * \param queue the queue of routers
+   */
+  static void SPFCalculateQueue (GlobalRouteManagerImpl *impl, SPFRootQueue *queue);
+
+  /**
+   * \brief Run the SPF calculations of the routers of a queue, in the
+   * number of threads set by the "GlobalRoutingThreadCount" global value.
+   *
+   * \param queue the queue of routers
+   */
+  void RunSPFQueue (SPFRootQueue &queue);
+
+  /**
+   * \brief Find the routers of this system.
+   *
+   * \param [out] roots the routers, with no result
+   */
+  static void CollectSPFRoots (std::vector<SPFRoot> &roots);
+
+  /**
+   * \brief Delete all the routes of a router.
+   *
+   * \param routing the routing protocol of the router
+   */
+  static void DeleteRoutes (Ptr<Ipv4GlobalRouting> routing);
+
+  /**
+   * \brief Test if the shortest paths of a router may have changed with
+   * the database.
+   *
+   * The test is conservative: it is true as soon as a changed link of
+   * a reachable vertex has the length of the shortest path between its
+   * ends, before or after the change, and for any change near the router,
+   * where the next hops are found.
+   *
+   * \param root the router
+   * \param result the shortest paths of the router in the previous database
+   * \param diff the differences of the databases
+   * \returns true if the SPF calculation of the router must run again
+   */
+  bool IsSPFTreeChanged (const SPFRoot &root, const SPFResult &result,
+                         const LSDBDiff &diff) const;
+
+  /**
+   * \brief Renumber the shortest paths of a router for the vertices of
+   * the new database, when they did not change.
+   *
+   * \param result the shortest paths of the router in the previous database
+   * \param diff the differences of the databases
+   * \param [out] newResult the same paths in the new database
+   */
+  void RenumberPaths (const SPFResult &result, const LSDBDiff &diff, SPFResult &newResult) const;
+
+  /**
+   * \brief Test if two shortest paths are the same.
+   *
+   * \param a the first path
+   * \param aExits the exit directions of the first path
+   * \param b the second path
+   * \param bExits the exit directions of the second path
+   * \returns true if the paths have the same distance and exit directions
+   */
+  static bool IsSamePath (const SPFResult::Path &a, const std::vector<SPFVertex::NodeExit_t> &aExits,
+                          const SPFResult::Path &b, const std::vector<SPFVertex::NodeExit_t> &bExits);
+
+  /**
+   * \brief Replace the routes of a router to the vertices whose shortest
+   * path or LSA changed, and to the external networks they advertise.
+   *
+   * \param root the router
+   * \param result the shortest paths of the router in the previous
+   * database, replaced by the new ones
+   * \param newResult the shortest paths of the router in the new database,
+   * left empty
+   * \param diff the differences of the databases
+   */
+  void PatchRoutes (const SPFRoot &root, SPFResult &result, SPFResult &newResult,
+                    const LSDBDiff &diff);
+
+  /**
+   * \brief The routes of each kind, as entries of a routing table.
+   */
+  struct RouteSet
+  {
+    std::vector<Ipv4RoutingTableEntry> host; //!< the host routes
+    std::vector<Ipv4RoutingTableEntry> network; //!< the network routes
+    std::vector<Ipv4RoutingTableEntry> external; //!< the external routes
+  };
+
+  /**
+   * \brief Get the routes of a router to the hosts and networks of an
+   * LSA, as the SPF calculation adds them.
+   *
+   * \param lsa the router or network LSA
+   * \param result the shortest paths of the router
+   * \param path the shortest path to the vertex of the LSA
+   * \param [in,out] routes the routes, to which those of the LSA are added
+   */
+  static void GetLSARoutes (GlobalRoutingLSA *lsa, const SPFResult &result,
+                            const SPFResult::Path &path, RouteSet &routes);
+
+  /**
+   * \brief Get the routes of a router to the network of an external LSA,
+   * as the SPF calculation adds them.
+   *
+   * \param extlsa the external LSA
+   * \param result the shortest paths of the router
+   * \param path the shortest path to the advertising router
+   * \param [in,out] routes the routes, to which those of the LSA are added
+   */
+  static void GetExternalRoutes (GlobalRoutingLSA *extlsa, const SPFResult &result,
+                                 const SPFResult::Path &path, RouteSet &routes);
+
   SPFVertex* m_spfroot; //!< the root node
+  SPFRoot m_spfrootRouter; //!< the router of the root node
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  bool m_ownLsdb; //!< whether m_lsdb is deleted with this object
+  std::vector<GlobalRoutingLSA::SPFStatus> m_status; //!< the status of the LSAs in the SPF calculation, by LSDB vertex index
+  std::vector<SPFVertex*> m_candidates; //!< the candidate vertices of the LSAs, by LSDB vertex index
+  std::vector<SPFResult> m_results; //!< the shortest paths of the routers by node ID, if recomputed incrementally
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
@@ -779,13 +1094,21 @@ private:
    */
   bool CheckForStubNode (Ipv4Address root);
 
+  /**
+   * \brief Look up the router of a root node.
+   *
+   * \param root the router ID of the root node
+   * \returns the router, with no node if none has the router ID
+   */
+  static SPFRoot FindSPFRoot (Ipv4Address root);
+
   /**
    * \brief Calculate the shortest path first (SPF) tree
    *
    * Equivalent to quagga ospf_spf_calculate
-   * \param root the root node
+   * \param root the router of the root node
    */
-  void SPFCalculate (Ipv4Address root);
+  void SPFCalculate (const SPFRoot &root);
 
   /**
    * \brief Process Stub nodes
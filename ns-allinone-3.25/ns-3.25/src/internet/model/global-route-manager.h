@@ -62,6 +62,13 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Recompute the routes after a change of the topology, either
+ * from scratch or, if the "GlobalRoutingIncrementalRecompute" global
+ * value is true, only for the changed LSAs
+ */
+  static void RecomputeRoutes ();
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
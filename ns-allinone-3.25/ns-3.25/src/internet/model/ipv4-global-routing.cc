@@ -16,6 +16,8 @@
 // Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
 //
 
+#include <algorithm>
+#include <map>
 #include <vector>
 #include <iomanip>
 #include "ns3/names.h"
@@ -27,6 +29,8 @@
 #include "ns3/ipv4-route.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/hash.h"
 #include "ns3/node.h"
 #include "ipv4-global-routing.h"
 #include "global-route-manager.h"
@@ -53,13 +57,29 @@ Ipv4GlobalRouting::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&Ipv4GlobalRouting::m_respondToInterfaceEvents),
                    MakeBooleanChecker ())
+    .AddAttribute ("FlowEcmpRouting",
+                   "Set to true if packets are routed among ECMP by a hash of their addresses, protocol and ports, "
+                   "so that the packets of a flow take the same route; ignored if RandomEcmpRouting is true",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Ipv4GlobalRouting::m_flowEcmpRouting),
+                   MakeBooleanChecker ())
+    .AddAttribute ("RouteCacheSize",
+                   "The number of slots of the route cache, each of which keeps the routes to one destination, 0 to disable the cache",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&Ipv4GlobalRouting::m_routeCacheSize),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
 
 Ipv4GlobalRouting::Ipv4GlobalRouting () 
   : m_randomEcmpRouting (false),
-    m_respondToInterfaceEvents (false)
+    m_respondToInterfaceEvents (false),
+    m_flowEcmpRouting (false),
+    m_routeCacheSize (1024),
+    m_nextTag (0),
+    m_nUnindexedRoutes (0),
+    m_flowHashSalt (0)
 {
   NS_LOG_FUNCTION (this);
 
@@ -80,6 +100,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  IndexRoute (m_hostTrie, route);
 }
 
 void 
@@ -90,6 +111,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  IndexRoute (m_hostTrie, route);
 }
 
 void 
@@ -105,6 +127,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  IndexRoute (m_networkTrie, route);
 }
 
 void 
@@ -118,6 +141,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  IndexRoute (m_networkTrie, route);
 }
 
 void 
@@ -133,19 +157,220 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  IndexRoute (m_ASexternalTrie, route);
 }
 
+uint32_t
+Ipv4GlobalRouting::RemoveHostRoutes (const std::vector<Ipv4RoutingTableEntry> &routes)
+{
+  NS_LOG_FUNCTION (this << routes.size ());
+  return RemoveRoutesFrom (m_hostRoutes, m_hostTrie, routes);
+}
 
-Ptr<Ipv4Route>
-Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
+uint32_t
+Ipv4GlobalRouting::RemoveNetworkRoutes (const std::vector<Ipv4RoutingTableEntry> &routes)
+{
+  NS_LOG_FUNCTION (this << routes.size ());
+  return RemoveRoutesFrom (m_networkRoutes, m_networkTrie, routes);
+}
+
+uint32_t
+Ipv4GlobalRouting::RemoveASExternalRoutes (const std::vector<Ipv4RoutingTableEntry> &routes)
+{
+  NS_LOG_FUNCTION (this << routes.size ());
+  return RemoveRoutesFrom (m_ASexternalRoutes, m_ASexternalTrie, routes);
+}
+
+/**
+ * \brief Order routing table entries by destination, mask, next hop and
+ * interface.
+ */
+struct Ipv4GlobalRoutingEntryLess
+{
+  /**
+   * \param a the first entry
+   * \param b the second entry
+   * \returns true if the first entry is ordered before the second
+   */
+  bool operator () (const Ipv4RoutingTableEntry &a, const Ipv4RoutingTableEntry &b) const
+  {
+    if (a.GetDest () != b.GetDest ())
+      {
+        return a.GetDest () < b.GetDest ();
+      }
+    if (a.GetDestNetworkMask () != b.GetDestNetworkMask ())
+      {
+        return a.GetDestNetworkMask ().Get () < b.GetDestNetworkMask ().Get ();
+      }
+    if (a.GetGateway () != b.GetGateway ())
+      {
+        return a.GetGateway () < b.GetGateway ();
+      }
+    return a.GetInterface () < b.GetInterface ();
+  }
+};
+
+uint32_t
+Ipv4GlobalRouting::RemoveRoutesFrom (std::list<Ipv4RoutingTableEntry *> &list, Ipv4RouteTrie &trie,
+                                     const std::vector<Ipv4RoutingTableEntry> &routes)
+{
+  NS_LOG_FUNCTION (this << &list << routes.size ());
+  typedef std::map<Ipv4RoutingTableEntry, uint32_t, Ipv4GlobalRoutingEntryLess> Pending;
+  Pending pending;
+  for (uint32_t i = 0; i < routes.size (); i++)
+    {
+      pending[routes[i]]++;
+    }
+  uint32_t removed = 0;
+  std::list<Ipv4RoutingTableEntry *>::iterator i = list.begin ();
+  while (i != list.end () && removed < routes.size ())
+    {
+      Pending::iterator match = pending.find (**i);
+      if (match != pending.end () && match->second > 0)
+        {
+          match->second--;
+          removed++;
+          UnindexRoute (trie, *i);
+          delete *i;
+          i = list.erase (i);
+        }
+      else
+        {
+          i++;
+        }
+    }
+  return removed;
+}
+
+void
+Ipv4GlobalRouting::IndexRoute (Ipv4RouteTrie &trie, Ipv4RoutingTableEntry *route)
+{
+  NS_LOG_FUNCTION (this << &trie << route);
+  InvalidateRouteCache ();
+  if (Ipv4RouteTrie::IsIndexable (route->GetDestNetworkMask ()))
+    {
+      trie.Add (route, m_nextTag++);
+    }
+  else
+    {
+      m_nUnindexedRoutes++;
+    }
+}
+
+void
+Ipv4GlobalRouting::UnindexRoute (Ipv4RouteTrie &trie, Ipv4RoutingTableEntry *route)
+{
+  NS_LOG_FUNCTION (this << &trie << route);
+  InvalidateRouteCache ();
+  if (Ipv4RouteTrie::IsIndexable (route->GetDestNetworkMask ()))
+    {
+      trie.Remove (route);
+    }
+  else
+    {
+      m_nUnindexedRoutes--;
+    }
+}
+
+bool
+Ipv4GlobalRouting::IsOnDevice (Ipv4RoutingTableEntry *route, Ptr<NetDevice> oif) const
+{
+  if (oif != 0 && oif != m_ipv4->GetNetDevice (route->GetInterface ()))
+    {
+      NS_LOG_LOGIC ("Not on requested interface, skipping");
+      return false;
+    }
+  return true;
+}
+
+/**
+ * \brief Order the routes of a trie by tag.
+ *
+ * \param a the first route
+ * \param b the second route
+ * \returns true if the first route has the smaller tag
+ */
+static bool
+IsTagLess (const Ipv4RouteTrie::Route &a, const Ipv4RouteTrie::Route &b)
+{
+  return a.tag < b.tag;
+}
+
+void
+Ipv4GlobalRouting::FindIndexedRoutes (Ipv4Address dest, Ptr<NetDevice> oif,
+                                      std::vector<Ipv4RoutingTableEntry *> &routes) const
 {
   NS_LOG_FUNCTION (this << dest << oif);
-  NS_LOG_LOGIC ("Looking for route for destination " << dest);
-  Ptr<Ipv4Route> rtentry = 0;
-  // store all available routes that bring packets to their destination
-  typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
-  RouteVec_t allRoutes;
+  const Ipv4RouteTrie::Routes *matches[Ipv4RouteTrie::MAX_MATCHES];
+  uint32_t n = m_hostTrie.Lookup (dest, matches);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      for (Ipv4RouteTrie::Routes::const_iterator j = matches[i]->begin (); j != matches[i]->end (); j++)
+        {
+          if (IsOnDevice (j->entry, oif))
+            {
+              routes.push_back (j->entry);
+            }
+        }
+    }
+  if (!routes.empty ())
+    {
+      return;
+    }
+//
+// All the network routes which match, whatever their prefix length, in
+// the order of the routing table, which is the order of their tags.
+//
+  n = m_networkTrie.Lookup (dest, matches);
+  std::vector<Ipv4RouteTrie::Route> found;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      for (Ipv4RouteTrie::Routes::const_iterator j = matches[i]->begin (); j != matches[i]->end (); j++)
+        {
+          if (IsOnDevice (j->entry, oif))
+            {
+              found.push_back (*j);
+            }
+        }
+    }
+  if (n > 1)
+    {
+      std::sort (found.begin (), found.end (), &IsTagLess);
+    }
+  for (uint32_t i = 0; i < found.size (); i++)
+    {
+      routes.push_back (found[i].entry);
+    }
+  if (!routes.empty ())
+    {
+      return;
+    }
+//
+// The first external route which matches.
+//
+  n = m_ASexternalTrie.Lookup (dest, matches);
+  const Ipv4RouteTrie::Route *first = 0;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      for (Ipv4RouteTrie::Routes::const_iterator j = matches[i]->begin (); j != matches[i]->end (); j++)
+        {
+          if ((first == 0 || j->tag < first->tag) && IsOnDevice (j->entry, oif))
+            {
+              first = &*j;
+            }
+        }
+    }
+  if (first != 0)
+    {
+      routes.push_back (first->entry);
+    }
+}
 
+void
+Ipv4GlobalRouting::ScanRoutes (Ipv4Address dest, Ptr<NetDevice> oif,
+                               std::vector<Ipv4RoutingTableEntry *> &routes) const
+{
+  NS_LOG_FUNCTION (this << dest << oif);
   NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
   for (HostRoutesCI i = m_hostRoutes.begin (); 
        i != m_hostRoutes.end (); 
@@ -162,14 +387,14 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
                   continue;
                 }
             }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i); 
+          routes.push_back (*i);
+          NS_LOG_LOGIC (routes.size () << "Found global host route" << *i); 
         }
     }
-  if (allRoutes.size () == 0) // if no host route is found
+  if (routes.size () == 0) // if no host route is found
     {
       NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin (); 
+      for (NetworkRoutesCI j = m_networkRoutes.begin (); 
            j != m_networkRoutes.end (); 
            j++) 
         {
@@ -185,14 +410,14 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
                       continue;
                     }
                 }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
+              routes.push_back (*j);
+              NS_LOG_LOGIC (routes.size () << "Found global network route" << *j);
             }
         }
     }
-  if (allRoutes.size () == 0)  // consider external if no host/network found
+  if (routes.size () == 0)  // consider external if no host/network found
     {
-      for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
+      for (ASExternalRoutesCI k = m_ASexternalRoutes.begin ();
            k != m_ASexternalRoutes.end ();
            k++)
         {
@@ -209,35 +434,44 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
                       continue;
                     }
                 }
-              allRoutes.push_back (*k);
+              routes.push_back (*k);
               break;
             }
         }
     }
-  if (allRoutes.size () > 0 ) // if route(s) is found
+}
+
+Ptr<Ipv4Route>
+Ipv4GlobalRouting::LookupGlobal (const Ipv4Header &header, Ptr<const Packet> p, Ptr<NetDevice> oif)
+{
+  Ipv4Address dest = header.GetDestination ();
+  NS_LOG_FUNCTION (this << dest << p << oif);
+  NS_LOG_LOGIC ("Looking for route for destination " << dest);
+  if (oif == 0 && m_routeCacheSize > 0)
     {
-      // pick up one of the routes uniformly at random if random
-      // ECMP routing is enabled, or always select the first route
-      // consistently if random ECMP routing is disabled
-      uint32_t selectIndex;
-      if (m_randomEcmpRouting)
+      const RouteGroup &group = GetCachedRoutes (dest);
+      if (group.empty ())
         {
-          selectIndex = m_rand->GetInteger (0, allRoutes.size ()-1);
+          return 0;
         }
-      else 
-        {
-          selectIndex = 0;
-        }
-      Ipv4RoutingTableEntry* route = allRoutes.at (selectIndex); 
-      // create a Ipv4Route object from the selected routing table entry
-      rtentry = Create<Ipv4Route> ();
-      rtentry->SetDestination (route->GetDest ());
-      /// \todo handle multi-address case
-      rtentry->SetSource (m_ipv4->GetAddress (route->GetInterface (), 0).GetLocal ());
-      rtentry->SetGateway (route->GetGateway ());
-      uint32_t interfaceIdx = route->GetInterface ();
-      rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
-      return rtentry;
+      return group[SelectRoute (group.size (), header, p)];
+    }
+
+  // store all available routes that bring packets to their destination
+  typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
+  RouteVec_t allRoutes;
+
+  if (m_nUnindexedRoutes == 0)
+    {
+      FindIndexedRoutes (dest, oif, allRoutes);
+    }
+  else
+    {
+      ScanRoutes (dest, oif, allRoutes);
+    }
+  if (allRoutes.size () > 0 ) // if route(s) is found
+    {
+      return CreateRoute (allRoutes.at (SelectRoute (allRoutes.size (), header, p)));
     }
   else 
     {
@@ -245,6 +479,109 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif)
     }
 }
 
+Ptr<Ipv4Route>
+Ipv4GlobalRouting::CreateRoute (Ipv4RoutingTableEntry *route) const
+{
+  NS_LOG_FUNCTION (this << route);
+  // create a Ipv4Route object from the selected routing table entry
+  Ptr<Ipv4Route> rtentry = Create<Ipv4Route> ();
+  rtentry->SetDestination (route->GetDest ());
+  /// \todo handle multi-address case
+  rtentry->SetSource (m_ipv4->GetAddress (route->GetInterface (), 0).GetLocal ());
+  rtentry->SetGateway (route->GetGateway ());
+  uint32_t interfaceIdx = route->GetInterface ();
+  rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
+  return rtentry;
+}
+
+const Ipv4GlobalRouting::RouteGroup &
+Ipv4GlobalRouting::GetCachedRoutes (Ipv4Address dest)
+{
+  NS_LOG_FUNCTION (this << dest);
+  if (m_routeCache.empty ())
+    {
+      RouteCacheSlot empty;
+      empty.valid = false;
+      m_routeCache.resize (m_routeCacheSize, empty);
+    }
+  // a multiplicative hash spreads nearby addresses over the slots
+  RouteCacheSlot &slot = m_routeCache[(dest.Get () * 2654435761U) % m_routeCache.size ()];
+  if (slot.valid && slot.dest == dest)
+    {
+      return slot.routes;
+    }
+  NS_LOG_LOGIC ("Route cache miss for " << dest);
+  std::vector<Ipv4RoutingTableEntry *> routes;
+  if (m_nUnindexedRoutes == 0)
+    {
+      FindIndexedRoutes (dest, 0, routes);
+    }
+  else
+    {
+      ScanRoutes (dest, 0, routes);
+    }
+  slot.valid = true;
+  slot.dest = dest;
+  slot.routes.clear ();
+  for (uint32_t j = 0; j < routes.size (); j++)
+    {
+      slot.routes.push_back (CreateRoute (routes[j]));
+    }
+  return slot.routes;
+}
+
+void
+Ipv4GlobalRouting::InvalidateRouteCache (void)
+{
+  if (!m_routeCache.empty ())
+    {
+      NS_LOG_LOGIC ("Clearing the route cache");
+      m_routeCache.clear ();
+    }
+}
+
+uint32_t
+Ipv4GlobalRouting::SelectRoute (uint32_t n, const Ipv4Header &header, Ptr<const Packet> p)
+{
+  // pick up one of the routes uniformly at random if random ECMP routing
+  // is enabled, by the flow of the packet if flow ECMP routing is
+  // enabled, or always select the first route consistently otherwise
+  if (m_randomEcmpRouting)
+    {
+      return m_rand->GetInteger (0, n - 1);
+    }
+  if (m_flowEcmpRouting && n > 1)
+    {
+      return GetFlowHash (header, p) % n;
+    }
+  return 0;
+}
+
+uint32_t
+Ipv4GlobalRouting::GetFlowHash (const Ipv4Header &header, Ptr<const Packet> p) const
+{
+  uint8_t buffer[17];
+  uint32_t values[3] = { m_flowHashSalt, header.GetSource ().Get (), header.GetDestination ().Get () };
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      buffer[4 * i] = values[i] >> 24;
+      buffer[4 * i + 1] = values[i] >> 16;
+      buffer[4 * i + 2] = values[i] >> 8;
+      buffer[4 * i + 3] = values[i];
+    }
+  buffer[12] = header.GetProtocol ();
+  // the source and destination ports are the first four bytes of both
+  // the TCP and UDP headers
+  uint32_t size = 13;
+  if (p != 0 && (header.GetProtocol () == 6 || header.GetProtocol () == 17)
+      && header.GetFragmentOffset () == 0 && header.IsLastFragment ()
+      && p->CopyData (buffer + 13, 4) == 4)
+    {
+      size = 17;
+    }
+  return Hash32 (reinterpret_cast<char *> (buffer), size);
+}
+
 uint32_t 
 Ipv4GlobalRouting::GetNRoutes (void) const
 {
@@ -319,6 +656,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
           if (tmp  == index)
             {
               NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_hostRoutes.size ());
+              UnindexRoute (m_hostTrie, *i);
               delete *i;
               m_hostRoutes.erase (i);
               NS_LOG_LOGIC ("Done removing host route " << index << "; host route remaining size = " << m_hostRoutes.size ());
@@ -336,6 +674,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_networkRoutes.size ());
+          UnindexRoute (m_networkTrie, *j);
           delete *j;
           m_networkRoutes.erase (j);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -352,6 +691,7 @@ Ipv4GlobalRouting::RemoveRoute (uint32_t index)
       if (tmp == index)
         {
           NS_LOG_LOGIC ("Removing route " << index << "; size = " << m_ASexternalRoutes.size ());
+          UnindexRoute (m_ASexternalTrie, *k);
           delete *k;
           m_ASexternalRoutes.erase (k);
           NS_LOG_LOGIC ("Done removing network route " << index << "; network route remaining size = " << m_networkRoutes.size ());
@@ -392,6 +732,11 @@ Ipv4GlobalRouting::DoDispose (void)
     {
       delete (*l);
     }
+  m_hostTrie.Clear ();
+  m_networkTrie.Clear ();
+  m_ASexternalTrie.Clear ();
+  m_nUnindexedRoutes = 0;
+  InvalidateRouteCache ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -468,7 +813,9 @@ Ipv4GlobalRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<Net
 // See if this is a unicast packet we have a route for.
 //
   NS_LOG_LOGIC ("Unicast destination- looking up");
-  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination (), oif);
+  // the packet does not start with its layer 4 header yet for all
+  // protocols, so that only the addresses and protocol of its flow are used
+  Ptr<Ipv4Route> rtentry = LookupGlobal (header, 0, oif);
   if (rtentry)
     {
       sockerr = Socket::ERROR_NOTERROR;
@@ -517,7 +864,7 @@ Ipv4GlobalRouting::RouteInput  (Ptr<const Packet> p, const Ipv4Header &header, P
     }
   // Next, try to find a route
   NS_LOG_LOGIC ("Unicast destination- looking up global route");
-  Ptr<Ipv4Route> rtentry = LookupGlobal (header.GetDestination ());
+  Ptr<Ipv4Route> rtentry = LookupGlobal (header, p);
   if (rtentry != 0)
     {
       NS_LOG_LOGIC ("Found unicast destination- calling unicast callback");
@@ -535,11 +882,10 @@ void
 Ipv4GlobalRouting::NotifyInterfaceUp (uint32_t i)
 {
   NS_LOG_FUNCTION (this << i);
+  InvalidateRouteCache ();
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutes ();
     }
 }
 
@@ -547,11 +893,10 @@ void
 Ipv4GlobalRouting::NotifyInterfaceDown (uint32_t i)
 {
   NS_LOG_FUNCTION (this << i);
+  InvalidateRouteCache ();
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutes ();
     }
 }
 
@@ -559,11 +904,10 @@ void
 Ipv4GlobalRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
   NS_LOG_FUNCTION (this << interface << address);
+  InvalidateRouteCache ();
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutes ();
     }
 }
 
@@ -571,11 +915,10 @@ void
 Ipv4GlobalRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
   NS_LOG_FUNCTION (this << interface << address);
+  InvalidateRouteCache ();
   if (m_respondToInterfaceEvents && Simulator::Now ().GetSeconds () > 0)  // avoid startup events
     {
-      GlobalRouteManager::DeleteGlobalRoutes ();
-      GlobalRouteManager::BuildGlobalRoutingDatabase ();
-      GlobalRouteManager::InitializeRoutes ();
+      GlobalRouteManager::RecomputeRoutes ();
     }
 }
 
@@ -585,6 +928,8 @@ Ipv4GlobalRouting::SetIpv4 (Ptr<Ipv4> ipv4)
   NS_LOG_FUNCTION (this << ipv4);
   NS_ASSERT (m_ipv4 == 0 && ipv4 != 0);
   m_ipv4 = ipv4;
+  Ptr<Node> node = ipv4->GetObject<Node> ();
+  m_flowHashSalt = node != 0 ? node->GetId () : 0;
 }
 
 
@@ -21,6 +21,7 @@
 #define IPV4_GLOBAL_ROUTING_H
 
 #include <list>
+#include <vector>
 #include <stdint.h>
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
@@ -28,6 +29,7 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ipv4-route-trie.h"
 
 namespace ns3 {
 
@@ -63,6 +65,18 @@ class Node;
  *
  * This class deals with Ipv4 unicast routes only.
  *
+ * When several equal cost routes lead to a destination, the first one is
+ * used, unless the RandomEcmpRouting attribute is true, in which case one
+ * is picked at random for each packet, or the FlowEcmpRouting attribute
+ * is true, in which case one is picked by a hash of the flow of the
+ * packet, so that the packets of a flow keep to the same path.
+ *
+ * The routes to recent destinations are kept in a direct mapped cache of
+ * RouteCacheSize slots, indexed by a hash of the destination, so that
+ * their packets share the same Ipv4Route objects instead of looking up
+ * the routing table and creating a new Ipv4Route each time.  The cache
+ * is cleared whenever a route or an interface changes.
+ *
  * \see Ipv4RoutingProtocol
  * \see GlobalRouteManager
  */
@@ -167,6 +181,42 @@ public:
                              Ipv4Address nextHop,
                              uint32_t interface);
 
+  /**
+   * \brief Remove host routes from the global routing table.
+   *
+   * For each of the given routes, the first host route of the table with
+   * the same destination, next hop and interface is removed.  The table
+   * is walked once, whatever the number of routes.
+   *
+   * \param routes The routes to remove.
+   * \returns the number of routes removed
+   */
+  uint32_t RemoveHostRoutes (const std::vector<Ipv4RoutingTableEntry> &routes);
+
+  /**
+   * \brief Remove network routes from the global routing table.
+   *
+   * For each of the given routes, the first network route of the table
+   * with the same network, mask, next hop and interface is removed.  The
+   * table is walked once, whatever the number of routes.
+   *
+   * \param routes The routes to remove.
+   * \returns the number of routes removed
+   */
+  uint32_t RemoveNetworkRoutes (const std::vector<Ipv4RoutingTableEntry> &routes);
+
+  /**
+   * \brief Remove external routes from the global routing table.
+   *
+   * For each of the given routes, the first external route of the table
+   * with the same network, mask, next hop and interface is removed.  The
+   * table is walked once, whatever the number of routes.
+   *
+   * \param routes The routes to remove.
+   * \returns the number of routes removed
+   */
+  uint32_t RemoveASExternalRoutes (const std::vector<Ipv4RoutingTableEntry> &routes);
+
   /**
    * \brief Get the number of individual unicast routes that have been added
    * to the routing table.
@@ -236,6 +286,10 @@ private:
   bool m_respondToInterfaceEvents;
   /// A uniform random number generator for randomly routing packets among ECMP 
   Ptr<UniformRandomVariable> m_rand;
+  /// Set to true if packets are routed among ECMP by a hash of their flow
+  bool m_flowEcmpRouting;
+  /// The number of slots of the route cache
+  uint32_t m_routeCacheSize;
 
   /// container of Ipv4RoutingTableEntry (routes to hosts)
   typedef std::list<Ipv4RoutingTableEntry *> HostRoutes;
@@ -258,12 +312,144 @@ private:
   /// iterator of container of Ipv4RoutingTableEntry (routes to external AS)
   typedef std::list<Ipv4RoutingTableEntry *>::iterator ASExternalRoutesI;
 
-  Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
+  /// routes to a destination, one for each equal cost route
+  typedef std::vector<Ptr<Ipv4Route> > RouteGroup;
+
+  /**
+   * \brief A slot of the route cache.
+   */
+  struct RouteCacheSlot
+  {
+    bool valid;        //!< true if the slot holds the routes to dest
+    Ipv4Address dest;  //!< the destination
+    RouteGroup routes; //!< the routes to the destination
+  };
+
+  /**
+   * \brief Lookup a route for a packet.
+   *
+   * \param header The IP header of the packet.
+   * \param p The packet, starting with its layer 4 header, or 0 if the
+   * packet is not known yet or does not start with it.
+   * \param oif The output device, or 0 for any device.
+   * \returns the route, or 0 if there is none
+   */
+  Ptr<Ipv4Route> LookupGlobal (const Ipv4Header &header, Ptr<const Packet> p, Ptr<NetDevice> oif = 0);
+
+  /**
+   * \brief Create the route object of a routing table entry.
+   *
+   * \param route The routing table entry.
+   * \returns the route
+   */
+  Ptr<Ipv4Route> CreateRoute (Ipv4RoutingTableEntry *route) const;
+
+  /**
+   * \brief Get the routes to a destination from the route cache, after
+   * adding them to it if needed.
+   *
+   * \param dest The destination.
+   * \returns the routes, empty if there is none
+   */
+  const RouteGroup &GetCachedRoutes (Ipv4Address dest);
+
+  /**
+   * \brief Clear the route cache, after a change of the routes.
+   */
+  void InvalidateRouteCache (void);
+
+  /**
+   * \brief Select one of several equal cost routes for a packet.
+   *
+   * \param n The number of routes, at least 1.
+   * \param header The IP header of the packet.
+   * \param p The packet, as for LookupGlobal ().
+   * \returns the index of the route
+   */
+  uint32_t SelectRoute (uint32_t n, const Ipv4Header &header, Ptr<const Packet> p);
+
+  /**
+   * \brief Hash the flow of a packet: its addresses, protocol and, for
+   * the TCP and UDP packets which are not fragments, its ports.
+   *
+   * \param header The IP header of the packet.
+   * \param p The packet, as for LookupGlobal ().
+   * \returns the hash
+   */
+  uint32_t GetFlowHash (const Ipv4Header &header, Ptr<const Packet> p) const;
+
+  /**
+   * \brief Find the routes to a destination in the tries of the routes.
+   *
+   * \param dest The destination.
+   * \param oif The output device, or 0 for any device.
+   * \param [out] routes The host routes to the destination if any, else
+   * the network routes, else the first external route, in the order of
+   * the routing table.
+   */
+  void FindIndexedRoutes (Ipv4Address dest, Ptr<NetDevice> oif,
+                          std::vector<Ipv4RoutingTableEntry *> &routes) const;
+
+  /**
+   * \brief Find the routes to a destination by walking the lists of
+   * routes, when some routes cannot be indexed.
+   *
+   * \param dest The destination.
+   * \param oif The output device, or 0 for any device.
+   * \param [out] routes The same routes as FindIndexedRoutes ().
+   */
+  void ScanRoutes (Ipv4Address dest, Ptr<NetDevice> oif,
+                   std::vector<Ipv4RoutingTableEntry *> &routes) const;
+
+  /**
+   * \brief Test if a route goes through an output device.
+   *
+   * \param route The route.
+   * \param oif The output device, or 0 for any device.
+   * \returns true if the route goes through the device
+   */
+  bool IsOnDevice (Ipv4RoutingTableEntry *route, Ptr<NetDevice> oif) const;
+
+  /**
+   * \brief Add a new route to the trie of its list, tagged with its rank.
+   *
+   * \param trie The trie.
+   * \param route The route.
+   */
+  void IndexRoute (Ipv4RouteTrie &trie, Ipv4RoutingTableEntry *route);
+
+  /**
+   * \brief Remove a route from the trie of its list.
+   *
+   * \param trie The trie.
+   * \param route The route.
+   */
+  void UnindexRoute (Ipv4RouteTrie &trie, Ipv4RoutingTableEntry *route);
+
+  /**
+   * \brief Remove routes from a list of routes.
+   *
+   * \param list The list of routes.
+   * \param trie The trie of the list.
+   * \param routes The routes to remove, each from its first match in the list.
+   * \returns the number of routes removed
+   */
+  uint32_t RemoveRoutesFrom (std::list<Ipv4RoutingTableEntry *> &list, Ipv4RouteTrie &trie,
+                             const std::vector<Ipv4RoutingTableEntry> &routes);
 
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+  Ipv4RouteTrie m_hostTrie;            //!< Longest prefix match index of m_hostRoutes
+  Ipv4RouteTrie m_networkTrie;         //!< Longest prefix match index of m_networkRoutes
+  Ipv4RouteTrie m_ASexternalTrie;      //!< Longest prefix match index of m_ASexternalRoutes
+  uint64_t m_nextTag;                  //!< Tag of the next route, increasing with the rank of the routes
+  uint32_t m_nUnindexedRoutes;         //!< Number of routes whose mask is not a prefix
+
+  std::vector<RouteCacheSlot> m_routeCache; //!< Route cache, empty until the first lookup
+  uint32_t m_flowHashSalt;             //!< Value hashed with the flows, which differs between nodes
+
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
@@ -0,0 +1,262 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ipv4-route-trie.h"
+#include "ipv4-routing-table-entry.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4RouteTrie");
+
+/**
+ * \brief Get the mask of a prefix length.
+ *
+ * \param length the prefix length
+ * \returns the mask
+ */
+static inline uint32_t
+PrefixMask (uint32_t length)
+{
+  return length == 0 ? 0 : 0xffffffffU << (32 - length);
+}
+
+/**
+ * \brief Get a bit of an address.
+ *
+ * \param address the address
+ * \param index the index of the bit, 0 for the most significant bit
+ * \returns the bit
+ */
+static inline uint32_t
+GetBit (uint32_t address, uint32_t index)
+{
+  return (address >> (31 - index)) & 1;
+}
+
+/**
+ * \brief Get the length of the longest common prefix of two prefixes.
+ *
+ * \param a the first prefix
+ * \param aLength the length of the first prefix
+ * \param b the second prefix
+ * \param bLength the length of the second prefix
+ * \returns the length of the common prefix
+ */
+static uint32_t
+GetCommonLength (uint32_t a, uint32_t aLength, uint32_t b, uint32_t bLength)
+{
+  uint32_t length = aLength < bLength ? aLength : bLength;
+  uint32_t diff = a ^ b;
+  uint32_t common = 0;
+  while (common < length && GetBit (diff, common) == 0)
+    {
+      common++;
+    }
+  return common;
+}
+
+Ipv4RouteTrie::Ipv4RouteTrie ()
+  : m_root (0),
+    m_nRoutes (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ipv4RouteTrie::~Ipv4RouteTrie ()
+{
+  NS_LOG_FUNCTION (this);
+  DeleteNodes (m_root);
+}
+
+bool
+Ipv4RouteTrie::IsIndexable (Ipv4Mask mask)
+{
+  return mask.Get () == PrefixMask (mask.GetPrefixLength ());
+}
+
+void
+Ipv4RouteTrie::Add (Ipv4RoutingTableEntry *entry, uint64_t tag)
+{
+  NS_LOG_FUNCTION (this << entry << tag);
+  Ipv4Mask mask = entry->GetDestNetworkMask ();
+  NS_ASSERT_MSG (IsIndexable (mask), "Mask " << mask << " is not a prefix");
+  uint32_t length = mask.GetPrefixLength ();
+  uint32_t prefix = entry->GetDest ().Get () & mask.Get ();
+//
+// Walk down the nodes whose prefix is a prefix of the new one, until the
+// node of the prefix or the place of a new node is found.
+//
+  Node **link = &m_root;
+  Node *node = 0;
+  while (node == 0)
+    {
+      Node *n = *link;
+      if (n == 0)
+        {
+          node = CreateNode (prefix, length);
+          *link = node;
+          break;
+        }
+      uint32_t common = GetCommonLength (n->prefix, n->length, prefix, length);
+      if (common == n->length && common == length)
+        {
+          node = n;
+        }
+      else if (common == n->length)
+        {
+          link = &n->child[GetBit (prefix, n->length)];
+        }
+      else
+        {
+          // the new prefix branches off above n
+          Node *branch = CreateNode (prefix & PrefixMask (common), common);
+          branch->child[GetBit (n->prefix, common)] = n;
+          *link = branch;
+          if (common == length)
+            {
+              node = branch;
+            }
+          else
+            {
+              node = CreateNode (prefix, length);
+              branch->child[GetBit (prefix, common)] = node;
+            }
+        }
+    }
+  Route route;
+  route.entry = entry;
+  route.tag = tag;
+  node->routes.push_back (route);
+  m_nRoutes++;
+}
+
+void
+Ipv4RouteTrie::Remove (Ipv4RoutingTableEntry *entry)
+{
+  NS_LOG_FUNCTION (this << entry);
+  Ipv4Mask mask = entry->GetDestNetworkMask ();
+  uint32_t length = mask.GetPrefixLength ();
+  uint32_t prefix = entry->GetDest ().Get () & mask.Get ();
+//
+// Find the node of the prefix, keeping the links to it from the root.
+//
+  Node **path[MAX_MATCHES + 1];
+  uint32_t depth = 0;
+  Node **link = &m_root;
+  while (*link != 0 && (*link)->length < length)
+    {
+      path[depth++] = link;
+      link = &(*link)->child[GetBit (prefix, (*link)->length)];
+    }
+  Node *node = *link;
+  NS_ASSERT_MSG (node != 0 && node->length == length && node->prefix == prefix,
+                 "No route to " << entry->GetDest () << "/" << length);
+  Routes::iterator i = node->routes.begin ();
+  while (i != node->routes.end () && i->entry != entry)
+    {
+      i++;
+    }
+  NS_ASSERT_MSG (i != node->routes.end (), "Route " << entry << " not found");
+  node->routes.erase (i);
+  m_nRoutes--;
+//
+// Remove the nodes which no longer have routes nor two children, up to
+// the root.
+//
+  path[depth++] = link;
+  while (depth > 0)
+    {
+      link = path[--depth];
+      node = *link;
+      if (!node->routes.empty () || (node->child[0] != 0 && node->child[1] != 0))
+        {
+          break;
+        }
+      *link = node->child[0] != 0 ? node->child[0] : node->child[1];
+      delete node;
+    }
+}
+
+void
+Ipv4RouteTrie::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  DeleteNodes (m_root);
+  m_root = 0;
+  m_nRoutes = 0;
+}
+
+uint32_t
+Ipv4RouteTrie::GetNRoutes (void) const
+{
+  return m_nRoutes;
+}
+
+uint32_t
+Ipv4RouteTrie::Lookup (Ipv4Address address, const Routes **matches) const
+{
+  NS_LOG_FUNCTION (this << address);
+  uint32_t key = address.Get ();
+  uint32_t n = 0;
+  const Node *node = m_root;
+  while (node != 0 && (key & PrefixMask (node->length)) == node->prefix)
+    {
+      if (!node->routes.empty ())
+        {
+          matches[n++] = &node->routes;
+        }
+      if (node->length == 32)
+        {
+          break;
+        }
+      node = node->child[GetBit (key, node->length)];
+    }
+  // longest prefix first
+  for (uint32_t i = 0; i < n / 2; i++)
+    {
+      const Routes *tmp = matches[i];
+      matches[i] = matches[n - 1 - i];
+      matches[n - 1 - i] = tmp;
+    }
+  return n;
+}
+
+Ipv4RouteTrie::Node *
+Ipv4RouteTrie::CreateNode (uint32_t prefix, uint32_t length)
+{
+  Node *node = new Node;
+  node->prefix = prefix;
+  node->length = length;
+  node->child[0] = 0;
+  node->child[1] = 0;
+  return node;
+}
+
+void
+Ipv4RouteTrie::DeleteNodes (Node *node)
+{
+  if (node == 0)
+    {
+      return;
+    }
+  DeleteNodes (node->child[0]);
+  DeleteNodes (node->child[1]);
+  delete node;
+}
+
+} // namespace ns3
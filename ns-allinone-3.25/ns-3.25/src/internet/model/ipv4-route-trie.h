@@ -0,0 +1,153 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_ROUTE_TRIE_H
+#define IPV4_ROUTE_TRIE_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/ipv4-address.h"
+
+namespace ns3 {
+
+class Ipv4RoutingTableEntry;
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief A longest prefix match index of the routes of a routing table.
+ *
+ * The routes are kept in a path-compressed binary trie (a Patricia
+ * trie) of their destination prefixes, so that finding the routes
+ * which match an address takes at most one step per prefix length,
+ * whatever the number of routes.  The routing protocol still owns the
+ * routes, and keeps the trie alongside its own lists of routes.
+ *
+ * The routes to the same prefix form a group, in the order in which
+ * they were added, so that equal cost routes stay together.  A tag,
+ * such as a metric or the rank of the route in the list of the routing
+ * protocol, is kept with each route.
+ *
+ * Only the routes whose mask is a prefix (contiguous ones, then zeros)
+ * can be indexed; see IsIndexable ().
+ */
+class Ipv4RouteTrie
+{
+public:
+  /**
+   * \brief A route of the trie.
+   */
+  struct Route
+  {
+    Ipv4RoutingTableEntry *entry; //!< the routing table entry
+    uint64_t tag; //!< the value kept with the entry
+  };
+
+  /** The routes to the same prefix, in the order in which they were added. */
+  typedef std::vector<Route> Routes;
+
+  /** The largest number of prefixes which can match an address. */
+  static const uint32_t MAX_MATCHES = 33;
+
+  Ipv4RouteTrie ();
+  ~Ipv4RouteTrie ();
+
+  /**
+   * \brief Test if the routes with a mask can be indexed.
+   *
+   * \param mask the mask
+   * \returns true if the mask is a prefix
+   */
+  static bool IsIndexable (Ipv4Mask mask);
+
+  /**
+   * \brief Add a route after the other routes to the same prefix.
+   *
+   * \param entry the routing table entry, whose mask must be indexable
+   * \param tag the value kept with the entry
+   */
+  void Add (Ipv4RoutingTableEntry *entry, uint64_t tag);
+
+  /**
+   * \brief Remove a route.
+   *
+   * \param entry the routing table entry, which was added before
+   */
+  void Remove (Ipv4RoutingTableEntry *entry);
+
+  /**
+   * \brief Remove all the routes.
+   */
+  void Clear (void);
+
+  /**
+   * \brief Get the number of routes of the trie.
+   *
+   * \returns the number of routes
+   */
+  uint32_t GetNRoutes (void) const;
+
+  /**
+   * \brief Find the groups of routes whose prefix matches an address.
+   *
+   * \param address the address
+   * \param [out] matches the groups, from the longest prefix to the
+   * shortest, in an array of at least MAX_MATCHES elements
+   * \returns the number of groups
+   */
+  uint32_t Lookup (Ipv4Address address, const Routes **matches) const;
+
+private:
+  /**
+   * \brief A node of the trie, for a prefix which has routes or which is
+   * the longest common prefix of its two children.
+   */
+  struct Node
+  {
+    uint32_t prefix; //!< the prefix, with its host bits cleared
+    uint32_t length; //!< the length of the prefix
+    Node *child[2]; //!< the children, by the bit after the prefix
+    Routes routes; //!< the routes to the prefix
+  };
+
+  /// Copy constructor, disallowed.
+  Ipv4RouteTrie (const Ipv4RouteTrie &);
+  /// Assignment operator, disallowed.
+  Ipv4RouteTrie &operator = (const Ipv4RouteTrie &);
+
+  /**
+   * \brief Create a node.
+   *
+   * \param prefix the prefix
+   * \param length the length of the prefix
+   * \returns the node, with no children and no routes
+   */
+  static Node *CreateNode (uint32_t prefix, uint32_t length);
+
+  /**
+   * \brief Delete a node and its descendants.
+   *
+   * \param node the node, or 0
+   */
+  static void DeleteNodes (Node *node);
+
+  Node *m_root; //!< the root of the trie, 0 if it is empty
+  uint32_t m_nRoutes; //!< the number of routes
+};
+
+} // namespace ns3
+
+#endif /* IPV4_ROUTE_TRIE_H */
@@ -54,7 +54,8 @@ Ipv4StaticRouting::GetTypeId (void)
 }
 
 Ipv4StaticRouting::Ipv4StaticRouting () 
-  : m_ipv4 (0)
+  : m_nUnindexedRoutes (0),
+    m_ipv4 (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -73,6 +74,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  IndexRoute (route, metric);
 }
 
 void 
@@ -87,6 +89,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  IndexRoute (route, metric);
 }
 
 void 
@@ -144,6 +147,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
                                                         networkMask,
                                                         outputInterface);
   m_networkRoutes.push_back (make_pair (route,0));
+  IndexRoute (route, 0);
 }
 
 uint32_t 
@@ -219,28 +223,49 @@ Ipv4StaticRouting::RemoveMulticastRoute (uint32_t index)
     }
 }
 
-Ptr<Ipv4Route>
-Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
+Ipv4RoutingTableEntry *
+Ipv4StaticRouting::FindIndexedRoute (Ipv4Address dest, Ptr<NetDevice> oif) const
 {
   NS_LOG_FUNCTION (this << dest << " " << oif);
-  Ptr<Ipv4Route> rtentry = 0;
-  uint16_t longest_mask = 0;
-  uint32_t shortest_metric = 0xffffffff;
-  /* when sending on local multicast, there have to be interface specified */
-  if (dest.IsLocalMulticast ())
+  const Ipv4RouteTrie::Routes *matches[Ipv4RouteTrie::MAX_MATCHES];
+  uint32_t n = m_networkTrie.Lookup (dest, matches);
+  Ipv4RoutingTableEntry *route = 0;
+  for (uint32_t i = 0; i < n && route == 0; i++)
     {
-      NS_ASSERT_MSG (oif, "Try to send on link-local multicast address, and no interface index is given!");
-
-      rtentry = Create<Ipv4Route> ();
-      rtentry->SetDestination (dest);
-      rtentry->SetGateway (Ipv4Address::GetZero ());
-      rtentry->SetOutputDevice (oif);
-      rtentry->SetSource (m_ipv4->GetAddress (m_ipv4->GetInterfaceForDevice (oif), 0).GetLocal ());
-      return rtentry;
+      // the routes of the longest prefix, the first host route or else
+      // the last one with the smallest metric, as ScanRoutes ()
+      bool host = matches[i]->front ().entry->GetDestNetworkMask () == Ipv4Mask::GetOnes ();
+      uint64_t shortest_metric = 0xffffffff;
+      for (Ipv4RouteTrie::Routes::const_iterator j = matches[i]->begin (); j != matches[i]->end (); j++)
+        {
+          if (oif != 0 && oif != m_ipv4->GetNetDevice (j->entry->GetInterface ()))
+            {
+              NS_LOG_LOGIC ("Not on requested interface, skipping");
+              continue;
+            }
+          if (j->tag > shortest_metric)
+            {
+              continue;
+            }
+          shortest_metric = j->tag;
+          route = j->entry;
+          if (host)
+            {
+              break;
+            }
+        }
     }
+  return route;
+}
 
-
-  for (NetworkRoutesI i = m_networkRoutes.begin (); 
+Ipv4RoutingTableEntry *
+Ipv4StaticRouting::ScanRoutes (Ipv4Address dest, Ptr<NetDevice> oif) const
+{
+  NS_LOG_FUNCTION (this << dest << " " << oif);
+  Ipv4RoutingTableEntry *route = 0;
+  uint16_t longest_mask = 0;
+  uint32_t shortest_metric = 0xffffffff;
+  for (NetworkRoutesCI i = m_networkRoutes.begin (); 
        i != m_networkRoutes.end (); 
        i++) 
     {
@@ -277,19 +302,81 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
               continue;
             }
           shortest_metric = metric;
-          Ipv4RoutingTableEntry* route = (j);
-          uint32_t interfaceIdx = route->GetInterface ();
-          rtentry = Create<Ipv4Route> ();
-          rtentry->SetDestination (route->GetDest ());
-          rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
-          rtentry->SetGateway (route->GetGateway ());
-          rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
+          route = j;
           if (masklen == 32)
             {
               break;
             }
         }
     }
+  return route;
+}
+
+void
+Ipv4StaticRouting::IndexRoute (Ipv4RoutingTableEntry *route, uint32_t metric)
+{
+  NS_LOG_FUNCTION (this << route << metric);
+  if (Ipv4RouteTrie::IsIndexable (route->GetDestNetworkMask ()))
+    {
+      m_networkTrie.Add (route, metric);
+    }
+  else
+    {
+      m_nUnindexedRoutes++;
+    }
+}
+
+void
+Ipv4StaticRouting::UnindexRoute (Ipv4RoutingTableEntry *route)
+{
+  NS_LOG_FUNCTION (this << route);
+  if (Ipv4RouteTrie::IsIndexable (route->GetDestNetworkMask ()))
+    {
+      m_networkTrie.Remove (route);
+    }
+  else
+    {
+      m_nUnindexedRoutes--;
+    }
+}
+
+Ptr<Ipv4Route>
+Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
+{
+  NS_LOG_FUNCTION (this << dest << " " << oif);
+  Ptr<Ipv4Route> rtentry = 0;
+  /* when sending on local multicast, there have to be interface specified */
+  if (dest.IsLocalMulticast ())
+    {
+      NS_ASSERT_MSG (oif, "Try to send on link-local multicast address, and no interface index is given!");
+
+      rtentry = Create<Ipv4Route> ();
+      rtentry->SetDestination (dest);
+      rtentry->SetGateway (Ipv4Address::GetZero ());
+      rtentry->SetOutputDevice (oif);
+      rtentry->SetSource (m_ipv4->GetAddress (m_ipv4->GetInterfaceForDevice (oif), 0).GetLocal ());
+      return rtentry;
+    }
+
+
+  Ipv4RoutingTableEntry *route;
+  if (m_nUnindexedRoutes == 0)
+    {
+      route = FindIndexedRoute (dest, oif);
+    }
+  else
+    {
+      route = ScanRoutes (dest, oif);
+    }
+  if (route != 0)
+    {
+      uint32_t interfaceIdx = route->GetInterface ();
+      rtentry = Create<Ipv4Route> ();
+      rtentry->SetDestination (route->GetDest ());
+      rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
+      rtentry->SetGateway (route->GetGateway ());
+      rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
+    }
   if (rtentry != 0)
     {
       NS_LOG_LOGIC ("Matching route via " << rtentry->GetGateway () << " at the end");
@@ -447,6 +534,7 @@ Ipv4StaticRouting::RemoveRoute (uint32_t index)
     {
       if (tmp == index)
         {
+          UnindexRoute (j->first);
           delete j->first;
           m_networkRoutes.erase (j);
           return;
@@ -575,6 +663,8 @@ Ipv4StaticRouting::DoDispose (void)
     {
       delete (j->first);
     }
+  m_networkTrie.Clear ();
+  m_nUnindexedRoutes = 0;
   for (MulticastRoutesI i = m_multicastRoutes.begin (); 
        i != m_multicastRoutes.end (); 
        i = m_multicastRoutes.erase (i)) 
@@ -613,6 +703,7 @@ Ipv4StaticRouting::NotifyInterfaceDown (uint32_t i)
     {
       if (it->first->GetInterface () == i)
         {
+          UnindexRoute (it->first);
           delete it->first;
           it = m_networkRoutes.erase (it);
         }
@@ -660,6 +751,7 @@ Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
           && it->first->GetDestNetwork () == networkAddress
           && it->first->GetDestNetworkMask () == networkMask)
         {
+          UnindexRoute (it->first);
           delete it->first;
           it = m_networkRoutes.erase (it);
         }
@@ -31,6 +31,7 @@
 #include "ns3/ptr.h"
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
+#include "ipv4-route-trie.h"
 
 namespace ns3 {
 
@@ -417,11 +418,53 @@ private:
   Ptr<Ipv4MulticastRoute> LookupStatic (Ipv4Address origin, Ipv4Address group,
                                         uint32_t interface);
 
+  /**
+   * \brief Find the route to a destination in the trie of the routes.
+   * \param dest destination address
+   * \param oif output interface if any (put 0 otherwise)
+   * \return the route with the longest prefix and the smallest metric
+   * among those with the longest prefix, or 0
+   */
+  Ipv4RoutingTableEntry *FindIndexedRoute (Ipv4Address dest, Ptr<NetDevice> oif) const;
+
+  /**
+   * \brief Find the route to a destination by walking the list of routes,
+   * when some routes cannot be indexed.
+   * \param dest destination address
+   * \param oif output interface if any (put 0 otherwise)
+   * \return the same route as FindIndexedRoute ()
+   */
+  Ipv4RoutingTableEntry *ScanRoutes (Ipv4Address dest, Ptr<NetDevice> oif) const;
+
+  /**
+   * \brief Add a new route to the trie of the routes.
+   * \param route the route
+   * \param metric the metric of the route
+   */
+  void IndexRoute (Ipv4RoutingTableEntry *route, uint32_t metric);
+
+  /**
+   * \brief Remove a route from the trie of the routes.
+   * \param route the route
+   */
+  void UnindexRoute (Ipv4RoutingTableEntry *route);
+
   /**
    * \brief the forwarding table for network.
    */
   NetworkRoutes m_networkRoutes;
 
+  /**
+   * \brief the longest prefix match index of the forwarding table,
+   * tagged with the metrics of the routes.
+   */
+  Ipv4RouteTrie m_networkTrie;
+
+  /**
+   * \brief the number of routes whose mask is not a prefix.
+   */
+  uint32_t m_nUnindexedRoutes;
+
   /**
    * \brief the forwarding table for multicast.
    */
@@ -26,7 +26,20 @@
 #include "ns3/global-route-manager-impl.h"
 #include "ns3/candidate-queue.h"
 #include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/uinteger.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/global-router-interface.h"
 #include <cstdlib> // for rand()
+#include <sstream>
+#include <string>
+#include <vector>
 
 using namespace ns3;
 
@@ -213,6 +226,210 @@ GlobalRouteManagerImplTestCase::DoRun (void)
   // does not crash
 }
 
+class CandidateQueueOrderTestCase : public TestCase
+{
+public:
+  CandidateQueueOrderTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Create a vertex.
+   * \param id the vertex id
+   * \param type the vertex type
+   * \param distance the distance from the root
+   * \returns the vertex
+   */
+  SPFVertex * MakeVertex (const char *id, SPFVertex::VertexType type, uint32_t distance);
+  /**
+   * Pop the vertices of a queue, and check their order.
+   * \param queue the queue
+   * \param expected the ids of the vertices, in the expected order
+   * \param n the number of vertices
+   */
+  void CheckOrder (CandidateQueue &queue, const char *expected[], uint32_t n);
+};
+
+CandidateQueueOrderTestCase::CandidateQueueOrderTestCase ()
+  : TestCase ("CandidateQueue tie-breaking and reordering")
+{
+}
+
+SPFVertex *
+CandidateQueueOrderTestCase::MakeVertex (const char *id, SPFVertex::VertexType type, uint32_t distance)
+{
+  SPFVertex *v = new SPFVertex;
+  v->SetVertexId (Ipv4Address (id));
+  v->SetVertexType (type);
+  v->SetDistanceFromRoot (distance);
+  return v;
+}
+
+void
+CandidateQueueOrderTestCase::CheckOrder (CandidateQueue &queue, const char *expected[], uint32_t n)
+{
+  NS_TEST_ASSERT_MSG_EQ (queue.Size (), n, "Wrong number of candidates");
+  for (uint32_t i = 0; i < n; i++)
+    {
+      SPFVertex *v = queue.Pop ();
+      NS_TEST_EXPECT_MSG_EQ (v->GetVertexId (), Ipv4Address (expected[i]),
+                             "Wrong candidate at position " << i);
+      delete v;
+    }
+  NS_TEST_ASSERT_MSG_EQ (queue.Empty (), true, "Candidates left in the queue");
+}
+
+void
+CandidateQueueOrderTestCase::DoRun (void)
+{
+  // Equal distances: network vertices first, then first in, first out
+  CandidateQueue ties;
+  ties.Push (MakeVertex ("0.0.0.1", SPFVertex::VertexRouter, 5));
+  ties.Push (MakeVertex ("10.0.0.1", SPFVertex::VertexNetwork, 5));
+  ties.Push (MakeVertex ("0.0.0.2", SPFVertex::VertexRouter, 5));
+  ties.Push (MakeVertex ("10.0.0.2", SPFVertex::VertexNetwork, 5));
+  ties.Push (MakeVertex ("0.0.0.3", SPFVertex::VertexRouter, 3));
+  ties.Push (MakeVertex ("0.0.0.4", SPFVertex::VertexRouter, 7));
+  const char *tiesOrder[] = { "0.0.0.3", "10.0.0.1", "10.0.0.2", "0.0.0.1", "0.0.0.2", "0.0.0.4" };
+  CheckOrder (ties, tiesOrder, 6);
+
+  // A vertex whose distance decreased to a tie goes after the vertices
+  // already at that distance, and before them if it is a network
+  CandidateQueue decrease;
+  decrease.Push (MakeVertex ("0.0.0.1", SPFVertex::VertexRouter, 10));
+  decrease.Push (MakeVertex ("0.0.0.2", SPFVertex::VertexRouter, 12));
+  decrease.Push (MakeVertex ("0.0.0.3", SPFVertex::VertexRouter, 10));
+  decrease.Push (MakeVertex ("0.0.0.4", SPFVertex::VertexRouter, 20));
+  decrease.Push (MakeVertex ("10.0.0.1", SPFVertex::VertexNetwork, 15));
+  SPFVertex *v = decrease.Find (Ipv4Address ("0.0.0.2"));
+  v->SetDistanceFromRoot (10);
+  decrease.Reorder (v);
+  v = decrease.Find (Ipv4Address ("0.0.0.4"));
+  v->SetDistanceFromRoot (8);
+  decrease.Reorder (v);
+  v = decrease.Find (Ipv4Address ("10.0.0.1"));
+  v->SetDistanceFromRoot (10);
+  decrease.Reorder (v);
+  const char *decreaseOrder[] = { "0.0.0.4", "10.0.0.1", "0.0.0.1", "0.0.0.3", "0.0.0.2" };
+  CheckOrder (decrease, decreaseOrder, 5);
+
+  // Reorder () of several vertices keeps their previous relative order
+  CandidateQueue reorder;
+  reorder.Push (MakeVertex ("0.0.0.1", SPFVertex::VertexRouter, 7));
+  reorder.Push (MakeVertex ("0.0.0.2", SPFVertex::VertexRouter, 12));
+  reorder.Push (MakeVertex ("0.0.0.3", SPFVertex::VertexRouter, 9));
+  reorder.Push (MakeVertex ("0.0.0.4", SPFVertex::VertexRouter, 9));
+  reorder.Push (MakeVertex ("0.0.0.5", SPFVertex::VertexRouter, 8));
+  reorder.Find (Ipv4Address ("0.0.0.4"))->SetDistanceFromRoot (7);
+  reorder.Find (Ipv4Address ("0.0.0.3"))->SetDistanceFromRoot (7);
+  reorder.Find (Ipv4Address ("0.0.0.2"))->SetDistanceFromRoot (7);
+  reorder.Reorder ();
+  const char *reorderOrder[] = { "0.0.0.1", "0.0.0.3", "0.0.0.4", "0.0.0.2", "0.0.0.5" };
+  CheckOrder (reorder, reorderOrder, 5);
+}
+
+class GlobalRouteManagerThreadsTestCase : public TestCase
+{
+public:
+  GlobalRouteManagerThreadsTestCase ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Compute the global routes of a grid of routers.
+   * \param threads the number of threads which compute the routes
+   * \param ecmpRoutes set to the number of destinations of the first
+   * router which have several equal-cost routes
+   * \returns the routing tables of all the routers
+   */
+  std::string ComputeRoutes (uint32_t threads, uint32_t &ecmpRoutes);
+};
+
+GlobalRouteManagerThreadsTestCase::GlobalRouteManagerThreadsTestCase ()
+  : TestCase ("Global routes computed by several threads")
+{
+}
+
+std::string
+GlobalRouteManagerThreadsTestCase::ComputeRoutes (uint32_t threads, uint32_t &ecmpRoutes)
+{
+  Config::SetGlobal ("GlobalRoutingThreadCount", UintegerValue (threads));
+
+  // A 4x4 grid of routers linked by point-to-point links, with a stub
+  // broadcast network on each router. Transit networks are left out:
+  // the next hops to a transit network reached by several equal-cost
+  // paths are not supported.
+  const uint32_t size = 4;
+  NodeContainer nodes;
+  nodes.Create (size * size);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  SimpleNetDeviceHelper devHelper;
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.255.0");
+  devHelper.SetNetDevicePointToPointMode (true);
+  for (uint32_t row = 0; row < size; row++)
+    {
+      for (uint32_t col = 0; col < size; col++)
+        {
+          if (col + 1 < size)
+            {
+              ipv4.Assign (devHelper.Install (NodeContainer (nodes.Get (row * size + col),
+                                                             nodes.Get (row * size + col + 1))));
+              ipv4.NewNetwork ();
+            }
+          if (row + 1 < size)
+            {
+              ipv4.Assign (devHelper.Install (NodeContainer (nodes.Get (row * size + col),
+                                                             nodes.Get ((row + 1) * size + col))));
+              ipv4.NewNetwork ();
+            }
+        }
+    }
+  devHelper.SetNetDevicePointToPointMode (false);
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      ipv4.Assign (devHelper.Install (nodes.Get (i)));
+      ipv4.NewNetwork ();
+    }
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  std::ostringstream oss;
+  ecmpRoutes = 0;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = nodes.Get (i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      oss << "Node " << i << std::endl;
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          Ipv4RoutingTableEntry *route = routing->GetRoute (j);
+          oss << *route << std::endl;
+          if (i == 0 && j > 0 && route->GetDest () == routing->GetRoute (j - 1)->GetDest ())
+            {
+              ecmpRoutes++;
+            }
+        }
+    }
+
+  Simulator::Destroy ();
+  Config::SetGlobal ("GlobalRoutingThreadCount", UintegerValue (1));
+  return oss.str ();
+}
+
+void
+GlobalRouteManagerThreadsTestCase::DoRun (void)
+{
+  uint32_t ecmpRoutes;
+  std::string expected = ComputeRoutes (1, ecmpRoutes);
+  NS_TEST_ASSERT_MSG_GT (ecmpRoutes, 0, "The topology has no equal-cost routes");
+
+  uint32_t threadCounts[] = { 2, 3, 8 };
+  for (uint32_t i = 0; i < sizeof (threadCounts) / sizeof (threadCounts[0]); i++)
+    {
+      uint32_t threadEcmpRoutes;
+      std::string routes = ComputeRoutes (threadCounts[i], threadEcmpRoutes);
+      NS_TEST_EXPECT_MSG_EQ (routes, expected, "Different routes with " << threadCounts[i] << " threads");
+    }
+}
 
 static class GlobalRouteManagerImplTestSuite : public TestSuite
 {
@@ -221,5 +438,7 @@ public:
     : TestSuite ("global-route-manager-impl", UNIT)
   {
     AddTestCase (new GlobalRouteManagerImplTestCase (), TestCase::QUICK);
+    AddTestCase (new CandidateQueueOrderTestCase (), TestCase::QUICK);
+    AddTestCase (new GlobalRouteManagerThreadsTestCase (), TestCase::QUICK);
   }
 } g_globalRoutingManagerImplTestSuite;
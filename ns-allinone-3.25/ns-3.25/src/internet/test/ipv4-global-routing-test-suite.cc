@@ -14,9 +14,13 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+#include <sstream>
 #include <vector>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
+#include "ns3/global-router-interface.h"
+#include "ns3/ipv4-global-routing.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
@@ -36,6 +40,7 @@
 #include "ns3/simple-channel.h"
 #include "ns3/socket-factory.h"
 #include "ns3/udp-socket-factory.h"
+#include "ns3/udp-header.h"
 
 using namespace ns3;
 
@@ -420,6 +425,312 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
 }
 
 
+// Test that an incremental recomputation of the routes gives the same
+// routes as a full one, for a series of link failures and repairs.
+//
+//  n7
+//   |p-p
+//  n0 --- n1 ------------------  (shared, metric 10)
+//   |      |         |      |
+//  n3 --- n2 ------ n4 --- n5 --- n6
+//   |             p-p    p-p       |
+//   --------------------------------
+//                p-p
+//
+// The shared network is never on the shortest path to a router, since
+// the SPF calculation does not support several equal cost paths to the
+// routers behind a network which is not adjacent to the root.
+//
+class Ipv4IncrementalGlobalRoutingTestCase : public TestCase
+{
+public:
+  Ipv4IncrementalGlobalRoutingTestCase ();
+  virtual ~Ipv4IncrementalGlobalRoutingTestCase ();
+
+private:
+  /**
+   * Set both ends of a link up or down.
+   * \param devices The devices of the link.
+   * \param up Whether to set the link up.
+   */
+  void SetLink (NetDeviceContainer devices, bool up);
+  /**
+   * Get the sorted routes of all the nodes.
+   * \param nodes The nodes.
+   * \returns The routes, one node per line.
+   */
+  std::string GetRoutes (NodeContainer nodes);
+  virtual void DoRun (void);
+};
+
+Ipv4IncrementalGlobalRoutingTestCase::Ipv4IncrementalGlobalRoutingTestCase ()
+  : TestCase ("Incremental recomputation of the global routes")
+{
+}
+
+Ipv4IncrementalGlobalRoutingTestCase::~Ipv4IncrementalGlobalRoutingTestCase ()
+{
+}
+
+void
+Ipv4IncrementalGlobalRoutingTestCase::SetLink (NetDeviceContainer devices, bool up)
+{
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      Ptr<Ipv4> ipv4 = devices.Get (i)->GetNode ()->GetObject<Ipv4> ();
+      int32_t interface = ipv4->GetInterfaceForDevice (devices.Get (i));
+      if (up)
+        {
+          ipv4->SetUp (interface);
+        }
+      else
+        {
+          ipv4->SetDown (interface);
+        }
+    }
+}
+
+std::string
+Ipv4IncrementalGlobalRoutingTestCase::GetRoutes (NodeContainer nodes)
+{
+  std::ostringstream os;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = nodes.Get (i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      std::vector<std::string> routes;
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          std::ostringstream route;
+          route << *routing->GetRoute (j);
+          routes.push_back (route.str ());
+        }
+      std::sort (routes.begin (), routes.end ());
+      os << "node " << i << ":";
+      for (uint32_t j = 0; j < routes.size (); j++)
+        {
+          os << " [" << routes[j] << "]";
+        }
+      os << std::endl;
+    }
+  return os.str ();
+}
+
+void
+Ipv4IncrementalGlobalRoutingTestCase::DoRun (void)
+{
+  NodeContainer c;
+  c.Create (8);
+  InternetStackHelper internet;
+  internet.Install (c);
+
+  SimpleNetDeviceHelper devHelper;
+  devHelper.SetNetDevicePointToPointMode (true);
+  NetDeviceContainer d0d1 = devHelper.Install (NodeContainer (c.Get (0), c.Get (1)));
+  NetDeviceContainer d1d2 = devHelper.Install (NodeContainer (c.Get (1), c.Get (2)));
+  NetDeviceContainer d2d3 = devHelper.Install (NodeContainer (c.Get (2), c.Get (3)));
+  NetDeviceContainer d3d0 = devHelper.Install (NodeContainer (c.Get (3), c.Get (0)));
+  NetDeviceContainer d2d4 = devHelper.Install (NodeContainer (c.Get (2), c.Get (4)));
+  NetDeviceContainer d4d5 = devHelper.Install (NodeContainer (c.Get (4), c.Get (5)));
+  NetDeviceContainer d5d6 = devHelper.Install (NodeContainer (c.Get (5), c.Get (6)));
+  NetDeviceContainer d3d6 = devHelper.Install (NodeContainer (c.Get (3), c.Get (6)));
+  NetDeviceContainer d0d7 = devHelper.Install (NodeContainer (c.Get (0), c.Get (7)));
+  devHelper.SetNetDevicePointToPointMode (false);
+  NetDeviceContainer d145 = devHelper.Install (NodeContainer (c.Get (1), c.Get (4), c.Get (5)));
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.255.252");
+  NetDeviceContainer links[] = { d0d1, d1d2, d2d3, d3d0, d2d4, d4d5, d5d6, d3d6, d0d7 };
+  for (uint32_t i = 0; i < sizeof (links) / sizeof (links[0]); i++)
+    {
+      ipv4.Assign (links[i]);
+      ipv4.NewNetwork ();
+    }
+  ipv4.SetBase ("10.1.0.0", "255.255.255.0");
+  ipv4.Assign (d145);
+  for (uint32_t i = 0; i < d145.GetN (); i++)
+    {
+      Ptr<Ipv4> ip = d145.Get (i)->GetNode ()->GetObject<Ipv4> ();
+      ip->SetMetric (ip->GetInterfaceForDevice (d145.Get (i)), 10);
+    }
+
+  Config::SetGlobal ("GlobalRoutingIncrementalRecompute", BooleanValue (true));
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+
+  // The changes of the topology, applied in turn
+  NetDeviceContainer lanDevice5 (d145.Get (2));
+  NetDeviceContainer endDevice6 (d5d6.Get (1));
+  struct
+  {
+    NetDeviceContainer devices;
+    bool up;
+  } changes[] = {
+    { d0d1, false },
+    { d2d4, false },
+    { d0d1, true },
+    { lanDevice5, false },
+    { d2d4, true },
+    { d3d6, false },
+    { endDevice6, false },
+    { lanDevice5, true },
+    { d0d7, false },
+    { d3d6, true },
+    { endDevice6, true },
+    { d0d7, true },
+  };
+  for (uint32_t i = 0; i < sizeof (changes) / sizeof (changes[0]); i++)
+    {
+      SetLink (changes[i].devices, changes[i].up);
+      Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+      std::string incremental = GetRoutes (c);
+
+      Config::SetGlobal ("GlobalRoutingIncrementalRecompute", BooleanValue (false));
+      Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+      std::string full = GetRoutes (c);
+      NS_TEST_ASSERT_MSG_EQ (incremental, full, "Incremental and full routes differ after change " << i);
+
+      // start the next change from the routes of a full recomputation
+      Config::SetGlobal ("GlobalRoutingIncrementalRecompute", BooleanValue (true));
+      Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+    }
+  Config::SetGlobal ("GlobalRoutingIncrementalRecompute", BooleanValue (false));
+
+  Simulator::Destroy ();
+}
+
+// Two equal cost routes lead from a router to 192.168.0.0/16.  With flow
+// ECMP routing, the packets of a flow take the same route and different
+// flows take both routes; the cached routes are shared between packets
+// and follow the changes of the routing table.
+//
+class Ipv4GlobalRoutingFlowEcmpTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingFlowEcmpTestCase ();
+  virtual ~Ipv4GlobalRoutingFlowEcmpTestCase ();
+
+private:
+  /**
+   * Route a UDP packet received by the router.
+   * \param source The source port.
+   * \param destination The destination port.
+   * \returns The route of the packet, or 0 if there is none.
+   */
+  Ptr<Ipv4Route> Forward (uint16_t source, uint16_t destination);
+  /**
+   * Record the route of a forwarded packet.
+   * \param route The route.
+   * \param p The packet.
+   * \param header The IP header of the packet.
+   */
+  void ReceiveRoute (Ptr<Ipv4Route> route, Ptr<const Packet> p, const Ipv4Header &header);
+  virtual void DoRun (void);
+
+  Ptr<Ipv4GlobalRouting> m_routing; //!< The routing protocol of the router
+  Ptr<NetDevice> m_inputDevice;     //!< The device which receives the packets
+  Ptr<Ipv4Route> m_route;           //!< The route of the last packet
+};
+
+Ipv4GlobalRoutingFlowEcmpTestCase::Ipv4GlobalRoutingFlowEcmpTestCase ()
+  : TestCase ("Flow ECMP routing and route cache of the global routing")
+{
+}
+
+Ipv4GlobalRoutingFlowEcmpTestCase::~Ipv4GlobalRoutingFlowEcmpTestCase ()
+{
+}
+
+void
+Ipv4GlobalRoutingFlowEcmpTestCase::ReceiveRoute (Ptr<Ipv4Route> route, Ptr<const Packet> p, const Ipv4Header &header)
+{
+  m_route = route;
+}
+
+Ptr<Ipv4Route>
+Ipv4GlobalRoutingFlowEcmpTestCase::Forward (uint16_t source, uint16_t destination)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  UdpHeader udp;
+  udp.SetSourcePort (source);
+  udp.SetDestinationPort (destination);
+  p->AddHeader (udp);
+  Ipv4Header header;
+  header.SetSource (Ipv4Address ("10.1.1.2"));
+  header.SetDestination (Ipv4Address ("192.168.1.1"));
+  header.SetProtocol (17);
+  m_route = 0;
+  m_routing->RouteInput (p, header, m_inputDevice,
+                         MakeCallback (&Ipv4GlobalRoutingFlowEcmpTestCase::ReceiveRoute, this),
+                         Ipv4RoutingProtocol::MulticastForwardCallback (),
+                         Ipv4RoutingProtocol::LocalDeliverCallback (),
+                         Ipv4RoutingProtocol::ErrorCallback ());
+  return m_route;
+}
+
+void
+Ipv4GlobalRoutingFlowEcmpTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  SimpleNetDeviceHelper devHelper;
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      devices.Add (devHelper.Install (node));
+    }
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      ipv4.Assign (NetDeviceContainer (devices.Get (i)));
+      ipv4.NewNetwork ();
+    }
+  m_inputDevice = devices.Get (0);
+  m_routing = node->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+  m_routing->SetAttribute ("FlowEcmpRouting", BooleanValue (true));
+  m_routing->AddNetworkRouteTo (Ipv4Address ("192.168.0.0"), Ipv4Mask ("255.255.0.0"), Ipv4Address ("10.1.2.2"), 2);
+  m_routing->AddNetworkRouteTo (Ipv4Address ("192.168.0.0"), Ipv4Mask ("255.255.0.0"), Ipv4Address ("10.1.3.2"), 3);
+
+  uint32_t used[2] = { 0, 0 };
+  for (uint16_t port = 1000; port < 1100; port++)
+    {
+      Ptr<Ipv4Route> route = Forward (port, 9);
+      NS_TEST_ASSERT_MSG_NE (route, 0, "No route for port " << port);
+      NS_TEST_ASSERT_MSG_EQ (Forward (port, 9), route, "Packets of the same flow take different routes");
+      used[route->GetGateway () == Ipv4Address ("10.1.2.2") ? 0 : 1]++;
+    }
+  NS_TEST_ASSERT_MSG_GT (used[0], 0, "The first route is never used");
+  NS_TEST_ASSERT_MSG_GT (used[1], 0, "The second route is never used");
+
+  // The cache must not keep a removed route
+  for (uint32_t i = 0; i < m_routing->GetNRoutes (); i++)
+    {
+      if (m_routing->GetRoute (i)->GetGateway () == Ipv4Address ("10.1.2.2"))
+        {
+          m_routing->RemoveRoute (i);
+          break;
+        }
+    }
+  for (uint16_t port = 1000; port < 1100; port++)
+    {
+      Ptr<Ipv4Route> route = Forward (port, 9);
+      NS_TEST_ASSERT_MSG_NE (route, 0, "No route for port " << port);
+      NS_TEST_ASSERT_MSG_EQ (route->GetGateway (), Ipv4Address ("10.1.3.2"), "Removed route still used");
+    }
+
+  // Without the cache, each packet gets its own route object
+  m_routing->SetAttribute ("RouteCacheSize", UintegerValue (0));
+  Ptr<Ipv4Route> route = Forward (1000, 9);
+  NS_TEST_ASSERT_MSG_NE (route, 0, "No route without the cache");
+  NS_TEST_ASSERT_MSG_NE (Forward (1000, 9), route, "Route object shared without the cache");
+  NS_TEST_ASSERT_MSG_EQ (route->GetGateway (), Ipv4Address ("10.1.3.2"), "Wrong route without the cache");
+
+  m_routing = 0;
+  m_inputDevice = 0;
+  m_route = 0;
+  Simulator::Destroy ();
+}
+
 class Ipv4GlobalRoutingTestSuite : public TestSuite
 {
 public:
@@ -431,6 +742,8 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
 {
   AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
   AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4IncrementalGlobalRoutingTestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4GlobalRoutingFlowEcmpTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -0,0 +1,341 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Tests of the longest prefix match index of the routing tables, and of
+// the lookups of the static and global routing tables through it
+
+#include <vector>
+
+#include "ns3/global-router-interface.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4-route-trie.h"
+#include "ns3/ipv4-routing-table-entry.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/node.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/** The prefix lengths of the random routes. */
+static const uint32_t g_lengths[] = { 0, 8, 16, 20, 24, 24, 28, 30, 32, 32 };
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Compare the matches of the trie with those of a walk of all the
+ * routes, while routes are added and removed.
+ */
+class Ipv4RouteTrieTestCase : public TestCase
+{
+public:
+  Ipv4RouteTrieTestCase ();
+  virtual ~Ipv4RouteTrieTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Check the lookups of random addresses.
+   *
+   * \param trie the trie
+   * \param routes the routes of the trie, in the order in which they were added
+   * \param random the random variable which draws the addresses
+   */
+  void CheckLookups (const Ipv4RouteTrie &trie, const std::vector<Ipv4RoutingTableEntry *> &routes,
+                     Ptr<UniformRandomVariable> random);
+};
+
+Ipv4RouteTrieTestCase::Ipv4RouteTrieTestCase ()
+  : TestCase ("Longest prefix match trie")
+{
+}
+
+Ipv4RouteTrieTestCase::~Ipv4RouteTrieTestCase ()
+{
+}
+
+void
+Ipv4RouteTrieTestCase::CheckLookups (const Ipv4RouteTrie &trie,
+                                     const std::vector<Ipv4RoutingTableEntry *> &routes,
+                                     Ptr<UniformRandomVariable> random)
+{
+  NS_TEST_ASSERT_MSG_EQ (trie.GetNRoutes (), routes.size (), "Wrong number of routes");
+  for (uint32_t i = 0; i < 200; i++)
+    {
+      Ipv4Address address ((10 << 24) | random->GetInteger (0, 0x1ffff));
+      const Ipv4RouteTrie::Routes *matches[Ipv4RouteTrie::MAX_MATCHES];
+      uint32_t n = trie.Lookup (address, matches);
+      // the matching routes, by decreasing prefix length then in order
+      std::vector<Ipv4RoutingTableEntry *> expected;
+      for (int32_t length = 32; length >= 0; length--)
+        {
+          for (uint32_t j = 0; j < routes.size (); j++)
+            {
+              Ipv4Mask mask = routes[j]->GetDestNetworkMask ();
+              if (mask.GetPrefixLength () == length && mask.IsMatch (address, routes[j]->GetDest ()))
+                {
+                  expected.push_back (routes[j]);
+                }
+            }
+        }
+      std::vector<Ipv4RoutingTableEntry *> found;
+      for (uint32_t j = 0; j < n; j++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (matches[j]->empty (), false, "Empty group of routes");
+          uint32_t length = matches[j]->front ().entry->GetDestNetworkMask ().GetPrefixLength ();
+          for (uint32_t k = 0; k < matches[j]->size (); k++)
+            {
+              Ipv4RoutingTableEntry *entry = (*matches[j])[k].entry;
+              NS_TEST_ASSERT_MSG_EQ (entry->GetDestNetworkMask ().GetPrefixLength (), length,
+                                     "Routes of different prefixes in a group");
+              NS_TEST_ASSERT_MSG_EQ ((*matches[j])[k].tag, entry->GetDest ().Get (), "Wrong tag");
+              found.push_back (entry);
+            }
+        }
+      NS_TEST_ASSERT_MSG_EQ (found.size (), expected.size (), "Wrong number of routes to " << address);
+      for (uint32_t j = 0; j < found.size (); j++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (found[j], expected[j], "Wrong route to " << address);
+        }
+    }
+}
+
+void
+Ipv4RouteTrieTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+  Ipv4RouteTrie trie;
+  std::vector<Ipv4RoutingTableEntry *> routes;
+  NS_TEST_ASSERT_MSG_EQ (Ipv4RouteTrie::IsIndexable (Ipv4Mask ("255.255.240.0")), true, "Prefix not indexable");
+  NS_TEST_ASSERT_MSG_EQ (Ipv4RouteTrie::IsIndexable (Ipv4Mask ("255.0.255.0")), false, "Non prefix indexable");
+  for (uint32_t round = 0; round < 10; round++)
+    {
+      for (uint32_t i = 0; i < 50; i++)
+        {
+          Ipv4Address dest ((10 << 24) | random->GetInteger (0, 0x1ffff));
+          Ipv4Mask mask;
+          uint32_t length = g_lengths[random->GetInteger (0, sizeof (g_lengths) / sizeof (g_lengths[0]) - 1)];
+          mask.Set (length == 0 ? 0 : 0xffffffffU << (32 - length));
+          Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
+          *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo (dest, mask, Ipv4Address ("10.255.0.1"), 1);
+          trie.Add (route, dest.Get ());
+          routes.push_back (route);
+        }
+      CheckLookups (trie, routes, random);
+      for (uint32_t i = 0; i < 30; i++)
+        {
+          uint32_t index = random->GetInteger (0, routes.size () - 1);
+          trie.Remove (routes[index]);
+          delete routes[index];
+          routes.erase (routes.begin () + index);
+        }
+      CheckLookups (trie, routes, random);
+    }
+  trie.Clear ();
+  for (uint32_t i = 0; i < routes.size (); i++)
+    {
+      delete routes[i];
+    }
+  routes.clear ();
+  CheckLookups (trie, routes, random);
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Compare the routes found by the static and global routing
+ * protocols through their tries with those found by walking their lists
+ * of routes, which they fall back to while a route has a mask which is
+ * not a prefix.
+ */
+class Ipv4IndexedLookupTestCase : public TestCase
+{
+public:
+  Ipv4IndexedLookupTestCase ();
+  virtual ~Ipv4IndexedLookupTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Look up random destinations.
+   *
+   * \param routing the routing protocol
+   * \param oif the output device, or 0
+   * \param [out] routes the routes found, 0 if none
+   */
+  void Lookup (Ptr<Ipv4RoutingProtocol> routing, Ptr<NetDevice> oif, std::vector<Ptr<Ipv4Route> > &routes);
+  /**
+   * \brief Check that the routes of the indexed and walked lookups are
+   * the same.
+   *
+   * \param indexed the routes found through the trie
+   * \param scanned the routes found through the lists
+   */
+  void CheckRoutes (const std::vector<Ptr<Ipv4Route> > &indexed, const std::vector<Ptr<Ipv4Route> > &scanned);
+};
+
+Ipv4IndexedLookupTestCase::Ipv4IndexedLookupTestCase ()
+  : TestCase ("Static and global routing lookups through the trie")
+{
+}
+
+Ipv4IndexedLookupTestCase::~Ipv4IndexedLookupTestCase ()
+{
+}
+
+void
+Ipv4IndexedLookupTestCase::Lookup (Ptr<Ipv4RoutingProtocol> routing, Ptr<NetDevice> oif,
+                                   std::vector<Ptr<Ipv4Route> > &routes)
+{
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (2);
+  routes.clear ();
+  for (uint32_t i = 0; i < 500; i++)
+    {
+      Ipv4Header header;
+      header.SetDestination (Ipv4Address ((10 << 24) | random->GetInteger (0, 0x1ffff)));
+      Socket::SocketErrno sockerr;
+      routes.push_back (routing->RouteOutput (0, header, oif, sockerr));
+    }
+}
+
+void
+Ipv4IndexedLookupTestCase::CheckRoutes (const std::vector<Ptr<Ipv4Route> > &indexed,
+                                        const std::vector<Ptr<Ipv4Route> > &scanned)
+{
+  uint32_t nFound = 0;
+  for (uint32_t i = 0; i < indexed.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((indexed[i] == 0), (scanned[i] == 0), "Route found by one lookup only");
+      if (indexed[i] == 0)
+        {
+          continue;
+        }
+      nFound++;
+      NS_TEST_ASSERT_MSG_EQ (indexed[i]->GetGateway (), scanned[i]->GetGateway (), "Different gateways");
+      NS_TEST_ASSERT_MSG_EQ (indexed[i]->GetOutputDevice (), scanned[i]->GetOutputDevice (), "Different devices");
+      NS_TEST_ASSERT_MSG_EQ (indexed[i]->GetDestination (), scanned[i]->GetDestination (), "Different destinations");
+    }
+  NS_TEST_ASSERT_MSG_GT (nFound, 0, "No route found");
+}
+
+void
+Ipv4IndexedLookupTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  SimpleNetDeviceHelper devHelper;
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      devices.Add (devHelper.Install (node));
+    }
+  Ipv4AddressHelper address ("172.16.0.0", "255.255.255.0");
+  address.Assign (devices);
+
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  Ipv4StaticRoutingHelper staticHelper;
+  Ptr<Ipv4StaticRouting> staticRouting = staticHelper.GetStaticRouting (ipv4);
+  Ptr<Ipv4GlobalRouting> globalRouting = node->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+
+  // overlapping routes, several to the same prefixes, with equal metrics
+  Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable> ();
+  random->SetStream (1);
+  for (uint32_t i = 0; i < 400; i++)
+    {
+      Ipv4Address dest ((10 << 24) | random->GetInteger (0, 0x1ffff));
+      uint32_t length = g_lengths[random->GetInteger (1, sizeof (g_lengths) / sizeof (g_lengths[0]) - 1)];
+      Ipv4Mask mask;
+      mask.Set (0xffffffffU << (32 - length));
+      Ipv4Address gateway ((172 << 24) | (16 << 16) | random->GetInteger (0, 0x2ff));
+      uint32_t interface = random->GetInteger (1, 3);
+      staticRouting->AddNetworkRouteTo (dest, mask, gateway, interface, random->GetInteger (0, 3));
+      switch (random->GetInteger (0, 2))
+        {
+        case 0:
+          globalRouting->AddHostRouteTo (dest, gateway, interface);
+          break;
+        case 1:
+          globalRouting->AddNetworkRouteTo (dest, mask, gateway, interface);
+          break;
+        default:
+          globalRouting->AddASExternalRouteTo (dest, mask, gateway, interface);
+          break;
+        }
+    }
+  staticRouting->SetDefaultRoute (Ipv4Address ("172.16.0.254"), 1, 5);
+
+  std::vector<Ptr<NetDevice> > oifs;
+  oifs.push_back (0);
+  oifs.push_back (devices.Get (1));
+  for (uint32_t i = 0; i < oifs.size (); i++)
+    {
+      std::vector<Ptr<Ipv4Route> > staticIndexed;
+      std::vector<Ptr<Ipv4Route> > globalIndexed;
+      Lookup (staticRouting, oifs[i], staticIndexed);
+      Lookup (globalRouting, oifs[i], globalIndexed);
+      // a mask which is not a prefix, and matches none of the destinations
+      staticRouting->AddNetworkRouteTo (Ipv4Address ("192.0.168.0"), Ipv4Mask ("255.0.255.0"), 1);
+      globalRouting->AddNetworkRouteTo (Ipv4Address ("192.0.168.0"), Ipv4Mask ("255.0.255.0"), 1);
+      std::vector<Ptr<Ipv4Route> > staticScanned;
+      std::vector<Ptr<Ipv4Route> > globalScanned;
+      Lookup (staticRouting, oifs[i], staticScanned);
+      Lookup (globalRouting, oifs[i], globalScanned);
+      staticRouting->RemoveRoute (staticRouting->GetNRoutes () - 1);
+      for (uint32_t j = 0; j < globalRouting->GetNRoutes (); j++)
+        {
+          if (globalRouting->GetRoute (j)->GetDestNetworkMask () == Ipv4Mask ("255.0.255.0"))
+            {
+              globalRouting->RemoveRoute (j);
+              break;
+            }
+        }
+      CheckRoutes (staticIndexed, staticScanned);
+      CheckRoutes (globalIndexed, globalScanned);
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Longest prefix match trie TestSuite
+ */
+class Ipv4RouteTrieTestSuite : public TestSuite
+{
+public:
+  Ipv4RouteTrieTestSuite ();
+};
+
+Ipv4RouteTrieTestSuite::Ipv4RouteTrieTestSuite ()
+  : TestSuite ("ipv4-route-trie", UNIT)
+{
+  AddTestCase (new Ipv4RouteTrieTestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4IndexedLookupTestCase, TestCase::QUICK);
+}
+
+static Ipv4RouteTrieTestSuite ipv4RouteTrieTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,715 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "ns3/simulator.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/core-config.h"
+
+#include <algorithm>
+#include <sched.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+// Note:  Logging in this file is largely avoided due to the
+// number of calls that are made to these functions and the possibility
+// of causing recursions leading to stack overflow
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+namespace {
+
+/**
+ * \ingroup mpi
+ * The partition run by the calling thread, 0 outside of
+ * MultithreadedSimulatorImpl::Run.
+ */
+#ifdef HAVE_TLS
+__thread void *g_currentPartition = 0;
+#else
+void *g_currentPartition = 0;
+#endif
+
+} // unnamed namespace
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Mpi")
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+    .AddAttribute ("ThreadCount",
+                   "The number of threads (and partitions) to use, "
+                   "0 for one per online processor.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MultithreadedSimulatorImpl::m_threadCount),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MaximumLookAhead",
+                   "Upper bound of the lookahead, which is otherwise the "
+                   "smallest delay of the point-to-point channels between "
+                   "partitions.",
+                   TimeValue (Time::Max ()),
+                   MakeTimeAccessor (&MultithreadedSimulatorImpl::m_maxLookAhead),
+                   MakeTimeChecker (TimeStep (1)))
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+  m_threadCount = 0;
+  m_lookAhead = 0;
+  m_stop = false;
+  m_currentTs = 0;
+  m_barrierCount = 0;
+  m_barrierSense = false;
+  m_main = SystemThread::Self ();
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultithreadedSimulatorImpl::NotifyConstructionCompleted (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t threads = m_threadCount;
+  if (threads == 0)
+    {
+      long online = sysconf (_SC_NPROCESSORS_ONLN);
+      threads = online > 0 ? online : 1;
+    }
+#ifndef HAVE_TLS
+  NS_LOG_WARN ("no thread-local storage: running a single partition");
+  threads = 1;
+#endif
+  for (uint32_t i = 0; i < threads; i++)
+    {
+      Partition *partition = new Partition ();
+      partition->impl = this;
+      partition->id = i;
+      // uids are allocated from 4.
+      // uid 0 is "invalid" events
+      // uid 1 is "now" events
+      // uid 2 is "destroy" events
+      partition->uid = 4;
+      // before ::Run is entered, the currentUid will be zero
+      partition->currentUid = 0;
+      partition->currentTs = 0;
+      partition->currentContext = 0xffffffff;
+      partition->unscheduledEvents = 0;
+      partition->nextTs = 0;
+      partition->barrierSense = false;
+      partition->stop = false;
+      partition->outbox.resize (threads);
+      m_partitions.push_back (partition);
+    }
+  SimulatorImpl::NotifyConstructionCompleted ();
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<Partition *>::iterator i = m_partitions.begin ();
+       i != m_partitions.end (); ++i)
+    {
+      Partition *partition = *i;
+      ProcessMailboxes (partition);
+      while (partition->events != 0 && !partition->events->IsEmpty ())
+        {
+          Scheduler::Event next = partition->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      delete partition;
+    }
+  m_partitions.clear ();
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  for (std::vector<Partition *>::iterator i = m_partitions.begin ();
+       i != m_partitions.end (); ++i)
+    {
+      Partition *partition = *i;
+      Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+      if (partition->events != 0)
+        {
+          while (!partition->events->IsEmpty ())
+            {
+              Scheduler::Event next = partition->events->RemoveNext ();
+              scheduler->Insert (next);
+            }
+        }
+      partition->events = scheduler;
+    }
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetCurrentPartition (void) const
+{
+  return static_cast<Partition *> (g_currentPartition);
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetPartition (uint32_t context) const
+{
+  if (context < m_contextPartition.size ())
+    {
+      return m_partitions[m_contextPartition[context]];
+    }
+  return m_partitions[0];
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  // All the partitions belong to the same process.
+  return 0;
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookAhead (void) const
+{
+  return TimeStep (m_lookAhead);
+}
+
+void
+MultithreadedSimulatorImpl::AssignPartitions (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t nNodes = NodeList::GetNNodes ();
+  uint32_t nPartitions = m_partitions.size ();
+  m_contextPartition.resize (nNodes);
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      m_contextPartition[i] = (uint64_t)i * nPartitions / nNodes;
+    }
+
+  // Until now every event went to the first partition: move them to
+  // the partition of their context, keeping their uids which are
+  // unique since they all come from the same counter.
+  Partition *first = m_partitions[0];
+  std::vector<Scheduler::Event> events;
+  while (!first->events->IsEmpty ())
+    {
+      events.push_back (first->events->RemoveNext ());
+    }
+  for (std::vector<Scheduler::Event>::const_iterator i = events.begin ();
+       i != events.end (); ++i)
+    {
+      Partition *partition = GetPartition (i->key.m_context);
+      partition->events->Insert (*i);
+      partition->unscheduledEvents++;
+    }
+  first->unscheduledEvents -= events.size ();
+  for (uint32_t i = 1; i < nPartitions; i++)
+    {
+      m_partitions[i]->uid = first->uid;
+    }
+
+  CalculateLookAhead ();
+}
+
+void
+MultithreadedSimulatorImpl::CalculateLookAhead (void)
+{
+  NS_LOG_FUNCTION (this);
+  Time lookAhead = m_maxLookAhead;
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); ++node)
+    {
+      uint32_t partition = m_contextPartition[(*node)->GetId ()];
+      for (uint32_t i = 0; i < (*node)->GetNDevices (); ++i)
+        {
+          Ptr<NetDevice> localNetDevice = (*node)->GetDevice (i);
+          Ptr<Channel> channel = localNetDevice->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+
+          // find the devices of the channel in other partitions
+          bool crossing = false;
+          for (uint32_t j = 0; j < channel->GetNDevices (); ++j)
+            {
+              Ptr<Node> remoteNode = channel->GetDevice (j)->GetNode ();
+              if (remoteNode != 0
+                  && m_contextPartition[remoteNode->GetId ()] != partition)
+                {
+                  crossing = true;
+                  break;
+                }
+            }
+          if (!crossing)
+            {
+              continue;
+            }
+
+          // Only point-to-point channels bound the time between a
+          // transmission and the reception of the packet, and only
+          // they know how to hand packets to another thread.
+          if (!localNetDevice->IsPointToPoint ()
+              || channel->GetNDevices () != 2
+              || !channel->SetAttributeFailSafe ("DeepCopy", BooleanValue (true)))
+            {
+              NS_FATAL_ERROR ("A " << channel->GetInstanceTypeId ().GetName ()
+                              << " of node " << (*node)->GetId ()
+                              << " joins two partitions: only point-to-point "
+                              "channels may join partitions, use fewer threads");
+            }
+          TimeValue delay;
+          channel->GetAttribute ("Delay", delay);
+          if (delay.Get () < lookAhead)
+            {
+              lookAhead = delay.Get ();
+            }
+        }
+    }
+  if (lookAhead <= TimeStep (0) && m_partitions.size () > 1)
+    {
+      NS_FATAL_ERROR ("A zero-delay channel connects two partitions: "
+                      "use fewer threads or a larger delay");
+    }
+  m_lookAhead = lookAhead.GetTimeStep ();
+  NS_LOG_INFO ("lookahead is " << lookAhead << " with "
+               << m_partitions.size () << " partitions");
+}
+
+void
+MultithreadedSimulatorImpl::Partition::Run (void)
+{
+  impl->ProcessPartition (this);
+}
+
+void
+MultithreadedSimulatorImpl::Barrier (Partition *partition)
+{
+  // Sense-reversing barrier: the last thread to arrive resets the
+  // counter and flips the global sense which releases the others.
+  partition->barrierSense = !partition->barrierSense;
+  if (__sync_add_and_fetch (&m_barrierCount, 1) == m_partitions.size ())
+    {
+      m_barrierCount = 0;
+      __atomic_store_n (&m_barrierSense, partition->barrierSense, __ATOMIC_RELEASE);
+    }
+  else
+    {
+      while (__atomic_load_n (&m_barrierSense, __ATOMIC_ACQUIRE) != partition->barrierSense)
+        {
+          sched_yield ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ProcessMailboxes (Partition *partition)
+{
+  // Drain the mailboxes in the order of the source partitions, so that
+  // the uids, hence the order of simultaneous events, are deterministic.
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin ();
+       i != m_partitions.end (); ++i)
+    {
+      std::vector<Scheduler::Event> &mailbox = (*i)->outbox[partition->id];
+      for (std::vector<Scheduler::Event>::iterator j = mailbox.begin ();
+           j != mailbox.end (); ++j)
+        {
+          j->key.m_uid = partition->uid;
+          partition->uid++;
+          partition->unscheduledEvents++;
+          partition->events->Insert (*j);
+        }
+      mailbox.clear ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent (Partition *partition)
+{
+  Scheduler::Event next = partition->events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= partition->currentTs);
+  partition->unscheduledEvents--;
+
+  NS_LOG_LOGIC ("handle " << next.key.m_ts);
+  partition->currentTs = next.key.m_ts;
+  partition->currentContext = next.key.m_context;
+  partition->currentUid = next.key.m_uid;
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+void
+MultithreadedSimulatorImpl::ProcessPartition (Partition *partition)
+{
+  g_currentPartition = partition;
+  const uint64_t maxTs = ~(uint64_t)0;
+  while (true)
+    {
+      // No thread is running events between the end-of-window barrier
+      // and the next one: mailboxes and the stop flag are stable.
+      ProcessMailboxes (partition);
+      partition->nextTs = partition->events->IsEmpty () ?
+        maxTs : partition->events->PeekNext ().key.m_ts;
+      bool stop = __atomic_load_n (&m_stop, __ATOMIC_RELAXED);
+      Barrier (partition);
+
+      uint64_t next = maxTs;
+      for (std::vector<Partition *>::const_iterator i = m_partitions.begin ();
+           i != m_partitions.end (); ++i)
+        {
+          next = std::min (next, (*i)->nextTs);
+        }
+      if (stop || next == maxTs)
+        {
+          break;
+        }
+      uint64_t windowEnd = maxTs - next > m_lookAhead ? next + m_lookAhead : maxTs;
+      while (!partition->events->IsEmpty ()
+             && partition->events->PeekNext ().key.m_ts < windowEnd
+             && !partition->stop)
+        {
+          ProcessOneEvent (partition);
+        }
+      Barrier (partition);
+    }
+  g_currentPartition = 0;
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  if (m_stop)
+    {
+      return true;
+    }
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin ();
+       i != m_partitions.end (); ++i)
+    {
+      if (!(*i)->events->IsEmpty ())
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (GetCurrentPartition () == 0, "Simulator::Run re-entered");
+  m_main = SystemThread::Self ();
+  if (m_contextPartition.empty ())
+    {
+      AssignPartitions ();
+    }
+  m_stop = false;
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin ();
+       i != m_partitions.end (); ++i)
+    {
+      (*i)->stop = false;
+    }
+
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 1; i < m_partitions.size (); i++)
+    {
+      Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&Partition::Run, m_partitions[i]));
+      thread->Start ();
+      threads.push_back (thread);
+    }
+  ProcessPartition (m_partitions[0]);
+  for (std::vector<Ptr<SystemThread> >::iterator i = threads.begin ();
+       i != threads.end (); ++i)
+    {
+      (*i)->Join ();
+    }
+
+  // Outside of Run, the main thread sees the most advanced partition.
+  for (std::vector<Partition *>::const_iterator i = m_partitions.begin ();
+       i != m_partitions.end (); ++i)
+    {
+      m_currentTs = std::max (m_currentTs, (*i)->currentTs);
+      // If the simulator stopped naturally by lack of events, make a
+      // consistency test to check that we didn't lose any events along the way.
+      NS_ASSERT (m_stop || (*i)->unscheduledEvents == 0);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  // The other partitions see the flag at the end of the window.
+  Partition *current = GetCurrentPartition ();
+  if (current != 0)
+    {
+      current->stop = true;
+    }
+  __atomic_store_n (&m_stop, true, __ATOMIC_RELAXED);
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  Simulator::Schedule (delay, &Simulator::Stop);
+}
+
+EventId
+MultithreadedSimulatorImpl::Insert (Partition *partition, uint64_t ts,
+                                    uint32_t context, EventImpl *event)
+{
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  ev.key.m_uid = partition->uid;
+  partition->uid++;
+  partition->unscheduledEvents++;
+  partition->events->Insert (ev);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep () << event);
+  Partition *current = GetCurrentPartition ();
+  if (current == 0)
+    {
+      NS_ASSERT_MSG (SystemThread::Equals (m_main), "Simulator::Schedule Thread-unsafe invocation!");
+      Time tAbsolute = delay + TimeStep (m_currentTs);
+      NS_ASSERT (tAbsolute.IsPositive ());
+      return Insert (GetPartition (0xffffffff), tAbsolute.GetTimeStep (), 0xffffffff, event);
+    }
+  Time tAbsolute = delay + TimeStep (current->currentTs);
+  NS_ASSERT (tAbsolute.IsPositive ());
+  NS_ASSERT (tAbsolute >= TimeStep (current->currentTs));
+  return Insert (current, tAbsolute.GetTimeStep (), current->currentContext, event);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << delay.GetTimeStep () << event);
+  Partition *current = GetCurrentPartition ();
+  Partition *target = GetPartition (context);
+  if (current == 0)
+    {
+      NS_ASSERT_MSG (SystemThread::Equals (m_main), "Simulator::ScheduleWithContext Thread-unsafe invocation!");
+      Insert (target, m_currentTs + delay.GetTimeStep (), context, event);
+    }
+  else if (current == target)
+    {
+      Insert (current, current->currentTs + delay.GetTimeStep (), context, event);
+    }
+  else
+    {
+      if ((uint64_t)delay.GetTimeStep () < m_lookAhead)
+        {
+          NS_FATAL_ERROR ("Event for context " << context << " scheduled "
+                          << delay << " in the future, below the lookahead of "
+                          << GetLookAhead () << " between partitions");
+        }
+      // The uid is assigned by the destination when it drains the mailbox.
+      Scheduler::Event ev;
+      ev.impl = event;
+      ev.key.m_ts = current->currentTs + delay.GetTimeStep ();
+      ev.key.m_context = context;
+      ev.key.m_uid = 0;
+      current->outbox[target->id].push_back (ev);
+    }
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << event);
+  return Schedule (TimeStep (0), event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << event);
+  NS_ASSERT_MSG (GetCurrentPartition () == 0 && SystemThread::Equals (m_main),
+                 "Simulator::ScheduleDestroy Thread-unsafe invocation!");
+
+  EventId id (Ptr<EventImpl> (event, false), m_currentTs, 0xffffffff, 2);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  // Do not add function logging here, to avoid stack overflow
+  Partition *current = GetCurrentPartition ();
+  return TimeStep (current != 0 ? current->currentTs : m_currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs ()) - Now ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Partition *partition = GetPartition (id.GetContext ());
+  NS_ASSERT_MSG (GetCurrentPartition () == 0 || GetCurrentPartition () == partition,
+                 "Cannot remove an event of another partition");
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  partition->events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  partition->unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0
+          || id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  Partition *partition = GetPartition (id.GetContext ());
+  Partition *current = GetCurrentPartition ();
+  if (current != 0 && current != partition)
+    {
+      // The other partition runs concurrently: its current timestamp
+      // and the cancel flag of its events cannot be read safely.
+      NS_FATAL_ERROR ("Event for context " << id.GetContext ()
+                      << " checked from another partition");
+    }
+  if (id.PeekEventImpl () == 0
+      || id.GetTs () < partition->currentTs
+      || (id.GetTs () == partition->currentTs
+          && id.GetUid () <= partition->currentUid)
+      || id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  Partition *current = GetCurrentPartition ();
+  return current != 0 ? current->currentContext : 0xffffffff;
+}
+
+} // namespace ns3
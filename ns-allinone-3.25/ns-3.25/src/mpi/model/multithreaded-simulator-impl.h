@@ -0,0 +1,248 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_MULTITHREADED_SIMULATOR_IMPL_H
+#define NS3_MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/simulator-impl.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/system-thread.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+
+#include <list>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Conservative parallel simulator using threads of a single
+ * process.
+ *
+ * Nodes are partitioned in contiguous blocks of node ids, one block per
+ * thread, and events are assigned to the partition of their context.
+ * Each partition owns its own event list, built with the scheduler
+ * selected by Simulator::SetScheduler.
+ *
+ * The simulation advances in time windows, as with the granted time
+ * window algorithm of DistributedSimulatorImpl: at the start of each
+ * window the threads agree on the smallest pending timestamp T, then
+ * each thread executes its events with a timestamp smaller than
+ * T + lookahead. The lookahead is the smallest delay of the
+ * point-to-point channels which connect nodes of different partitions,
+ * bounded by the MaximumLookAhead attribute. Any other channel which
+ * connects nodes of different partitions is rejected when Run is first
+ * called.
+ *
+ * Events scheduled for a node of another partition (with
+ * Simulator::ScheduleWithContext) are not serialized: they are pushed
+ * in a mailbox dedicated to the (source, destination) pair of
+ * partitions. Each mailbox has a single producer and a single consumer
+ * which never access it concurrently, since the destination only drains
+ * it between two windows, so no lock is needed. Such events must be
+ * scheduled at least one lookahead in the future.
+ *
+ * Reference counts are not atomic, so objects must not be shared by
+ * partitions. The point-to-point channels which join partitions are
+ * switched to their DeepCopy mode: the receiving partition gets a copy
+ * of each packet which shares no data with the packet of the sender.
+ *
+ * Limitations:
+ *  - events which user code schedules across partitions must only
+ *    carry objects which the source partition no longer uses;
+ *  - an event can only be cancelled, removed or checked by the
+ *    partition which runs it;
+ *  - trace sinks and models which share state between nodes, such as
+ *    the topology caches of nix-vector routing, must not be used by
+ *    nodes of different partitions;
+ *  - the TxRxPointToPoint sinks of the channels which join partitions
+ *    get a null receiving device, which rules out AnimationInterface;
+ *  - nodes created after the first call to Run are simulated by the
+ *    first partition;
+ *  - when Simulator::Stop is called, the other partitions complete
+ *    their current window before stopping.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  MultithreadedSimulatorImpl ();
+  /** Destructor. */
+  ~MultithreadedSimulatorImpl ();
+
+  // Inherited
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &delay);
+  virtual EventId Schedule (Time const &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+
+  /**
+   * Get the lookahead used to size the time windows.
+   *
+   * This is only known once Run has been called.
+   *
+   * \returns The lookahead.
+   */
+  Time GetLookAhead (void) const;
+
+private:
+  virtual void DoDispose (void);
+  virtual void NotifyConstructionCompleted (void);
+
+  /** The state of one partition, owned by one thread. */
+  struct Partition
+  {
+    /** Run the partition, in its own thread. */
+    void Run (void);
+
+    /** The simulator. */
+    MultithreadedSimulatorImpl *impl;
+    /** The partition index. */
+    uint32_t id;
+    /** The event list of the partition. */
+    Ptr<Scheduler> events;
+    /** Next event unique id. */
+    uint32_t uid;
+    /** Unique id of the current event. */
+    uint32_t currentUid;
+    /** Timestamp of the current event. */
+    uint64_t currentTs;
+    /** Execution context of the current event. */
+    uint32_t currentContext;
+    /** Number of events inserted but not yet run. */
+    int unscheduledEvents;
+    /** Timestamp of the next event, published at window boundaries. */
+    uint64_t nextTs;
+    /** Local sense of the window barrier. */
+    bool barrierSense;
+    /** Whether Simulator::Stop was called by this partition. */
+    bool stop;
+    /**
+     * Mailboxes of events sent to each other partition during the
+     * current window, indexed by destination.
+     */
+    std::vector<std::vector<Scheduler::Event> > outbox;
+  };
+
+  /**
+   * Get the partition run by the calling thread.
+   *
+   * \returns The partition, or 0 when called outside of Run.
+   */
+  Partition * GetCurrentPartition (void) const;
+  /**
+   * Get the partition which owns the events of a context.
+   *
+   * \param [in] context The event context.
+   * \returns The partition.
+   */
+  Partition * GetPartition (uint32_t context) const;
+  /**
+   * Insert an event in the event list of a partition.
+   *
+   * \param [in] partition The partition.
+   * \param [in] ts The event timestamp.
+   * \param [in] context The event context.
+   * \param [in] event The event implementation.
+   * \returns The event id.
+   */
+  EventId Insert (Partition *partition, uint64_t ts, uint32_t context, EventImpl *event);
+  /**
+   * Assign nodes to partitions, move the events scheduled so far to
+   * their partition and compute the lookahead.
+   */
+  void AssignPartitions (void);
+  /** Compute the lookahead from the cross-partition channels. */
+  void CalculateLookAhead (void);
+  /**
+   * Run the windows of a partition until the simulation ends.
+   *
+   * \param [in] partition The partition.
+   */
+  void ProcessPartition (Partition *partition);
+  /**
+   * Process the next event of a partition.
+   *
+   * \param [in] partition The partition.
+   */
+  void ProcessOneEvent (Partition *partition);
+  /**
+   * Move the events sent by other partitions into the event list of
+   * a partition.
+   *
+   * \param [in] partition The destination partition.
+   */
+  void ProcessMailboxes (Partition *partition);
+  /**
+   * Wait until all threads reach the barrier.
+   *
+   * \param [in] partition The partition of the calling thread.
+   */
+  void Barrier (Partition *partition);
+
+  /** The partitions. */
+  std::vector<Partition *> m_partitions;
+  /** Partition index of each node id. */
+  std::vector<uint32_t> m_contextPartition;
+  /** Number of threads, 0 for one per processor. */
+  uint32_t m_threadCount;
+  /** Upper bound of the lookahead. */
+  Time m_maxLookAhead;
+  /** The lookahead, in time steps. */
+  uint64_t m_lookAhead;
+
+  /** Container type for the events to run at Simulator::Destroy() */
+  typedef std::list<EventId> DestroyEvents;
+  /** The container of events to run at Destroy. */
+  DestroyEvents m_destroyEvents;
+  /** Flag calling for the end of the simulation. */
+  bool m_stop;
+  /** Timestamp seen by the main thread outside of Run. */
+  uint64_t m_currentTs;
+  /** Number of threads which reached the barrier. */
+  uint32_t m_barrierCount;
+  /** Global sense of the window barrier. */
+  bool m_barrierSense;
+  /** Main execution thread. */
+  SystemThread::ThreadId m_main;
+};
+
+} // namespace ns3
+
+#endif /* NS3_MULTITHREADED_SIMULATOR_IMPL_H */
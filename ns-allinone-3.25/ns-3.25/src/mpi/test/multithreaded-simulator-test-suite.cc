@@ -0,0 +1,207 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/node-container.h"
+#include "ns3/object-factory.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup mpi
+ * Check that MultithreadedSimulatorImpl runs the same events as
+ * DefaultSimulatorImpl on a ring of nodes exchanging events.
+ */
+class MultithreadedSimulatorRingTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor.
+   *
+   * \param [in] threads The number of threads.
+   * \param [in] stop Whether to stop the simulation before the ring
+   *             runs out of events.
+   */
+  MultithreadedSimulatorRingTestCase (uint32_t threads, bool stop);
+
+private:
+  virtual void DoRun (void);
+
+  /** A trace of event timestamps, per node. */
+  typedef std::vector<std::vector<int64_t> > Traces;
+
+  /**
+   * Run the ring with the current simulator implementation.
+   *
+   * \returns The event timestamps seen by each node.
+   */
+  Traces RunRing (void);
+  /**
+   * An event which travels along the ring.
+   *
+   * \param [in] node The node which receives the event.
+   * \param [in] ttl The number of hops left.
+   */
+  void Hop (uint32_t node, uint32_t ttl);
+  /**
+   * A local event, scheduled by Hop.
+   *
+   * \param [in] node The node.
+   */
+  void Local (uint32_t node);
+
+  /** The number of threads. */
+  uint32_t m_threads;
+  /** Whether to call Simulator::Stop. */
+  bool m_stop;
+  /** The traces of the current run. */
+  Traces m_traces;
+};
+
+/** The number of nodes in the ring. */
+static const uint32_t RING_SIZE = 8;
+/** The time at which the simulation is stopped, if requested. */
+static const Time RING_STOP = MilliSeconds (20);
+
+/**
+ * Build the name of a MultithreadedSimulatorRingTestCase.
+ *
+ * \param [in] threads The number of threads.
+ * \param [in] stop Whether the test calls Simulator::Stop.
+ * \returns The test name.
+ */
+static std::string
+RingTestName (uint32_t threads, bool stop)
+{
+  std::ostringstream oss;
+  oss << "Check a ring of events with " << threads << " threads"
+      << (stop ? " and Simulator::Stop" : "");
+  return oss.str ();
+}
+
+MultithreadedSimulatorRingTestCase::MultithreadedSimulatorRingTestCase (uint32_t threads, bool stop)
+  : TestCase (RingTestName (threads, stop)),
+    m_threads (threads),
+    m_stop (stop)
+{
+}
+
+void
+MultithreadedSimulatorRingTestCase::Hop (uint32_t node, uint32_t ttl)
+{
+  m_traces[node].push_back (Simulator::Now ().GetTimeStep ());
+  Simulator::Schedule (MicroSeconds (3 + node),
+                       &MultithreadedSimulatorRingTestCase::Local, this, node);
+  if (ttl > 0)
+    {
+      uint32_t next = (node + 1) % RING_SIZE;
+      Simulator::ScheduleWithContext (next, MilliSeconds (1) + MicroSeconds (node),
+                                      &MultithreadedSimulatorRingTestCase::Hop, this,
+                                      next, ttl - 1);
+    }
+}
+
+void
+MultithreadedSimulatorRingTestCase::Local (uint32_t node)
+{
+  m_traces[node].push_back (Simulator::Now ().GetTimeStep ());
+}
+
+MultithreadedSimulatorRingTestCase::Traces
+MultithreadedSimulatorRingTestCase::RunRing (void)
+{
+  NodeContainer nodes;
+  nodes.Create (RING_SIZE);
+  m_traces.clear ();
+  m_traces.resize (RING_SIZE);
+  for (uint32_t i = 0; i < RING_SIZE; i++)
+    {
+      Simulator::ScheduleWithContext (i, MicroSeconds (i),
+                                      &MultithreadedSimulatorRingTestCase::Hop, this,
+                                      i, 50);
+    }
+  if (m_stop)
+    {
+      Simulator::Stop (RING_STOP);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  if (m_stop)
+    {
+      // Partitions other than the one which ran Simulator::Stop may
+      // complete their time window.
+      for (uint32_t i = 0; i < RING_SIZE; i++)
+        {
+          std::vector<int64_t> &trace = m_traces[i];
+          while (!trace.empty () && trace.back () >= RING_STOP.GetTimeStep ())
+            {
+              trace.pop_back ();
+            }
+        }
+    }
+  return m_traces;
+}
+
+void
+MultithreadedSimulatorRingTestCase::DoRun (void)
+{
+  Traces expected = RunRing ();
+
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::MultithreadedSimulatorImpl");
+  factory.Set ("ThreadCount", UintegerValue (m_threads));
+  factory.Set ("MaximumLookAhead", TimeValue (MilliSeconds (1)));
+  Ptr<MultithreadedSimulatorImpl> impl = factory.Create<MultithreadedSimulatorImpl> ();
+  Simulator::SetImplementation (impl);
+  Traces traces = RunRing ();
+
+  NS_TEST_EXPECT_MSG_EQ (impl->GetLookAhead (), MilliSeconds (1), "Unexpected lookahead");
+  for (uint32_t i = 0; i < RING_SIZE; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (traces[i].size (), expected[i].size (),
+                             "Wrong number of events at node " << i);
+      NS_TEST_EXPECT_MSG_EQ ((traces[i] == expected[i]), true,
+                             "Wrong event times at node " << i);
+    }
+}
+
+/**
+ * \ingroup mpi
+ * MultithreadedSimulatorImpl test suite.
+ */
+class MultithreadedSimulatorTestSuite : public TestSuite
+{
+public:
+  MultithreadedSimulatorTestSuite ()
+    : TestSuite ("multithreaded-simulator")
+  {
+    uint32_t threadCounts[] = { 1, 2, 3, RING_SIZE };
+    for (uint32_t i = 0; i < sizeof (threadCounts) / sizeof (threadCounts[0]); i++)
+      {
+        AddTestCase (new MultithreadedSimulatorRingTestCase (threadCounts[i], false), TestCase::QUICK);
+        AddTestCase (new MultithreadedSimulatorRingTestCase (threadCounts[i], true), TestCase::QUICK);
+      }
+  }
+} g_multithreadedSimulatorTestSuite;
@@ -20,6 +20,7 @@
 #include "buffer.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
+#include "ns3/core-config.h"
 
 #define LOG_INTERNAL_STATE(y)                                                                    \
   NS_LOG_LOGIC (y << "start="<<m_start<<", end="<<m_end<<", zero start="<<m_zeroAreaStart<<              \
@@ -75,10 +76,28 @@ uint32_t Buffer::g_recommendedStart = 0;
 #define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
 #define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
 #define UNINITIALIZED ((Buffer::FreeList*)0)
+#ifdef HAVE_TLS
+/* The free list is only used by the thread which loaded this library,
+ * that is, the thread which constructed g_localStaticDestructor: the
+ * other threads, such as those of a parallel simulator, allocate and
+ * release their data directly.
+ */
+static __thread bool g_freeListOwner = false;
+#define IS_FREE_LIST_OWNER() (g_freeListOwner)
+#else /* HAVE_TLS */
+#define IS_FREE_LIST_OWNER() (true)
+#endif /* HAVE_TLS */
 uint32_t Buffer::g_maxSize = 0;
 Buffer::FreeList *Buffer::g_freeList = 0;
 struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
 
+Buffer::LocalStaticDestructor::LocalStaticDestructor(void)
+{
+#ifdef HAVE_TLS
+  g_freeListOwner = true;
+#endif /* HAVE_TLS */
+}
+
 Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
 {
   NS_LOG_FUNCTION (this);
@@ -99,7 +118,12 @@ Buffer::Recycle (struct Buffer::Data *data)
 {
   NS_LOG_FUNCTION (data);
   NS_ASSERT (data->m_count == 0);
-  NS_ASSERT (!IS_UNINITIALIZED (g_freeList));
+  if (!IS_FREE_LIST_OWNER () || IS_UNINITIALIZED (g_freeList))
+    {
+      // data allocated by another thread.
+      Buffer::Deallocate (data);
+      return;
+    }
   g_maxSize = std::max (g_maxSize, data->m_size);
   /* feed into free list */
   if (data->m_size < g_maxSize ||
@@ -120,6 +144,10 @@ Buffer::Create (uint32_t dataSize)
 {
   NS_LOG_FUNCTION (dataSize);
   /* try to find a buffer correctly sized. */
+  if (!IS_FREE_LIST_OWNER ())
+    {
+      return Buffer::Allocate (dataSize);
+    }
   if (IS_UNINITIALIZED (g_freeList))
     {
       g_freeList = new Buffer::FreeList ();
@@ -400,6 +428,58 @@ void
 Buffer::AddAtEnd (const Buffer &o)
 {
   NS_LOG_FUNCTION (this << &o);
+  NS_ASSERT (CheckInternalState ());
+  if (o.GetSize () == 0)
+    {
+      return;
+    }
+  if (GetSize () == 0)
+    {
+      *this = o;
+      return;
+    }
+  uint32_t zeroSize = m_zeroAreaEnd - m_zeroAreaStart;
+  uint32_t oZeroSize = o.m_zeroAreaEnd - o.m_zeroAreaStart;
+  if (m_end == m_zeroAreaEnd &&
+      o.m_start == o.m_zeroAreaStart &&
+      o.m_end == o.m_zeroAreaEnd &&
+      m_data->m_count == 1)
+    {
+      /**
+       * The other buffer only holds zeroes and this buffer ends
+       * with its zero area: grow the zero area. The data must not
+       * be shared, or a later AddAtEnd could write in place over the
+       * bytes of the other owners.
+       */
+      m_zeroAreaEnd += oZeroSize;
+      m_end += oZeroSize;
+      m_data->m_dirtyEnd = m_end;
+      NS_ASSERT (CheckInternalState ());
+      return;
+    }
+  if (m_data == o.m_data &&
+      GetInternalEnd () == o.m_start &&
+      (zeroSize == 0 || oZeroSize == 0 ||
+       (m_zeroAreaStart == o.m_start && o.m_zeroAreaStart == o.m_start)) &&
+      o.GetInternalEnd () + zeroSize + oZeroSize <= m_data->m_dirtyEnd)
+    {
+      /**
+       * The two buffers are adjacent slices of the same data, as
+       * created by CreateFragment, with at most one zero area between
+       * them: merge the slices without copying. The bytes of a shared
+       * data area are never modified, so this cannot change the
+       * content of other buffers.
+       */
+      if (zeroSize == 0)
+        {
+          m_zeroAreaStart = o.m_zeroAreaStart;
+        }
+      m_zeroAreaEnd = m_zeroAreaStart + zeroSize + oZeroSize;
+      m_end = o.GetInternalEnd () + zeroSize + oZeroSize;
+      m_maxZeroAreaStart = std::max (m_maxZeroAreaStart, m_zeroAreaStart);
+      NS_ASSERT (CheckInternalState ());
+      return;
+    }
   if (m_data->m_count == 1 &&
       m_end == m_zeroAreaEnd &&
       m_end == m_data->m_dirtyEnd &&
@@ -426,14 +506,30 @@ Buffer::AddAtEnd (const Buffer &o)
       return;
     }
 
-  Buffer dst = CreateFullCopy ();
-  Buffer src = o.CreateFullCopy ();
+  if (m_data == o.m_data)
+    {
+      Buffer dst = CreateFullCopy ();
+      Buffer src = o.CreateFullCopy ();
+
+      dst.AddAtEnd (src.GetSize ());
+      Buffer::Iterator destStart = dst.End ();
+      destStart.Prev (src.GetSize ());
+      destStart.Write (src.Begin (), src.End ());
+      *this = dst;
+      NS_ASSERT (CheckInternalState ());
+      return;
+    }
 
-  dst.AddAtEnd (src.GetSize ());
-  Buffer::Iterator destStart = dst.End ();
-  destStart.Prev (src.GetSize ());
-  destStart.Write (src.Begin (), src.End ());
-  *this = dst;
+  /**
+   * Copy the bytes of the other buffer once, right after ours:
+   * the zero areas of both buffers are written out only if they
+   * must be.
+   */
+  uint32_t size = o.GetSize ();
+  AddAtEnd (size);
+  Buffer::Iterator destStart = End ();
+  destStart.Prev (size);
+  destStart.Write (o.Begin (), o.End ());
   NS_ASSERT (CheckInternalState ());
 }
 
@@ -843,27 +939,32 @@ Buffer::Iterator::Write (Iterator start, Iterator end)
   uint32_t size = end.m_current - start.m_current;
   NS_ASSERT_MSG (CheckNoZero (m_current, m_current + size),
                  GetWriteErrorMessage ());
+  // The bytes written are all on the same side of our zero area.
+  uint8_t *to = &m_data[m_current];
+  if (m_current >= m_zeroEnd)
+    {
+      to -= m_zeroEnd - m_zeroStart;
+    }
+  m_current += size;
   if (start.m_current <= start.m_zeroStart)
     {
       uint32_t toCopy = std::min (size, start.m_zeroStart - start.m_current);
-      memcpy (&m_data[m_current], &start.m_data[start.m_current], toCopy);
+      memcpy (to, &start.m_data[start.m_current], toCopy);
       start.m_current += toCopy;
-      m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   if (start.m_current <= start.m_zeroEnd)
     {
       uint32_t toCopy = std::min (size, start.m_zeroEnd - start.m_current);
-      memset (&m_data[m_current], 0, toCopy);
+      memset (to, 0, toCopy);
       start.m_current += toCopy;
-      m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   uint32_t toCopy = std::min (size, start.m_dataEnd - start.m_current);
   uint8_t *from = &start.m_data[start.m_current - (start.m_zeroEnd-start.m_zeroStart)];
-  uint8_t *to = &m_data[m_current];
   memcpy (to, from, toCopy);
-  m_current += toCopy;
 }
 
 void 
@@ -521,6 +521,11 @@ private:
    * Add bytes at the end of the Buffer.
    * Any call to this method invalidates any Iterator
    * pointing to this Buffer.
+   *
+   * No byte is copied when \p o only holds zeroes and this buffer
+   * ends with zeroes, or when the two buffers are adjacent fragments
+   * of the same buffer, as returned by CreateFragment. Otherwise, the
+   * bytes of \p o are copied once.
    */
   void AddAtEnd (const Buffer &o);
   /**
@@ -790,6 +795,7 @@ private:
   /// Local static destructor structure
   struct LocalStaticDestructor 
   {
+    LocalStaticDestructor ();
     ~LocalStaticDestructor ();
   };
   static uint32_t g_maxSize; //!< Max observed data size
@@ -19,6 +19,7 @@
  */
 #include "byte-tag-list.h"
 #include "ns3/log.h"
+#include "ns3/core-config.h"
 #include <vector>
 #include <cstring>
 
@@ -55,10 +56,31 @@ struct ByteTagListData {
 static class ByteTagListDataFreeList : public std::vector<struct ByteTagListData *>
 {
 public:
+  ByteTagListDataFreeList ();
   ~ByteTagListDataFreeList ();
 } g_freeList; //!< Container for struct ByteTagListData
 static uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
 
+#ifdef HAVE_TLS
+/**
+ * \ingroup packet
+ * Whether the calling thread constructed g_freeList: the other threads,
+ * such as those of a parallel simulator, allocate and release their
+ * data directly.
+ */
+static __thread bool g_freeListOwner = false;
+#define IS_FREE_LIST_OWNER() (g_freeListOwner)
+#else /* HAVE_TLS */
+#define IS_FREE_LIST_OWNER() (true)
+#endif /* HAVE_TLS */
+
+ByteTagListDataFreeList::ByteTagListDataFreeList ()
+{
+#ifdef HAVE_TLS
+  g_freeListOwner = true;
+#endif /* HAVE_TLS */
+}
+
 ByteTagListDataFreeList::~ByteTagListDataFreeList ()
 {
   NS_LOG_FUNCTION (this);
@@ -344,7 +366,7 @@ struct ByteTagListData *
 ByteTagList::Allocate (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  while (!g_freeList.empty ())
+  while (IS_FREE_LIST_OWNER () && !g_freeList.empty ())
     {
       struct ByteTagListData *data = g_freeList.back ();
       g_freeList.pop_back ();
@@ -358,7 +380,8 @@ ByteTagList::Allocate (uint32_t size)
       uint8_t *buffer = (uint8_t *)data;
       delete [] buffer;
     }
-  uint8_t *buffer = new uint8_t [std::max (size, g_maxSize) + sizeof (struct ByteTagListData) - 4];
+  uint32_t allocSize = IS_FREE_LIST_OWNER () ? std::max (size, g_maxSize) : size;
+  uint8_t *buffer = new uint8_t [allocSize + sizeof (struct ByteTagListData) - 4];
   struct ByteTagListData *data = (struct ByteTagListData *)buffer;
   data->count = 1;
   data->size = size;
@@ -374,6 +397,15 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
     {
       return;
     }
+  if (!IS_FREE_LIST_OWNER ())
+    {
+      if (--data->count == 0)
+        {
+          uint8_t *buffer = (uint8_t *)data;
+          delete [] buffer;
+        }
+      return;
+    }
   g_maxSize = std::max (g_maxSize, data->size);
   data->count--;
   if (data->count == 0)
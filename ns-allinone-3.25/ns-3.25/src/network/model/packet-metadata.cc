@@ -22,6 +22,7 @@
 #include "ns3/assert.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include "ns3/core-config.h"
 #include "packet-metadata.h"
 #include "buffer.h"
 #include "header.h"
@@ -36,8 +37,31 @@ bool PacketMetadata::m_enableChecking = false;
 bool PacketMetadata::m_metadataSkipped = false;
 uint32_t PacketMetadata::m_maxSize = 0;
 uint16_t PacketMetadata::m_chunkUid = 0;
+bool PacketMetadata::m_sampling = false;
+uint64_t PacketMetadata::m_samplingThreshold = 0;
+TypeId PacketMetadata::m_filterTid;
+Callback<bool, const Header &> PacketMetadata::m_filter;
 PacketMetadata::DataFreeList PacketMetadata::m_freeList;
 
+#ifdef HAVE_TLS
+/* The free list is only used by the thread which constructed it, that
+ * is, the thread which loaded this library: the other threads, such as
+ * those of a parallel simulator, allocate and release their data
+ * directly.
+ */
+static __thread bool g_freeListOwner = false;
+#define IS_FREE_LIST_OWNER() (g_freeListOwner)
+#else /* HAVE_TLS */
+#define IS_FREE_LIST_OWNER() (true)
+#endif /* HAVE_TLS */
+
+PacketMetadata::DataFreeList::DataFreeList ()
+{
+#ifdef HAVE_TLS
+  g_freeListOwner = true;
+#endif /* HAVE_TLS */
+}
+
 PacketMetadata::DataFreeList::~DataFreeList ()
 {
   NS_LOG_FUNCTION (this);
@@ -70,6 +94,24 @@ PacketMetadata::EnableChecking (void)
   m_enableChecking = true;
 }
 
+void
+PacketMetadata::EnableSampling (double fraction)
+{
+  NS_LOG_FUNCTION (fraction);
+  NS_ASSERT (fraction >= 0 && fraction <= 1);
+  Enable ();
+  m_sampling = true;
+  m_samplingThreshold = static_cast<uint64_t> (fraction * 4294967296.0);
+}
+
+void
+PacketMetadata::SetSamplingFilter (TypeId tid, Callback<bool, const Header &> filter)
+{
+  NS_LOG_FUNCTION (tid.GetName ());
+  m_filterTid = tid;
+  m_filter = filter;
+}
+
 void
 PacketMetadata::ReserveCopy (uint32_t size)
 {
@@ -400,6 +442,51 @@ PacketMetadata::AddSmall (const struct PacketMetadata::SmallItem *item)
   return n;
 }
 
+void
+PacketMetadata::AddWhole (const PacketMetadata::SmallItem *item, bool atEnd)
+{
+  NS_LOG_FUNCTION (this << item->typeUid << item->size << atEnd);
+  uint16_t written;
+  if (item->typeUid < 0x4000 && item->size < 0x4000)
+    {
+      /* Fast path: a fixed-size item with two bytes for each
+       * variable-size field, which skips the uleb128 size
+       * computations.
+       */
+      written = 10;
+      if (m_used + written > m_data->m_size ||
+          (m_head != 0xffff &&
+           m_data->m_count != 1 &&
+           m_used != m_data->m_dirtyEnd))
+        {
+          ReserveCopy (written);
+        }
+      uint8_t *buffer = &m_data->m_data[m_used];
+      buffer[0] = item->next & 0xff;
+      buffer[1] = item->next >> 8;
+      buffer[2] = item->prev & 0xff;
+      buffer[3] = item->prev >> 8;
+      buffer[4] = 0x80 | (item->typeUid & 0x7f);
+      buffer[5] = item->typeUid >> 7;
+      buffer[6] = 0x80 | (item->size & 0x7f);
+      buffer[7] = item->size >> 7;
+      buffer[8] = item->chunkUid & 0xff;
+      buffer[9] = item->chunkUid >> 8;
+    }
+  else
+    {
+      written = AddSmall (item);
+    }
+  if (atEnd)
+    {
+      UpdateTail (written);
+    }
+  else
+    {
+      UpdateHead (written);
+    }
+}
+
 uint16_t
 PacketMetadata::AddBig (uint32_t next, uint32_t prev, 
                         const PacketMetadata::SmallItem *item,
@@ -506,6 +593,7 @@ PacketMetadata::ReplaceTail (PacketMetadata::SmallItem *item,
 
   // create a copy of the packet without its tail.
   PacketMetadata h (m_packetUid, 0);
+  h.m_samplingState = m_samplingState;
   uint16_t current = m_head;
   while (current != 0xffff && current != m_tail)
     {
@@ -572,6 +660,10 @@ PacketMetadata::Create (uint32_t size)
 {
   NS_LOG_FUNCTION (size);
   NS_LOG_LOGIC ("create size="<<size<<", max="<<m_maxSize);
+  if (!IS_FREE_LIST_OWNER ())
+    {
+      return PacketMetadata::Allocate (size);
+    }
   if (size > m_maxSize)
     {
       m_maxSize = size;
@@ -597,7 +689,7 @@ void
 PacketMetadata::Recycle (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
-  if (!m_enable)
+  if (!m_enable || !IS_FREE_LIST_OWNER ())
     {
       PacketMetadata::Deallocate (data);
       return;
@@ -657,6 +749,10 @@ PacketMetadata::AddHeader (const Header &header, uint32_t size)
   NS_LOG_FUNCTION (this << &header << size);
   NS_ASSERT (IsStateOk ());
   uint32_t uid = header.GetInstanceTypeId ().GetUid () << 1;
+  if (m_samplingState == FILTERED)
+    {
+      ApplySamplingFilter (header);
+    }
   DoAddHeader (uid, size);
   NS_ASSERT (IsStateOk ());
 }
@@ -669,6 +765,10 @@ PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (m_samplingState == SKIPPED)
+    {
+      return;
+    }
 
   struct PacketMetadata::SmallItem item;
   item.next = m_head;
@@ -677,8 +777,27 @@ PacketMetadata::DoAddHeader (uint32_t uid, uint32_t size)
   item.size = size;
   item.chunkUid = m_chunkUid;
   m_chunkUid++;
-  uint16_t written = AddSmall (&item);
-  UpdateHead (written);
+  AddWhole (&item, false);
+}
+void
+PacketMetadata::ApplySamplingFilter (Header const &header)
+{
+  NS_LOG_FUNCTION (this << &header);
+  TypeId tid = header.GetInstanceTypeId ();
+  if (tid != m_filterTid && !tid.IsChildOf (m_filterTid))
+    {
+      return;
+    }
+  if (m_filter (header))
+    {
+      m_samplingState = RECORDED;
+    }
+  else
+    {
+      m_samplingState = SKIPPED;
+      m_head = 0xffff;
+      m_tail = 0xffff;
+    }
 }
 void 
 PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
@@ -691,6 +810,10 @@ PacketMetadata::RemoveHeader (const Header &header, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (m_samplingState == SKIPPED)
+    {
+      return;
+    }
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_head, &item, &extraItem);
@@ -739,6 +862,10 @@ PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (m_samplingState == SKIPPED)
+    {
+      return;
+    }
   struct PacketMetadata::SmallItem item;
   item.next = 0xffff;
   item.prev = m_tail;
@@ -746,8 +873,7 @@ PacketMetadata::AddTrailer (const Trailer &trailer, uint32_t size)
   item.size = size;
   item.chunkUid = m_chunkUid;
   m_chunkUid++;
-  uint16_t written = AddSmall (&item);
-  UpdateTail (written);
+  AddWhole (&item, true);
   NS_ASSERT (IsStateOk ());
 }
 void 
@@ -761,6 +887,10 @@ PacketMetadata::RemoveTrailer (const Trailer &trailer, uint32_t size)
       m_metadataSkipped = true;
       return;
     }
+  if (m_samplingState == SKIPPED)
+    {
+      return;
+    }
   struct PacketMetadata::SmallItem item;
   struct PacketMetadata::ExtraItem extraItem;
   uint32_t read = ReadItems (m_tail, &item, &extraItem);
@@ -808,6 +938,18 @@ PacketMetadata::AddAtEnd (PacketMetadata const&o)
       m_metadataSkipped = true;
       return;
     }
+  if (m_samplingState == SKIPPED)
+    {
+      return;
+    }
+  if (o.m_samplingState == SKIPPED)
+    {
+      // The items of the other packet are unknown, so are ours now.
+      m_samplingState = SKIPPED;
+      m_head = 0xffff;
+      m_tail = 0xffff;
+      return;
+    }
   if (m_tail == 0xffff)
     {
       // We have no items so 'AddAtEnd' is 
@@ -885,6 +1027,10 @@ PacketMetadata::AddPaddingAtEnd (uint32_t end)
       m_metadataSkipped = true;
       return;
     }
+  if (m_samplingState == SKIPPED)
+    {
+      return;
+    }
 }
 void 
 PacketMetadata::RemoveAtStart (uint32_t start)
@@ -896,6 +1042,10 @@ PacketMetadata::RemoveAtStart (uint32_t start)
       m_metadataSkipped = true;
       return;
     }
+  if (m_samplingState == SKIPPED)
+    {
+      return;
+    }
   NS_ASSERT (m_data != 0);
   uint32_t leftToRemove = start;
   uint16_t current = m_head;
@@ -923,6 +1073,7 @@ PacketMetadata::RemoveAtStart (uint32_t start)
         {
           // fragment the list item.
           PacketMetadata fragment (m_packetUid, 0);
+          fragment.m_samplingState = m_samplingState;
           extraItem.fragmentStart += leftToRemove;
           leftToRemove = 0;
           uint16_t written = fragment.AddBig (0xffff, fragment.m_tail,
@@ -959,6 +1110,10 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
       m_metadataSkipped = true;
       return;
     }
+  if (m_samplingState == SKIPPED)
+    {
+      return;
+    }
   NS_ASSERT (m_data != 0);
 
   uint32_t leftToRemove = end;
@@ -987,6 +1142,7 @@ PacketMetadata::RemoveAtEnd (uint32_t end)
         {
           // fragment the list item.
           PacketMetadata fragment (m_packetUid, 0);
+          fragment.m_samplingState = m_samplingState;
           NS_ASSERT (extraItem.fragmentEnd > leftToRemove);
           extraItem.fragmentEnd -= leftToRemove;
           leftToRemove = 0;
@@ -1337,6 +1493,8 @@ PacketMetadata::Deserialize (const uint8_t* buffer, uint32_t size)
       uint32_t tmp = AddBig (0xffff, m_tail, &item, &extraItem);
       UpdateTail (tmp);
     }
+  // Packets which were not sampled are serialized without any item.
+  m_samplingState = (m_sampling && m_head == 0xffff) ? SKIPPED : RECORDED;
   NS_ASSERT (desSize == 0);
   return (desSize !=0) ? 0 : 1;
 }
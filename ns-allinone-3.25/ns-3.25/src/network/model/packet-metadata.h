@@ -73,7 +73,16 @@ class Trailer;
  * as fixed-size 32 bit integers, others as fixed-size 16 bit 
  * integers, and some others as variable-size 32-bit integers.
  * The variable-size 32 bit integers are stored using the uleb128
- * encoding.
+ * encoding. Whole headers and trailers whose type uid and size are
+ * smaller than 2^14, by far the most common items, are always
+ * written with two bytes per variable-size field, which is still
+ * valid uleb128 and makes their items fixed-size.
+ *
+ * Recording this metadata for every packet is costly. With
+ * EnableSampling, it is recorded only for a fraction of the
+ * packets, picked from their uid, and possibly only for the packets
+ * which match a filter: the items of the other packets are never
+ * recorded, so that they do not print anything.
  */
 class PacketMetadata 
 {
@@ -159,6 +168,36 @@ private:
    * \brief Enable the packet metadata checking
    */
   static void EnableChecking (void);
+  /**
+   * \brief Record the packet metadata for a sample of the packets only
+   *
+   * The packets are picked from a hash of their uid, so that the
+   * sample does not depend on the random number streams and is the
+   * same for each run of a simulation. The packets which are not
+   * picked behave as if the packet metadata was not enabled.
+   *
+   * This must be called, as Enable, before any packet is created; it
+   * also enables the packet metadata.
+   *
+   * \param fraction the fraction of the packets to pick, between 0 and 1
+   */
+  static void EnableSampling (double fraction);
+  /**
+   * \brief Record the packet metadata only for the packets of some flows
+   *
+   * The items of a packet are recorded until the first header of type
+   * \p tid, or of a subclass of \p tid, is added to it: the packet
+   * stops recording them, and forgets the items recorded so far, if
+   * \p filter returns false for this header. A null \p filter
+   * removes the current filter.
+   *
+   * This only applies to the packets picked by EnableSampling.
+   *
+   * \param tid the type of the header which identifies the flows,
+   *        such as the TypeId of UdpHeader
+   * \param filter returns true for the headers of the packets to record
+   */
+  static void SetSamplingFilter (TypeId tid, Callback<bool, const Header &> filter);
 
   /**
    * \brief Constructor
@@ -497,6 +536,7 @@ private:
   class DataFreeList : public std::vector<struct Data *>
   {
 public:
+    DataFreeList ();
     ~DataFreeList ();
   };
 
@@ -543,6 +583,36 @@ public:
    */
   inline void UpdateTail (uint16_t written);
 
+  /**
+   * \brief Append a header or a trailer which is not a fragment
+   *
+   * \param item the item to add
+   * \param atEnd true to append the item at the tail of the list,
+   *        false to prepend it at the head
+   */
+  void AddWhole (const PacketMetadata::SmallItem *item, bool atEnd);
+
+  /**
+   * \brief Sampling state of the packet metadata of a packet
+   */
+  enum SamplingState
+  {
+    RECORDED, //!< the items are recorded
+    FILTERED, //!< the items are recorded until the filter is applied
+    SKIPPED   //!< the items are not recorded
+  };
+  /**
+   * \brief Get the sampling state of a new packet
+   * \param uid the packet uid
+   * \returns the sampling state
+   */
+  static inline uint8_t GetSamplingState (uint64_t uid);
+  /**
+   * \brief Apply the sampling filter when adding a header
+   * \param header the header added
+   */
+  void ApplySamplingFilter (Header const &header);
+
   /**
    * \brief Get the ULEB128 (Unsigned Little Endian Base 128) size
    * \param value the value
@@ -670,6 +740,15 @@ public:
   static uint32_t m_maxSize; //!< maximum metadata size
   static uint16_t m_chunkUid; //!< Chunk Uid
 
+  static bool m_sampling; //!< Record the metadata of a sample of the packets
+  /**
+   * A packet is picked by EnableSampling when the hash of its uid is
+   * smaller than this threshold.
+   */
+  static uint64_t m_samplingThreshold;
+  static TypeId m_filterTid; //!< Type of the header checked by the filter
+  static Callback<bool, const Header &> m_filter; //!< Sampling filter
+
   struct Data *m_data; //!< Metadata storage
   /*
      head -(next)-> tail
@@ -679,6 +758,7 @@ public:
   uint16_t m_head; //!< list head
   uint16_t m_tail; //!< list tail
   uint16_t m_used; //!< used portion
+  uint8_t m_samplingState; //!< sampling state, see SamplingState
   uint64_t m_packetUid; //!< packet Uid
 };
 
@@ -686,11 +766,28 @@ public:
 
 namespace ns3 {
 
+uint8_t
+PacketMetadata::GetSamplingState (uint64_t uid)
+{
+  if (!m_sampling)
+    {
+      return RECORDED;
+    }
+  // Fibonacci hashing spreads consecutive uids evenly.
+  uint64_t hash = (uid * 0x9e3779b97f4a7c15ULL) >> 32;
+  if (hash >= m_samplingThreshold)
+    {
+      return SKIPPED;
+    }
+  return m_filter.IsNull () ? RECORDED : FILTERED;
+}
+
 PacketMetadata::PacketMetadata (uint64_t uid, uint32_t size)
   : m_data (PacketMetadata::Create (10)),
     m_head (0xffff),
     m_tail (0xffff),
     m_used (0),
+    m_samplingState (GetSamplingState (uid)),
     m_packetUid (uid)
 {
   memset (m_data->m_data, 0xff, 4);
@@ -704,6 +801,7 @@ PacketMetadata::PacketMetadata (PacketMetadata const &o)
     m_head (o.m_head),
     m_tail (o.m_tail),
     m_used (o.m_used),
+    m_samplingState (o.m_samplingState),
     m_packetUid (o.m_packetUid)
 {
   NS_ASSERT (m_data != 0);
@@ -729,6 +827,7 @@ PacketMetadata::operator = (PacketMetadata const& o)
   m_head = o.m_head;
   m_tail = o.m_tail;
   m_used = o.m_used;
+  m_samplingState = o.m_samplingState;
   m_packetUid = o.m_packetUid;
   return *this;
 }
@@ -135,12 +135,14 @@ Packet::Packet ()
      * metadata is for the system id. For non-
      * distributed simulations, this is simply 
      * zero.  The lower 32 bits are for the 
-     * global UID
+     * global UID, which is incremented atomically
+     * since packets may be created by the threads
+     * of a parallel simulator.
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, 0),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32
+                | __sync_fetch_and_add (&m_globalUid, 1), 0),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 
 Packet::Packet (const Packet &o)
@@ -177,12 +179,14 @@ Packet::Packet (uint32_t size)
      * metadata is for the system id. For non-
      * distributed simulations, this is simply 
      * zero.  The lower 32 bits are for the 
-     * global UID
+     * global UID, which is incremented atomically
+     * since packets may be created by the threads
+     * of a parallel simulator.
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32
+                | __sync_fetch_and_add (&m_globalUid, 1), size),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
   : m_buffer (0, false),
@@ -203,12 +207,14 @@ Packet::Packet (uint8_t const*buffer, uint32_t size)
      * metadata is for the system id. For non-
      * distributed simulations, this is simply 
      * zero.  The lower 32 bits are for the 
-     * global UID
+     * global UID, which is incremented atomically
+     * since packets may be created by the threads
+     * of a parallel simulator.
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32
+                | __sync_fetch_and_add (&m_globalUid, 1), size),
     m_nixVector (0)
 {
-  m_globalUid++;
   m_buffer.AddAtStart (size);
   Buffer::Iterator i = m_buffer.Begin ();
   i.Write (buffer, size);
@@ -545,6 +551,20 @@ Packet::EnableChecking (void)
   PacketMetadata::EnableChecking ();
 }
 
+void
+Packet::EnableSampledPrinting (double fraction)
+{
+  NS_LOG_FUNCTION (fraction);
+  PacketMetadata::EnableSampling (fraction);
+}
+
+void
+Packet::SetPrintingFilter (TypeId tid, Callback<bool, const Header &> filter)
+{
+  NS_LOG_FUNCTION (tid.GetName ());
+  PacketMetadata::SetSamplingFilter (tid, filter);
+}
+
 uint32_t Packet::GetSerializedSize (void) const
 {
   uint32_t size = 0;
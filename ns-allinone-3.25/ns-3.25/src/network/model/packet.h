@@ -501,6 +501,34 @@ public:
    * errors will be detected and will abort the program.
    */
   static void EnableChecking (void);
+  /**
+   * \brief Enable printing the metadata of a sample of the packets.
+   *
+   * Recording the metadata of every packet slows down a simulation
+   * noticeably. This records it only for a fraction of the packets,
+   * picked from their uid: Print prints nothing for the other
+   * packets. As EnablePrinting, this must be invoked before any packet
+   * is created.
+   *
+   * \param fraction the fraction of the packets to print, between 0 and 1
+   *
+   * \sa PacketMetadata::EnableSampling SetPrintingFilter
+   */
+  static void EnableSampledPrinting (double fraction);
+  /**
+   * \brief Print the metadata of the packets of some flows only.
+   *
+   * The metadata of a packet picked by EnableSampledPrinting stops
+   * being recorded when the first header of type \p tid added to it
+   * is rejected by \p filter. For example, a filter on UdpHeader can
+   * select the packets of a flow from their ports.
+   *
+   * \param tid the type of the header which identifies the flows
+   * \param filter returns true for the headers of the packets to print
+   *
+   * \sa PacketMetadata::SetSamplingFilter
+   */
+  static void SetPrintingFilter (TypeId tid, Callback<bool, const Header &> filter);
 
   /**
    * \brief Returns number of bytes required for packet
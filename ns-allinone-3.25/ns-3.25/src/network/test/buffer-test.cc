@@ -359,6 +359,115 @@ BufferTest::DoRun (void)
   val2 <<= 8;
   val2 |= i.ReadU8 ();
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
+
+  // adjacent fragments are merged without copying.
+  buffer = Buffer ();
+  buffer.AddAtStart (6);
+  i = buffer.Begin ();
+  i.WriteU8 (0x1);
+  i.WriteU8 (0x2);
+  i.WriteU8 (0x3);
+  i.WriteU8 (0x4);
+  i.WriteU8 (0x5);
+  i.WriteU8 (0x6);
+  frag0 = buffer.CreateFragment (0, 2);
+  frag1 = buffer.CreateFragment (2, 4);
+  frag0.AddAtEnd (frag1);
+  NS_TEST_ASSERT_MSG_EQ (frag0.GetSize (), 6, "Bad merged fragment size");
+  NS_TEST_ASSERT_MSG_EQ (frag0.PeekData (), buffer.PeekData (), "Fragments were copied");
+  ENSURE_WRITTEN_BYTES (frag0, 6, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6);
+  // out of order fragments are copied.
+  frag0 = buffer.CreateFragment (0, 2);
+  frag1.AddAtEnd (frag0);
+  NS_TEST_ASSERT_MSG_EQ (frag1.GetSize (), 6, "Bad appended fragment size");
+  ENSURE_WRITTEN_BYTES (frag1, 6, 0x3, 0x4, 0x5, 0x6, 0x1, 0x2);
+  ENSURE_WRITTEN_BYTES (buffer, 6, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6);
+
+  // adjacent fragments which split a zero area.
+  buffer = Buffer (4);
+  buffer.AddAtStart (2);
+  i = buffer.Begin ();
+  i.WriteU8 (0x1);
+  i.WriteU8 (0x2);
+  buffer.AddAtEnd (2);
+  i = buffer.End ();
+  i.Prev (2);
+  i.WriteU8 (0x3);
+  i.WriteU8 (0x4);
+  for (uint32_t split = 0; split <= buffer.GetSize (); split++)
+    {
+      frag0 = buffer.CreateFragment (0, split);
+      frag1 = buffer.CreateFragment (split, buffer.GetSize () - split);
+      frag0.AddAtEnd (frag1);
+      NS_TEST_ASSERT_MSG_EQ (frag0.GetSize (), 8, "Bad merged fragment size");
+      ENSURE_WRITTEN_BYTES (frag0, 8, 0x1, 0x2, 0x00, 0x00, 0x00, 0x00, 0x3, 0x4);
+    }
+  frag0 = buffer.CreateFragment (5, 3);
+  frag1 = buffer.CreateFragment (0, 5);
+  frag0.AddAtEnd (frag1);
+  ENSURE_WRITTEN_BYTES (frag0, 8, 0x00, 0x3, 0x4, 0x1, 0x2, 0x00, 0x00, 0x00);
+
+  // buffers which only hold zeroes.
+  buffer = Buffer (3);
+  buffer.AddAtEnd (Buffer (4));
+  NS_TEST_ASSERT_MSG_EQ (buffer.GetSize (), 7, "Bad zero buffer size");
+  ENSURE_WRITTEN_BYTES (buffer, 7, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00);
+  other = Buffer ();
+  other.AddAtStart (1);
+  other.Begin ().WriteU8 (0x9);
+  other.AddAtEnd (Buffer (2));
+  other.AddAtEnd (buffer.CreateFragment (0, 1));
+  ENSURE_WRITTEN_BYTES (other, 4, 0x9, 0x00, 0x00, 0x00);
+  buffer = Buffer ();
+  buffer.AddAtEnd (other);
+  ENSURE_WRITTEN_BYTES (buffer, 4, 0x9, 0x00, 0x00, 0x00);
+
+  // bytes copied after the zero area of the destination.
+  buffer = Buffer (4);
+  buffer.AddAtEnd (1);
+  i = buffer.End ();
+  i.Prev ();
+  i.WriteU8 (0x1);
+  other = Buffer ();
+  other.AddAtStart (2);
+  i = other.Begin ();
+  i.WriteU8 (0x7);
+  i.WriteU8 (0x8);
+  buffer.AddAtEnd (other);
+  NS_TEST_ASSERT_MSG_EQ (buffer.GetSize (), 7, "Bad appended buffer size");
+  ENSURE_WRITTEN_BYTES (buffer, 7, 0x00, 0x00, 0x00, 0x00, 0x1, 0x7, 0x8);
+
+  // zeroes appended to a buffer whose data is shared must not let it
+  // write over the bytes of the other owner of the data.  The large
+  // buffers leave room in the data recycled for the two copies.
+  {
+    {
+      Buffer large0, large1;
+      large0.AddAtEnd (100000);
+      large1.AddAtEnd (100000);
+    }
+    Buffer first;
+    first.AddAtStart (2);
+    i = first.Begin ();
+    i.WriteU8 (0x7);
+    i.WriteU8 (0x7);
+    first.AddAtEnd (Buffer (4));
+    Buffer second = first;
+    first.AddAtEnd (3);
+    i = first.End ();
+    i.Prev (3);
+    i.WriteU8 (0x1);
+    i.WriteU8 (0x1);
+    i.WriteU8 (0x1);
+    second.AddAtEnd (Buffer (3));
+    second.AddAtEnd (2);
+    i = second.End ();
+    i.Prev (2);
+    i.WriteU8 (0x9);
+    i.WriteU8 (0x9);
+    ENSURE_WRITTEN_BYTES (first, 9, 0x7, 0x7, 0x00, 0x00, 0x00, 0x00, 0x1, 0x1, 0x1);
+    ENSURE_WRITTEN_BYTES (second, 11, 0x7, 0x7, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x9, 0x9);
+  }
 }
 //-----------------------------------------------------------------------------
 class BufferTestSuite : public TestSuite
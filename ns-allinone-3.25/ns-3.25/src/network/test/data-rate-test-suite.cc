@@ -0,0 +1,105 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+class DataRateTxTimeTestCase : public TestCase
+{
+public:
+  DataRateTxTimeTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+DataRateTxTimeTestCase::DataRateTxTimeTestCase ()
+  : TestCase ("Check the transmission times computed by DataRate")
+{
+}
+
+void
+DataRateTxTimeTestCase::DoRun (void)
+{
+  NS_TEST_ASSERT_MSG_EQ (DataRate ("5Mbps").CalculateBytesTxTime (1000), MicroSeconds (1600),
+                         "1000 bytes at 5Mbps");
+  NS_TEST_ASSERT_MSG_EQ (DataRate ("54Mbps").CalculateBitsTxTime (54), MicroSeconds (1),
+                         "54 bits at 54Mbps");
+  NS_TEST_ASSERT_MSG_EQ (DataRate ("100Gbps").CalculateBytesTxTime (1), TimeStep (0),
+                         "Transmission times are truncated to the resolution");
+  NS_TEST_ASSERT_MSG_EQ (DataRate ("3bps").CalculateBitsTxTime (1), TimeStep (333333333),
+                         "1 bit at 3bps");
+  // Bytes count up to 2^32, whose bits do not fit in 32 bits
+  NS_TEST_ASSERT_MSG_EQ (DataRate ("8bps").CalculateBytesTxTime (0xffffffff), Seconds (4294967295.0),
+                         "4294967295 bytes at 8bps");
+}
+
+class DataRateTxTimeRoundingTestCase : public TestCase
+{
+public:
+  DataRateTxTimeRoundingTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+DataRateTxTimeRoundingTestCase::DataRateTxTimeRoundingTestCase ()
+  : TestCase ("Check that DataRate transmission times round as Seconds (double)")
+{
+}
+
+void
+DataRateTxTimeRoundingTestCase::DoRun (void)
+{
+  // The double path truncates these just below the exact number of steps.
+  NS_TEST_ASSERT_MSG_EQ (DataRate ("5Mbps").CalculateBytesTxTime (1500), NanoSeconds (2399999),
+                         "1500 bytes at 5Mbps");
+  NS_TEST_ASSERT_MSG_EQ (DataRate ("10Mbps").CalculateBytesTxTime (1500), NanoSeconds (1199999),
+                         "1500 bytes at 10Mbps");
+  NS_TEST_ASSERT_MSG_EQ (DataRate ("1Gbps").CalculateBytesTxTime (1000), NanoSeconds (7999),
+                         "1000 bytes at 1Gbps");
+  NS_TEST_ASSERT_MSG_EQ (DataRate ("1Gbps").CalculateBitsTxTime (8000), NanoSeconds (7999),
+                         "8000 bits at 1Gbps");
+
+  const char *rates[] = { "1bps", "3bps", "9600bps", "56kbps", "1Mbps", "2Mbps", "5Mbps", "5.5Mbps",
+                          "6Mbps", "10Mbps", "11Mbps", "54Mbps", "100Mbps", "300Mbps", "1Gbps",
+                          "1.5Gbps", "10Gbps", "40Gbps", "100Gbps" };
+  for (uint32_t i = 0; i < sizeof (rates) / sizeof (rates[0]); i++)
+    {
+      DataRate rate (rates[i]);
+      for (uint32_t bytes = 0; bytes <= 2000; bytes++)
+        {
+          Time expected = Seconds (static_cast<double> (bytes) * 8 / rate.GetBitRate ());
+          NS_TEST_ASSERT_MSG_EQ (rate.CalculateBytesTxTime (bytes), expected,
+                                 bytes << " bytes at " << rates[i]);
+          NS_TEST_ASSERT_MSG_EQ (rate.CalculateBitsTxTime (bytes),
+                                 Seconds (static_cast<double> (bytes) / rate.GetBitRate ()),
+                                 bytes << " bits at " << rates[i]);
+        }
+    }
+}
+
+static class DataRateTestSuite : public TestSuite
+{
+public:
+  DataRateTestSuite ()
+    : TestSuite ("data-rate", UNIT)
+  {
+    AddTestCase (new DataRateTxTimeTestCase (), TestCase::QUICK);
+    AddTestCase (new DataRateTxTimeRoundingTestCase (), TestCase::QUICK);
+  }
+} g_dataRateTestSuite;
@@ -256,6 +256,8 @@ public:
   virtual ~PacketMetadataTest ();
   void CheckHistory (Ptr<Packet> p, const char *file, int line, uint32_t n, ...);
   virtual void DoRun (void);
+protected:
+  PacketMetadataTest (std::string name);
 private:
   Ptr<Packet> DoAddHeader (Ptr<Packet> p);
 };
@@ -265,6 +267,11 @@ PacketMetadataTest::PacketMetadataTest ()
 {
 }
 
+PacketMetadataTest::PacketMetadataTest (std::string name)
+  : TestCase (name)
+{
+}
+
 PacketMetadataTest::~PacketMetadataTest ()
 {
 }
@@ -822,6 +829,83 @@ PacketMetadataTest::DoRun (void)
   delete [] buf;
   NS_TEST_EXPECT_MSG_EQ (msg, std::string ("hello world"), "Could not find original data in received packet");
 }
+
+/**
+ * Check that the metadata is only recorded for the sampled packets.
+ */
+class PacketMetadataSamplingTest : public PacketMetadataTest
+{
+public:
+  PacketMetadataSamplingTest ();
+  virtual void DoRun (void);
+private:
+  /**
+   * Sampling filter which only accepts the packets whose first
+   * HistoryHeader is 2 bytes long.
+   * \param header the header
+   * \returns true if the packet should be recorded
+   */
+  static bool Filter (const Header &header);
+};
+
+PacketMetadataSamplingTest::PacketMetadataSamplingTest ()
+  : PacketMetadataTest ("Packet metadata sampling")
+{
+}
+
+bool
+PacketMetadataSamplingTest::Filter (const Header &header)
+{
+  return header.GetSerializedSize () == 2;
+}
+
+void
+PacketMetadataSamplingTest::DoRun (void)
+{
+  Packet::EnableSampledPrinting (0.25);
+  Ptr<Packet> p;
+  uint32_t sampled = 0;
+  for (uint32_t i = 0; i < 1000; i++)
+    {
+      p = Create<Packet> (10);
+      ADD_HEADER (p, 1);
+      if (p->BeginItem ().HasNext ())
+        {
+          CHECK_HISTORY (p, 2, 1, 10);
+          sampled++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_GT (sampled, 200, "Too few packets were sampled");
+  NS_TEST_EXPECT_MSG_LT (sampled, 300, "Too many packets were sampled");
+
+  Packet::EnableSampledPrinting (1);
+  Packet::SetPrintingFilter (HistoryHeaderBase::GetTypeId (),
+                             MakeCallback (&PacketMetadataSamplingTest::Filter));
+  p = Create<Packet> (10);
+  ADD_TRAILER (p, 4);
+  ADD_HEADER (p, 2);
+  ADD_HEADER (p, 3);
+  CHECK_HISTORY (p, 4, 3, 2, 10, 4);
+  Ptr<Packet> other = Create<Packet> (10);
+  ADD_TRAILER (other, 4);
+  ADD_HEADER (other, 3);
+  ADD_HEADER (other, 2);
+  NS_TEST_EXPECT_MSG_EQ (other->BeginItem ().HasNext (), false,
+                         "Filtered out packet has metadata");
+  REM_HEADER (other, 2);
+  other->RemoveAtStart (3);
+  NS_TEST_EXPECT_MSG_EQ (other->BeginItem ().HasNext (), false,
+                         "Filtered out packet has metadata");
+  Ptr<Packet> fragment = p->CreateFragment (0, 5);
+  CHECK_HISTORY (fragment, 2, 3, 2);
+  fragment->AddAtEnd (p->CreateFragment (5, p->GetSize () - 5));
+  CHECK_HISTORY (fragment, 4, 3, 2, 10, 4);
+  fragment->AddAtEnd (other);
+  NS_TEST_EXPECT_MSG_EQ (fragment->BeginItem ().HasNext (), false,
+                         "Aggregate of a filtered out packet has metadata");
+
+  Packet::SetPrintingFilter (TypeId (), MakeNullCallback<bool, const Header &> ());
+}
 //-----------------------------------------------------------------------------
 class PacketMetadataTestSuite : public TestSuite
 {
@@ -833,6 +917,7 @@ PacketMetadataTestSuite::PacketMetadataTestSuite ()
   : TestSuite ("packet-metadata", UNIT)
 {
   AddTestCase (new PacketMetadataTest, TestCase::QUICK);
+  AddTestCase (new PacketMetadataSamplingTest, TestCase::QUICK);
 }
 
 PacketMetadataTestSuite g_packetMetadataTest;
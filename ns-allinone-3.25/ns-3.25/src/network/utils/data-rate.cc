@@ -22,6 +22,7 @@
 #include "ns3/nstime.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
+#include <limits>
 
 namespace ns3 {
   
@@ -232,18 +233,56 @@ double DataRate::CalculateTxTime (uint32_t bytes) const
   return static_cast<double>(bytes)*8/m_bps;
 }
 
+/**
+ * Calculate the transmission time of a number of bits.
+ *
+ * The transmission time is Seconds (bits / bps), computed in double.
+ * That conversion is slow, and it truncates to the resolution a value
+ * which is off by the rounding of the double, so that a transmission
+ * time of an exact number of steps is often one step short.
+ *
+ * The quotient of bits * steps-per-second by the rate, in integers,
+ * is used instead when the remainder is far enough from 0 and from
+ * the rate for the rounding of the double path not to matter. Both
+ * paths then give the same result. Otherwise, or if the product would
+ * overflow, the double path is used.
+ *
+ * \param [in] bits The number of bits.
+ * \param [in] bps The data rate, in bits per second.
+ * \return The transmission time.
+ */
+static Time
+BitsTxTime (uint64_t bits, uint64_t bps)
+{
+  int64_t stepsPerSecond = Time::FromInteger (1, Time::S).GetTimeStep ();
+  if (bps != 0 && bps < (static_cast<uint64_t> (1) << 53)
+      && stepsPerSecond > 0 && stepsPerSecond < (static_cast<int64_t> (1) << 44)
+      && bits <= static_cast<uint64_t> (std::numeric_limits<int64_t>::max () / stepsPerSecond))
+    {
+      // The double path is off by at most 2^-53 of the quotient, plus
+      // 2^-65 of a second: less than 2^-20 steps below 2^32 steps.
+      uint64_t product = bits * stepsPerSecond;
+      uint64_t steps = product / bps;
+      uint64_t remainder = product % bps;
+      uint64_t margin = (bps >> 20) + 1;
+      if (steps < (static_cast<uint64_t> (1) << 32) && remainder >= margin && bps - remainder >= margin)
+        {
+          return TimeStep (steps);
+        }
+    }
+  return Seconds (static_cast<double> (bits) / bps);
+}
+
 Time DataRate::CalculateBytesTxTime (uint32_t bytes) const
 {
   NS_LOG_FUNCTION (this << bytes);
-  // \todo avoid to use double (if possible).
-  return Seconds (static_cast<double>(bytes)*8/m_bps);
+  return BitsTxTime (static_cast<uint64_t> (bytes) * 8, m_bps);
 }
 
 Time DataRate::CalculateBitsTxTime (uint32_t bits) const
 {
   NS_LOG_FUNCTION (this << bits);
-  // \todo avoid to use double (if possible).
-  return Seconds (static_cast<double>(bits)/m_bps);
+  return BitsTxTime (bits, m_bps);
 }
 
 uint64_t DataRate::GetBitRate () const
@@ -48,5 +48,15 @@
  * nix-vector and transmits the packet through the corresponding 
  * net-device.  This continues until the packet reaches the destination.
  *
+ * The breadth-first search from a source node covers the whole topology,
+ * and the resulting shortest path tree gives the nix-vectors to all the
+ * destinations of that node.  The trees of the most recent sources are
+ * kept, as many as the NixVectorTreeCacheSize global value allows, and
+ * each node caches the nix-vectors and routes of at most CacheSize
+ * destinations, least recently used first out.  The neighbors of each
+ * node are found once and shared by all the searches.  All of these
+ * are flushed when an Ipv4 interface or address changes, and when the
+ * link of a device goes up or down.
+ *
  */
 
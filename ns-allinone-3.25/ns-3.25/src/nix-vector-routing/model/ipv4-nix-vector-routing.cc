@@ -18,13 +18,14 @@
  * Authors: Josh Pelkey <jpelkey@gatech.edu>
  */
 
-#include <queue>
 #include <iomanip>
 
 #include "ns3/log.h"
 #include "ns3/abort.h"
 #include "ns3/names.h"
 #include "ns3/ipv4-list-routing.h"
+#include "ns3/global-value.h"
+#include "ns3/uinteger.h"
 
 #include "ipv4-nix-vector-routing.h"
 
@@ -35,6 +36,22 @@ NS_LOG_COMPONENT_DEFINE ("Ipv4NixVectorRouting");
 NS_OBJECT_ENSURE_REGISTERED (Ipv4NixVectorRouting);
 
 bool Ipv4NixVectorRouting::g_isCacheDirty = false;
+const uint32_t Ipv4NixVectorRouting::NO_PARENT;
+std::vector<Ipv4NixVectorRouting::Adjacency> Ipv4NixVectorRouting::g_adjacency;
+std::map<Ipv4Address, uint32_t> Ipv4NixVectorRouting::g_nodeByAddress;
+std::map<uint32_t, Ipv4NixVectorRouting::Tree> Ipv4NixVectorRouting::g_trees;
+std::list<uint32_t> Ipv4NixVectorRouting::g_treeAges;
+std::set<NetDevice *> Ipv4NixVectorRouting::g_linkChangeDevices;
+
+/**
+ * \ingroup nix-vector-routing
+ * The maximum number of shortest path trees kept for the source nodes.
+ */
+static GlobalValue g_treeCacheSize = GlobalValue ("NixVectorTreeCacheSize",
+                                                  "The maximum number of shortest path trees of the nodes "
+                                                  "kept by the nix-vector routing, 0 for no limit",
+                                                  UintegerValue (256),
+                                                  MakeUintegerChecker<uint32_t> ());
 
 TypeId 
 Ipv4NixVectorRouting::GetTypeId (void)
@@ -43,12 +60,17 @@ Ipv4NixVectorRouting::GetTypeId (void)
     .SetParent<Ipv4RoutingProtocol> ()
     .SetGroupName ("NixVectorRouting")
     .AddConstructor<Ipv4NixVectorRouting> ()
+    .AddAttribute ("CacheSize",
+                   "The maximum number of destinations whose nix-vector and route are cached, 0 for no limit",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&Ipv4NixVectorRouting::m_cacheSize),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
 
 Ipv4NixVectorRouting::Ipv4NixVectorRouting ()
-  : m_totalNeighbors (0)
+  : m_cacheSize (1024)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -75,6 +97,10 @@ Ipv4NixVectorRouting::DoDispose ()
 
   m_node = 0;
   m_ipv4 = 0;
+  FlushCache ();
+  // the nodes are going away, do not keep them in the shared topology
+  ClearTopology ();
+  g_linkChangeDevices.clear ();
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -92,6 +118,7 @@ void
 Ipv4NixVectorRouting::FlushGlobalNixRoutingCache (void) const
 {
   NS_LOG_FUNCTION_NOARGS ();
+  ClearTopology ();
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
@@ -102,23 +129,153 @@ Ipv4NixVectorRouting::FlushGlobalNixRoutingCache (void) const
           continue;
         }
       NS_LOG_LOGIC ("Flushing Nix caches.");
-      rp->FlushNixCache ();
-      rp->FlushIpv4RouteCache ();
+      rp->FlushCache ();
     }
 }
 
 void
-Ipv4NixVectorRouting::FlushNixCache (void) const
+Ipv4NixVectorRouting::FlushCache (void) const
 {
   NS_LOG_FUNCTION_NOARGS ();
-  m_nixCache.clear ();
+  m_cache.clear ();
+  m_cacheAges.clear ();
 }
 
 void
-Ipv4NixVectorRouting::FlushIpv4RouteCache (void) const
+Ipv4NixVectorRouting::ClearTopology (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  m_ipv4RouteCache.clear ();
+  g_adjacency.clear ();
+  g_nodeByAddress.clear ();
+  g_trees.clear ();
+  g_treeAges.clear ();
+}
+
+Ipv4NixVectorRouting::CacheEntry *
+Ipv4NixVectorRouting::FindCacheEntry (Ipv4Address address)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  CheckCacheStateAndFlush ();
+
+  std::map<Ipv4Address, CacheEntry>::iterator iter = m_cache.find (address);
+  if (iter == m_cache.end ())
+    {
+      // not in cache
+      return 0;
+    }
+  NS_LOG_LOGIC ("Found " << address << " in cache.");
+  m_cacheAges.splice (m_cacheAges.begin (), m_cacheAges, iter->second.age);
+  return &iter->second;
+}
+
+Ipv4NixVectorRouting::CacheEntry &
+Ipv4NixVectorRouting::AddCacheEntry (Ipv4Address address)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  std::map<Ipv4Address, CacheEntry>::iterator iter = m_cache.find (address);
+  if (iter != m_cache.end ())
+    {
+      return iter->second;
+    }
+  if (m_cacheSize != 0 && m_cache.size () >= m_cacheSize)
+    {
+      NS_LOG_LOGIC ("Cache full, evicting " << m_cacheAges.back ());
+      m_cache.erase (m_cacheAges.back ());
+      m_cacheAges.pop_back ();
+    }
+  m_cacheAges.push_front (address);
+  CacheEntry &entry = m_cache[address];
+  entry.age = m_cacheAges.begin ();
+  return entry;
+}
+
+const Ipv4NixVectorRouting::Adjacency &
+Ipv4NixVectorRouting::GetAdjacency (uint32_t nodeId)
+{
+  if (g_adjacency.size () <= nodeId)
+    {
+      Adjacency empty;
+      empty.valid = false;
+      empty.nNeighbors = 0;
+      g_adjacency.resize (NodeList::GetNNodes () > nodeId ? NodeList::GetNNodes () : nodeId + 1, empty);
+    }
+  Adjacency &adjacency = g_adjacency[nodeId];
+  if (adjacency.valid)
+    {
+      return adjacency;
+    }
+
+  NS_LOG_LOGIC ("Finding the neighbors of Node " << nodeId);
+  Ptr<Node> node = NodeList::GetNode (nodeId);
+  adjacency.valid = true;
+  adjacency.ipv4 = node->GetObject<Ipv4> ();
+  for (uint32_t i = 0; i < node->GetNDevices (); i++)
+    {
+      Ptr<NetDevice> localNetDevice = node->GetDevice (i);
+      Ptr<Channel> channel = localNetDevice->GetChannel ();
+      if (channel == 0)
+        {
+          continue;
+        }
+      if (g_linkChangeDevices.insert (PeekPointer (localNetDevice)).second)
+        {
+          localNetDevice->AddLinkChangeCallback (MakeCallback (&Ipv4NixVectorRouting::NotifyLinkChange));
+        }
+
+      // this function takes in the local net dev, and channnel, and
+      // writes to the netDeviceContainer the adjacent net devs
+      NetDeviceContainer netDeviceContainer;
+      GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
+
+      Port port;
+      port.device = localNetDevice;
+      port.interface = adjacency.ipv4 ? adjacency.ipv4->GetInterfaceForDevice (localNetDevice) : 0;
+      port.isBridge = localNetDevice->IsBridge ();
+      for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
+        {
+          port.neighbors.push_back (std::make_pair ((*iter)->GetNode ()->GetId (), *iter));
+        }
+      adjacency.nNeighbors += port.neighbors.size ();
+      adjacency.ports.push_back (port);
+    }
+  return adjacency;
+}
+
+const Ipv4NixVectorRouting::ParentVector_t *
+Ipv4NixVectorRouting::GetTree (Ptr<Node> source)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  uint32_t sourceId = source->GetId ();
+  std::map<uint32_t, Tree>::iterator iter = g_trees.find (sourceId);
+  if (iter != g_trees.end ())
+    {
+      NS_LOG_LOGIC ("Found the tree of Node " << sourceId << " in cache.");
+      g_treeAges.splice (g_treeAges.begin (), g_treeAges, iter->second.age);
+      return &iter->second.parents;
+    }
+
+  ParentVector_t parentVector;
+  if (!BFS (NodeList::GetNNodes (), source, parentVector, 0))
+    {
+      return 0;
+    }
+
+  UintegerValue treeCacheSize;
+  g_treeCacheSize.GetValue (treeCacheSize);
+  if (treeCacheSize.Get () != 0 && g_trees.size () >= treeCacheSize.Get ())
+    {
+      NS_LOG_LOGIC ("Tree cache full, evicting the tree of Node " << g_treeAges.back ());
+      g_trees.erase (g_treeAges.back ());
+      g_treeAges.pop_back ();
+    }
+  g_treeAges.push_front (sourceId);
+  Tree &tree = g_trees[sourceId];
+  tree.parents.swap (parentVector);
+  tree.age = g_treeAges.begin ();
+  return &tree.parents;
 }
 
 Ptr<NixVector>
@@ -149,12 +306,22 @@ Ipv4NixVectorRouting::GetNixVector (Ptr<Node> source, Ipv4Address dest, Ptr<NetD
   else
     {
       // otherwise proceed as normal 
-      // and build the nix vector
-      std::vector< Ptr<Node> > parentVector;
-
-      BFS (NodeList::GetNNodes (), source, destNode, parentVector, oif);
+      // and build the nix vector, from the shared tree of
+      // the source unless a specific output interface is
+      // to be used
+      const ParentVector_t *parentVector;
+      ParentVector_t oifParentVector;
+      if (oif)
+        {
+          BFS (NodeList::GetNNodes (), source, oifParentVector, oif);
+          parentVector = &oifParentVector;
+        }
+      else
+        {
+          parentVector = GetTree (source);
+        }
 
-      if (BuildNixVector (parentVector, source->GetId (), destNode->GetId (), nixVector))
+      if (parentVector && BuildNixVector (*parentVector, source->GetId (), destNode->GetId (), nixVector))
         {
           return nixVector;
         }
@@ -166,41 +333,7 @@ Ipv4NixVectorRouting::GetNixVector (Ptr<Node> source, Ipv4Address dest, Ptr<NetD
     }
 }
 
-Ptr<NixVector>
-Ipv4NixVectorRouting::GetNixVectorInCache (Ipv4Address address)
-{
-  NS_LOG_FUNCTION_NOARGS ();
 
-  CheckCacheStateAndFlush ();
-
-  NixMap_t::iterator iter = m_nixCache.find (address);
-  if (iter != m_nixCache.end ())
-    {
-      NS_LOG_LOGIC ("Found Nix-vector in cache.");
-      return iter->second;
-    }
-
-  // not in cache
-  return 0;
-}
-
-Ptr<Ipv4Route>
-Ipv4NixVectorRouting::GetIpv4RouteInCache (Ipv4Address address)
-{
-  NS_LOG_FUNCTION_NOARGS ();
-
-  CheckCacheStateAndFlush ();
-
-  Ipv4RouteMap_t::iterator iter = m_ipv4RouteCache.find (address);
-  if (iter != m_ipv4RouteCache.end ())
-    {
-      NS_LOG_LOGIC ("Found Ipv4Route in cache.");
-      return iter->second;
-    }
-
-  // not in cache
-  return 0;
-}
 
 bool
 Ipv4NixVectorRouting::BuildNixVectorLocal (Ptr<NixVector> nixVector)
@@ -230,7 +363,7 @@ Ipv4NixVectorRouting::BuildNixVectorLocal (Ptr<NixVector> nixVector)
 }
 
 bool
-Ipv4NixVectorRouting::BuildNixVector (const std::vector< Ptr<Node> > & parentVector, uint32_t source, uint32_t dest, Ptr<NixVector> nixVector)
+Ipv4NixVectorRouting::BuildNixVector (const ParentVector_t & parentVector, uint32_t source, uint32_t dest, Ptr<NixVector> nixVector)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
@@ -239,66 +372,48 @@ Ipv4NixVectorRouting::BuildNixVector (const std::vector< Ptr<Node> > & parentVec
       return true;
     }
 
-  if (parentVector.at (dest) == 0)
+  if (parentVector.at (dest) == NO_PARENT)
     {
       return false;
     }
 
-  Ptr<Node> parentNode = parentVector.at (dest);
+  uint32_t parentId = parentVector.at (dest);
+  const Adjacency &parent = GetAdjacency (parentId);
 
-  uint32_t numberOfDevices = parentNode->GetNDevices ();
   uint32_t destId = 0;
   uint32_t totalNeighbors = 0;
 
   // scan through the net devices on the parent node
   // and then look at the nodes adjacent to them
-  for (uint32_t i = 0; i < numberOfDevices; i++)
+  for (std::vector<Port>::const_iterator port = parent.ports.begin (); port != parent.ports.end (); port++)
     {
-      // Get a net device from the node
-      // as well as the channel, and figure
-      // out the adjacent net devices
-      Ptr<NetDevice> localNetDevice = parentNode->GetDevice (i);
-      if (localNetDevice->IsBridge ())
-        {
-          continue;
-        }
-      Ptr<Channel> channel = localNetDevice->GetChannel ();
-      if (channel == 0)
+      if (port->isBridge)
         {
           continue;
         }
 
-      // this function takes in the local net dev, and channnel, and
-      // writes to the netDeviceContainer the adjacent net devs
-      NetDeviceContainer netDeviceContainer;
-      GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
-
       // Finally we can get the adjacent nodes
       // and scan through them.  If we find the 
       // node that matches "dest" then we can add 
       // the index  to the nix vector.
       // the index corresponds to the neighbor index
-      uint32_t offset = 0;
-      for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
+      for (uint32_t offset = 0; offset < port->neighbors.size (); offset++)
         {
-          Ptr<Node> remoteNode = (*iter)->GetNode ();
-
-          if (remoteNode->GetId () == dest)
+          if (port->neighbors[offset].first == dest)
             {
               destId = totalNeighbors + offset;
             }
-          offset += 1;
         }
 
-      totalNeighbors += netDeviceContainer.GetN ();
+      totalNeighbors += port->neighbors.size ();
     }
   NS_LOG_LOGIC ("Adding Nix: " << destId << " with " 
-                               << nixVector->BitCount (totalNeighbors) << " bits, for node " << parentNode->GetId ());
+                               << nixVector->BitCount (totalNeighbors) << " bits, for node " << parentId);
   nixVector->AddNeighborIndex (destId, nixVector->BitCount (totalNeighbors));
 
   // recurse through parent vector, grabbing the path 
   // and building the nix vector
-  BuildNixVector (parentVector, source, (parentVector.at (dest))->GetId (), nixVector);
+  BuildNixVector (parentVector, source, parentId, nixVector);
   return true;
 }
 
@@ -347,58 +462,41 @@ Ipv4NixVectorRouting::GetNodeByIp (Ipv4Address dest)
 { 
   NS_LOG_FUNCTION_NOARGS ();
 
-  NodeContainer allNodes = NodeContainer::GetGlobal ();
-  Ptr<Node> destNode;
-
-  for (NodeContainer::Iterator i = allNodes.Begin (); i != allNodes.End (); ++i)
+  if (g_nodeByAddress.empty ())
     {
-      Ptr<Node> node = *i;
-      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-      if (ipv4->GetInterfaceForAddress (dest) != -1)
+      // the first node with an address wins, as when
+      // searching the node list in order
+      for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); ++i)
         {
-          destNode = node;
-          break;
+          Ptr<Ipv4> ipv4 = (*i)->GetObject<Ipv4> ();
+          if (ipv4 == 0)
+            {
+              continue;
+            }
+          for (uint32_t j = 0; j < ipv4->GetNInterfaces (); j++)
+            {
+              for (uint32_t k = 0; k < ipv4->GetNAddresses (j); k++)
+                {
+                  g_nodeByAddress.insert (std::make_pair (ipv4->GetAddress (j, k).GetLocal (), (*i)->GetId ()));
+                }
+            }
         }
     }
 
-  if (!destNode)
+  std::map<Ipv4Address, uint32_t>::const_iterator iter = g_nodeByAddress.find (dest);
+  if (iter == g_nodeByAddress.end ())
     {
       NS_LOG_ERROR ("Couldn't find dest node given the IP" << dest);
       return 0;
     }
 
-  return destNode;
+  return NodeList::GetNode (iter->second);
 }
 
 uint32_t
 Ipv4NixVectorRouting::FindTotalNeighbors (void)
 {
-  uint32_t numberOfDevices = m_node->GetNDevices ();
-  uint32_t totalNeighbors = 0;
-
-  // scan through the net devices on the parent node
-  // and then look at the nodes adjacent to them
-  for (uint32_t i = 0; i < numberOfDevices; i++)
-    {
-      // Get a net device from the node
-      // as well as the channel, and figure
-      // out the adjacent net devices
-      Ptr<NetDevice> localNetDevice = m_node->GetDevice (i);
-      Ptr<Channel> channel = localNetDevice->GetChannel ();
-      if (channel == 0)
-        {
-          continue;
-        }
-
-      // this function takes in the local net dev, and channnel, and
-      // writes to the netDeviceContainer the adjacent net devs
-      NetDeviceContainer netDeviceContainer;
-      GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
-
-      totalNeighbors += netDeviceContainer.GetN ();
-    }
-
-  return totalNeighbors;
+  return GetAdjacency (m_node->GetId ()).nNeighbors;
 }
 
 Ptr<BridgeNetDevice>
@@ -444,35 +542,20 @@ Ipv4NixVectorRouting::NetDeviceIsBridged (Ptr<NetDevice> nd) const
 uint32_t
 Ipv4NixVectorRouting::FindNetDeviceForNixIndex (uint32_t nodeIndex, Ipv4Address & gatewayIp)
 {
-  uint32_t numberOfDevices = m_node->GetNDevices ();
+  const Adjacency &adjacency = GetAdjacency (m_node->GetId ());
   uint32_t index = 0;
   uint32_t totalNeighbors = 0;
 
   // scan through the net devices on the parent node
   // and then look at the nodes adjacent to them
-  for (uint32_t i = 0; i < numberOfDevices; i++)
+  for (std::vector<Port>::const_iterator port = adjacency.ports.begin (); port != adjacency.ports.end (); port++)
     {
-      // Get a net device from the node
-      // as well as the channel, and figure
-      // out the adjacent net devices
-      Ptr<NetDevice> localNetDevice = m_node->GetDevice (i);
-      Ptr<Channel> channel = localNetDevice->GetChannel ();
-      if (channel == 0)
-        {
-          continue;
-        }
-
-      // this function takes in the local net dev, and channnel, and
-      // writes to the netDeviceContainer the adjacent net devs
-      NetDeviceContainer netDeviceContainer;
-      GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
-
       // check how many neighbors we have
-      if (nodeIndex < (totalNeighbors + netDeviceContainer.GetN ()))
+      if (nodeIndex < (totalNeighbors + port->neighbors.size ()))
         {
           // found the proper net device
-          index = i;
-          Ptr<NetDevice> gatewayDevice = netDeviceContainer.Get (nodeIndex-totalNeighbors);
+          index = port->device->GetIfIndex ();
+          Ptr<NetDevice> gatewayDevice = port->neighbors[nodeIndex - totalNeighbors].second;
           Ptr<Node> gatewayNode = gatewayDevice->GetNode ();
           Ptr<Ipv4> ipv4 = gatewayNode->GetObject<Ipv4> ();
 
@@ -481,7 +564,7 @@ Ipv4NixVectorRouting::FindNetDeviceForNixIndex (uint32_t nodeIndex, Ipv4Address
           gatewayIp = ifAddr.GetLocal ();
           break;
         }
-      totalNeighbors += netDeviceContainer.GetN ();
+      totalNeighbors += port->neighbors.size ();
     }
 
   return index;
@@ -499,7 +582,11 @@ Ipv4NixVectorRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<
 
   NS_LOG_DEBUG ("Dest IP from header: " << header.GetDestination ());
   // check if cache
-  nixVectorInCache = GetNixVectorInCache (header.GetDestination ());
+  CacheEntry *entry = FindCacheEntry (header.GetDestination ());
+  if (entry)
+    {
+      nixVectorInCache = entry->nixVector;
+    }
 
   // not in cache
   if (!nixVectorInCache)
@@ -510,7 +597,8 @@ Ipv4NixVectorRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<
       nixVectorInCache = GetNixVector (m_node, header.GetDestination (), oif);
 
       // cache it
-      m_nixCache.insert (NixMap_t::value_type (header.GetDestination (), nixVectorInCache));
+      entry = &AddCacheEntry (header.GetDestination ());
+      entry->nixVector = nixVectorInCache;
     }
 
   // path exists
@@ -525,32 +613,18 @@ Ipv4NixVectorRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<
 
       // Get the interface number that we go out of, by extracting
       // from the nix-vector
-      if (m_totalNeighbors == 0)
-        {
-          m_totalNeighbors = FindTotalNeighbors ();
-        }
-
-      // Get the interface number that we go out of, by extracting
-      // from the nix-vector
-      uint32_t numberOfBits = nixVectorForPacket->BitCount (m_totalNeighbors);
+      uint32_t numberOfBits = nixVectorForPacket->BitCount (FindTotalNeighbors ());
       uint32_t nodeIndex = nixVectorForPacket->ExtractNeighborIndex (numberOfBits);
 
       // Search here in a cache for this node index 
       // and look for a Ipv4Route
-      rtentry = GetIpv4RouteInCache (header.GetDestination ());
+      rtentry = entry->route;
 
       if (!rtentry || !(rtentry->GetOutputDevice () == oif))
         {
           // not in cache or a different specified output
-          // device is to be used
-
-          // first, make sure we erase existing (incorrect)
-          // rtentry from the map
-          if (rtentry)
-            {
-              m_ipv4RouteCache.erase (header.GetDestination ());
-            }
-
+          // device is to be used, the new rtentry replaces
+          // the existing (incorrect) one in the cache
           NS_LOG_LOGIC ("Ipv4Route not in cache, build: ");
           Ipv4Address gatewayIp;
           uint32_t index = FindNetDeviceForNixIndex (nodeIndex, gatewayIp);
@@ -588,7 +662,7 @@ Ipv4NixVectorRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<
           sockerr = Socket::ERROR_NOTERROR;
 
           // add rtentry to cache
-          m_ipv4RouteCache.insert (Ipv4RouteMap_t::value_type (header.GetDestination (), rtentry));
+          entry->route = rtentry;
         }
 
       NS_LOG_LOGIC ("Nix-vector contents: " << *nixVectorInCache << " : Remaining bits: " << nixVectorForPacket->GetRemainingBits ());
@@ -654,14 +728,14 @@ Ipv4NixVectorRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header,
 
   // Get the interface number that we go out of, by extracting
   // from the nix-vector
-  if (m_totalNeighbors == 0)
-    {
-      m_totalNeighbors = FindTotalNeighbors ();
-    }
-  uint32_t numberOfBits = nixVector->BitCount (m_totalNeighbors);
+  uint32_t numberOfBits = nixVector->BitCount (FindTotalNeighbors ());
   uint32_t nodeIndex = nixVector->ExtractNeighborIndex (numberOfBits);
 
-  rtentry = GetIpv4RouteInCache (header.GetDestination ());
+  CacheEntry *entry = FindCacheEntry (header.GetDestination ());
+  if (entry)
+    {
+      rtentry = entry->route;
+    }
   // not in cache
   if (!rtentry)
     {
@@ -680,7 +754,7 @@ Ipv4NixVectorRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header,
       rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIndex));
 
       // add rtentry to cache
-      m_ipv4RouteCache.insert (Ipv4RouteMap_t::value_type (header.GetDestination (), rtentry));
+      AddCacheEntry (header.GetDestination ()).route = rtentry;
     }
 
   NS_LOG_LOGIC ("At Node " << m_node->GetId () << ", Extracting " << numberOfBits <<
@@ -708,11 +782,27 @@ Ipv4NixVectorRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const
       << ", Local time: " << GetObject<Node> ()->GetLocalTime ().As (Time::S)
       << ", Nix Routing" << std::endl;
 
+  // the cache holds the nix-vectors and the routes of
+  // the destinations, either of which may be missing
+  NixMap_t nixCache;
+  Ipv4RouteMap_t ipv4RouteCache;
+  for (std::map<Ipv4Address, CacheEntry>::const_iterator it = m_cache.begin (); it != m_cache.end (); it++)
+    {
+      if (it->second.nixVector)
+        {
+          nixCache.insert (NixMap_t::value_type (it->first, it->second.nixVector));
+        }
+      if (it->second.route)
+        {
+          ipv4RouteCache.insert (Ipv4RouteMap_t::value_type (it->first, it->second.route));
+        }
+    }
+
   *os << "NixCache:" << std::endl;
-  if (m_nixCache.size () > 0)
+  if (nixCache.size () > 0)
     {
       *os << "Destination     NixVector" << std::endl;
-      for (NixMap_t::const_iterator it = m_nixCache.begin (); it != m_nixCache.end (); it++)
+      for (NixMap_t::const_iterator it = nixCache.begin (); it != nixCache.end (); it++)
         {
           std::ostringstream dest;
           dest << it->first;
@@ -721,10 +811,10 @@ Ipv4NixVectorRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const
         }
     }
   *os << "Ipv4RouteCache:" << std::endl;
-  if (m_ipv4RouteCache.size () > 0)
+  if (ipv4RouteCache.size () > 0)
     {
       *os << "Destination     Gateway         Source            OutputDevice" << std::endl;
-      for (Ipv4RouteMap_t::const_iterator it = m_ipv4RouteCache.begin (); it != m_ipv4RouteCache.end (); it++)
+      for (Ipv4RouteMap_t::const_iterator it = ipv4RouteCache.begin (); it != ipv4RouteCache.end (); it++)
         {
           std::ostringstream dest, gw, src;
           dest << it->second->GetDestination ();
@@ -748,6 +838,12 @@ Ipv4NixVectorRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const
   *os << std::endl;
 }
 
+void
+Ipv4NixVectorRouting::NotifyLinkChange (void)
+{
+  g_isCacheDirty = true;
+}
+
 // virtual functions from Ipv4RoutingProtocol 
 void
 Ipv4NixVectorRouting::NotifyInterfaceUp (uint32_t i)
@@ -772,150 +868,87 @@ Ipv4NixVectorRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddr
 
 bool
 Ipv4NixVectorRouting::BFS (uint32_t numberOfNodes, Ptr<Node> source, 
-                           Ptr<Node> dest, std::vector< Ptr<Node> > & parentVector,
+                           ParentVector_t & parentVector,
                            Ptr<NetDevice> oif)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  NS_LOG_LOGIC ("Going from Node " << source->GetId () << " to Node " << dest->GetId ());
-  std::queue< Ptr<Node> > greyNodeList;  // discovered nodes with unexplored children
+  NS_LOG_LOGIC ("Going from Node " << source->GetId ());
+  // discovered nodes, those from greyNode on have unexplored children
+  std::vector<uint32_t> greyNodeList;
+  greyNodeList.reserve (numberOfNodes);
+  uint32_t greyNode = 0;
 
   // reset the parent vector
-  parentVector.clear ();
-  parentVector.reserve (sizeof (Ptr<Node>)*numberOfNodes);
-  parentVector.insert (parentVector.begin (), sizeof (Ptr<Node>)*numberOfNodes, 0); // initialize to 0
+  parentVector.assign (numberOfNodes, NO_PARENT);
 
   // Add the source node to the queue, set its parent to itself 
-  greyNodeList.push (source);
-  parentVector.at (source->GetId ()) = source;
+  greyNodeList.push_back (source->GetId ());
+  parentVector.at (source->GetId ()) = source->GetId ();
 
   // BFS loop
-  while (greyNodeList.size () != 0)
+  while (greyNode < greyNodeList.size ())
     {
-      Ptr<Node> currNode = greyNodeList.front ();
-      Ptr<Ipv4> ipv4 = currNode->GetObject<Ipv4> ();
- 
-      if (currNode == dest) 
-        {
-          NS_LOG_LOGIC ("Made it to Node " << currNode->GetId ());
-          return true;
-        }
+      uint32_t currNode = greyNodeList[greyNode];
+      const Adjacency &adjacency = GetAdjacency (currNode);
+      Ptr<Ipv4> ipv4 = adjacency.ipv4;
 
-      // if this is the first iteration of the loop and a 
-      // specific output interface was given, make sure 
-      // we go this way
-      if (currNode == source && oif)
+      for (std::vector<Port>::const_iterator port = adjacency.ports.begin (); port != adjacency.ports.end (); port++)
         {
+          // if this is the first iteration of the loop and a 
+          // specific output interface was given, make sure 
+          // we go this way
+          if (currNode == source->GetId () && oif && port->device != oif)
+            {
+              continue;
+            }
+
           // make sure that we can go this way
           if (ipv4)
             {
-              uint32_t interfaceIndex = (ipv4)->GetInterfaceForDevice (oif);
-              if (!(ipv4->IsUp (interfaceIndex)))
+              if (!(ipv4->IsUp (port->interface)))
                 {
                   NS_LOG_LOGIC ("Ipv4Interface is down");
-                  return false;
+                  continue;
                 }
             }
-          if (!(oif->IsLinkUp ()))
+          if (!(port->device->IsLinkUp ()))
             {
               NS_LOG_LOGIC ("Link is down.");
-              return false;
-            }
-          Ptr<Channel> channel = oif->GetChannel ();
-          if (channel == 0)
-            { 
-              return false;
+              continue;
             }
 
-          // this function takes in the local net dev, and channnel, and
-          // writes to the netDeviceContainer the adjacent net devs
-          NetDeviceContainer netDeviceContainer;
-          GetAdjacentNetDevices (oif, channel, netDeviceContainer);
-
           // Finally we can get the adjacent nodes
           // and scan through them.  We push them
           // to the greyNode queue, if they aren't 
           // already there.
-          for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
+          for (uint32_t i = 0; i < port->neighbors.size (); i++)
             {
-              Ptr<Node> remoteNode = (*iter)->GetNode ();
+              uint32_t remoteNode = port->neighbors[i].first;
 
               // check to see if this node has been pushed before
               // by checking to see if it has a parent
-              // if it doesn't (null or 0), then set its parent and 
+              // if it doesn't (NO_PARENT), then set its parent and 
               // push to the queue
-              if (parentVector.at (remoteNode->GetId ()) == 0)
-                {
-                  parentVector.at (remoteNode->GetId ()) = currNode;
-                  greyNodeList.push (remoteNode);
-                }
-            }
-        }
-      else
-        {
-          // Iterate over the current node's adjacent vertices
-          // and push them into the queue
-          for (uint32_t i = 0; i < (currNode->GetNDevices ()); i++)
-            {
-              // Get a net device from the node
-              // as well as the channel, and figure
-              // out the adjacent net device
-              Ptr<NetDevice> localNetDevice = currNode->GetDevice (i);
-
-              // make sure that we can go this way
-              if (ipv4)
-                {
-                  uint32_t interfaceIndex = (ipv4)->GetInterfaceForDevice (currNode->GetDevice (i));
-                  if (!(ipv4->IsUp (interfaceIndex)))
-                    {
-                      NS_LOG_LOGIC ("Ipv4Interface is down");
-                      continue;
-                    }
-                }
-              if (!(localNetDevice->IsLinkUp ()))
-                {
-                  NS_LOG_LOGIC ("Link is down.");
-                  continue;
-                }
-              Ptr<Channel> channel = localNetDevice->GetChannel ();
-              if (channel == 0)
-                { 
-                  continue;
-                }
-
-              // this function takes in the local net dev, and channnel, and
-              // writes to the netDeviceContainer the adjacent net devs
-              NetDeviceContainer netDeviceContainer;
-              GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
-
-              // Finally we can get the adjacent nodes
-              // and scan through them.  We push them
-              // to the greyNode queue, if they aren't 
-              // already there.
-              for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
+              if (parentVector.at (remoteNode) == NO_PARENT)
                 {
-                  Ptr<Node> remoteNode = (*iter)->GetNode ();
-
-                  // check to see if this node has been pushed before
-                  // by checking to see if it has a parent
-                  // if it doesn't (null or 0), then set its parent and 
-                  // push to the queue
-                  if (parentVector.at (remoteNode->GetId ()) == 0)
-                    {
-                      parentVector.at (remoteNode->GetId ()) = currNode;
-                      greyNodeList.push (remoteNode);
-                    }
+                  parentVector.at (remoteNode) = currNode;
+                  greyNodeList.push_back (remoteNode);
                 }
             }
         }
 
-      // Pop off the head grey node.  We have all its children.
+      // Move past the head grey node.  We have all its children.
       // It is now black.
-      greyNodeList.pop ();
+      greyNode++;
     }
 
-  // Didn't find the dest...
-  return false;
+  if (oif && greyNodeList.size () == 1)
+    {
+      NS_LOG_LOGIC ("Cannot go out of the output interface");
+      return false;
+    }
+  return true;
 }
 
 void 
@@ -21,7 +21,11 @@
 #ifndef IPV4_NIX_VECTOR_ROUTING_H
 #define IPV4_NIX_VECTOR_ROUTING_H
 
+#include <list>
 #include <map>
+#include <set>
+#include <utility>
+#include <vector>
 
 #include "ns3/channel.h"
 #include "ns3/node-container.h"
@@ -48,6 +52,10 @@ typedef std::map<Ipv4Address, Ptr<Ipv4Route> > Ipv4RouteMap_t;
 /**
  * \ingroup nix-vector-routing
  * Nix-vector routing protocol
+ *
+ * The adjacency of the nodes and the shortest path trees of the source
+ * nodes are shared by all the instances; the nix-vectors and routes are
+ * cached per node, for at most CacheSize destinations.
  */
 class Ipv4NixVectorRouting : public Ipv4RoutingProtocol
 {
@@ -82,13 +90,71 @@ public:
 
 private:
 
-  /* flushes the cache which stores nix-vector based on
-   * destination IP */
-  void FlushNixCache (void) const;
-
-  /* flushes the cache which stores the Ipv4 route
-   * based on the destination IP */
-  void FlushIpv4RouteCache (void) const;
+  /* a device of a node which has a channel, with the devices
+   * adjacent to it on that channel */
+  struct Port
+  {
+    Ptr<NetDevice> device;  /* the device */
+    uint32_t interface;     /* the Ipv4 interface of the device */
+    bool isBridge;          /* true if the device is a bridge */
+    /* the adjacent nodes and devices */
+    std::vector<std::pair<uint32_t, Ptr<NetDevice> > > neighbors;
+  };
+
+  /* the devices of a node which have a channel, in the order of
+   * the devices of the node */
+  struct Adjacency
+  {
+    bool valid;             /* true once the ports have been found */
+    Ptr<Ipv4> ipv4;         /* the Ipv4 of the node, if any */
+    std::vector<Port> ports;
+    uint32_t nNeighbors;    /* the number of neighbors of all the ports */
+  };
+
+  /* parent of each node in a shortest path tree, by node id */
+  typedef std::vector<uint32_t> ParentVector_t;
+
+  /* shortest path tree of a source node in the tree cache */
+  struct Tree
+  {
+    ParentVector_t parents;
+    std::list<uint32_t>::iterator age; /* position in g_treeAges */
+  };
+
+  /* nix-vector and route to a destination in the cache of a node */
+  struct CacheEntry
+  {
+    Ptr<NixVector> nixVector;
+    Ptr<Ipv4Route> route;
+    std::list<Ipv4Address>::iterator age; /* position in m_cacheAges */
+  };
+
+  /* flushes the cache which stores the nix-vectors and the Ipv4
+   * routes based on destination IP */
+  void FlushCache (void) const;
+
+  /* forgets the neighbors, addresses and trees of all the nodes */
+  static void ClearTopology (void);
+
+  /* finds the cache entry of a destination IP, and marks it as
+   * the most recently used, returns 0 if not in cache */
+  CacheEntry *FindCacheEntry (Ipv4Address);
+
+  /* finds or adds the cache entry of a destination IP, evicting
+   * the least recently used entry if the cache is full */
+  CacheEntry &AddCacheEntry (Ipv4Address);
+
+  /* returns the neighbors of a node, found on first use, and
+   * watches the link state of its devices */
+  const Adjacency &GetAdjacency (uint32_t nodeId);
+
+  /* marks the caches dirty when the link state of a device of the
+   * topology changes, since the trees and nix-vectors depend on it */
+  static void NotifyLinkChange (void);
+
+  /* returns the shortest path tree of a source node, from the
+   * tree cache or built by BFS, or 0 if the BFS fails */
+  const ParentVector_t *GetTree (Ptr<Node> source);
 
   /* upon a run-time topology change caches are
    * flushed and the total number of neighbors is
@@ -100,28 +166,22 @@ private:
    *  BuildNixVector to return the built nix-vector */
   Ptr<NixVector> GetNixVector (Ptr<Node>, Ipv4Address, Ptr<NetDevice>);
 
-  /* checks the cache based on dest IP for the nix-vector */
-  Ptr<NixVector> GetNixVectorInCache (Ipv4Address);
-
-  /* checks the cache based on dest IP for the Ipv4Route */
-  Ptr<Ipv4Route> GetIpv4RouteInCache (Ipv4Address);
-
   /* given a net-device returns all the adjacent net-devices,
    * essentially getting the neighbors on that channel */
   void GetAdjacentNetDevices (Ptr<NetDevice>, Ptr<Channel>, NetDeviceContainer &);
 
-  /* iterates through the node list and finds the one
-   * corresponding to the given Ipv4Address */
+  /* finds the node corresponding to the given Ipv4Address,
+   * in a map of the addresses of all the nodes */
   Ptr<Node> GetNodeByIp (Ipv4Address);
 
   /* Recurses the parent vector, created by BFS and actually builds the nixvector */
-  bool BuildNixVector (const std::vector< Ptr<Node> > & parentVector, uint32_t source, uint32_t dest, Ptr<NixVector> nixVector);
+  bool BuildNixVector (const ParentVector_t & parentVector, uint32_t source, uint32_t dest, Ptr<NixVector> nixVector);
 
   /* special variation of BuildNixVector for when a node is sending to itself */
   bool BuildNixVectorLocal (Ptr<NixVector> nixVector);
 
-  /* simple iterates through the nodes net-devices and determines
-   * how many neighbors it has */
+  /* returns how many neighbors the node has through its
+   * net-devices */
   uint32_t FindTotalNeighbors (void);
 
   /* determine if the netdevice is bridged */
@@ -132,18 +192,18 @@ private:
    * derived from this */
   uint32_t FindNetDeviceForNixIndex (uint32_t nodeIndex, Ipv4Address & gatewayIp);
 
-  /* Breadth first search algorithm
+  /* Breadth first search algorithm, building the shortest path
+   * tree of the source node to all the nodes
    * Param1: total number of nodes
    * Param2: Source Node
-   * Param3: Dest Node
-   * Param4: (returned) Parent vector for retracing routes
-   * Param5: specific output interface to use from source node, if not null
-   * Returns: false if dest not found, true o.w.
+   * Param3: (returned) Parent vector for retracing routes, with
+   *         NO_PARENT for the nodes which cannot be reached
+   * Param4: specific output interface to use from source node, if not null
+   * Returns: false if the output interface cannot be used, true o.w.
    */
   bool BFS (uint32_t numberOfNodes,
             Ptr<Node> source,
-            Ptr<Node> dest,
-            std::vector< Ptr<Node> > & parentVector,
+            ParentVector_t & parentVector,
             Ptr<NetDevice> oif);
 
   void DoDispose (void);
@@ -171,18 +231,36 @@ private:
    */
   static bool g_isCacheDirty;
 
-  /* Cache stores nix-vectors based on destination ip */
-  mutable NixMap_t m_nixCache;
+  /* parent of the nodes which cannot be reached */
+  static const uint32_t NO_PARENT = 0xffffffff;
+
+  /* Neighbors of the nodes, by node id */
+  static std::vector<Adjacency> g_adjacency;
+
+  /* Node ids of the addresses of all the nodes, built on first use */
+  static std::map<Ipv4Address, uint32_t> g_nodeByAddress;
 
-  /* Cache stores Ipv4Routes based on destination ip */
-  mutable Ipv4RouteMap_t m_ipv4RouteCache;
+  /* Shortest path trees of the source nodes, by node id */
+  static std::map<uint32_t, Tree> g_trees;
+
+  /* Source nodes of the trees, most recently used first */
+  static std::list<uint32_t> g_treeAges;
+
+  /* Devices whose link state changes are notified to NotifyLinkChange,
+   * kept until the nodes are disposed of */
+  static std::set<NetDevice *> g_linkChangeDevices;
+
+  /* Cache stores nix-vectors and Ipv4Routes based on destination ip */
+  mutable std::map<Ipv4Address, CacheEntry> m_cache;
+
+  /* Destinations of the cache, most recently used first */
+  mutable std::list<Ipv4Address> m_cacheAges;
+
+  /* Maximum number of destinations of the cache, 0 for no limit */
+  uint32_t m_cacheSize;
 
   Ptr<Ipv4> m_ipv4;
   Ptr<Node> m_node;
-
-  /* Total neighbors used for nix-vector to determine
-   * number of bits */
-  uint32_t m_totalNeighbors;
 };
 } // namespace ns3
 
@@ -0,0 +1,360 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/config.h"
+#include "ns3/uinteger.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/error-model.h"
+#include "ns3/mac48-address.h"
+#include "ns3/packet.h"
+#include "ns3/nix-vector.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-nix-vector-helper.h"
+#include "ns3/ipv4-nix-vector-routing.h"
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \brief A SimpleNetDevice whose link can be taken down.
+ */
+class NixTestNetDevice : public SimpleNetDevice
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  NixTestNetDevice ();
+
+  /**
+   * \brief Take the link up or down, and notify it.
+   * \param up Whether the link is up.
+   */
+  void SetLinkUp (bool up);
+
+  virtual bool IsLinkUp (void) const;
+  virtual void AddLinkChangeCallback (Callback<void> callback);
+
+private:
+  bool m_linkUp;                            //!< Whether the link is up
+  TracedCallback<> m_linkChangeCallbacks;   //!< The link change callbacks
+};
+
+TypeId
+NixTestNetDevice::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::NixTestNetDevice")
+    .SetParent<SimpleNetDevice> ()
+    .SetGroupName ("NixVectorRouting")
+    .AddConstructor<NixTestNetDevice> ()
+  ;
+  return tid;
+}
+
+NixTestNetDevice::NixTestNetDevice ()
+  : m_linkUp (true)
+{
+}
+
+void
+NixTestNetDevice::SetLinkUp (bool up)
+{
+  m_linkUp = up;
+  m_linkChangeCallbacks ();
+}
+
+bool
+NixTestNetDevice::IsLinkUp (void) const
+{
+  return m_linkUp;
+}
+
+void
+NixTestNetDevice::AddLinkChangeCallback (Callback<void> callback)
+{
+  m_linkChangeCallbacks.ConnectWithoutContext (callback);
+}
+
+/**
+ * \brief Check that the caches of the nix-vector routing do not change
+ * the routes, when their entries are evicted and rebuilt, and when a
+ * link goes down.
+ */
+class NixVectorRoutingCacheTestCase : public TestCase
+{
+public:
+  NixVectorRoutingCacheTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /** The route of each source node to each destination address. */
+  typedef std::map<std::pair<uint32_t, Ipv4Address>, std::string> Routes;
+
+  /**
+   * \brief Route from every node to every address of the other nodes.
+   *
+   * \param cacheSize The CacheSize of the routing of the nodes.
+   * \param treeCacheSize The NixVectorTreeCacheSize.
+   * \param destinationFirst Whether to iterate over the destinations
+   *        in the outer loop, so that successive routes come from
+   *        different sources.
+   * \param flushEach Whether to flush the caches before each route.
+   * \returns The routes.
+   */
+  Routes RouteAll (uint32_t cacheSize, uint32_t treeCacheSize,
+                   bool destinationFirst, bool flushEach);
+
+  /**
+   * \brief Route a packet from a node.
+   *
+   * \param source The node.
+   * \param destination The destination address.
+   * \param flush Whether to flush the caches first.
+   * \returns The gateway, the output device and the nix-vector.
+   */
+  std::string Route (uint32_t source, Ipv4Address destination, bool flush);
+
+  /**
+   * \brief Link two nodes with a NixTestNetDevice each.
+   *
+   * \param a The first node.
+   * \param b The second node.
+   * \returns The devices.
+   */
+  NetDeviceContainer Link (Ptr<Node> a, Ptr<Node> b);
+
+  NodeContainer m_nodes;                    //!< The nodes
+  std::vector<Ipv4Address> m_addresses;     //!< The addresses of the nodes
+  std::vector<uint32_t> m_addressNodes;     //!< The node of each address
+};
+
+NixVectorRoutingCacheTestCase::NixVectorRoutingCacheTestCase ()
+  : TestCase ("Nix-vector routes with small caches and link changes")
+{
+}
+
+NetDeviceContainer
+NixVectorRoutingCacheTestCase::Link (Ptr<Node> a, Ptr<Node> b)
+{
+  Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+  NetDeviceContainer devices;
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<NixTestNetDevice> device = CreateObject<NixTestNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetChannel (channel);
+      (i == 0 ? a : b)->AddDevice (device);
+      devices.Add (device);
+    }
+  return devices;
+}
+
+std::string
+NixVectorRoutingCacheTestCase::Route (uint32_t source, Ipv4Address destination, bool flush)
+{
+  Ptr<Ipv4NixVectorRouting> nix = m_nodes.Get (source)->GetObject<Ipv4NixVectorRouting> ();
+  if (flush)
+    {
+      nix->FlushGlobalNixRoutingCache ();
+    }
+  Ptr<Ipv4RoutingProtocol> routing = nix;
+  Ptr<Packet> p = Create<Packet> ();
+  Ipv4Header header;
+  header.SetDestination (destination);
+  Socket::SocketErrno error;
+  Ptr<Ipv4Route> route = routing->RouteOutput (p, header, 0, error);
+  std::ostringstream oss;
+  if (route == 0)
+    {
+      oss << "no route";
+    }
+  else
+    {
+      oss << route->GetGateway () << " " << route->GetOutputDevice ()->GetIfIndex ()
+          << " " << *p->GetNixVector ();
+    }
+  return oss.str ();
+}
+
+NixVectorRoutingCacheTestCase::Routes
+NixVectorRoutingCacheTestCase::RouteAll (uint32_t cacheSize, uint32_t treeCacheSize,
+                                         bool destinationFirst, bool flushEach)
+{
+  Config::SetGlobal ("NixVectorTreeCacheSize", UintegerValue (treeCacheSize));
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      m_nodes.Get (i)->GetObject<Ipv4NixVectorRouting> ()->SetAttribute ("CacheSize", UintegerValue (cacheSize));
+    }
+
+  Routes routes;
+  uint32_t nOuter = destinationFirst ? m_addresses.size () : m_nodes.GetN ();
+  uint32_t nInner = destinationFirst ? m_nodes.GetN () : m_addresses.size ();
+  for (uint32_t i = 0; i < nOuter; i++)
+    {
+      for (uint32_t j = 0; j < nInner; j++)
+        {
+          uint32_t source = destinationFirst ? j : i;
+          uint32_t address = destinationFirst ? i : j;
+          if (m_addressNodes[address] != source)
+            {
+              std::pair<uint32_t, Ipv4Address> key (source, m_addresses[address]);
+              routes[key] = Route (source, m_addresses[address], flushEach);
+            }
+        }
+    }
+  return routes;
+}
+
+void
+NixVectorRoutingCacheTestCase::DoRun (void)
+{
+  // A 5x5 grid of nodes, with a broadcast channel between four nodes
+  const uint32_t size = 5;
+  m_nodes.Create (size * size);
+  InternetStackHelper internet;
+  Ipv4NixVectorHelper nix;
+  internet.SetRoutingHelper (nix);
+  internet.Install (m_nodes);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.255.0");
+  NetDeviceContainer downLink;
+  for (uint32_t row = 0; row < size; row++)
+    {
+      for (uint32_t col = 0; col < size; col++)
+        {
+          uint32_t node = row * size + col;
+          if (col + 1 < size)
+            {
+              NetDeviceContainer devices = Link (m_nodes.Get (node), m_nodes.Get (node + 1));
+              if (node == 0)
+                {
+                  downLink = devices;
+                }
+              ipv4.Assign (devices);
+              ipv4.NewNetwork ();
+            }
+          if (row + 1 < size)
+            {
+              ipv4.Assign (Link (m_nodes.Get (node), m_nodes.Get (node + size)));
+              ipv4.NewNetwork ();
+            }
+        }
+    }
+  Ptr<SimpleChannel> lan = CreateObject<SimpleChannel> ();
+  uint32_t lanNodes[] = { 2, 10, 14, 22 };
+  NetDeviceContainer lanDevices;
+  for (uint32_t i = 0; i < sizeof (lanNodes) / sizeof (lanNodes[0]); i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetChannel (lan);
+      m_nodes.Get (lanNodes[i])->AddDevice (device);
+      lanDevices.Add (device);
+    }
+  ipv4.Assign (lanDevices);
+
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      Ptr<Ipv4> ip = m_nodes.Get (i)->GetObject<Ipv4> ();
+      for (uint32_t j = 1; j < ip->GetNInterfaces (); j++)
+        {
+          m_addresses.push_back (ip->GetAddress (j, 0).GetLocal ());
+          m_addressNodes.push_back (i);
+        }
+    }
+
+  Routes expected = RouteAll (0, 0, false, true);
+  NS_TEST_ASSERT_MSG_EQ (expected.size (), m_addresses.size () * (m_nodes.GetN () - 1), "Missing routes");
+  for (Routes::const_iterator i = expected.begin (); i != expected.end (); i++)
+    {
+      NS_TEST_ASSERT_MSG_NE (i->second, "no route", "No route from " << i->first.first << " to " << i->first.second);
+    }
+
+  // Large caches, then caches small enough to evict most of the
+  // nix-vectors and trees, twice so that evicted entries are rebuilt
+  NS_TEST_EXPECT_MSG_EQ ((RouteAll (0, 0, false, false) == expected), true,
+                         "Different routes with unbounded caches");
+  NS_TEST_EXPECT_MSG_EQ ((RouteAll (0, 0, true, false) == expected), true,
+                         "Different routes with unbounded caches, by destination");
+  for (uint32_t round = 0; round < 2; round++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((RouteAll (3, 2, true, false) == expected), true,
+                             "Different routes with small caches, by destination");
+      NS_TEST_EXPECT_MSG_EQ ((RouteAll (3, 2, false, false) == expected), true,
+                             "Different routes with small caches, by source");
+    }
+
+  // Take a link down without telling Ipv4: the warm caches and trees
+  // must not keep routing over it
+  RouteAll (0, 0, false, false);
+  DynamicCast<NixTestNetDevice> (downLink.Get (0))->SetLinkUp (false);
+  DynamicCast<NixTestNetDevice> (downLink.Get (1))->SetLinkUp (false);
+  Routes down = RouteAll (0, 0, false, true);
+  NS_TEST_EXPECT_MSG_EQ ((down == expected), false, "Taking the link down changed no route");
+  Ptr<Ipv4> ip1 = m_nodes.Get (1)->GetObject<Ipv4> ();
+  std::pair<uint32_t, Ipv4Address> acrossLink (0, ip1->GetAddress (ip1->GetInterfaceForDevice (downLink.Get (1)), 0).GetLocal ());
+  NS_TEST_EXPECT_MSG_NE (down.find (acrossLink)->second, expected.find (acrossLink)->second,
+                         "The route across the link did not change");
+  DynamicCast<NixTestNetDevice> (downLink.Get (0))->SetLinkUp (true);
+  DynamicCast<NixTestNetDevice> (downLink.Get (1))->SetLinkUp (true);
+  RouteAll (0, 0, false, false);
+  DynamicCast<NixTestNetDevice> (downLink.Get (0))->SetLinkUp (false);
+  DynamicCast<NixTestNetDevice> (downLink.Get (1))->SetLinkUp (false);
+  NS_TEST_EXPECT_MSG_EQ ((RouteAll (0, 0, false, false) == down), true,
+                         "Stale routes after the link went down, with unbounded caches");
+  NS_TEST_EXPECT_MSG_EQ ((RouteAll (3, 2, true, false) == down), true,
+                         "Stale routes after the link went down, with small caches");
+
+  Config::SetGlobal ("NixVectorTreeCacheSize", UintegerValue (256));
+  m_nodes = NodeContainer ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief TestSuite for the nix-vector routing.
+ */
+class NixVectorRoutingTestSuite : public TestSuite
+{
+public:
+  NixVectorRoutingTestSuite ();
+};
+
+NixVectorRoutingTestSuite::NixVectorRoutingTestSuite ()
+  : TestSuite ("nix-vector-routing", UNIT)
+{
+  AddTestCase (new NixVectorRoutingCacheTestCase (), TestCase::QUICK);
+}
+
+static NixVectorRoutingTestSuite g_nixVectorRoutingTestSuite; //!< The testsuite
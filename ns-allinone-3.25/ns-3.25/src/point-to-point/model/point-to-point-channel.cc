@@ -21,7 +21,11 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/node.h"
 #include "ns3/log.h"
+#include "ns3/system-mutex.h"
+#include <vector>
 
 namespace ns3 {
 
@@ -29,6 +33,21 @@ NS_LOG_COMPONENT_DEFINE ("PointToPointChannel");
 
 NS_OBJECT_ENSURE_REGISTERED (PointToPointChannel);
 
+/**
+ * Get the lock which serializes the TxRxPointToPoint invocations of
+ * the channels which deep copy packets, whose two devices are run by
+ * different threads.
+ *
+ * \returns The lock.
+ */
+static SystemMutex &
+GetDeepCopyTraceMutex (void)
+{
+  // Never destroyed: channels may outlive the other statics.
+  static SystemMutex *mutex = new SystemMutex ();
+  return *mutex;
+}
+
 TypeId 
 PointToPointChannel::GetTypeId (void)
 {
@@ -40,10 +59,21 @@ PointToPointChannel::GetTypeId (void)
                    TimeValue (Seconds (0)),
                    MakeTimeAccessor (&PointToPointChannel::m_delay),
                    MakeTimeChecker ())
+    .AddAttribute ("DeepCopy",
+                   "Whether the receivers get deep copies of the packets, "
+                   "which share no data with the packets of the senders. "
+                   "MultithreadedSimulatorImpl sets it on the channels "
+                   "whose devices are run by different threads.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PointToPointChannel::SetDeepCopy,
+                                        &PointToPointChannel::GetDeepCopy),
+                   MakeBooleanChecker ())
     .AddTraceSource ("TxRxPointToPoint",
                      "Trace source indicating transmission of packet "
                      "from the PointToPointChannel, used by the Animation "
-                     "interface.",
+                     "interface. In DeepCopy mode, the receiving device is "
+                     "null since another thread may run it, and the sinks "
+                     "are called by the threads of both devices, one at a time.",
                      MakeTraceSourceAccessor (&PointToPointChannel::m_txrxPointToPoint),
                      "ns3::PointToPointChannel::TxRxAnimationCallback")
   ;
@@ -57,7 +87,8 @@ PointToPointChannel::PointToPointChannel()
   :
     Channel (),
     m_delay (Seconds (0.)),
-    m_nDevices (0)
+    m_nDevices (0),
+    m_deepCopy (false)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -80,6 +111,37 @@ PointToPointChannel::Attach (Ptr<PointToPointNetDevice> device)
       m_link[1].m_dst = m_link[0].m_src;
       m_link[0].m_state = IDLE;
       m_link[1].m_state = IDLE;
+      CacheDestinations ();
+    }
+}
+
+void
+PointToPointChannel::SetDeepCopy (bool deepCopy)
+{
+  NS_LOG_FUNCTION (this << deepCopy);
+  m_deepCopy = deepCopy;
+  CacheDestinations ();
+}
+
+bool
+PointToPointChannel::GetDeepCopy (void) const
+{
+  return m_deepCopy;
+}
+
+void
+PointToPointChannel::CacheDestinations (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (!m_deepCopy || m_nDevices != N_DEVICES)
+    {
+      return;
+    }
+  for (int i = 0; i < N_DEVICES; i++)
+    {
+      NS_ASSERT_MSG (m_link[i].m_dst->GetNode () != 0,
+                     "Devices must be added to a node before attaching a channel which deep copies packets");
+      m_link[i].m_dstNode = m_link[i].m_dst->GetNode ()->GetId ();
     }
 }
 
@@ -97,6 +159,26 @@ PointToPointChannel::TransmitStart (
 
   uint32_t wire = src == m_link[0].m_src ? 0 : 1;
 
+  if (m_deepCopy)
+    {
+      // The receiver may run in another thread: it gets a packet which
+      // shares no data with p, and the reference counts of its device
+      // and node are left alone, by the trace sinks too.
+      uint32_t size = p->GetSerializedSize ();
+      std::vector<uint8_t> buffer (size);
+      p->Serialize (&buffer[0], size);
+      Ptr<Packet> copy = Create<Packet> (&buffer[0], size, true);
+      Simulator::ScheduleWithContext (m_link[wire].m_dstNode,
+                                      txTime + m_delay, &PointToPointNetDevice::Receive,
+                                      PeekPointer (m_link[wire].m_dst), copy);
+      if (!m_txrxPointToPoint.IsEmpty ())
+        {
+          CriticalSection cs (GetDeepCopyTraceMutex ());
+          m_txrxPointToPoint (p, src, 0, txTime, txTime + m_delay);
+        }
+      return true;
+    }
+
   Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
                                   txTime + m_delay, &PointToPointNetDevice::Receive,
                                   m_link[wire].m_dst, p);
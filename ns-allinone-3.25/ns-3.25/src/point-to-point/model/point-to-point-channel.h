@@ -134,7 +134,7 @@ protected:
    *
    * \param [in] packet The packet being transmitted.
    * \param [in] txDevice the TransmitTing NetDevice.
-   * \param [in] rxDevice the Receiving NetDevice.
+   * \param [in] rxDevice the Receiving NetDevice, null in DeepCopy mode.
    * \param [in] duration The amount of time to transmit the packet.
    * \param [in] lastBitTime Last bit receive time (relative to now)
    * \deprecated The non-const \c Ptr<NetDevice> argument is deprecated
@@ -149,15 +149,36 @@ private:
   /** Each point to point link has exactly two net devices. */
   static const int N_DEVICES = 2;
 
+  /**
+   * \brief Set whether the receivers get deep copies of the packets
+   * \param deepCopy true to deep copy the packets
+   */
+  void SetDeepCopy (bool deepCopy);
+
+  /**
+   * \brief Get whether the receivers get deep copies of the packets
+   * \returns true if the packets are deep copied
+   */
+  bool GetDeepCopy (void) const;
+
+  /**
+   * \brief Record the node ids of the destinations, once both devices
+   * are attached, so that deep copies are sent without touching the
+   * destination node.
+   */
+  void CacheDestinations (void);
+
   Time          m_delay;    //!< Propagation delay
   int32_t       m_nDevices; //!< Devices of this channel
+  bool          m_deepCopy; //!< Hand deep copies of the packets to the receivers
 
   /**
    * The trace source for the packet transmission animation events that the 
    * device can fire.
    * Arguments to the callback are the packet, transmitting
    * net device, receiving net device, transmission time and 
-   * packet receipt time.
+   * packet receipt time.  In DeepCopy mode, the receiving net
+   * device is null and the invocations are serialized.
    *
    * \see class CallBackTraceSource
    * \deprecated The non-const \c Ptr<NetDevice> argument is deprecated
@@ -194,11 +215,12 @@ public:
     /** \brief Create the link, it will be in INITIALIZING state
      *
      */
-    Link() : m_state (INITIALIZING), m_src (0), m_dst (0) {}
+    Link() : m_state (INITIALIZING), m_src (0), m_dst (0), m_dstNode (0) {}
 
-    WireState                  m_state; //!< State of the link
-    Ptr<PointToPointNetDevice> m_src;   //!< First NetDevice
-    Ptr<PointToPointNetDevice> m_dst;   //!< Second NetDevice
+    WireState                  m_state;   //!< State of the link
+    Ptr<PointToPointNetDevice> m_src;     //!< First NetDevice
+    Ptr<PointToPointNetDevice> m_dst;     //!< Second NetDevice
+    uint32_t                   m_dstNode; //!< Node id of m_dst, for deep copies
   };
 
   Link    m_link[N_DEVICES]; //!< Link model
@@ -257,7 +257,7 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   NS_ASSERT_MSG (m_txMachineState == READY, "Must be READY to transmit");
   m_txMachineState = BUSY;
   m_currentPkt = p;
-  m_phyTxBeginTrace (m_currentPkt);
+  NS_OPTIONAL_TRACE (m_phyTxBeginTrace (m_currentPkt));
 
   Time txTime = m_bps.CalculateBytesTxTime (p->GetSize ());
   Time txCompleteTime = txTime + m_tInterframeGap;
@@ -268,7 +268,7 @@ PointToPointNetDevice::TransmitStart (Ptr<Packet> p)
   bool result = m_channel->TransmitStart (p, this, txTime);
   if (result == false)
     {
-      m_phyTxDropTrace (p);
+      NS_OPTIONAL_TRACE (m_phyTxDropTrace (p));
     }
   return result;
 }
@@ -289,7 +289,7 @@ PointToPointNetDevice::TransmitComplete (void)
 
   NS_ASSERT_MSG (m_currentPkt != 0, "PointToPointNetDevice::TransmitComplete(): m_currentPkt zero");
 
-  m_phyTxEndTrace (m_currentPkt);
+  NS_OPTIONAL_TRACE (m_phyTxEndTrace (m_currentPkt));
   m_currentPkt = 0;
 
   Ptr<NetDeviceQueue> txq;
@@ -320,8 +320,8 @@ PointToPointNetDevice::TransmitComplete (void)
       txq->Start ();
     }
   Ptr<Packet> p = item->GetPacket ();
-  m_snifferTrace (p);
-  m_promiscSnifferTrace (p);
+  NS_OPTIONAL_TRACE (m_snifferTrace (p));
+  NS_OPTIONAL_TRACE (m_promiscSnifferTrace (p));
   TransmitStart (p);
 }
 
@@ -369,7 +369,7 @@ PointToPointNetDevice::Receive (Ptr<Packet> packet)
       // If we have an error model and it indicates that it is time to lose a
       // corrupted packet, don't forward this packet up, let it go.
       //
-      m_phyRxDropTrace (packet);
+      NS_OPTIONAL_TRACE (m_phyRxDropTrace (packet));
     }
   else 
     {
@@ -378,9 +378,9 @@ PointToPointNetDevice::Receive (Ptr<Packet> packet)
       // device because it is so simple, but this is not usually the case in
       // more complicated devices.
       //
-      m_snifferTrace (packet);
-      m_promiscSnifferTrace (packet);
-      m_phyRxEndTrace (packet);
+      NS_OPTIONAL_TRACE (m_snifferTrace (packet));
+      NS_OPTIONAL_TRACE (m_promiscSnifferTrace (packet));
+      NS_OPTIONAL_TRACE (m_phyRxEndTrace (packet));
 
       //
       // Trace sinks will expect complete packets, not packets without some of the
@@ -398,11 +398,11 @@ PointToPointNetDevice::Receive (Ptr<Packet> packet)
 
       if (!m_promiscCallback.IsNull ())
         {
-          m_macPromiscRxTrace (originalPacket);
+          NS_OPTIONAL_TRACE (m_macPromiscRxTrace (originalPacket));
           m_promiscCallback (this, packet, protocol, GetRemote (), GetAddress (), NetDevice::PACKET_HOST);
         }
 
-      m_macRxTrace (originalPacket);
+      NS_OPTIONAL_TRACE (m_macRxTrace (originalPacket));
       m_rxCallback (this, packet, protocol, GetRemote ());
     }
 }
@@ -556,7 +556,7 @@ PointToPointNetDevice::Send (
   //
   if (IsLinkUp () == false)
     {
-      m_macTxDropTrace (packet);
+      NS_OPTIONAL_TRACE (m_macTxDropTrace (packet));
       return false;
     }
 
@@ -566,7 +566,7 @@ PointToPointNetDevice::Send (
   //
   AddHeader (packet, protocolNumber);
 
-  m_macTxTrace (packet);
+  NS_OPTIONAL_TRACE (m_macTxTrace (packet));
 
   //
   // We should enqueue and dequeue the packet to hit the tracing hooks.
@@ -579,8 +579,8 @@ PointToPointNetDevice::Send (
       if (m_txMachineState == READY)
         {
           packet = m_queue->Dequeue ()->GetPacket ();
-          m_snifferTrace (packet);
-          m_promiscSnifferTrace (packet);
+          NS_OPTIONAL_TRACE (m_snifferTrace (packet));
+          NS_OPTIONAL_TRACE (m_promiscSnifferTrace (packet));
           return TransmitStart (packet);
         }
       return true;
@@ -588,7 +588,7 @@ PointToPointNetDevice::Send (
 
   // Enqueue may fail (overflow). Stop the tx queue, so that the upper layers
   // do not send packets until there is room in the queue again.
-  m_macTxDropTrace (packet);
+  NS_OPTIONAL_TRACE (m_macTxDropTrace (packet));
   if (txq)
   {
     txq->Stop ();
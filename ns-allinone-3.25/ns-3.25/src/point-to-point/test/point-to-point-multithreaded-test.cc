@@ -0,0 +1,311 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/object-factory.h"
+#include "ns3/packet.h"
+#include "ns3/channel-list.h"
+#include "ns3/channel.h"
+#include "ns3/config.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \brief Check that MultithreadedSimulatorImpl delivers the same packets
+ * as DefaultSimulatorImpl over point-to-point links between partitions.
+ *
+ * The nodes form a ring of point-to-point links. Each node sends a burst
+ * of packets to both neighbors, and forwards every packet it receives
+ * to its other neighbor, shortened, until the packets are too small.
+ * A sink is connected to the TxRxPointToPoint trace source of every
+ * channel.
+ */
+class PointToPointMultithreadedTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   *
+   * \param threads The number of threads of the simulator.
+   */
+  PointToPointMultithreadedTest (uint32_t threads);
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /** The reception times and packet sizes seen by each node. */
+  typedef std::vector<std::vector<std::pair<int64_t, uint32_t> > > Traces;
+
+  /** The TxRxPointToPoint invocations of a channel. */
+  struct TxRx
+  {
+    TxRx () : count (0), nullRx (0), deepCopy (false) {}
+    uint32_t count;  //!< The number of invocations
+    uint32_t nullRx; //!< The number of invocations without receiving device
+    bool deepCopy;   //!< Whether the channel deep copied the packets
+  };
+
+  /**
+   * \brief Run the ring with the current simulator implementation
+   *
+   * \returns The packets received by each node.
+   */
+  Traces RunRing (void);
+
+  /**
+   * \brief Send the initial burst of a node
+   *
+   * \param node The node.
+   */
+  void SendBurst (Ptr<Node> node);
+
+  /**
+   * \brief Receive a packet, and forward it to the other neighbor
+   *
+   * \param device The receiving device.
+   * \param packet The packet.
+   * \param protocol The protocol number.
+   * \param from The sender address.
+   * \param to The destination address.
+   * \param packetType The packet type.
+   */
+  void Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                uint16_t protocol, const Address &from,
+                const Address &to, NetDevice::PacketType packetType);
+
+  /**
+   * \brief Count a transmission on a channel
+   *
+   * \param context The trace context, which holds the channel id.
+   * \param packet The packet.
+   * \param tx The transmitting device.
+   * \param rx The receiving device.
+   * \param txTime The transmission time.
+   * \param rxTime The reception time.
+   */
+  void TxRxTrace (std::string context, Ptr<const Packet> packet,
+                  Ptr<NetDevice> tx, Ptr<NetDevice> rx,
+                  Time txTime, Time rxTime);
+
+  uint32_t m_threads;       //!< The number of threads
+  Traces m_traces;          //!< The traces of the current run
+  std::vector<TxRx> m_txrx; //!< The channel traces of the current run
+};
+
+/** The number of nodes in the ring. */
+static const uint32_t P2P_RING_SIZE = 8;
+
+/**
+ * \brief Build the name of a PointToPointMultithreadedTest
+ *
+ * \param threads The number of threads.
+ * \returns The test name.
+ */
+static std::string
+MultithreadedTestName (uint32_t threads)
+{
+  std::ostringstream oss;
+  oss << "PointToPoint packets between " << threads << " threads";
+  return oss.str ();
+}
+
+PointToPointMultithreadedTest::PointToPointMultithreadedTest (uint32_t threads)
+  : TestCase (MultithreadedTestName (threads)),
+    m_threads (threads)
+{
+}
+
+void
+PointToPointMultithreadedTest::SendBurst (Ptr<Node> node)
+{
+  for (uint32_t i = 0; i < 10; i++)
+    {
+      for (uint32_t j = 0; j < node->GetNDevices (); j++)
+        {
+          Ptr<NetDevice> device = node->GetDevice (j);
+          Ptr<Packet> p = Create<Packet> (1000 + 10 * node->GetId () + i);
+          device->Send (p, device->GetBroadcast (), 0x800);
+        }
+    }
+}
+
+void
+PointToPointMultithreadedTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet,
+                                        uint16_t protocol, const Address &from,
+                                        const Address &to, NetDevice::PacketType packetType)
+{
+  Ptr<Node> node = device->GetNode ();
+  m_traces[node->GetId ()].push_back (std::make_pair (Simulator::Now ().GetTimeStep (),
+                                                      packet->GetSize ()));
+  if (packet->GetSize () > 200)
+    {
+      // The forwarded packet shares its buffer with the received one.
+      Ptr<Packet> copy = packet->Copy ();
+      copy->RemoveAtStart (150);
+      Ptr<NetDevice> other = node->GetDevice (device->GetIfIndex () == 0 ? 1 : 0);
+      other->Send (copy, other->GetBroadcast (), 0x800);
+    }
+}
+
+void
+PointToPointMultithreadedTest::TxRxTrace (std::string context, Ptr<const Packet> packet,
+                                          Ptr<NetDevice> tx, Ptr<NetDevice> rx,
+                                          Time txTime, Time rxTime)
+{
+  // The channels joining partitions serialize their invocations, and
+  // the others are only fired by one thread, so each channel has its
+  // own counters.
+  std::istringstream iss (context.substr (std::string ("/ChannelList/").size ()));
+  uint32_t channel;
+  iss >> channel;
+  m_txrx[channel].count++;
+  if (rx == 0)
+    {
+      m_txrx[channel].nullRx++;
+    }
+}
+
+PointToPointMultithreadedTest::Traces
+PointToPointMultithreadedTest::RunRing (void)
+{
+  NodeContainer nodes;
+  nodes.Create (P2P_RING_SIZE);
+  m_traces.clear ();
+  m_traces.resize (P2P_RING_SIZE);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  for (uint32_t i = 0; i < P2P_RING_SIZE; i++)
+    {
+      // Distinct delays avoid simultaneous receptions, whose order is
+      // only defined within a partition.
+      p2p.SetChannelAttribute ("Delay", TimeValue (MilliSeconds (1) + MicroSeconds (37 * i)));
+      p2p.Install (nodes.Get (i), nodes.Get ((i + 1) % P2P_RING_SIZE));
+    }
+  m_txrx.clear ();
+  m_txrx.resize (ChannelList::GetNChannels ());
+  Config::Connect ("/ChannelList/*/$ns3::PointToPointChannel/TxRxPointToPoint",
+                   MakeCallback (&PointToPointMultithreadedTest::TxRxTrace, this));
+  for (uint32_t i = 0; i < P2P_RING_SIZE; i++)
+    {
+      Ptr<Node> node = nodes.Get (i);
+      node->RegisterProtocolHandler (MakeCallback (&PointToPointMultithreadedTest::Receive, this),
+                                     0x800, 0);
+      Simulator::ScheduleWithContext (i, MicroSeconds (11 * i),
+                                      &PointToPointMultithreadedTest::SendBurst, this, node);
+    }
+  Simulator::Run ();
+  for (uint32_t i = 0; i < m_txrx.size (); i++)
+    {
+      BooleanValue deepCopy;
+      ChannelList::GetChannel (i)->GetAttribute ("DeepCopy", deepCopy);
+      m_txrx[i].deepCopy = deepCopy.Get ();
+    }
+  Simulator::Destroy ();
+
+  for (uint32_t i = 0; i < P2P_RING_SIZE; i++)
+    {
+      std::sort (m_traces[i].begin (), m_traces[i].end ());
+    }
+  return m_traces;
+}
+
+void
+PointToPointMultithreadedTest::DoRun (void)
+{
+  Traces expected = RunRing ();
+  std::vector<TxRx> expectedTxRx = m_txrx;
+
+  ObjectFactory factory;
+  factory.SetTypeId ("ns3::MultithreadedSimulatorImpl");
+  factory.Set ("ThreadCount", UintegerValue (m_threads));
+  Ptr<MultithreadedSimulatorImpl> impl = factory.Create<MultithreadedSimulatorImpl> ();
+  Simulator::SetImplementation (impl);
+  Traces traces = RunRing ();
+
+  if (m_threads > 1)
+    {
+      // The lookahead is the delay of one of the links between partitions.
+      NS_TEST_EXPECT_MSG_GT_OR_EQ (impl->GetLookAhead (), MilliSeconds (1), "Unexpected lookahead");
+      NS_TEST_EXPECT_MSG_LT (impl->GetLookAhead (), MilliSeconds (1) + MicroSeconds (37 * P2P_RING_SIZE),
+                             "Unexpected lookahead");
+    }
+  for (uint32_t i = 0; i < P2P_RING_SIZE; i++)
+    {
+      NS_TEST_EXPECT_MSG_GT (expected[i].size (), 20U, "Too few packets at node " << i);
+      NS_TEST_EXPECT_MSG_EQ (traces[i].size (), expected[i].size (),
+                             "Wrong number of packets at node " << i);
+      NS_TEST_EXPECT_MSG_EQ ((traces[i] == expected[i]), true,
+                             "Wrong packets at node " << i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_txrx.size (), expectedTxRx.size (), "Wrong number of channels");
+  for (uint32_t i = 0; i < m_txrx.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (expectedTxRx[i].deepCopy, false, "Deep copies without partitions");
+      NS_TEST_EXPECT_MSG_EQ (expectedTxRx[i].nullRx, 0U, "Missing receiving device");
+      NS_TEST_EXPECT_MSG_EQ (m_txrx[i].count, expectedTxRx[i].count,
+                             "Wrong number of transmissions on channel " << i);
+      NS_TEST_EXPECT_MSG_EQ (m_txrx[i].nullRx, m_txrx[i].deepCopy ? m_txrx[i].count : 0U,
+                             "Wrong receiving devices on channel " << i);
+      // Channel i joins node i to the next one.
+      bool crossing = i * m_threads / P2P_RING_SIZE
+        != (i + 1) % P2P_RING_SIZE * m_threads / P2P_RING_SIZE;
+      NS_TEST_EXPECT_MSG_EQ (m_txrx[i].deepCopy, crossing,
+                             "Unexpected DeepCopy mode on channel " << i);
+    }
+}
+
+/**
+ * \brief TestSuite for PointToPoint links run by MultithreadedSimulatorImpl
+ */
+class PointToPointMultithreadedTestSuite : public TestSuite
+{
+public:
+  /**
+   * \brief Constructor
+   */
+  PointToPointMultithreadedTestSuite ();
+};
+
+PointToPointMultithreadedTestSuite::PointToPointMultithreadedTestSuite ()
+  : TestSuite ("devices-point-to-point-multithreaded", UNIT)
+{
+  uint32_t threadCounts[] = { 1, 2, 3, 4 };
+  for (uint32_t i = 0; i < sizeof (threadCounts) / sizeof (threadCounts[0]); i++)
+    {
+      AddTestCase (new PointToPointMultithreadedTest (threadCounts[i]), TestCase::QUICK);
+    }
+}
+
+static PointToPointMultithreadedTestSuite g_pointToPointMultithreadedTestSuite; //!< The testsuite
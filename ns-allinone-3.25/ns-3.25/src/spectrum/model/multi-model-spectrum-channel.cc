@@ -34,6 +34,7 @@
 #include <ns3/propagation-delay-model.h>
 #include <ns3/antenna-model.h>
 #include <ns3/angles.h>
+#include <cmath>
 #include <iostream>
 #include <utility>
 #include "multi-model-spectrum-channel.h"
@@ -82,6 +83,8 @@ RxSpectrumModelInfo::RxSpectrumModelInfo (Ptr<const SpectrumModel> rxSpectrumMod
 
 
 MultiModelSpectrumChannel::MultiModelSpectrumChannel ()
+  : m_maxRange (0.0),
+    m_indexCellSize (0.0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -95,6 +98,17 @@ MultiModelSpectrumChannel::DoDispose ()
   m_spectrumPropagationLoss = 0;
   m_txSpectrumModelInfoMap.clear ();
   m_rxSpectrumModelInfoMap.clear ();
+  for (std::map<Ptr<MobilityModel>, std::set<Ptr<SpectrumPhy> > >::iterator it = m_rxIndexMobility.begin ();
+       it != m_rxIndexMobility.end ();
+       ++it)
+    {
+      it->first->TraceDisconnectWithoutContext ("CourseChange",
+                                                MakeCallback (&MultiModelSpectrumChannel::NotifyCourseChange, this));
+    }
+  m_rxIndexMobility.clear ();
+  m_rxIndex.clear ();
+  m_rxIndexCells.clear ();
+  m_rxIndexUnplaced.clear ();
   SpectrumChannel::DoDispose ();
 }
 
@@ -119,6 +133,17 @@ MultiModelSpectrumChannel::GetTypeId (void)
                    DoubleValue (1.0e9),
                    MakeDoubleAccessor (&MultiModelSpectrumChannel::m_maxLossDb),
                    MakeDoubleChecker<double> ())
+    .AddAttribute ("MaxRange",
+                   "If positive, the maximum distance in meters at which "
+                   "transmissions are passed to the receiving PHYs, which "
+                   "are then looked up in a grid indexed by their position "
+                   "instead of being all evaluated. Receivers farther away, "
+                   "and their PathLoss trace, are skipped regardless of the "
+                   "loss models. The default value of zero passes "
+                   "transmissions to every receiver.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&MultiModelSpectrumChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0.0))
     .AddTraceSource ("PathLoss",
                      "This trace is fired whenever a new path loss value "
                      "is calculated. The first and second parameters "
@@ -204,6 +229,165 @@ MultiModelSpectrumChannel::AddRx (Ptr<SpectrumPhy> phy)
       NS_ASSERT (ret2.second);
     }
 
+  if (m_indexCellSize > 0)
+    {
+      IndexRx (phy);
+    }
+}
+
+
+MultiModelSpectrumChannel::IndexCell_t
+MultiModelSpectrumChannel::GetIndexCell (const Vector &position) const
+{
+  return std::make_pair (static_cast<int64_t> (std::floor (position.x / m_indexCellSize)),
+                         static_cast<int64_t> (std::floor (position.y / m_indexCellSize)));
+}
+
+void
+MultiModelSpectrumChannel::BuildIndex (void)
+{
+  NS_LOG_FUNCTION (this << m_maxRange);
+  m_indexCellSize = m_maxRange;
+  m_rxIndexCells.clear ();
+  m_rxIndexUnplaced.clear ();
+  for (std::map<Ptr<SpectrumPhy>, RxIndexEntry>::iterator it = m_rxIndex.begin ();
+       it != m_rxIndex.end ();
+       ++it)
+    {
+      it->second.inCell = false;
+      PlaceRx (it->first, it->second);
+    }
+  for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
+       rxInfoIterator != m_rxSpectrumModelInfoMap.end ();
+       ++rxInfoIterator)
+    {
+      for (std::set<Ptr<SpectrumPhy> >::const_iterator phyIt = rxInfoIterator->second.m_rxPhySet.begin ();
+           phyIt != rxInfoIterator->second.m_rxPhySet.end ();
+           ++phyIt)
+        {
+          if (m_rxIndex.find (*phyIt) == m_rxIndex.end ())
+            {
+              IndexRx (*phyIt);
+            }
+        }
+    }
+}
+
+void
+MultiModelSpectrumChannel::IndexRx (Ptr<SpectrumPhy> phy)
+{
+  NS_LOG_FUNCTION (this << phy);
+  Ptr<MobilityModel> mobility = phy->GetMobility ();
+  std::map<Ptr<SpectrumPhy>, RxIndexEntry>::iterator it = m_rxIndex.find (phy);
+  if (it == m_rxIndex.end ())
+    {
+      RxIndexEntry entry;
+      entry.inCell = false;
+      it = m_rxIndex.insert (std::make_pair (phy, entry)).first;
+    }
+  else if (it->second.mobility != mobility && it->second.mobility != 0)
+    {
+      m_rxIndexMobility[it->second.mobility].erase (phy);
+    }
+  it->second.mobility = mobility;
+  if (mobility != 0)
+    {
+      std::map<Ptr<MobilityModel>, std::set<Ptr<SpectrumPhy> > >::iterator mobilityIt = m_rxIndexMobility.find (mobility);
+      if (mobilityIt == m_rxIndexMobility.end ())
+        {
+          mobilityIt = m_rxIndexMobility.insert (std::make_pair (mobility, std::set<Ptr<SpectrumPhy> > ())).first;
+          mobility->TraceConnectWithoutContext ("CourseChange",
+                                                MakeCallback (&MultiModelSpectrumChannel::NotifyCourseChange, this));
+        }
+      mobilityIt->second.insert (phy);
+    }
+  PlaceRx (phy, it->second);
+}
+
+void
+MultiModelSpectrumChannel::PlaceRx (Ptr<SpectrumPhy> phy, RxIndexEntry &entry)
+{
+  if (entry.inCell)
+    {
+      m_rxIndexCells[entry.cell].erase (phy);
+    }
+  else
+    {
+      m_rxIndexUnplaced.erase (phy);
+    }
+  Ptr<MobilityModel> mobility = entry.mobility;
+  Vector velocity;
+  if (mobility != 0)
+    {
+      velocity = mobility->GetVelocity ();
+    }
+  if (mobility != 0 && velocity.x == 0 && velocity.y == 0 && velocity.z == 0)
+    {
+      entry.inCell = true;
+      entry.cell = GetIndexCell (mobility->GetPosition ());
+      m_rxIndexCells[entry.cell].insert (phy);
+    }
+  else
+    {
+      entry.inCell = false;
+      m_rxIndexUnplaced.insert (phy);
+    }
+}
+
+void
+MultiModelSpectrumChannel::NotifyCourseChange (Ptr<const MobilityModel> mobility)
+{
+  NS_LOG_FUNCTION (this << mobility);
+  std::map<Ptr<MobilityModel>, std::set<Ptr<SpectrumPhy> > >::iterator mobilityIt =
+    m_rxIndexMobility.find (ConstCast<MobilityModel> (mobility));
+  if (mobilityIt == m_rxIndexMobility.end () || m_indexCellSize <= 0)
+    {
+      return;
+    }
+  for (std::set<Ptr<SpectrumPhy> >::const_iterator phyIt = mobilityIt->second.begin ();
+       phyIt != mobilityIt->second.end ();
+       ++phyIt)
+    {
+      PlaceRx (*phyIt, m_rxIndex[*phyIt]);
+    }
+}
+
+void
+MultiModelSpectrumChannel::FindRxInRange (Ptr<MobilityModel> txMobility, std::set<Ptr<SpectrumPhy> > &inRange) const
+{
+  IndexCell_t txCell = GetIndexCell (txMobility->GetPosition ());
+  for (int64_t dx = -1; dx <= 1; dx++)
+    {
+      for (int64_t dy = -1; dy <= 1; dy++)
+        {
+          std::map<IndexCell_t, std::set<Ptr<SpectrumPhy> > >::const_iterator cellIt =
+            m_rxIndexCells.find (std::make_pair (txCell.first + dx, txCell.second + dy));
+          if (cellIt == m_rxIndexCells.end ())
+            {
+              continue;
+            }
+          for (std::set<Ptr<SpectrumPhy> >::const_iterator phyIt = cellIt->second.begin ();
+               phyIt != cellIt->second.end ();
+               ++phyIt)
+            {
+              if (m_rxIndex.find (*phyIt)->second.mobility->GetDistanceFrom (txMobility) <= m_maxRange)
+                {
+                  inRange.insert (*phyIt);
+                }
+            }
+        }
+    }
+  for (std::set<Ptr<SpectrumPhy> >::const_iterator phyIt = m_rxIndexUnplaced.begin ();
+       phyIt != m_rxIndexUnplaced.end ();
+       ++phyIt)
+    {
+      // the mobility model may have been set after the receiver was indexed
+      Ptr<MobilityModel> receiverMobility = (*phyIt)->GetMobility ();
+      if (receiverMobility == 0 || receiverMobility->GetDistanceFrom (txMobility) <= m_maxRange)
+        {
+          inRange.insert (*phyIt);
+        }
+    }
 }
 
 
@@ -272,6 +456,18 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
   NS_LOG_LOGIC ("converter map size: " << txInfoIteratorerator->second.m_spectrumConverterMap.size ());
   NS_LOG_LOGIC ("converter map first element: " << txInfoIteratorerator->second.m_spectrumConverterMap.begin ()->first);
 
+  bool useIndex = (m_maxRange > 0 && txMobility != 0);
+  std::set<Ptr<SpectrumPhy> > inRange;
+  if (useIndex)
+    {
+      if (m_indexCellSize != m_maxRange)
+        {
+          BuildIndex ();
+        }
+      FindRxInRange (txMobility, inRange);
+      NS_LOG_LOGIC (inRange.size () << " receivers within " << m_maxRange << " m");
+    }
+
   for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin ();
        rxInfoIterator != m_rxSpectrumModelInfoMap.end ();
        ++rxInfoIterator)
@@ -279,6 +475,26 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
       SpectrumModelUid_t rxSpectrumModelUid = rxInfoIterator->second.m_rxSpectrumModel->GetUid ();
       NS_LOG_LOGIC (" rxSpectrumModelUids " << rxSpectrumModelUid);
 
+      const std::set<Ptr<SpectrumPhy> > *rxPhySet = &rxInfoIterator->second.m_rxPhySet;
+      std::set<Ptr<SpectrumPhy> > rxPhyInRange;
+      if (useIndex)
+        {
+          for (std::set<Ptr<SpectrumPhy> >::const_iterator phyIt = inRange.begin ();
+               phyIt != inRange.end ();
+               ++phyIt)
+            {
+              if (rxPhySet->find (*phyIt) != rxPhySet->end ())
+                {
+                  rxPhyInRange.insert (*phyIt);
+                }
+            }
+          rxPhySet = &rxPhyInRange;
+        }
+      if (rxPhySet->empty ())
+        {
+          continue;
+        }
+
       Ptr <SpectrumValue> convertedTxPowerSpectrum;
       if (txSpectrumModelUid == rxSpectrumModelUid)
         {
@@ -294,8 +510,8 @@ MultiModelSpectrumChannel::StartTx (Ptr<SpectrumSignalParameters> txParams)
         }
 
 
-      for (std::set<Ptr<SpectrumPhy> >::const_iterator rxPhyIterator = rxInfoIterator->second.m_rxPhySet.begin ();
-           rxPhyIterator != rxInfoIterator->second.m_rxPhySet.end ();
+      for (std::set<Ptr<SpectrumPhy> >::const_iterator rxPhyIterator = rxPhySet->begin ();
+           rxPhyIterator != rxPhySet->end ();
            ++rxPhyIterator)
         {
           NS_ASSERT_MSG ((*rxPhyIterator)->GetRxSpectrumModel ()->GetUid () == rxSpectrumModelUid,
@@ -27,8 +27,10 @@
 #include <ns3/spectrum-channel.h>
 #include <ns3/spectrum-propagation-loss-model.h>
 #include <ns3/propagation-delay-model.h>
+#include <ns3/vector.h>
 #include <map>
 #include <set>
+#include <utility>
 
 namespace ns3 {
 
@@ -102,6 +104,17 @@ typedef std::map<SpectrumModelUid_t, RxSpectrumModelInfo> RxSpectrumModelInfoMap
  * for this to work is that, after the SpectrumPhy switched its
  * SpectrumModel,  MultiModelSpectrumChannel::AddRx () is
  * called again passing the pointer to that SpectrumPhy.
+ *
+ * When the MaxRange attribute is set, the receivers are kept in a
+ * uniform grid of square cells as wide as MaxRange, indexed by their
+ * position in the horizontal plane, and a transmission is only
+ * delivered to the receivers of the cell of the transmitter and of its
+ * eight neighbours which are within MaxRange of the transmitter. The
+ * cost of a transmission then depends on the density of the receivers
+ * rather than on their number. Receivers at rest are moved between
+ * cells when their MobilityModel notifies a course change; moving
+ * receivers, and receivers without a MobilityModel, are checked at
+ * every transmission.
  */
 class MultiModelSpectrumChannel : public SpectrumChannel
 {
@@ -158,6 +171,59 @@ private:
    */
   virtual void StartRx (Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
 
+  /** Coordinates of a cell of the receiver index. */
+  typedef std::pair<int64_t, int64_t> IndexCell_t;
+
+  /** The place of a receiver in the receiver index. */
+  struct RxIndexEntry
+  {
+    Ptr<MobilityModel> mobility;  //!< Mobility model of the receiver, if any.
+    bool inCell;                  //!< Whether the receiver is in a cell.
+    IndexCell_t cell;             //!< The cell of the receiver, if inCell.
+  };
+
+  /**
+   * Get the index cell holding a position.
+   *
+   * @param position The position.
+   * @return The cell coordinates.
+   */
+  IndexCell_t GetIndexCell (const Vector &position) const;
+
+  /** Build the receiver index for the current MaxRange. */
+  void BuildIndex (void);
+
+  /**
+   * Add a receiver to the index, or update its place.
+   *
+   * @param phy The receiver.
+   */
+  void IndexRx (Ptr<SpectrumPhy> phy);
+
+  /**
+   * Move the receiver to the cell of its current position, or to the
+   * receivers checked at every transmission if it is moving.
+   *
+   * @param phy The receiver.
+   * @param entry The index entry of the receiver.
+   */
+  void PlaceRx (Ptr<SpectrumPhy> phy, RxIndexEntry &entry);
+
+  /**
+   * Update the index when the course of a receiver changes.
+   *
+   * @param mobility The mobility model of the receiver.
+   */
+  void NotifyCourseChange (Ptr<const MobilityModel> mobility);
+
+  /**
+   * Find the receivers within MaxRange of a transmitter.
+   *
+   * @param txMobility The mobility model of the transmitter.
+   * @param [out] inRange The receivers in range.
+   */
+  void FindRxInRange (Ptr<MobilityModel> txMobility, std::set<Ptr<SpectrumPhy> > &inRange) const;
+
   /**
    * Propagation delay model to be used with this channel.
    */
@@ -201,6 +267,30 @@ private:
    */
   double m_maxLossDb;
 
+  /**
+   * Maximum distance [m] at which transmissions are delivered, or zero
+   * to deliver them to every receiver.
+   */
+  double m_maxRange;
+
+  /**
+   * Cell width of the receiver index [m], or zero if the index has not
+   * been built.
+   */
+  double m_indexCellSize;
+
+  /** The index entry of each receiver. */
+  std::map<Ptr<SpectrumPhy>, RxIndexEntry> m_rxIndex;
+
+  /** The receivers at rest in each cell of the index. */
+  std::map<IndexCell_t, std::set<Ptr<SpectrumPhy> > > m_rxIndexCells;
+
+  /** The receivers checked at every transmission. */
+  std::set<Ptr<SpectrumPhy> > m_rxIndexUnplaced;
+
+  /** The receivers of each mobility model whose course changes are tracked. */
+  std::map<Ptr<MobilityModel>, std::set<Ptr<SpectrumPhy> > > m_rxIndexMobility;
+
   /**
    * \deprecated The non-const \c Ptr<SpectrumPhy> argument
    * is deprecated and will be changed to \c Ptr<const SpectrumPhy>
@@ -0,0 +1,184 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/double.h>
+#include <ns3/net-device.h>
+#include <ns3/antenna-model.h>
+#include <ns3/spectrum-phy.h>
+#include <ns3/spectrum-value.h>
+#include <ns3/spectrum-signal-parameters.h>
+#include <ns3/spectrum-model-ism2400MHz-res1MHz.h>
+#include <ns3/multi-model-spectrum-channel.h>
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/constant-velocity-mobility-model.h>
+
+using namespace ns3;
+
+/**
+ * \ingroup spectrum
+ * A SpectrumPhy which counts the signals it receives.
+ */
+class CountingSpectrumPhy : public SpectrumPhy
+{
+public:
+  CountingSpectrumPhy ()
+    : m_received (0)
+  {
+  }
+
+  virtual void SetDevice (Ptr<NetDevice> d)
+  {
+  }
+  virtual Ptr<NetDevice> GetDevice () const
+  {
+    return 0;
+  }
+  virtual void SetMobility (Ptr<MobilityModel> m)
+  {
+    m_mobility = m;
+  }
+  virtual Ptr<MobilityModel> GetMobility ()
+  {
+    return m_mobility;
+  }
+  virtual void SetChannel (Ptr<SpectrumChannel> c)
+  {
+  }
+  virtual Ptr<const SpectrumModel> GetRxSpectrumModel () const
+  {
+    return SpectrumModelIsm2400MhzRes1Mhz;
+  }
+  virtual Ptr<AntennaModel> GetRxAntenna ()
+  {
+    return 0;
+  }
+  virtual void StartRx (Ptr<SpectrumSignalParameters> params)
+  {
+    m_received++;
+  }
+
+  uint32_t m_received;               //!< Number of signals received.
+
+private:
+  Ptr<MobilityModel> m_mobility;     //!< Mobility model.
+};
+
+/**
+ * \ingroup spectrum
+ * Check that MultiModelSpectrumChannel only delivers signals within
+ * MaxRange, as receivers move.
+ */
+class MultiModelSpectrumChannelRangeTestCase : public TestCase
+{
+public:
+  MultiModelSpectrumChannelRangeTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * Transmit a signal from a PHY.
+   *
+   * \param phy The transmitter.
+   */
+  void Send (Ptr<SpectrumPhy> phy);
+
+  /** The channel under test. */
+  Ptr<MultiModelSpectrumChannel> m_channel;
+};
+
+MultiModelSpectrumChannelRangeTestCase::MultiModelSpectrumChannelRangeTestCase ()
+  : TestCase ("Check the MaxRange of MultiModelSpectrumChannel")
+{
+}
+
+void
+MultiModelSpectrumChannelRangeTestCase::Send (Ptr<SpectrumPhy> phy)
+{
+  Ptr<SpectrumSignalParameters> params = Create<SpectrumSignalParameters> ();
+  params->psd = Create<SpectrumValue> (SpectrumModelIsm2400MhzRes1Mhz);
+  params->txPhy = phy;
+  params->duration = MicroSeconds (100);
+  m_channel->StartTx (params);
+}
+
+void
+MultiModelSpectrumChannelRangeTestCase::DoRun (void)
+{
+  m_channel = CreateObject<MultiModelSpectrumChannel> ();
+  m_channel->SetAttribute ("MaxRange", DoubleValue (100.0));
+
+  // A transmitter at the origin, receivers in range, out of range, and
+  // without mobility model.
+  double x[5] = { 0.0, 99.0, -30.0, 101.0, 250.0 };
+  Ptr<CountingSpectrumPhy> phys[5];
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      Ptr<ConstantPositionMobilityModel> mobility = CreateObject<ConstantPositionMobilityModel> ();
+      mobility->SetPosition (Vector (x[i], 0.0, 0.0));
+      phys[i] = CreateObject<CountingSpectrumPhy> ();
+      phys[i]->SetMobility (mobility);
+      m_channel->AddRx (phys[i]);
+    }
+  Ptr<CountingSpectrumPhy> anywhere = CreateObject<CountingSpectrumPhy> ();
+  m_channel->AddRx (anywhere);
+  // A receiver moving towards the transmitter at 10 m/s.
+  Ptr<ConstantVelocityMobilityModel> moving = CreateObject<ConstantVelocityMobilityModel> ();
+  moving->SetPosition (Vector (0.0, 150.0, 0.0));
+  moving->SetVelocity (Vector (0.0, -10.0, 0.0));
+  Ptr<CountingSpectrumPhy> mover = CreateObject<CountingSpectrumPhy> ();
+  mover->SetMobility (moving);
+  m_channel->AddRx (mover);
+
+  Simulator::Schedule (Seconds (1.0), &MultiModelSpectrumChannelRangeTestCase::Send, this, phys[0]);
+  // Move the receiver at 250 m next to the transmitter; by now the
+  // moving receiver is 60 m away.
+  Simulator::Schedule (Seconds (2.0), &ConstantPositionMobilityModel::SetPosition,
+                       DynamicCast<ConstantPositionMobilityModel> (phys[4]->GetMobility ()),
+                       Vector (0.0, 10.0, 0.0));
+  Simulator::Schedule (Seconds (9.0), &MultiModelSpectrumChannelRangeTestCase::Send, this, phys[0]);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (phys[0]->m_received, 0, "The transmitter received its own signal");
+  NS_TEST_EXPECT_MSG_EQ (phys[1]->m_received, 2, "Receiver at 99 m missed a signal");
+  NS_TEST_EXPECT_MSG_EQ (phys[2]->m_received, 2, "Receiver at 30 m missed a signal");
+  NS_TEST_EXPECT_MSG_EQ (phys[3]->m_received, 0, "Receiver at 101 m received a signal");
+  NS_TEST_EXPECT_MSG_EQ (phys[4]->m_received, 1, "Receiver moved in range should receive once");
+  NS_TEST_EXPECT_MSG_EQ (anywhere->m_received, 2, "Receiver without mobility missed a signal");
+  NS_TEST_EXPECT_MSG_EQ (mover->m_received, 1, "Moving receiver should receive once in range");
+
+  m_channel->Dispose ();
+  m_channel = 0;
+}
+
+/**
+ * \ingroup spectrum
+ * MultiModelSpectrumChannel test suite.
+ */
+class MultiModelSpectrumChannelTestSuite : public TestSuite
+{
+public:
+  MultiModelSpectrumChannelTestSuite ()
+    : TestSuite ("multi-model-spectrum-channel", UNIT)
+  {
+    AddTestCase (new MultiModelSpectrumChannelRangeTestCase, TestCase::QUICK);
+  }
+};
+
+static MultiModelSpectrumChannelTestSuite g_multiModelSpectrumChannelTestSuite;
@@ -0,0 +1,161 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Measure the cost of the transmissions of a YansWifiChannel shared by
+// a growing number of PHYs laid out on a square grid, with and without
+// the culling of receptions below the energy detection threshold.
+//
+// For each node count, the program prints the wall clock time of the
+// run, the number of reception and drop traces fired by the PHYs, and
+// the number of transmissions simulated per second of wall clock time.
+//
+// ./waf --run "yans-wifi-channel-bench --minNodes=64 --maxNodes=4096"
+
+#include "ns3/yans-wifi-channel.h"
+#include "ns3/yans-wifi-phy.h"
+#include "ns3/yans-error-rate-model.h"
+#include "ns3/propagation-loss-model.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/wifi-tx-vector.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+/** Number of PhyRxBegin and PhyRxDrop traces fired by the PHYs. */
+static uint64_t g_receptions = 0;
+
+static void
+RxBegin (Ptr<const Packet> p)
+{
+  g_receptions++;
+}
+
+static void
+RxDrop (Ptr<const Packet> p)
+{
+  g_receptions++;
+}
+
+static void
+Send (Ptr<YansWifiPhy> phy, uint32_t packetSize)
+{
+  WifiTxVector txVector;
+  txVector.SetMode (WifiMode ("OfdmRate54Mbps"));
+  txVector.SetTxPowerLevel (0);
+  phy->SendPacket (Create<Packet> (packetSize), txVector, WIFI_PREAMBLE_LONG);
+}
+
+/**
+ * Run one simulation.
+ *
+ * \param nNodes The number of PHYs.
+ * \param spacing The distance between neighbours of the grid, in meters.
+ * \param nPackets The number of transmissions.
+ * \param packetSize The size of the transmitted packets.
+ * \param culling Whether undetectable receptions are culled.
+ * \param [out] ms The wall clock time of the run, in milliseconds.
+ * \returns The number of reception and drop traces.
+ */
+static uint64_t
+RunOne (uint32_t nNodes, double spacing, uint32_t nPackets, uint32_t packetSize,
+        bool culling, int64_t &ms)
+{
+  g_receptions = 0;
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  channel->SetPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+  channel->SetAttribute ("EnableCulling", BooleanValue (culling));
+
+  Ptr<ErrorRateModel> error = CreateObject<YansErrorRateModel> ();
+  uint32_t side = static_cast<uint32_t> (std::ceil (std::sqrt (static_cast<double> (nNodes))));
+  std::vector<Ptr<YansWifiPhy> > phys;
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      Ptr<ConstantPositionMobilityModel> position = CreateObject<ConstantPositionMobilityModel> ();
+      position->SetPosition (Vector ((i % side) * spacing, (i / side) * spacing, 0.0));
+      Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+      phy->SetErrorRateModel (error);
+      phy->SetChannel (channel);
+      phy->SetMobility (position);
+      phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+      phy->TraceConnectWithoutContext ("PhyRxBegin", MakeCallback (&RxBegin));
+      phy->TraceConnectWithoutContext ("PhyRxDrop", MakeCallback (&RxDrop));
+      phys.push_back (phy);
+    }
+
+  // One transmission per millisecond, by the PHYs in a scattered order: a 54 Mbps
+  // frame is short enough that transmissions never overlap.
+  for (uint32_t i = 0; i < nPackets; i++)
+    {
+      Simulator::Schedule (MilliSeconds (i), &Send, phys[(i * 7919) % nNodes], packetSize);
+    }
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  ms = clock.End ();
+  Simulator::Destroy ();
+  return g_receptions;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t minNodes = 64;
+  uint32_t maxNodes = 1024;
+  double spacing = 50.0;
+  uint32_t nPackets = 1000;
+  uint32_t packetSize = 1000;
+
+  CommandLine cmd;
+  cmd.AddValue ("minNodes", "Number of PHYs of the first run", minNodes);
+  cmd.AddValue ("maxNodes", "Number of PHYs of the last run, doubling from minNodes", maxNodes);
+  cmd.AddValue ("spacing", "Distance between neighbours of the grid, in meters", spacing);
+  cmd.AddValue ("nPackets", "Number of transmissions of each run", nPackets);
+  cmd.AddValue ("packetSize", "Size of the transmitted packets", packetSize);
+  cmd.Parse (argc, argv);
+
+  std::cout << std::setw (8) << "nodes"
+            << std::setw (10) << "culling"
+            << std::setw (12) << "ms"
+            << std::setw (14) << "rx traces"
+            << std::setw (14) << "tx/s" << std::endl;
+  for (uint32_t nNodes = minNodes; nNodes <= maxNodes; nNodes *= 2)
+    {
+      for (uint32_t culling = 0; culling < 2; culling++)
+        {
+          int64_t ms;
+          uint64_t receptions = RunOne (nNodes, spacing, nPackets, packetSize, culling != 0, ms);
+          double txPerSecond = nPackets * 1000.0 / (ms > 0 ? ms : 1);
+          std::cout << std::setw (8) << nNodes
+                    << std::setw (10) << (culling ? "on" : "off")
+                    << std::setw (12) << ms
+                    << std::setw (14) << receptions
+                    << std::setw (14) << static_cast<uint64_t> (txPerSecond) << std::endl;
+        }
+    }
+  return 0;
+}
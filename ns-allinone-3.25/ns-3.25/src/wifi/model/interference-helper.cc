@@ -194,10 +194,10 @@ InterferenceHelper::GetEnergyDuration (double energyW)
   double noiseInterferenceW = 0.0;
   Time end = now;
   noiseInterferenceW = m_firstPower;
-  for (NiChanges::const_iterator i = m_niChanges.begin (); i != m_niChanges.end (); i++)
+  for (NiChangeMap::const_iterator i = m_niChanges.begin (); i != m_niChanges.end (); i++)
     {
-      noiseInterferenceW += i->GetDelta ();
-      end = i->GetTime ();
+      noiseInterferenceW += i->second;
+      end = i->first;
       if (end < now)
         {
           continue;
@@ -216,18 +216,10 @@ InterferenceHelper::AppendEvent (Ptr<InterferenceHelper::Event> event)
   Time now = Simulator::Now ();
   if (!m_rxing)
     {
-      NiChanges::iterator nowIterator = GetPosition (now);
-      for (NiChanges::iterator i = m_niChanges.begin (); i != nowIterator; i++)
-        {
-          m_firstPower += i->GetDelta ();
-        }
-      m_niChanges.erase (m_niChanges.begin (), nowIterator);
-      m_niChanges.insert (m_niChanges.begin (), NiChange (event->GetStartTime (), event->GetRxPowerW ()));
-    }
-  else
-    {
-      AddNiChangeEvent (NiChange (event->GetStartTime (), event->GetRxPowerW ()));
+      //the remaining changes are all later than the start of the event
+      FoldNiChanges (now);
     }
+  AddNiChangeEvent (NiChange (event->GetStartTime (), event->GetRxPowerW ()));
   AddNiChangeEvent (NiChange (event->GetEndTime (), -event->GetRxPowerW ()));
 
 }
@@ -253,13 +245,18 @@ InterferenceHelper::CalculateNoiseInterferenceW (Ptr<InterferenceHelper::Event>
 {
   double noiseInterference = m_firstPower;
   NS_ASSERT (m_rxing);
-  for (NiChanges::const_iterator i = m_niChanges.begin () + 1; i != m_niChanges.end (); i++)
+  //only the changes during the event are visited: the first change is
+  //the start of the event, and its end is the last change at its end time
+  NiChangeMap::const_iterator i = m_niChanges.begin ();
+  NiChangeMap::const_iterator end = m_niChanges.upper_bound (event->GetEndTime ());
+  NS_ASSERT (i != end);
+  for (i++; i != end; i++)
     {
-      if ((event->GetEndTime () == i->GetTime ()) && event->GetRxPowerW () == -i->GetDelta ())
+      if ((event->GetEndTime () == i->first) && event->GetRxPowerW () == -i->second)
         {
           break;
         }
-      ni->push_back (*i);
+      ni->push_back (NiChange (i->first, i->second));
     }
   ni->insert (ni->begin (), NiChange (event->GetStartTime (), noiseInterference));
   ni->push_back (NiChange (event->GetEndTime (), 0));
@@ -833,16 +830,22 @@ InterferenceHelper::EraseEvents (void)
   m_firstPower = 0.0;
 }
 
-InterferenceHelper::NiChanges::iterator
-InterferenceHelper::GetPosition (Time moment)
+void
+InterferenceHelper::FoldNiChanges (Time moment)
 {
-  return std::upper_bound (m_niChanges.begin (), m_niChanges.end (), NiChange (moment, 0));
+  NiChangeMap::iterator end = m_niChanges.upper_bound (moment);
+  for (NiChangeMap::const_iterator i = m_niChanges.begin (); i != end; i++)
+    {
+      m_firstPower += i->second;
+    }
+  m_niChanges.erase (m_niChanges.begin (), end);
 }
 
 void
 InterferenceHelper::AddNiChangeEvent (NiChange change)
 {
-  m_niChanges.insert (GetPosition (change.GetTime ()), change);
+  //a change is inserted after the changes at the same time
+  m_niChanges.insert (std::make_pair (change.GetTime (), change.GetDelta ()));
 }
 
 void
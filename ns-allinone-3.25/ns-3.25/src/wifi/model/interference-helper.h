@@ -24,6 +24,7 @@
 #include <stdint.h>
 #include <vector>
 #include <list>
+#include <map>
 #include "wifi-mode.h"
 #include "wifi-preamble.h"
 #include "wifi-phy-standard.h"
@@ -259,6 +260,11 @@ private:
    * typedef for a vector of NiChanges
    */
   typedef std::vector <NiChange> NiChanges;
+  /**
+   * typedef for the power changes recorded by the helper, in time order:
+   * changes at the same time are kept in insertion order.
+   */
+  typedef std::multimap <Time, double> NiChangeMap;
   /**
    * typedef for a list of Events
    */
@@ -325,12 +331,23 @@ private:
 
   double m_noiseFigure; /**< noise figure (linear) */
   Ptr<ErrorRateModel> m_errorRateModel;
-  /// Experimental: needed for energy duration calculation
-  NiChanges m_niChanges;
+  /**
+   * The power changes, in a balanced tree so that a change is inserted
+   * in logarithmic time wherever it falls. The changes up to the start
+   * of the event being received, or up to the last event added while
+   * not receiving, are folded into m_firstPower, so that the first
+   * change is the start of the event being received.
+   */
+  NiChangeMap m_niChanges;
   double m_firstPower;
   bool m_rxing;
-  /// Returns an iterator to the first nichange, which is later than moment
-  NiChanges::iterator GetPosition (Time moment);
+  /**
+   * Fold the changes up to and including the given time into
+   * m_firstPower and forget them.
+   *
+   * \param moment
+   */
+  void FoldNiChanges (Time moment);
   /**
    * Add NiChange to the list at the appropriate position.
    *
@@ -259,31 +259,31 @@ WifiMac::GetMaxPropagationDelay (void) const
 void
 WifiMac::NotifyTx (Ptr<const Packet> packet)
 {
-  m_macTxTrace (packet);
+  NS_OPTIONAL_TRACE (m_macTxTrace (packet));
 }
 
 void
 WifiMac::NotifyTxDrop (Ptr<const Packet> packet)
 {
-  m_macTxDropTrace (packet);
+  NS_OPTIONAL_TRACE (m_macTxDropTrace (packet));
 }
 
 void
 WifiMac::NotifyRx (Ptr<const Packet> packet)
 {
-  m_macRxTrace (packet);
+  NS_OPTIONAL_TRACE (m_macRxTrace (packet));
 }
 
 void
 WifiMac::NotifyPromiscRx (Ptr<const Packet> packet)
 {
-  m_macPromiscRxTrace (packet);
+  NS_OPTIONAL_TRACE (m_macPromiscRxTrace (packet));
 }
 
 void
 WifiMac::NotifyRxDrop (Ptr<const Packet> packet)
 {
-  m_macRxDropTrace (packet);
+  NS_OPTIONAL_TRACE (m_macRxDropTrace (packet));
 }
 
 void
@@ -722,49 +722,49 @@ WifiPhy::CalculateTxDuration (uint32_t size, WifiTxVector txVector, WifiPreamble
 void
 WifiPhy::NotifyTxBegin (Ptr<const Packet> packet)
 {
-  m_phyTxBeginTrace (packet);
+  NS_OPTIONAL_TRACE (m_phyTxBeginTrace (packet));
 }
 
 void
 WifiPhy::NotifyTxEnd (Ptr<const Packet> packet)
 {
-  m_phyTxEndTrace (packet);
+  NS_OPTIONAL_TRACE (m_phyTxEndTrace (packet));
 }
 
 void
 WifiPhy::NotifyTxDrop (Ptr<const Packet> packet)
 {
-  m_phyTxDropTrace (packet);
+  NS_OPTIONAL_TRACE (m_phyTxDropTrace (packet));
 }
 
 void
 WifiPhy::NotifyRxBegin (Ptr<const Packet> packet)
 {
-  m_phyRxBeginTrace (packet);
+  NS_OPTIONAL_TRACE (m_phyRxBeginTrace (packet));
 }
 
 void
 WifiPhy::NotifyRxEnd (Ptr<const Packet> packet)
 {
-  m_phyRxEndTrace (packet);
+  NS_OPTIONAL_TRACE (m_phyRxEndTrace (packet));
 }
 
 void
 WifiPhy::NotifyRxDrop (Ptr<const Packet> packet)
 {
-  m_phyRxDropTrace (packet);
+  NS_OPTIONAL_TRACE (m_phyRxDropTrace (packet));
 }
 
 void
 WifiPhy::NotifyMonitorSniffRx (Ptr<const Packet> packet, uint16_t channelFreqMhz, uint16_t channelNumber, uint32_t rate, WifiPreamble preamble, WifiTxVector txVector, struct mpduInfo aMpdu, struct signalNoiseDbm signalNoise)
 {
-  m_phyMonitorSniffRxTrace (packet, channelFreqMhz, channelNumber, rate, preamble, txVector, aMpdu, signalNoise);
+  NS_OPTIONAL_TRACE (m_phyMonitorSniffRxTrace (packet, channelFreqMhz, channelNumber, rate, preamble, txVector, aMpdu, signalNoise));
 }
 
 void
 WifiPhy::NotifyMonitorSniffTx (Ptr<const Packet> packet, uint16_t channelFreqMhz, uint16_t channelNumber, uint32_t rate, WifiPreamble preamble, WifiTxVector txVector, struct mpduInfo aMpdu)
 {
-  m_phyMonitorSniffTxTrace (packet, channelFreqMhz, channelNumber, rate, preamble, txVector, aMpdu);
+  NS_OPTIONAL_TRACE (m_phyMonitorSniffTxTrace (packet, channelFreqMhz, channelNumber, rate, preamble, txVector, aMpdu));
 }
 
 
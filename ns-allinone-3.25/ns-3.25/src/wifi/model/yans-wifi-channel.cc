@@ -25,6 +25,8 @@
 #include "ns3/node.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
 #include "ns3/object-factory.h"
 #include "yans-wifi-channel.h"
 #include "ns3/propagation-loss-model.h"
@@ -51,11 +53,27 @@ YansWifiChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&YansWifiChannel::m_delay),
                    MakePointerChecker<PropagationDelayModel> ())
+    .AddAttribute ("EnableCulling",
+                   "If true, do not deliver a transmission to the PHYs which receive it "
+                   "more than CullingMargin dB below their energy detection threshold. "
+                   "Such signals no longer add to the interference seen by these PHYs.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&YansWifiChannel::m_culling),
+                   MakeBooleanChecker ())
+    .AddAttribute ("CullingMargin",
+                   "The margin, in dB, below the energy detection threshold of a PHY "
+                   "under which transmissions are not delivered to that PHY, when "
+                   "EnableCulling is true.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&YansWifiChannel::m_cullingMargin),
+                   MakeDoubleChecker<double> (0.0))
   ;
   return tid;
 }
 
 YansWifiChannel::YansWifiChannel ()
+  : m_culling (false),
+    m_cullingMargin (0.0)
 {
 }
 
@@ -83,22 +101,36 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
 {
   Ptr<MobilityModel> senderMobility = sender->GetMobility ()->GetObject<MobilityModel> ();
   NS_ASSERT (senderMobility != 0);
+  uint16_t channelNumber = sender->GetChannelNumber ();
+  struct Parameters parameters;
+  parameters.type = mpdutype;
+  parameters.duration = duration;
+  parameters.txVector = txVector;
+  parameters.preamble = preamble;
   uint32_t j = 0;
   for (PhyList::const_iterator i = m_phyList.begin (); i != m_phyList.end (); i++, j++)
     {
       if (sender != (*i))
         {
           //For now don't account for inter channel interference
-          if ((*i)->GetChannelNumber () != sender->GetChannelNumber ())
+          if ((*i)->GetChannelNumber () != channelNumber)
             {
               continue;
             }
 
           Ptr<MobilityModel> receiverMobility = (*i)->GetMobility ()->GetObject<MobilityModel> ();
+          //Both models are evaluated for every receiver, in the same order,
+          //so that culling does not change the random variates they draw.
           Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
           double rxPowerDbm = m_loss->CalcRxPower (txPowerDbm, senderMobility, receiverMobility);
           NS_LOG_DEBUG ("propagation: txPower=" << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, " <<
                         "distance=" << senderMobility->GetDistanceFrom (receiverMobility) << "m, delay=" << delay);
+          if (m_culling
+              && rxPowerDbm + (*i)->GetRxGain () + m_cullingMargin < (*i)->GetEdThreshold ())
+            {
+              NS_LOG_DEBUG ("culled: rxPower=" << rxPowerDbm << "dbm, receiver " << j);
+              continue;
+            }
           Ptr<Packet> copy = packet->Copy ();
           Ptr<Object> dstNetDevice = m_phyList[j]->GetDevice ();
           uint32_t dstNode;
@@ -111,13 +143,7 @@ YansWifiChannel::Send (Ptr<YansWifiPhy> sender, Ptr<const Packet> packet, double
               dstNode = dstNetDevice->GetObject<NetDevice> ()->GetNode ()->GetId ();
             }
 
-          struct Parameters parameters;
           parameters.rxPowerDbm = rxPowerDbm;
-          parameters.type = mpdutype;
-          parameters.duration = duration;
-          parameters.txVector = txVector;
-          parameters.preamble = preamble;
-
           Simulator::ScheduleWithContext (dstNode,
                                           delay, &YansWifiChannel::Receive, this,
                                           j, copy, parameters);
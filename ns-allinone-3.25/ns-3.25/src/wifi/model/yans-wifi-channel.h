@@ -57,6 +57,14 @@ struct Parameters
  * class and contains a ns3::PropagationLossModel and a ns3::PropagationDelayModel.
  * By default, no propagation models are set so, it is the caller's responsability
  * to set them before using the channel.
+ *
+ * In dense deployments most receivers of a transmission may hear it far
+ * below their energy detection threshold. When the EnableCulling
+ * attribute is set, Send does not schedule the reception of such a
+ * transmission at all, so that the cost of a transmission depends on the
+ * number of PHYs which could detect it rather than on the number of PHYs
+ * on the channel. The culled signals are then ignored by the interference
+ * computation of these PHYs, which the CullingMargin attribute bounds.
  */
 class YansWifiChannel : public WifiChannel
 {
@@ -137,6 +145,8 @@ private:
   PhyList m_phyList;                   //!< List of YansWifiPhys connected to this YansWifiChannel
   Ptr<PropagationLossModel> m_loss;    //!< Propagation loss model
   Ptr<PropagationDelayModel> m_delay;  //!< Propagation delay model
+  bool m_culling;                      //!< Whether undetectable receptions are culled
+  double m_cullingMargin;              //!< Culling margin below the energy detection threshold (dB)
 };
 
 } //namespace ns3
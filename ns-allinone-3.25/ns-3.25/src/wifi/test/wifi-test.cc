@@ -618,6 +618,111 @@ Bug730TestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (result, true, "packet reception unexpectedly stopped after adapting fragmentation threshold!");
 }
 
+//-----------------------------------------------------------------------------
+/**
+ * Check that YansWifiChannel culls the receptions below the energy
+ * detection threshold only when asked to.
+ */
+class YansWifiChannelCullingTest : public TestCase
+{
+public:
+  YansWifiChannelCullingTest ();
+
+  virtual void DoRun (void);
+
+
+private:
+  /**
+   * Send one packet from a PHY to a near and a far PHY.
+   *
+   * \param culling Whether the channel culls undetectable receptions.
+   */
+  void RunOne (bool culling);
+  void Send (Ptr<YansWifiPhy> phy);
+  void Receive (std::string context, Ptr<const Packet> p);
+
+  uint32_t m_near;  //!< Receptions started by the near PHY
+  uint32_t m_far;   //!< Receptions started by the far PHY
+};
+
+YansWifiChannelCullingTest::YansWifiChannelCullingTest ()
+  : TestCase ("Culling of undetectable receptions by YansWifiChannel"),
+    m_near (0),
+    m_far (0)
+{
+}
+
+void
+YansWifiChannelCullingTest::Send (Ptr<YansWifiPhy> phy)
+{
+  WifiTxVector txVector;
+  txVector.SetMode (WifiMode ("OfdmRate6Mbps"));
+  txVector.SetTxPowerLevel (0);
+  phy->SendPacket (Create<Packet> (1000), txVector, WIFI_PREAMBLE_LONG);
+}
+
+void
+YansWifiChannelCullingTest::Receive (std::string context, Ptr<const Packet> p)
+{
+  if (context == "near")
+    {
+      m_near++;
+    }
+  else
+    {
+      m_far++;
+    }
+}
+
+void
+YansWifiChannelCullingTest::RunOne (bool culling)
+{
+  m_near = 0;
+  m_far = 0;
+  Ptr<YansWifiChannel> channel = CreateObject<YansWifiChannel> ();
+  channel->SetPropagationDelayModel (CreateObject<ConstantSpeedPropagationDelayModel> ());
+  channel->SetPropagationLossModel (CreateObject<LogDistancePropagationLossModel> ());
+  channel->SetAttribute ("EnableCulling", BooleanValue (culling));
+
+  Ptr<ErrorRateModel> error = CreateObject<YansErrorRateModel> ();
+  Ptr<YansWifiPhy> phys[3];
+  // The far PHY receives the transmission about 166 dB below the
+  // transmission power, far below its energy detection threshold.
+  double distances[3] = { 0.0, 5.0, 10000.0 };
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Ptr<ConstantPositionMobilityModel> position = CreateObject<ConstantPositionMobilityModel> ();
+      position->SetPosition (Vector (distances[i], 0.0, 0.0));
+      phys[i] = CreateObject<YansWifiPhy> ();
+      phys[i]->SetErrorRateModel (error);
+      phys[i]->SetChannel (channel);
+      phys[i]->SetMobility (position);
+      phys[i]->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+    }
+  for (uint32_t i = 1; i < 3; i++)
+    {
+      std::string context = (i == 1) ? "near" : "far";
+      phys[i]->TraceConnect ("PhyRxBegin", context, MakeCallback (&YansWifiChannelCullingTest::Receive, this));
+      phys[i]->TraceConnect ("PhyRxDrop", context, MakeCallback (&YansWifiChannelCullingTest::Receive, this));
+    }
+
+  Simulator::Schedule (Seconds (1.0), &YansWifiChannelCullingTest::Send, this, phys[0]);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+YansWifiChannelCullingTest::DoRun (void)
+{
+  RunOne (false);
+  NS_TEST_EXPECT_MSG_EQ (m_near, 1, "The near PHY did not see the transmission");
+  NS_TEST_EXPECT_MSG_EQ (m_far, 1, "Without culling, the far PHY should see the transmission");
+
+  RunOne (true);
+  NS_TEST_EXPECT_MSG_EQ (m_near, 1, "Culling dropped a detectable reception");
+  NS_TEST_EXPECT_MSG_EQ (m_far, 0, "Culling did not drop an undetectable reception");
+}
+
 //-----------------------------------------------------------------------------
 class WifiTestSuite : public TestSuite
 {
@@ -633,6 +738,7 @@ WifiTestSuite::WifiTestSuite ()
   AddTestCase (new InterferenceHelperSequenceTest, TestCase::QUICK); //Bug 991
   AddTestCase (new Bug555TestCase, TestCase::QUICK); //Bug 555
   AddTestCase (new Bug730TestCase, TestCase::QUICK); //Bug 730
+  AddTestCase (new YansWifiChannelCullingTest, TestCase::QUICK);
 }
 
 static WifiTestSuite g_wifiTestSuite;
@@ -0,0 +1,100 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Measure the cost of a log message whose level is disabled, of a
+// message written to std::clog (redirected to a file), and of a
+// message written to a binary sink.
+//
+// ./waf --run "bench-log --n=1000000"
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("BenchLog");
+
+/**
+ * Print a result line.
+ *
+ * \param [in] name The name of the measurement.
+ * \param [in] n The number of operations.
+ * \param [in] ms The wall clock time of the operations, in milliseconds.
+ */
+static void
+Report (std::string name, uint32_t n, int64_t ms)
+{
+  double perSecond = n * 1000.0 / (ms > 0 ? ms : 1);
+  std::cout << std::left << std::setw (28) << name
+            << std::right << std::setw (10) << ms
+            << std::setw (14) << static_cast<uint64_t> (perSecond) << std::endl;
+}
+
+/**
+ * Time log messages.
+ *
+ * \param [in] name The name of the measurement.
+ * \param [in] n The number of messages.
+ */
+static void
+Log (std::string name, uint32_t n)
+{
+  double x = 0.5;
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      NS_LOG_DEBUG ("packet " << i << " size " << 1000 + (i & 0xff) << " x " << x);
+    }
+  Report (name, n, clock.End ());
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t n = 1000000;
+  std::string file = "bench-log.tmp";
+
+  CommandLine cmd;
+  cmd.AddValue ("n", "Number of messages of each measurement", n);
+  cmd.AddValue ("file", "Scratch file of the log messages", file);
+  cmd.Parse (argc, argv);
+
+  std::cout << std::left << std::setw (28) << "operation"
+            << std::right << std::setw (10) << "ms"
+            << std::setw (14) << "msg/s" << std::endl;
+
+  Log ("disabled", n);
+
+  LogComponentEnable ("BenchLog", LOG_LEVEL_DEBUG);
+  LogComponentEnable ("BenchLog", LOG_PREFIX_ALL);
+  {
+    std::ofstream os (file.c_str ());
+    std::streambuf *clog = std::clog.rdbuf (os.rdbuf ());
+    Log ("std::clog", n);
+    std::clog.rdbuf (clog);
+  }
+
+  LogSetBinarySink (file, 65536);
+  Log ("binary sink", n);
+  LogCloseBinarySink ();
+  std::remove (file.c_str ());
+  return 0;
+}
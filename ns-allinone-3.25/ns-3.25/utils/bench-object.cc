@@ -0,0 +1,219 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Measure the cost of the TypeId machinery: the creation of objects
+// through an ObjectFactory, the lookup of attributes and trace sources
+// by name, the lookup of TypeIds by name, and the lookup of aggregated
+// objects.
+//
+// ./waf --run "bench-object --n=1000000"
+
+#include <iomanip>
+#include <iostream>
+
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+/** A base class with a few attributes and a trace source. */
+class BenchBase : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+private:
+  uint32_t m_a;
+  uint32_t m_b;
+  double m_c;
+  TracedValue<uint32_t> m_trace;
+};
+
+TypeId
+BenchBase::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("BenchBase")
+    .SetParent<Object> ()
+    .AddAttribute ("A", "", UintegerValue (1),
+                   MakeUintegerAccessor (&BenchBase::m_a),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("B", "", UintegerValue (2),
+                   MakeUintegerAccessor (&BenchBase::m_b),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("C", "", DoubleValue (3.0),
+                   MakeDoubleAccessor (&BenchBase::m_c),
+                   MakeDoubleChecker<double> ())
+    .AddTraceSource ("Trace", "",
+                     MakeTraceSourceAccessor (&BenchBase::m_trace),
+                     "ns3::TracedValueCallback::Uint32")
+  ;
+  return tid;
+}
+
+/** A derived class, so that lookups have to find inherited attributes. */
+class BenchDerived : public BenchBase
+{
+public:
+  static TypeId GetTypeId (void);
+private:
+  uint32_t m_d;
+  uint32_t m_e;
+  double m_f;
+};
+
+TypeId
+BenchDerived::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("BenchDerived")
+    .SetParent<BenchBase> ()
+    .AddConstructor<BenchDerived> ()
+    .AddAttribute ("D", "", UintegerValue (4),
+                   MakeUintegerAccessor (&BenchDerived::m_d),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("E", "", UintegerValue (5),
+                   MakeUintegerAccessor (&BenchDerived::m_e),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("F", "", DoubleValue (6.0),
+                   MakeDoubleAccessor (&BenchDerived::m_f),
+                   MakeDoubleChecker<double> ())
+  ;
+  return tid;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (BenchDerived);
+
+/** An object to aggregate. */
+class BenchAggregateA : public Object
+{
+public:
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("BenchAggregateA")
+      .SetParent<Object> ()
+    ;
+    return tid;
+  }
+};
+
+/** Another object to aggregate. */
+class BenchAggregateB : public BenchAggregateA
+{
+public:
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("BenchAggregateB")
+      .SetParent<BenchAggregateA> ()
+    ;
+    return tid;
+  }
+};
+
+static void
+Sink (uint32_t oldValue, uint32_t newValue)
+{
+}
+
+/**
+ * Print a result line.
+ *
+ * \param [in] name The name of the measurement.
+ * \param [in] n The number of operations.
+ * \param [in] ms The wall clock time of the operations, in milliseconds.
+ */
+static void
+Report (std::string name, uint32_t n, int64_t ms)
+{
+  double perSecond = n * 1000.0 / (ms > 0 ? ms : 1);
+  std::cout << std::left << std::setw (28) << name
+            << std::right << std::setw (10) << ms
+            << std::setw (14) << static_cast<uint64_t> (perSecond) << std::endl;
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t n = 1000000;
+
+  CommandLine cmd;
+  cmd.AddValue ("n", "Number of operations of each measurement", n);
+  cmd.Parse (argc, argv);
+
+  ObjectFactory factory;
+  factory.SetTypeId ("BenchDerived");
+  factory.Set ("A", UintegerValue (10));
+  factory.Set ("E", UintegerValue (50));
+  Ptr<Object> object = factory.Create ();
+
+  std::cout << std::left << std::setw (28) << "operation"
+            << std::right << std::setw (10) << "ms"
+            << std::setw (14) << "ops/s" << std::endl;
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      factory.Create ();
+    }
+  Report ("ObjectFactory::Create", n, clock.End ());
+
+  clock.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      factory.Set ("B", UintegerValue (i));
+    }
+  Report ("ObjectFactory::Set", n, clock.End ());
+
+  clock.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      object->SetAttribute ("C", DoubleValue (i));
+    }
+  Report ("SetAttribute (inherited)", n, clock.End ());
+
+  clock.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      object->TraceConnectWithoutContext ("Trace", MakeCallback (&Sink));
+      object->TraceDisconnectWithoutContext ("Trace", MakeCallback (&Sink));
+    }
+  Report ("TraceConnect+Disconnect", n, clock.End ());
+
+  clock.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      TypeId::LookupByName ("BenchDerived");
+    }
+  Report ("TypeId::LookupByName", n, clock.End ());
+
+  object->AggregateObject (CreateObject<BenchAggregateA> ());
+  object->AggregateObject (CreateObject<BenchAggregateB> ());
+  clock.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      object->GetObject<BenchAggregateB> ();
+      object->GetObject<BenchDerived> ();
+    }
+  Report ("GetObject", 2 * n, clock.End ());
+
+  Config::RegisterRootNamespaceObject (object);
+  clock.Start ();
+  for (uint32_t i = 0; i < n / 10; i++)
+    {
+      Config::Set ("/$BenchAggregateB/$BenchDerived/C", DoubleValue (i));
+    }
+  Report ("Config::Set", n / 10, clock.End ());
+  Config::UnregisterRootNamespaceObject (object);
+
+  return 0;
+}
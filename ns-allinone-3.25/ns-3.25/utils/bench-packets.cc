@@ -302,6 +302,44 @@ benchByteTags (uint32_t n)
     }
 }
 
+static void
+benchPacketTags (uint32_t n)
+{
+  // The sizes of the QosTag, AmpduTag and SnrTag added by wifi
+  BenchTag<1> qos;
+  BenchTag<2> ampdu;
+  BenchTag<8> snr;
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (1500);
+      p->AddPacketTag (qos);
+      p->AddPacketTag (ampdu);
+      Ptr<Packet> rx = p->Copy ();
+      rx->AddPacketTag (snr);
+      rx->PeekPacketTag (qos);
+      rx->PeekPacketTag (ampdu);
+      rx->RemovePacketTag (snr);
+      rx->RemovePacketTag (ampdu);
+      rx->RemovePacketTag (qos);
+    }
+}
+
+static void
+benchFlowProbeTags (uint32_t n)
+{
+  // The size of the Ipv4FlowProbeTag added by FlowMonitor
+  BenchTag<20> probe;
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (1500);
+      p->AddByteTag (probe);
+      Ptr<Packet> rx = p->Copy ();
+      rx->FindFirstMatchingByteTag (probe);
+    }
+}
+
 static uint64_t
 runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
 {
@@ -359,6 +397,8 @@ int main (int argc, char *argv[])
   runBench (&benchD, n, minIterations, "Intermixed add/remove headers and tags");
   runBench (&benchFragment, n, minIterations, "Fragmentation and concatenation");
   runBench (&benchByteTags, n, minIterations, "Benchmark byte tags");
+  runBench (&benchPacketTags, n, minIterations, "Wifi packet tags");
+  runBench (&benchFlowProbeTags, n, minIterations, "Flow probe byte tags");
 
   return 0;
 }
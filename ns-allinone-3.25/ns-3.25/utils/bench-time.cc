@@ -0,0 +1,142 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Measure the throughput of Time arithmetic, of the conversions
+// between Times and numbers, and of the computation of transmission
+// times by DataRate.
+//
+// The measurements run from within Simulator::Run, where Time
+// instances are no longer recorded for a change of resolution.
+//
+// ./waf --run "bench-time --n=10000000"
+
+#include <iomanip>
+#include <iostream>
+
+#include "ns3/core-module.h"
+#include "ns3/data-rate.h"
+
+using namespace ns3;
+
+/** Accumulate results, so that the measured operations are not elided. */
+static double g_sink = 0;
+
+/**
+ * Print a result line.
+ *
+ * \param [in] name The name of the measurement.
+ * \param [in] n The number of operations.
+ * \param [in] ms The wall clock time of the operations, in milliseconds.
+ */
+static void
+Report (std::string name, uint32_t n, int64_t ms)
+{
+  double perSecond = n * 1000.0 / (ms > 0 ? ms : 1);
+  std::cout << std::left << std::setw (28) << name
+            << std::right << std::setw (10) << ms
+            << std::setw (14) << static_cast<uint64_t> (perSecond) << std::endl;
+}
+
+/**
+ * Run all the measurements.
+ *
+ * \param [in] n The number of operations of each measurement.
+ */
+static void
+Bench (uint32_t n)
+{
+  std::cout << std::left << std::setw (28) << "operation"
+            << std::right << std::setw (10) << "ms"
+            << std::setw (14) << "ops/s" << std::endl;
+
+  Time a = MicroSeconds (3);
+  Time b = NanoSeconds (7);
+  SystemWallClockMs clock;
+
+  clock.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      a = a + b;
+    }
+  Report ("Time + Time", n, clock.End ());
+
+  clock.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      g_sink += (b * (i & 0xff)).GetTimeStep ();
+    }
+  Report ("Time * integer", n, clock.End ());
+
+  clock.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      g_sink += a / b;
+    }
+  Report ("Time / Time", n, clock.End ());
+
+  clock.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      g_sink += a.GetSeconds ();
+    }
+  Report ("GetSeconds", n, clock.End ());
+
+  clock.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      g_sink += a.GetMicroSeconds ();
+    }
+  Report ("GetMicroSeconds", n, clock.End ());
+
+  clock.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      g_sink += Seconds (i * 1e-6).GetTimeStep ();
+    }
+  Report ("Seconds (double)", n, clock.End ());
+
+  clock.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      g_sink += MicroSeconds (i).GetTimeStep ();
+    }
+  Report ("MicroSeconds (integer)", n, clock.End ());
+
+  DataRate rate ("54Mbps");
+  clock.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      g_sink += rate.CalculateBytesTxTime (i & 0x7ff).GetTimeStep ();
+    }
+  Report ("CalculateBytesTxTime", n, clock.End ());
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t n = 10000000;
+
+  CommandLine cmd;
+  cmd.AddValue ("n", "Number of operations of each measurement", n);
+  cmd.Parse (argc, argv);
+
+  Simulator::ScheduleNow (&Bench, n);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::cout << "checksum: " << g_sink << std::endl;
+  return 0;
+}
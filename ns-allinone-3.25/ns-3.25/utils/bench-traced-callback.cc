@@ -0,0 +1,109 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Measure the cost of firing a TracedCallback with no sink, which is
+// the common case of most trace sources, and with a few sinks, and the
+// cost of connecting and disconnecting a sink.
+//
+// ./waf --run "bench-traced-callback --n=10000000"
+
+#include <iomanip>
+#include <iostream>
+
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+/** The number of sink invocations. */
+static uint64_t g_calls = 0;
+
+static void
+Sink (uint32_t a, double b)
+{
+  g_calls++;
+}
+
+/**
+ * Print a result line.
+ *
+ * \param [in] name The name of the measurement.
+ * \param [in] n The number of operations.
+ * \param [in] ms The wall clock time of the operations, in milliseconds.
+ */
+static void
+Report (std::string name, uint32_t n, int64_t ms)
+{
+  double perSecond = n * 1000.0 / (ms > 0 ? ms : 1);
+  std::cout << std::left << std::setw (28) << name
+            << std::right << std::setw (10) << ms
+            << std::setw (14) << static_cast<uint64_t> (perSecond) << std::endl;
+}
+
+/**
+ * Time the invocations of a TracedCallback.
+ *
+ * \param [in] name The name of the measurement.
+ * \param [in] trace The TracedCallback.
+ * \param [in] n The number of invocations.
+ */
+static void
+Fire (std::string name, const TracedCallback<uint32_t, double> &trace, uint32_t n)
+{
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      trace (i, 1.0);
+    }
+  Report (name, n, clock.End ());
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t n = 10000000;
+
+  CommandLine cmd;
+  cmd.AddValue ("n", "Number of operations of each measurement", n);
+  cmd.Parse (argc, argv);
+
+  std::cout << std::left << std::setw (28) << "operation"
+            << std::right << std::setw (10) << "ms"
+            << std::setw (14) << "ops/s" << std::endl;
+
+  TracedCallback<uint32_t, double> trace;
+  Fire ("fire, no sink", trace, n);
+  trace.ConnectWithoutContext (MakeCallback (&Sink));
+  Fire ("fire, 1 sink", trace, n);
+  trace.ConnectWithoutContext (MakeCallback (&Sink));
+  Fire ("fire, 2 sinks", trace, n);
+  trace.ConnectWithoutContext (MakeCallback (&Sink));
+  trace.ConnectWithoutContext (MakeCallback (&Sink));
+  Fire ("fire, 4 sinks", trace, n);
+
+  TracedCallback<uint32_t, double> other;
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < n / 10; i++)
+    {
+      other.ConnectWithoutContext (MakeCallback (&Sink));
+      other.DisconnectWithoutContext (MakeCallback (&Sink));
+    }
+  Report ("connect+disconnect", n / 10, clock.End ());
+
+  std::cout << "sink calls: " << g_calls << std::endl;
+  return 0;
+}
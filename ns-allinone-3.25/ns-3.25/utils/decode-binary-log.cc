@@ -0,0 +1,44 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Print the messages of a binary log sink, written by a program which
+// called LogSetBinarySink, from the oldest to the newest.
+//
+// ./waf --run "decode-binary-log --file=simulation.log"
+
+#include <iostream>
+
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+int
+main (int argc, char *argv[])
+{
+  std::string file;
+
+  CommandLine cmd;
+  cmd.AddValue ("file", "The file of the binary log sink", file);
+  cmd.Parse (argc, argv);
+
+  if (file.empty ())
+    {
+      std::cerr << "usage: decode-binary-log --file=FILE" << std::endl;
+      return 1;
+    }
+  LogDecodeBinarySink (file, std::cout);
+  return 0;
+}